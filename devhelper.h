@@ -14,6 +14,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 // Platform-specific includes
 #ifdef _WIN32
@@ -78,6 +79,66 @@ typedef struct {
     int total_credits;
 } AcademicInfo;
 
+// System monitor sampling structures (Linux /proc)
+#define SYSMON_MAX_CPUS 256
+
+typedef struct {
+    unsigned long long user;
+    unsigned long long nice;
+    unsigned long long system;
+    unsigned long long idle;
+    unsigned long long iowait;
+    unsigned long long irq;
+    unsigned long long softirq;
+    unsigned long long steal;
+} CpuTimes;
+
+typedef struct {
+    int cpu_count;
+    int procs_running;
+    unsigned long long context_switches;
+    CpuTimes total;
+    CpuTimes cpu[SYSMON_MAX_CPUS];
+} CpuSnapshot;
+
+typedef struct {
+    unsigned long long total_kb;
+    unsigned long long free_kb;
+    unsigned long long available_kb;
+    unsigned long long buffers_kb;
+    unsigned long long cached_kb;
+    unsigned long long swap_total_kb;
+    unsigned long long swap_free_kb;
+} MemorySnapshot;
+
+typedef struct {
+    double load1;
+    double load5;
+    double load15;
+    int running_tasks;
+    int total_tasks;
+} LoadSnapshot;
+
+typedef struct {
+    unsigned long long reads;
+    unsigned long long writes;
+    unsigned long long read_sectors;
+    unsigned long long write_sectors;
+    unsigned long long io_ms;
+    unsigned long long rx_bytes;
+    unsigned long long tx_bytes;
+    unsigned long long rx_packets;
+    unsigned long long tx_packets;
+} IoSnapshot;
+
+typedef struct {
+    long long time_ms;
+    CpuSnapshot cpu;
+    MemorySnapshot mem;
+    LoadSnapshot load;
+    IoSnapshot io;
+} LiveSample;
+
 // Function Declarations
 
 // Utils Functions (utils.c)
@@ -93,6 +154,11 @@ void print_success(const char *message);
 void print_error(const char *message);
 void print_info(const char *message);
 void print_warning(const char *message);
+void terminal_set_raw(bool enable);
+bool terminal_interrupted(void);
+int wait_for_key(int timeout_ms);
+void get_terminal_size(int *rows, int *cols);
+long long monotonic_ms(void);
 
 // Project Setup Functions (project_setup.c)
 void project_setup_menu(void);
@@ -115,6 +181,629 @@ void display_disk_usage(void);
 void display_network_info(void);
 void display_system_info(void);
 void display_all_resources(void);
+int sysmon_command(int argc, char *argv[]);
+long sysmon_read_file(const char *path, char *buf, size_t size);
+bool sysmon_read_cpu(CpuSnapshot *snap);
+bool sysmon_read_memory(MemorySnapshot *mem);
+bool sysmon_read_load(LoadSnapshot *load);
+bool sysmon_read_io(IoSnapshot *io);
+bool sysmon_read_sample(LiveSample *sample);
+unsigned long long cpu_times_total(const CpuTimes *t);
+double sysmon_cpu_busy_percent(const CpuTimes *prev, const CpuTimes *cur);
+void format_kb(unsigned long long kb, char *out, size_t size);
+
+// Live Monitor Functions (sysmon_live.c)
+typedef enum {
+    CELL_DEFAULT = 0,
+    CELL_RED,
+    CELL_GREEN,
+    CELL_YELLOW,
+    CELL_BLUE,
+    CELL_MAGENTA,
+    CELL_CYAN,
+    CELL_BOLD
+} CellColor;
+
+typedef struct {
+    char glyph[4];
+    unsigned char color;
+} ScreenCell;
+
+typedef struct {
+    int rows;
+    int cols;
+    ScreenCell *front;
+    ScreenCell *back;
+    char *out;
+    size_t out_cap;
+    bool force_redraw;
+} LiveScreen;
+
+bool live_screen_init(LiveScreen *screen);
+void live_screen_free(LiveScreen *screen);
+void live_screen_begin(LiveScreen *screen);
+int live_screen_print(LiveScreen *screen, int row, int col, CellColor color, const char *fmt, ...);
+int live_screen_bar(LiveScreen *screen, int row, int col, int width, double percent);
+void live_screen_flush(LiveScreen *screen);
+typedef bool (*LiveSampleSource)(void *ctx, LiveSample *sample);
+
+void live_monitor_run(const char *title, LiveSampleSource source, void *ctx,
+                      int interval_ms, double *speed);
+void sysmon_live_view(int interval_ms);
+int prompt_interval_ms(void);
+
+// Resource History Functions (sysmon_history.c)
+typedef enum {
+    HIST_CPU_BUSY = 0,
+    HIST_CPU_IOWAIT,
+    HIST_MEM_USED,
+    HIST_SWAP_USED,
+    HIST_LOAD1,
+    HISTORY_METRIC_COUNT
+} HistoryMetric;
+
+typedef enum {
+    HISTORY_MINUTE = 0,
+    HISTORY_HOUR,
+    HISTORY_DAY,
+    HISTORY_WINDOW_COUNT
+} HistoryWindow;
+
+#define HISTORY_TIER_COUNT 3
+
+typedef struct {
+    float min;
+    float max;
+    float avg;
+} HistoryPoint;
+
+void history_record(const float values[HISTORY_METRIC_COUNT]);
+int history_read(HistoryMetric metric, HistoryWindow window, HistoryPoint *out, int max_points);
+const char *history_metric_name(HistoryMetric metric);
+void format_sparkline(const HistoryPoint *points, int count, float lo, float hi,
+                      char *out, size_t size);
+void display_metric_history(HistoryMetric metric, float lo, float hi);
+void history_start_sampler(void);
+
+// Process Table Functions (sysmon_proc.c)
+#define PROC_TOP_MAX 256
+
+typedef struct {
+    double key;
+    int index;
+} TopNItem;
+
+typedef struct {
+    TopNItem *items;
+    int size;
+    int capacity;
+} TopNHeap;
+
+typedef enum {
+    PROC_SORT_CPU = 0,
+    PROC_SORT_MEMORY
+} ProcSortKey;
+
+typedef struct {
+    int pid;
+    int ppid;
+    int nice;
+    int threads;
+    char state;
+    bool alive;
+    char comm[32];
+    unsigned long long start_time;
+    unsigned long long cpu_ticks;
+    unsigned long long vsize_bytes;
+    long rss_pages;
+    long shared_pages;
+    double cpu_percent;
+} ProcEntry;
+
+typedef struct {
+    int proc_fd;
+    ProcEntry *entries;     // Current scan, sorted by pid
+    ProcEntry *previous;    // Last scan, for CPU deltas
+    int *pids;
+    int count;
+    int capacity;
+    int total_threads;
+    long clock_ticks;
+    long page_size;
+    long long last_scan_ms;
+    long long scan_ms;
+} ProcTable;
+
+void topn_init(TopNHeap *heap, TopNItem *storage, int capacity);
+void topn_offer(TopNHeap *heap, double key, int index);
+int topn_finish(TopNHeap *heap);
+bool proc_table_init(ProcTable *table);
+void proc_table_free(ProcTable *table);
+int proc_table_refresh(ProcTable *table);
+int proc_table_top(ProcTable *table, ProcSortKey key, TopNItem *out, int n);
+void sysmon_process_view(int interval_ms);
+
+// Recording Functions (sysmon_record.c)
+void sysmon_record(const char *path, int interval_ms, int duration_s);
+void sysmon_replay(const char *path, double speed, int start_s);
+size_t put_varint(uint8_t *out, uint64_t value);
+size_t get_varint(const uint8_t *p, const uint8_t *end, uint64_t *value);
+uint64_t zigzag(int64_t v);
+int64_t unzigzag(uint64_t v);
+size_t encode_residuals(const int64_t *residuals, int count, uint8_t *out);
+bool decode_residuals(const uint8_t *p, const uint8_t *end, int64_t *residuals, int count);
+
+// Session Statistics Functions (sysmon_stats.c)
+typedef struct {
+    char name[32];
+    double scale;               // Stored value = value * scale
+    int bucket_count;
+    unsigned int *counts;
+    unsigned long long total;
+    double min;
+    double max;
+    double sum;
+} QuantileSketch;
+
+typedef struct {
+    QuantileSketch *sketches;
+    int count;
+    int capacity;
+} SketchSet;
+
+bool sketch_init(QuantileSketch *sketch, const char *name, double scale, double max_value);
+void sketch_free(QuantileSketch *sketch);
+void sketch_add(QuantileSketch *sketch, double value);
+double sketch_quantile(const QuantileSketch *sketch, double q);
+bool sketch_merge(QuantileSketch *dst, const QuantileSketch *src);
+QuantileSketch *sketch_set_get(SketchSet *set, const char *name, double scale,
+                               double max_value, bool create);
+void sketch_set_free(SketchSet *set);
+bool sketch_set_save(const SketchSet *set, const char *path);
+bool sketch_set_merge_file(SketchSet *set, const char *path);
+void sketch_set_report(const SketchSet *set);
+void sysmon_session(int interval_ms, int duration_s, const char *save_path);
+int sysmon_merge_sessions(int count, char *paths[], const char *out_path);
+
+// Disk I/O Functions (sysmon_disk.c)
+#define DISK_MAX_DEVICES 256
+
+typedef struct {
+    unsigned long long reads;
+    unsigned long long read_sectors;
+    unsigned long long read_ms;
+    unsigned long long writes;
+    unsigned long long write_sectors;
+    unsigned long long write_ms;
+    unsigned long long in_flight;
+    unsigned long long io_ms;
+    unsigned long long weighted_ms;
+} DiskCounters;
+
+typedef struct {
+    char name[32];
+    char parent[32];        // Disk a partition belongs to
+    bool is_partition;
+    bool present;
+    bool sampled;
+    DiskCounters counters;
+    double reads_per_sec;
+    double writes_per_sec;
+    double read_mb_per_sec;
+    double write_mb_per_sec;
+    double read_await_ms;
+    double write_await_ms;
+    double queue_depth;
+    double util_percent;
+} DiskDevice;
+
+typedef struct {
+    DiskDevice devices[DISK_MAX_DEVICES];
+    int count;
+    long long last_ms;
+} DiskTable;
+
+bool disk_table_refresh(DiskTable *table);
+void sysmon_disk_io_view(int interval_ms);
+
+// Network Functions (sysmon_net.c)
+typedef struct {
+    unsigned long long rx_bytes;
+    unsigned long long rx_packets;
+    unsigned long long rx_errors;
+    unsigned long long rx_drops;
+    unsigned long long tx_bytes;
+    unsigned long long tx_packets;
+    unsigned long long tx_errors;
+    unsigned long long tx_drops;
+} NetCounters;
+
+typedef struct {
+    char name[32];
+    bool present;
+    bool sampled;
+    NetCounters counters;
+    double rx_bytes_per_sec;
+    double tx_bytes_per_sec;
+    double rx_packets_per_sec;
+    double tx_packets_per_sec;
+    double drops_per_sec;
+    double errors_per_sec;
+} NetInterface;
+
+typedef struct {
+    NetInterface *ifaces;   // In /proc/net/dev order
+    int count;
+    int capacity;
+    long long last_ms;
+} NetTable;
+
+bool net_table_refresh(NetTable *table);
+void net_table_free(NetTable *table);
+void display_network_native(void);
+void sysmon_net_view(int interval_ms);
+
+// Container Functions (sysmon_cgroup.c)
+typedef struct {
+    int version;                        // 2 or 1, 0 if no cgroup was found
+    char path[MAX_PATH_LENGTH];
+    bool has_cpu;
+    bool has_memory;
+    bool has_io;
+    unsigned long long cpu_quota_usec;  // 0 = no quota
+    unsigned long long cpu_period_usec;
+    unsigned long long cpu_usage_usec;
+    unsigned long long cpu_user_usec;
+    unsigned long long cpu_system_usec;
+    unsigned long long nr_periods;
+    unsigned long long nr_throttled;
+    unsigned long long throttled_usec;
+    unsigned long long mem_current;     // Bytes; limits are 0 when unlimited
+    unsigned long long mem_max;
+    unsigned long long mem_high;
+    unsigned long long swap_current;
+    unsigned long long swap_max;
+    unsigned long long mem_anon;
+    unsigned long long mem_file;
+    unsigned long long mem_kernel;
+    unsigned long long mem_shmem;
+    unsigned long long mem_sock;
+    unsigned long long mem_dirty;
+    unsigned long long mem_writeback;
+    unsigned long long events_high;
+    unsigned long long events_max;
+    unsigned long long events_oom;
+    unsigned long long events_oom_kill;
+    unsigned long long io_read_bytes;
+    unsigned long long io_write_bytes;
+    unsigned long long io_reads;
+    unsigned long long io_writes;
+} CgroupSnapshot;
+
+bool cgroup_read(CgroupSnapshot *snap);
+const char *cgroup_v2_dir(void);
+bool cgroup_memory_limit(int pid, unsigned long long *limit, unsigned long long *used);
+void display_cgroup_cpu(void);
+void display_cgroup_memory(void);
+void display_cgroup_io(void);
+
+// Pressure Stall Functions (sysmon_psi.c)
+#define PSI_RESOURCE_COUNT 3    // cpu, memory, io
+
+typedef struct {
+    bool valid;
+    double avg10;
+    double avg60;
+    double avg300;
+    unsigned long long total_usec;
+} PsiLine;
+
+typedef struct {
+    PsiLine some;
+    PsiLine full;
+} PsiResource;
+
+typedef struct {
+    long long time_ms;
+    bool has_host;
+    bool has_cgroup;
+    PsiResource host[PSI_RESOURCE_COUNT];
+    PsiResource cgroup[PSI_RESOURCE_COUNT];
+} PsiSnapshot;
+
+bool psi_read(PsiSnapshot *snap);
+void sysmon_psi_view(int interval_ms, int trigger_percent);
+
+// Alert Rule Functions (sysmon_alert.c)
+typedef enum {
+    ALERT_OP_GT,
+    ALERT_OP_GE,
+    ALERT_OP_LT,
+    ALERT_OP_LE
+} AlertOp;
+
+typedef enum {
+    ALERT_OK,
+    ALERT_PENDING,
+    ALERT_FIRING
+} AlertState;
+
+typedef enum {
+    ALERT_ACTION_NONE,
+    ALERT_ACTION_EXEC,
+    ALERT_ACTION_LOG
+} AlertAction;
+
+// Hot evaluation record; everything else lives in AlertRuleInfo
+typedef struct {
+    int slot;               // Index into the per-sample value vector
+    AlertOp op;
+    AlertState state;
+    double threshold;
+    double clear;           // Hysteresis level that resolves a firing rule
+    long long duration_ms;
+    long long since_ms;
+} AlertRule;
+
+typedef struct {
+    char name[32];
+    int metric;
+    AlertAction action;
+    char target[MAX_INPUT_LENGTH];
+} AlertRuleInfo;
+
+typedef struct {
+    AlertRule *rules;
+    AlertRuleInfo *info;
+    int count;
+    int capacity;
+} AlertRuleSet;
+
+bool alert_rule_compile(AlertRuleSet *set, const char *text, char *err, size_t err_size);
+bool alert_rules_load(AlertRuleSet *set, const char *path);
+void alert_rules_free(AlertRuleSet *set);
+int alert_rules_evaluate(AlertRuleSet *set, const double *values, long long now_ms);
+void sysmon_alert_watch(const char *rules_path, int interval_ms);
+
+// Directory Size Functions (sysmon_du.c)
+void sysmon_du_view(const char *path, int threads);
+
+// Process Memory Functions (sysmon_smaps.c)
+typedef enum {
+    SMAPS_SORT_PSS = 0,
+    SMAPS_SORT_RSS,
+    SMAPS_SORT_PRIVATE,
+    SMAPS_SORT_SWAP
+} SmapsSortKey;
+
+typedef struct {
+    int pid;
+    bool readable;
+    unsigned long long rss_kb;
+    unsigned long long pss_kb;
+    unsigned long long shared_clean_kb;
+    unsigned long long shared_dirty_kb;
+    unsigned long long private_clean_kb;
+    unsigned long long private_dirty_kb;
+    unsigned long long anon_huge_kb;
+    unsigned long long swap_kb;
+    unsigned long long swap_pss_kb;
+} SmapsEntry;
+
+typedef struct {
+    ProcTable procs;        // Pid listing and names
+    SmapsEntry *entries;    // Parallel to procs.entries
+    int capacity;
+    int unreadable;
+    unsigned long long total_pss_kb;
+    unsigned long long total_rss_kb;
+    unsigned long long total_swap_kb;
+    long long scan_ms;
+} SmapsTable;
+
+bool smaps_table_init(SmapsTable *table);
+void smaps_table_free(SmapsTable *table);
+int smaps_table_refresh(SmapsTable *table);
+int smaps_table_top(const SmapsTable *table, SmapsSortKey key, TopNItem *out, int n);
+void sysmon_smaps_view(int interval_ms);
+
+// Socket Functions (sysmon_sock.c)
+#define SOCK_STATE_ESTABLISHED 1
+#define SOCK_STATE_SYN_RECV 3
+#define SOCK_STATE_TIME_WAIT 6
+#define SOCK_STATE_CLOSE_WAIT 8
+#define SOCK_STATE_LISTEN 10
+#define SOCK_STATE_COUNT 12
+
+typedef struct {
+    unsigned char family;       // AF_INET or AF_INET6
+    unsigned char protocol;     // IPPROTO_TCP or IPPROTO_UDP
+    unsigned char state;        // Kernel TCP state number
+    unsigned short local_port;
+    unsigned short remote_port;
+    unsigned char local_addr[16];
+    unsigned char remote_addr[16];
+    unsigned int recv_queue;
+    unsigned int send_queue;
+    unsigned int uid;
+    unsigned long inode;
+    int pid;                    // Owner, -1 if unknown
+} SocketEntry;
+
+typedef struct {
+    SocketEntry *entries;
+    int count;
+    int capacity;
+    int *map;                   // Inode hash: entry index + 1, 0 = empty
+    size_t map_capacity;
+    int owned;
+    int state_counts[SOCK_STATE_COUNT];
+    bool used_netlink;
+    long long scan_ms;
+} SocketTable;
+
+int socket_table_refresh(SocketTable *table);
+void socket_table_free(SocketTable *table);
+const char *socket_state_name(const SocketEntry *entry);
+void display_socket_summary(void);
+void sysmon_socket_view(int interval_ms);
+
+// CPU Efficiency Functions (sysmon_perf.c)
+typedef enum {
+    PERF_CYCLES = 0,
+    PERF_INSTRUCTIONS,
+    PERF_CACHE_REFS,
+    PERF_CACHE_MISSES,
+    PERF_BRANCHES,
+    PERF_BRANCH_MISSES,
+    PERF_CPU_CLOCK,
+    PERF_CONTEXT_SWITCHES,
+    PERF_PAGE_FAULTS,
+    PERF_MIGRATIONS,
+    PERF_COUNTER_COUNT
+} PerfCounter;
+
+typedef struct {
+    int cpu;                                    // -1 when following a pid
+    int tid;                                    // Thread counted when following a pid
+    bool online;
+    int fds[PERF_COUNTER_COUNT];
+    unsigned long long raw[PERF_COUNTER_COUNT][3];  // value, enabled, running
+    double delta[PERF_COUNTER_COUNT];           // Multiplex-scaled, last window
+    double running_share[PERF_COUNTER_COUNT];   // running / enabled, last window
+    CpuTimes times;                             // /proc/stat, per-core mode only
+    double busy_percent;
+} PerfTarget;
+
+typedef struct {
+    int pid;                    // -1 for per-core counting
+    bool hardware;              // false when only software events opened
+    PerfTarget *targets;                        // Online cores, or the pid's threads
+    int target_count;
+    int target_capacity;
+    int threads_missed;                         // Threads that could not get counters
+    double exited[PERF_COUNTER_COUNT];          // Last window of threads that exited since
+    int last_errno;
+    long long last_ms;
+    long long elapsed_ms;
+} PerfSession;
+
+bool perf_session_open(PerfSession *session, int pid);
+void perf_session_sample(PerfSession *session);
+void perf_session_close(PerfSession *session);
+void sysmon_perf_view(int interval_ms, int pid);
+
+// Stack Profiler Functions (sysmon_profile.c)
+void sysmon_profile(int pid, int duration_s, int hz, const char *out_path, bool use_ptrace);
+
+// Agent and Collector Functions (sysmon_agent.c)
+void sysmon_agent(const char *target, int interval_ms, int batch, const char *name);
+void sysmon_collector(const char *listen_spec, int interval_ms);
+
+// Stress Functions (sysmon_stress.c)
+#define STRESS_MAX_RAMP 16
+
+typedef struct {
+    int cpu_workers;
+    int cpu_percent;                // Duty cycle per worker
+    int mem_mb;                     // Footprint
+    int mem_mb_per_sec;             // 0 = as fast as possible
+    int disk_mb_per_sec;
+    char disk_dir[MAX_PATH_LENGTH];
+    int duration_s;                 // 0 = until a key
+    int ramp_count;
+    int ramp_at_s[STRESS_MAX_RAMP];
+    int ramp_percent[STRESS_MAX_RAMP];
+} StressConfig;
+
+bool stress_parse(StressConfig *config, int argc, char *argv[]);
+void sysmon_stress(const StressConfig *config);
+
+// Disk Benchmark Functions (sysmon_iobench.c)
+void sysmon_io_bench(const char *dir, int block_kb, int queue_depth, int file_mb, int seconds,
+                     bool use_threads);
+
+// NUMA Node and Cache Functions (sysmon_numa.c)
+typedef struct {
+    int level;
+    char type[16];                  // Data, Instruction, Unified
+    long long size_bytes;
+    int line_size;
+    char shared_cpus[64];           // shared_cpu_list
+} CpuCache;
+
+int parse_cpu_list(const char *text, int *out, int max);
+int numa_node_list(int *nodes, int max);
+int numa_node_cpus(int node, int *cpus, int max);
+int read_cpu_caches(int cpu, CpuCache *caches, int max);
+long long cpu_data_cache_size(int cpu, int level);
+void display_cpu_topology(void);
+void display_numa_process(int pid);
+
+// Memory Benchmark Functions (sysmon_membench.c)
+void sysmon_mem_bench(int array_mb, int threads);
+
+// Page-Cache Residency Functions (sysmon_fincore.c)
+typedef enum {
+    FINCORE_REPORT,
+    FINCORE_WARM,
+    FINCORE_EVICT
+} FincoreAction;
+
+void sysmon_fincore(char **paths, int path_count, FincoreAction action, int threads);
+
+// Interrupt and Scheduler Functions (sysmon_irq.c)
+void sysmon_irq_view(int interval_ms);
+
+// Memory Growth Watch Functions (sysmon_leak.c)
+void sysmon_leak_watch(const int *pids, int count, int interval_s, int window_s);
+
+// Process I/O Functions (sysmon_iotop.c)
+typedef enum {
+    IOTOP_SORT_TOTAL = 0,
+    IOTOP_SORT_READ,
+    IOTOP_SORT_WRITE,
+    IOTOP_SORT_SYSCALLS
+} IoSortKey;
+
+typedef struct {
+    int pid;
+    bool readable;
+    unsigned long long start_time;  // From the process table, to match pids
+    unsigned long long cpu_ticks;
+    unsigned long long syscr;
+    unsigned long long syscw;
+    unsigned long long read_bytes;  // Storage I/O, not page-cache hits
+    unsigned long long write_bytes;
+    long long read_ms;              // When /proc/[pid]/io was last parsed
+    double read_rate;               // Bytes and calls per second
+    double write_rate;
+    double syscr_rate;
+    double syscw_rate;
+} IoEntry;
+
+typedef struct {
+    ProcTable procs;        // Pid listing, names and CPU ticks
+    IoEntry *entries;       // Parallel to procs.entries
+    IoEntry *previous;      // Last scan, sorted by pid
+    int count;
+    int capacity;
+    int parsed;             // io files read in the last scan
+    int unreadable;
+    unsigned long scans;
+    double total_read_rate;
+    double total_write_rate;
+    long long scan_ms;
+} IoTable;
+
+bool io_table_init(IoTable *table);
+void io_table_free(IoTable *table);
+int io_table_refresh(IoTable *table);
+int io_table_top(const IoTable *table, IoSortKey key, TopNItem *out, int n);
+void sysmon_iotop_view(int interval_ms);
+
+// Metrics Exporter Functions (sysmon_exporter.c)
+void sysmon_exporter(const char *listen_spec, int staleness_ms);
 
 // Git Helper Functions (git_helper.c)
 void git_helper_menu(void);
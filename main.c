@@ -25,10 +25,20 @@ void display_main_menu(void) {
 /**
  * Main program loop
  */
-int main(void) {
+int main(int argc, char *argv[]) {
     int choice;
     bool running = true;
 
+    // Non-interactive subcommands, e.g. "devhelper sysmon live 500"
+    if (argc > 1) {
+        if (strcmp(argv[1], "sysmon") == 0) {
+            return sysmon_command(argc - 2, argv + 2);
+        }
+        fprintf(stderr, "Unknown command: %s\n", argv[1]);
+        fprintf(stderr, "Usage: devhelper [sysmon <command> ...]\n");
+        return 1;
+    }
+
     while (running) {
         clear_screen();
         display_main_menu();
@@ -0,0 +1,835 @@
+/**
+ * DevHelper+Portal CLI - Monitoring Agent and Collector
+ *
+ * The agent samples CPU, memory, disk and network like the live view
+ * and streams them to a collector over TCP or a Unix socket. The
+ * collector accepts any number of agents and shows one row per host
+ * with sparklines of recent CPU and memory use.
+ *
+ * Stream layout: frames of [type:u8][payload length:varint][payload],
+ * using the recording's column coding. A HELLO frame names the host,
+ * then a KEY frame carries absolute columns and DELTA frames carry the
+ * change from the previous sample (gauges) or the change of that change
+ * (counters) as zero-run-compressed zigzag varints. At steady state a
+ * sample is a couple of dozen bytes. The agent sends several samples
+ * per write so hundreds of agents cost the collector few wakeups.
+ */
+
+#define _GNU_SOURCE
+#include "devhelper.h"
+#include <signal.h>
+
+#ifdef __linux__
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#endif
+
+#ifdef __linux__
+
+#define AGENT_VERSION 1
+#define AGENT_DEFAULT_PORT "7373"
+#define AGENT_KEY_INTERVAL 300      // Samples between key frames
+#define AGENT_MAX_BATCH 60
+#define AGENT_MAX_FRAME 1024
+#define FLEET_HISTORY 40
+#define FLEET_MAX_CONNECTIONS 1024
+#define FLEET_READ_BUFFER 16384
+
+enum {
+    AGENT_FRAME_HELLO = 1,
+    AGENT_FRAME_KEY = 2,
+    AGENT_FRAME_DELTA = 3
+};
+
+enum {
+    COL_TIME = 0,
+    COL_CPU_BUSY,
+    COL_CPU_IDLE,
+    COL_CPU_IOWAIT,
+    COL_MEM_TOTAL,
+    COL_MEM_AVAILABLE,
+    COL_SWAP_TOTAL,
+    COL_SWAP_FREE,
+    COL_LOAD1,
+    COL_RUNNING,
+    COL_READ_SECTORS,
+    COL_WRITE_SECTORS,
+    COL_IO_MS,
+    COL_RX_BYTES,
+    COL_TX_BYTES,
+    AGENT_COLUMNS
+};
+
+static bool agent_column_is_counter(int col) {
+    return col <= COL_CPU_IOWAIT || col >= COL_READ_SECTORS;
+}
+
+static volatile sig_atomic_t agent_interrupted = 0;
+
+static void agent_signal_handler(int sig) {
+    (void)sig;
+    agent_interrupted = 1;
+}
+
+static void sample_to_agent_columns(const LiveSample *s, long long start_ms, int64_t *cols) {
+    const CpuTimes *t = &s->cpu.total;
+
+    cols[COL_TIME] = s->time_ms - start_ms;
+    cols[COL_CPU_BUSY] = (int64_t)(t->user + t->nice + t->system + t->irq + t->softirq + t->steal);
+    cols[COL_CPU_IDLE] = (int64_t)(t->idle + t->iowait);
+    cols[COL_CPU_IOWAIT] = (int64_t)t->iowait;
+    cols[COL_MEM_TOTAL] = (int64_t)s->mem.total_kb;
+    cols[COL_MEM_AVAILABLE] = (int64_t)s->mem.available_kb;
+    cols[COL_SWAP_TOTAL] = (int64_t)s->mem.swap_total_kb;
+    cols[COL_SWAP_FREE] = (int64_t)s->mem.swap_free_kb;
+    cols[COL_LOAD1] = (int64_t)(s->load.load1 * 100.0 + 0.5);
+    cols[COL_RUNNING] = s->load.running_tasks;
+    cols[COL_READ_SECTORS] = (int64_t)s->io.read_sectors;
+    cols[COL_WRITE_SECTORS] = (int64_t)s->io.write_sectors;
+    cols[COL_IO_MS] = (int64_t)s->io.io_ms;
+    cols[COL_RX_BYTES] = (int64_t)s->io.rx_bytes;
+    cols[COL_TX_BYTES] = (int64_t)s->io.tx_bytes;
+}
+
+/* ------------------------------------------------------------------ */
+/* Addresses                                                           */
+/* ------------------------------------------------------------------ */
+
+/**
+ * Parse "unix:/path", "/path", "tcp:host:port", "host:port" or "port"
+ * into a socket address. `listening` picks the wildcard address for a
+ * bare port.
+ */
+static bool parse_endpoint(const char *spec, bool listening, struct sockaddr_storage *addr,
+                           socklen_t *len, char *label, size_t label_size) {
+    memset(addr, 0, sizeof(*addr));
+
+    if (strncmp(spec, "unix:", 5) == 0 || spec[0] == '/') {
+        const char *path = spec[0] == '/' ? spec : spec + 5;
+        struct sockaddr_un *un = (struct sockaddr_un *)addr;
+        if (strlen(path) >= sizeof(un->sun_path)) {
+            return false;
+        }
+        un->sun_family = AF_UNIX;
+        strcpy(un->sun_path, path);
+        *len = sizeof(*un);
+        snprintf(label, label_size, "unix:%s", path);
+        return true;
+    }
+
+    char host[256] = "";
+    const char *port = AGENT_DEFAULT_PORT;
+    const char *rest = strncmp(spec, "tcp:", 4) == 0 ? spec + 4 : spec;
+    const char *colon = strrchr(rest, ':');
+    if (colon != NULL) {
+        size_t n = (size_t)(colon - rest);
+        if (n >= sizeof(host)) {
+            return false;
+        }
+        memcpy(host, rest, n);
+        host[n] = '\0';
+        port = colon + 1;
+    } else if (rest[0] >= '0' && rest[0] <= '9' && strchr(rest, '.') == NULL) {
+        port = rest;
+    } else {
+        snprintf(host, sizeof(host), "%s", rest);
+    }
+    if (host[0] == '\0' && !listening) {
+        strcpy(host, "127.0.0.1");
+    }
+
+    struct addrinfo hints, *result;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = listening ? AI_PASSIVE : 0;
+    if (getaddrinfo(host[0] ? host : NULL, port, &hints, &result) != 0) {
+        return false;
+    }
+    memcpy(addr, result->ai_addr, result->ai_addrlen);
+    *len = result->ai_addrlen;
+    freeaddrinfo(result);
+    snprintf(label, label_size, "tcp:%s:%s", host[0] ? host : "*", port);
+    return true;
+}
+
+/* ------------------------------------------------------------------ */
+/* Agent                                                               */
+/* ------------------------------------------------------------------ */
+
+typedef struct {
+    int fd;
+    long long start_ms;
+    int since_key;
+    int64_t prev[AGENT_COLUMNS];
+    int64_t prev_delta[AGENT_COLUMNS];
+    uint8_t batch[AGENT_MAX_BATCH * AGENT_MAX_FRAME + AGENT_MAX_FRAME];
+    size_t batch_len;
+    int batch_samples;
+} AgentStream;
+
+static void agent_put_frame(AgentStream *stream, uint8_t type, const uint8_t *payload, size_t len) {
+    stream->batch[stream->batch_len++] = type;
+    stream->batch_len += put_varint(stream->batch + stream->batch_len, len);
+    memcpy(stream->batch + stream->batch_len, payload, len);
+    stream->batch_len += len;
+}
+
+static void agent_put_hello(AgentStream *stream, const char *name, int cpu_count, int interval_ms) {
+    uint8_t payload[512];
+    char host[256];
+    size_t n = 0;
+
+    if (name != NULL && name[0] != '\0') {
+        snprintf(host, sizeof(host), "%s", name);
+    } else if (gethostname(host, sizeof(host)) != 0) {
+        strcpy(host, "unknown");
+    }
+    host[sizeof(host) - 1] = '\0';
+    size_t host_len = strlen(host);
+
+    n += put_varint(payload + n, AGENT_VERSION);
+    n += put_varint(payload + n, AGENT_COLUMNS);
+    n += put_varint(payload + n, (uint64_t)cpu_count);
+    n += put_varint(payload + n, (uint64_t)interval_ms);
+    n += put_varint(payload + n, host_len);
+    memcpy(payload + n, host, host_len);
+    n += host_len;
+    agent_put_frame(stream, AGENT_FRAME_HELLO, payload, n);
+    stream->since_key = AGENT_KEY_INTERVAL;     // Next sample is a key frame
+}
+
+static void agent_put_sample(AgentStream *stream, const LiveSample *sample) {
+    int64_t cols[AGENT_COLUMNS];
+    int64_t residuals[AGENT_COLUMNS];
+    uint8_t payload[AGENT_MAX_FRAME];
+
+    sample_to_agent_columns(sample, stream->start_ms, cols);
+    bool key = stream->since_key >= AGENT_KEY_INTERVAL;
+    for (int c = 0; c < AGENT_COLUMNS; c++) {
+        int64_t delta = cols[c] - stream->prev[c];
+        if (key) {
+            residuals[c] = cols[c];
+        } else {
+            residuals[c] = agent_column_is_counter(c) ? delta - stream->prev_delta[c] : delta;
+        }
+        stream->prev_delta[c] = key ? 0 : delta;
+        stream->prev[c] = cols[c];
+    }
+    size_t len = encode_residuals(residuals, AGENT_COLUMNS, payload);
+    agent_put_frame(stream, key ? AGENT_FRAME_KEY : AGENT_FRAME_DELTA, payload, len);
+    stream->since_key = key ? 1 : stream->since_key + 1;
+    stream->batch_samples++;
+}
+
+static bool write_all(int fd, const uint8_t *data, size_t len) {
+    while (len > 0) {
+        ssize_t n = send(fd, data, len, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+static int agent_connect(const struct sockaddr_storage *addr, socklen_t len) {
+    int fd = socket(addr->ss_family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    if (connect(fd, (const struct sockaddr *)addr, len) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+#endif
+
+/**
+ * Stream samples to a collector every interval_ms, `batch` samples per
+ * write, until SIGINT/SIGTERM (or a key on a terminal). Reconnects with
+ * backoff when the collector goes away. `name` overrides the hostname.
+ */
+void sysmon_agent(const char *target, int interval_ms, int batch, const char *name) {
+#ifndef __linux__
+    (void)target;
+    (void)interval_ms;
+    (void)batch;
+    (void)name;
+    print_warning("The monitoring agent reads /proc and is only available on Linux.");
+#else
+    static AgentStream stream;
+    static LiveSample sample;
+    struct sockaddr_storage addr;
+    socklen_t addr_len;
+    char label[300];
+
+    if (interval_ms < 100) interval_ms = 100;
+    if (interval_ms > 60000) interval_ms = 60000;
+    if (batch < 1) batch = 1;
+    if (batch > AGENT_MAX_BATCH) batch = AGENT_MAX_BATCH;
+
+    if (!parse_endpoint(target, false, &addr, &addr_len, label, sizeof(label))) {
+        print_error("Invalid collector address! Use host:port, tcp:host:port or unix:/path.");
+        return;
+    }
+    if (!sysmon_read_sample(&sample)) {
+        print_error("Could not read /proc samples!");
+        return;
+    }
+
+    struct sigaction sa, old_int, old_term;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = agent_signal_handler;
+    sigaction(SIGINT, &sa, &old_int);
+    sigaction(SIGTERM, &sa, &old_term);
+    agent_interrupted = 0;
+
+    bool interactive = isatty(STDIN_FILENO);
+    printf("%sStreaming to %s every %d ms, %d samples per write - %s%s\n", COLOR_CYAN, label,
+           interval_ms, batch, interactive ? "press any key to stop" : "send SIGINT or SIGTERM to stop",
+           COLOR_RESET);
+    if (interactive) {
+        terminal_set_raw(true);
+    }
+
+    memset(&stream, 0, sizeof(stream));
+    stream.fd = -1;
+    stream.start_ms = sample.time_ms;
+    unsigned long long sent_bytes = 0, sent_samples = 0;
+    int backoff_ms = 500;
+    long long next_connect = 0;
+    long long next_tick = monotonic_ms();
+
+    while (!agent_interrupted) {
+        int wait_ms = (int)(next_tick - monotonic_ms());
+        if (interactive) {
+            if (wait_for_key(wait_ms) >= 0) {
+                break;
+            }
+        } else if (wait_ms > 0) {
+            poll(NULL, 0, wait_ms);
+        }
+        long long now = monotonic_ms();
+        if (now < next_tick) {
+            continue;
+        }
+        next_tick += interval_ms;
+        if (next_tick <= now) {
+            next_tick = now + interval_ms;
+        }
+
+        if (stream.fd < 0) {
+            if (now < next_connect) {
+                continue;
+            }
+            stream.fd = agent_connect(&addr, addr_len);
+            if (stream.fd < 0) {
+                next_connect = now + backoff_ms;
+                backoff_ms = backoff_ms * 2 > 30000 ? 30000 : backoff_ms * 2;
+                continue;
+            }
+            backoff_ms = 500;
+            stream.batch_len = 0;
+            stream.batch_samples = 0;
+            agent_put_hello(&stream, name, sample.cpu.cpu_count, interval_ms);
+        }
+
+        if (!sysmon_read_sample(&sample)) {
+            continue;
+        }
+        agent_put_sample(&stream, &sample);
+        if (stream.batch_samples < batch) {
+            continue;
+        }
+
+        if (!write_all(stream.fd, stream.batch, stream.batch_len)) {
+            // Collector gone: drop the batch and start over with a HELLO
+            close(stream.fd);
+            stream.fd = -1;
+            next_connect = now + backoff_ms;
+            continue;
+        }
+        sent_bytes += stream.batch_len;
+        sent_samples += (unsigned long long)stream.batch_samples;
+        stream.batch_len = 0;
+        stream.batch_samples = 0;
+        if (interactive) {
+            printf("\r  %llu samples sent, %.1f bytes/sample   ", sent_samples,
+                   (double)sent_bytes / (double)sent_samples);
+            fflush(stdout);
+        }
+    }
+
+    if (stream.fd >= 0) {
+        if (stream.batch_len > 0) {
+            write_all(stream.fd, stream.batch, stream.batch_len);
+        }
+        close(stream.fd);
+    }
+    if (interactive) {
+        terminal_set_raw(false);
+    }
+    sigaction(SIGINT, &old_int, NULL);
+    sigaction(SIGTERM, &old_term, NULL);
+    printf("\n");
+    print_info("Agent stopped.");
+#endif
+}
+
+#ifdef __linux__
+
+/* ------------------------------------------------------------------ */
+/* Collector                                                           */
+/* ------------------------------------------------------------------ */
+
+typedef struct {
+    char name[64];
+    bool connected;
+    int cpu_count;
+    long long last_seen_ms;
+    unsigned long long samples;
+    bool have_rates;
+    double cpu_percent;
+    double mem_percent;
+    double swap_percent;
+    double load1;
+    double disk_bytes_per_sec;
+    double rx_bytes_per_sec;
+    double tx_bytes_per_sec;
+    float cpu_history[FLEET_HISTORY];
+    float mem_history[FLEET_HISTORY];
+    int history_count;
+    int history_next;
+} FleetHost;
+
+typedef struct {
+    int fd;
+    int host;                   // -1 until HELLO
+    bool have_key;
+    int64_t cols[AGENT_COLUMNS];
+    int64_t prev_delta[AGENT_COLUMNS];
+    uint8_t buf[FLEET_READ_BUFFER];
+    size_t len;
+} FleetConnection;
+
+typedef struct {
+    FleetHost *hosts;
+    int host_count;
+    int host_capacity;
+    FleetConnection *conns[FLEET_MAX_CONNECTIONS];
+    int conn_count;
+    unsigned long long bytes;
+    unsigned long long frames;
+    int bad_streams;
+} Fleet;
+
+/**
+ * Find or add a host by name. Hosts are kept sorted for display, so
+ * connections pointing past an insertion are shifted along.
+ */
+static int fleet_host(Fleet *fleet, const char *name) {
+    int pos = 0;
+    while (pos < fleet->host_count) {
+        int cmp = strcmp(fleet->hosts[pos].name, name);
+        if (cmp == 0) {
+            return pos;
+        }
+        if (cmp > 0) {
+            break;
+        }
+        pos++;
+    }
+    if (fleet->host_count == fleet->host_capacity) {
+        int capacity = fleet->host_capacity ? fleet->host_capacity * 2 : 64;
+        FleetHost *grown = realloc(fleet->hosts, (size_t)capacity * sizeof(FleetHost));
+        if (grown == NULL) {
+            return -1;
+        }
+        fleet->hosts = grown;
+        fleet->host_capacity = capacity;
+    }
+
+    memmove(&fleet->hosts[pos + 1], &fleet->hosts[pos], (size_t)(fleet->host_count - pos) * sizeof(FleetHost));
+    fleet->host_count++;
+    for (int i = 0; i < fleet->conn_count; i++) {
+        if (fleet->conns[i]->host >= pos) {
+            fleet->conns[i]->host++;
+        }
+    }
+
+    FleetHost *host = &fleet->hosts[pos];
+    memset(host, 0, sizeof(*host));
+    snprintf(host->name, sizeof(host->name), "%s", name);
+    return pos;
+}
+
+/**
+ * Turn two consecutive column vectors into the host's rates and history
+ */
+static void fleet_update_host(FleetHost *host, const int64_t *prev, const int64_t *cur) {
+    double seconds = (double)(cur[COL_TIME] - prev[COL_TIME]) / 1000.0;
+    double busy = (double)(cur[COL_CPU_BUSY] - prev[COL_CPU_BUSY]);
+    double idle = (double)(cur[COL_CPU_IDLE] - prev[COL_CPU_IDLE]);
+
+    if (seconds <= 0.0) {
+        return;
+    }
+    host->cpu_percent = busy + idle > 0.0 ? 100.0 * busy / (busy + idle) : 0.0;
+    host->mem_percent = cur[COL_MEM_TOTAL] > 0
+        ? 100.0 * (double)(cur[COL_MEM_TOTAL] - cur[COL_MEM_AVAILABLE]) / (double)cur[COL_MEM_TOTAL] : 0.0;
+    host->swap_percent = cur[COL_SWAP_TOTAL] > 0
+        ? 100.0 * (double)(cur[COL_SWAP_TOTAL] - cur[COL_SWAP_FREE]) / (double)cur[COL_SWAP_TOTAL] : 0.0;
+    host->load1 = (double)cur[COL_LOAD1] / 100.0;
+    host->disk_bytes_per_sec = (double)((cur[COL_READ_SECTORS] - prev[COL_READ_SECTORS]) +
+                                        (cur[COL_WRITE_SECTORS] - prev[COL_WRITE_SECTORS])) * 512.0 / seconds;
+    host->rx_bytes_per_sec = (double)(cur[COL_RX_BYTES] - prev[COL_RX_BYTES]) / seconds;
+    host->tx_bytes_per_sec = (double)(cur[COL_TX_BYTES] - prev[COL_TX_BYTES]) / seconds;
+    host->have_rates = true;
+
+    host->cpu_history[host->history_next] = (float)host->cpu_percent;
+    host->mem_history[host->history_next] = (float)host->mem_percent;
+    host->history_next = (host->history_next + 1) % FLEET_HISTORY;
+    if (host->history_count < FLEET_HISTORY) {
+        host->history_count++;
+    }
+}
+
+/**
+ * Apply one frame. Returns false if the stream is malformed.
+ */
+static bool fleet_apply_frame(Fleet *fleet, FleetConnection *conn, uint8_t type,
+                              const uint8_t *p, const uint8_t *end) {
+    if (type == AGENT_FRAME_HELLO) {
+        uint64_t version, columns, cpus, interval, name_len;
+        size_t n;
+        char name[64];
+        if ((n = get_varint(p, end, &version)) == 0 || version != AGENT_VERSION) return false;
+        p += n;
+        if ((n = get_varint(p, end, &columns)) == 0 || columns != AGENT_COLUMNS) return false;
+        p += n;
+        if ((n = get_varint(p, end, &cpus)) == 0) return false;
+        p += n;
+        if ((n = get_varint(p, end, &interval)) == 0) return false;
+        p += n;
+        if ((n = get_varint(p, end, &name_len)) == 0 || name_len > (uint64_t)(end - p - n)) return false;
+        p += n;
+        if (name_len >= sizeof(name)) name_len = sizeof(name) - 1;
+        memcpy(name, p, (size_t)name_len);
+        name[name_len] = '\0';
+
+        conn->host = fleet_host(fleet, name);
+        conn->have_key = false;
+        if (conn->host < 0) return false;
+        FleetHost *host = &fleet->hosts[conn->host];
+        host->connected = true;
+        host->cpu_count = (int)cpus;
+        host->last_seen_ms = monotonic_ms();
+        return true;
+    }
+
+    if (conn->host < 0 || (type != AGENT_FRAME_KEY && type != AGENT_FRAME_DELTA)) {
+        return false;
+    }
+    int64_t residuals[AGENT_COLUMNS];
+    int64_t cur[AGENT_COLUMNS];
+    if (!decode_residuals(p, end, residuals, AGENT_COLUMNS)) {
+        return false;
+    }
+
+    FleetHost *host = &fleet->hosts[conn->host];
+    if (type == AGENT_FRAME_KEY) {
+        memcpy(cur, residuals, sizeof(cur));
+        memset(conn->prev_delta, 0, sizeof(conn->prev_delta));
+    } else {
+        if (!conn->have_key) return false;
+        for (int c = 0; c < AGENT_COLUMNS; c++) {
+            int64_t delta = agent_column_is_counter(c) ? conn->prev_delta[c] + residuals[c] : residuals[c];
+            cur[c] = conn->cols[c] + delta;
+            conn->prev_delta[c] = delta;
+        }
+    }
+    if (conn->have_key) {
+        fleet_update_host(host, conn->cols, cur);
+    }
+    memcpy(conn->cols, cur, sizeof(cur));
+    conn->have_key = true;
+    host->samples++;
+    host->last_seen_ms = monotonic_ms();
+    return true;
+}
+
+/**
+ * Read what the socket has and apply every complete frame.
+ * Returns false when the connection should be closed.
+ */
+static bool fleet_read(Fleet *fleet, FleetConnection *conn) {
+    ssize_t n = recv(conn->fd, conn->buf + conn->len, sizeof(conn->buf) - conn->len, 0);
+    if (n < 0 && (errno == EAGAIN || errno == EINTR)) {
+        return true;
+    }
+    if (n <= 0) {
+        return false;
+    }
+    conn->len += (size_t)n;
+    fleet->bytes += (unsigned long long)n;
+
+    size_t pos = 0;
+    while (pos < conn->len) {
+        const uint8_t *end = conn->buf + conn->len;
+        uint64_t payload_len;
+        size_t used = get_varint(conn->buf + pos + 1, end, &payload_len);
+        if (pos + 1 >= conn->len || used == 0) {
+            break;      // Header not complete yet
+        }
+        if (payload_len > AGENT_MAX_FRAME) {
+            fleet->bad_streams++;
+            return false;
+        }
+        size_t start = pos + 1 + used;
+        if (start + payload_len > conn->len) {
+            break;
+        }
+        if (!fleet_apply_frame(fleet, conn, conn->buf[pos], conn->buf + start,
+                               conn->buf + start + payload_len)) {
+            fleet->bad_streams++;
+            return false;
+        }
+        fleet->frames++;
+        pos = start + (size_t)payload_len;
+    }
+    memmove(conn->buf, conn->buf + pos, conn->len - pos);
+    conn->len -= pos;
+    return true;
+}
+
+static void fleet_close(Fleet *fleet, int index) {
+    FleetConnection *conn = fleet->conns[index];
+    if (conn->host >= 0) {
+        fleet->hosts[conn->host].connected = false;
+    }
+    close(conn->fd);
+    free(conn);
+    fleet->conns[index] = fleet->conns[--fleet->conn_count];
+}
+
+static void history_points(const float *ring, int count, int next, HistoryPoint *out) {
+    int first = (next - count + FLEET_HISTORY) % FLEET_HISTORY;
+    for (int i = 0; i < count; i++) {
+        float v = ring[(first + i) % FLEET_HISTORY];
+        out[i].min = v;
+        out[i].max = v;
+        out[i].avg = v;
+    }
+}
+
+static void render_fleet_frame(LiveScreen *screen, Fleet *fleet, const char *label, int spark_width) {
+    HistoryPoint points[FLEET_HISTORY];
+    char spark[FLEET_HISTORY * 4 + 1];
+    int row = 0;
+    int connected = 0;
+    long long now = monotonic_ms();
+
+    for (int i = 0; i < fleet->host_count; i++) {
+        connected += fleet->hosts[i].connected;
+    }
+
+    live_screen_begin(screen);
+    live_screen_print(screen, row, 0, CELL_BOLD, "DevHelper Fleet");
+    live_screen_print(screen, row++, 17, CELL_CYAN, "%s  %d/%d hosts up  %llu frames %.1f KB  (any key exits)",
+                      label, connected, fleet->host_count, fleet->frames, (double)fleet->bytes / 1024.0);
+    row++;
+    live_screen_print(screen, row++, 0, CELL_BOLD, "%-20s %5s %-*s %5s %-*s %6s %8s %8s %8s %5s",
+                      "Host", "CPU%", spark_width, "", "Mem%", spark_width, "",
+                      "load1", "disk/s", "rx/s", "tx/s", "age");
+
+    for (int i = 0; i < fleet->host_count && row < screen->rows; i++) {
+        const FleetHost *host = &fleet->hosts[i];
+        long long age = (now - host->last_seen_ms) / 1000;
+        CellColor color = !host->connected ? CELL_RED : age > 10 ? CELL_YELLOW : CELL_DEFAULT;
+        char disk[16], rx[16], tx[16];
+
+        snprintf(disk, sizeof(disk), "%.1fM", host->disk_bytes_per_sec / 1e6);
+        snprintf(rx, sizeof(rx), "%.1fM", host->rx_bytes_per_sec / 1e6);
+        snprintf(tx, sizeof(tx), "%.1fM", host->tx_bytes_per_sec / 1e6);
+
+        int shown = host->history_count < spark_width ? host->history_count : spark_width;
+        int c = live_screen_print(screen, row, 0, color, "%-20.20s ", host->name);
+        if (!host->have_rates) {
+            live_screen_print(screen, row++, c, color, "%s", host->connected ? "waiting for samples"
+                                                                             : "disconnected");
+            continue;
+        }
+
+        c += live_screen_print(screen, row, c, host->cpu_percent >= 90.0 ? CELL_RED : color,
+                               "%5.1f ", host->cpu_percent);
+        history_points(host->cpu_history, host->history_count, host->history_next, points);
+        format_sparkline(points + host->history_count - shown, shown, 0.0f, 100.0f, spark, sizeof(spark));
+        live_screen_print(screen, row, c, CELL_GREEN, "%s", spark);
+        c += spark_width + 1;
+
+        c += live_screen_print(screen, row, c, host->mem_percent >= 90.0 ? CELL_RED : color,
+                               "%5.1f ", host->mem_percent);
+        history_points(host->mem_history, host->history_count, host->history_next, points);
+        format_sparkline(points + host->history_count - shown, shown, 0.0f, 100.0f, spark, sizeof(spark));
+        live_screen_print(screen, row, c, CELL_CYAN, "%s", spark);
+        c += spark_width + 1;
+
+        live_screen_print(screen, row++, c, color, "%6.2f %8s %8s %8s %4llds",
+                          host->load1, disk, rx, tx, age);
+    }
+}
+
+static int fleet_listen(const char *spec, char *label, size_t label_size) {
+    struct sockaddr_storage addr;
+    socklen_t len;
+    int one = 1;
+
+    if (!parse_endpoint(spec, true, &addr, &len, label, label_size)) {
+        return -1;
+    }
+    int fd = socket(addr.ss_family, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    if (addr.ss_family == AF_UNIX) {
+        unlink(((struct sockaddr_un *)&addr)->sun_path);
+    } else {
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    }
+    if (bind(fd, (struct sockaddr *)&addr, len) < 0 || listen(fd, 128) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+#endif
+
+/**
+ * Accept agents on `listen_spec` and show the fleet table, redrawn
+ * every interval_ms
+ */
+void sysmon_collector(const char *listen_spec, int interval_ms) {
+#ifndef __linux__
+    (void)listen_spec;
+    (void)interval_ms;
+    print_warning("The collector is only available on Linux.");
+#else
+    static struct pollfd pfds[FLEET_MAX_CONNECTIONS + 2];
+    Fleet fleet;
+    LiveScreen screen;
+    char label[300];
+
+    if (interval_ms < 100) interval_ms = 100;
+    if (interval_ms > 5000) interval_ms = 5000;
+
+    int listen_fd = fleet_listen(listen_spec, label, sizeof(label));
+    if (listen_fd < 0) {
+        print_error("Could not listen on that address!");
+        return;
+    }
+    if (!live_screen_init(&screen)) {
+        print_error("Not enough memory for the fleet view!");
+        close(listen_fd);
+        return;
+    }
+    memset(&fleet, 0, sizeof(fleet));
+
+    // Name + CPU/mem columns + sparklines + the rest must fit the screen
+    int spark_width = (screen.cols - 20 - 6 - 6 - 7 - 9 * 3 - 6 - 2) / 2;
+    if (spark_width > FLEET_HISTORY) spark_width = FLEET_HISTORY;
+    if (spark_width < 4) spark_width = 4;
+
+    struct sigaction sa, old_int, old_term;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = agent_signal_handler;
+    sigaction(SIGINT, &sa, &old_int);
+    sigaction(SIGTERM, &sa, &old_term);
+    agent_interrupted = 0;
+
+    terminal_set_raw(true);
+    render_fleet_frame(&screen, &fleet, label, spark_width);
+    live_screen_flush(&screen);
+
+    long long next_tick = monotonic_ms() + interval_ms;
+    while (!agent_interrupted) {
+        int count = 0;
+        pfds[count].fd = STDIN_FILENO;
+        pfds[count++].events = POLLIN;
+        pfds[count].fd = listen_fd;
+        pfds[count++].events = fleet.conn_count < FLEET_MAX_CONNECTIONS ? POLLIN : 0;
+        for (int i = 0; i < fleet.conn_count; i++) {
+            pfds[count].fd = fleet.conns[i]->fd;
+            pfds[count++].events = POLLIN;
+        }
+
+        int timeout = (int)(next_tick - monotonic_ms());
+        int ready = poll(pfds, (nfds_t)count, timeout < 0 ? 0 : timeout);
+        if (ready > 0) {
+            if (pfds[0].revents & (POLLIN | POLLHUP)) {
+                break;
+            }
+            // Walk backwards: closing swaps the last connection into the slot
+            for (int i = fleet.conn_count - 1; i >= 0; i--) {
+                if (pfds[i + 2].revents != 0 && !fleet_read(&fleet, fleet.conns[i])) {
+                    fleet_close(&fleet, i);
+                }
+            }
+            if (pfds[1].revents & POLLIN) {
+                int fd;
+                while (fleet.conn_count < FLEET_MAX_CONNECTIONS &&
+                       (fd = accept4(listen_fd, NULL, NULL, SOCK_CLOEXEC | SOCK_NONBLOCK)) >= 0) {
+                    FleetConnection *conn = calloc(1, sizeof(FleetConnection));
+                    if (conn == NULL) {
+                        close(fd);
+                        break;
+                    }
+                    conn->fd = fd;
+                    conn->host = -1;
+                    fleet.conns[fleet.conn_count++] = conn;
+                }
+            }
+        }
+
+        long long now = monotonic_ms();
+        if (now < next_tick) {
+            continue;
+        }
+        next_tick += interval_ms;
+        if (next_tick <= now) {
+            next_tick = now + interval_ms;
+        }
+
+        render_fleet_frame(&screen, &fleet, label, spark_width);
+        live_screen_flush(&screen);
+    }
+
+    terminal_set_raw(false);
+    sigaction(SIGINT, &old_int, NULL);
+    sigaction(SIGTERM, &old_term, NULL);
+    printf("%s\033[H\033[2J", COLOR_RESET);
+    fflush(stdout);
+    while (fleet.conn_count > 0) {
+        fleet_close(&fleet, fleet.conn_count - 1);
+    }
+    close(listen_fd);
+    if (strncmp(label, "unix:", 5) == 0) {
+        unlink(label + 5);
+    }
+    free(fleet.hosts);
+    live_screen_free(&screen);
+#endif
+}
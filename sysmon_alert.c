@@ -0,0 +1,579 @@
+/**
+ * DevHelper+Portal CLI - Alert Rules
+ *
+ * Watches resource samples against threshold rules such as
+ *
+ *     mem_low:   mem.available < 5% for 30s clear 8 log /tmp/alerts.log
+ *     iowait:    core.iowait > 40 for 10s exec notify-send "iowait high"
+ *
+ * Rules are compiled once into a flat array of (slot, op, threshold)
+ * records. Each sample computes every metric into a value vector a
+ * single time, so evaluating a rule is one load and one compare.
+ */
+
+#define _GNU_SOURCE
+#include "devhelper.h"
+
+#include <ctype.h>
+#include <time.h>
+
+#ifdef __linux__
+#include <signal.h>
+#include <sys/wait.h>
+#endif
+
+/* ------------------------------------------------------------------ */
+/* Metrics                                                             */
+/* ------------------------------------------------------------------ */
+
+// Value vector slots. core.* metrics keep the max and the min over all
+// cores so "any core above" and "any core below" are a single lookup.
+enum {
+    SLOT_CPU_BUSY,
+    SLOT_CPU_IOWAIT,
+    SLOT_CPU_STEAL,
+    SLOT_CORE_BUSY_MAX,
+    SLOT_CORE_BUSY_MIN,
+    SLOT_CORE_IOWAIT_MAX,
+    SLOT_CORE_IOWAIT_MIN,
+    SLOT_MEM_USED,
+    SLOT_MEM_AVAILABLE,
+    SLOT_SWAP_USED,
+    SLOT_LOAD1,
+    SLOT_LOAD5,
+    SLOT_LOAD15,
+    SLOT_DISK_READ,
+    SLOT_DISK_WRITE,
+    SLOT_DISK_IOPS,
+    SLOT_DISK_BUSY,
+    SLOT_NET_RX,
+    SLOT_NET_TX,
+    SLOT_PROCS_RUNNING,
+    SLOT_CTXT,
+    SLOT_COUNT
+};
+
+static const struct {
+    const char *name;
+    int slot_above;     // Slot used with > and >=
+    int slot_below;     // Slot used with < and <=
+    const char *unit;
+} alert_metrics[] = {
+    { "cpu.busy",      SLOT_CPU_BUSY,      SLOT_CPU_BUSY,      "%" },
+    { "cpu.iowait",    SLOT_CPU_IOWAIT,    SLOT_CPU_IOWAIT,    "%" },
+    { "cpu.steal",     SLOT_CPU_STEAL,     SLOT_CPU_STEAL,     "%" },
+    { "core.busy",     SLOT_CORE_BUSY_MAX, SLOT_CORE_BUSY_MIN, "%" },
+    { "core.iowait",   SLOT_CORE_IOWAIT_MAX, SLOT_CORE_IOWAIT_MIN, "%" },
+    { "mem.used",      SLOT_MEM_USED,      SLOT_MEM_USED,      "%" },
+    { "mem.available", SLOT_MEM_AVAILABLE, SLOT_MEM_AVAILABLE, "%" },
+    { "swap.used",     SLOT_SWAP_USED,     SLOT_SWAP_USED,     "%" },
+    { "load1",         SLOT_LOAD1,         SLOT_LOAD1,         "" },
+    { "load5",         SLOT_LOAD5,         SLOT_LOAD5,         "" },
+    { "load15",        SLOT_LOAD15,        SLOT_LOAD15,        "" },
+    { "disk.read",     SLOT_DISK_READ,     SLOT_DISK_READ,     " MB/s" },
+    { "disk.write",    SLOT_DISK_WRITE,    SLOT_DISK_WRITE,    " MB/s" },
+    { "disk.iops",     SLOT_DISK_IOPS,     SLOT_DISK_IOPS,     " IOPS" },
+    { "disk.busy",     SLOT_DISK_BUSY,     SLOT_DISK_BUSY,     "%" },
+    { "net.rx",        SLOT_NET_RX,        SLOT_NET_RX,        " MB/s" },
+    { "net.tx",        SLOT_NET_TX,        SLOT_NET_TX,        " MB/s" },
+    { "procs.running", SLOT_PROCS_RUNNING, SLOT_PROCS_RUNNING, "" },
+    { "ctxt",          SLOT_CTXT,          SLOT_CTXT,          "/s" },
+};
+
+#define ALERT_METRIC_COUNT (int)(sizeof(alert_metrics) / sizeof(alert_metrics[0]))
+
+static double percent_of(unsigned long long part, unsigned long long whole) {
+    return whole > 0 ? 100.0 * (double)part / (double)whole : 0.0;
+}
+
+/**
+ * Turn two consecutive samples into the value vector rules look at
+ */
+static void compute_values(const LiveSample *prev, const LiveSample *cur, double *values) {
+    double seconds = (double)(cur->time_ms - prev->time_ms) / 1000.0;
+    const MemorySnapshot *mem = &cur->mem;
+    unsigned long long total = cpu_times_total(&cur->cpu.total) - cpu_times_total(&prev->cpu.total);
+
+    if (seconds <= 0.0) {
+        seconds = 1.0;
+    }
+
+    values[SLOT_CPU_BUSY] = sysmon_cpu_busy_percent(&prev->cpu.total, &cur->cpu.total);
+    values[SLOT_CPU_IOWAIT] = percent_of(cur->cpu.total.iowait - prev->cpu.total.iowait, total);
+    values[SLOT_CPU_STEAL] = percent_of(cur->cpu.total.steal - prev->cpu.total.steal, total);
+
+    double busy_max = 0.0, busy_min = 100.0, iowait_max = 0.0, iowait_min = 100.0;
+    for (int i = 0; i < cur->cpu.cpu_count; i++) {
+        const CpuTimes *a = &prev->cpu.cpu[i], *b = &cur->cpu.cpu[i];
+        double busy = sysmon_cpu_busy_percent(a, b);
+        double iowait = percent_of(b->iowait - a->iowait, cpu_times_total(b) - cpu_times_total(a));
+        if (busy > busy_max) busy_max = busy;
+        if (busy < busy_min) busy_min = busy;
+        if (iowait > iowait_max) iowait_max = iowait;
+        if (iowait < iowait_min) iowait_min = iowait;
+    }
+    values[SLOT_CORE_BUSY_MAX] = busy_max;
+    values[SLOT_CORE_BUSY_MIN] = busy_min;
+    values[SLOT_CORE_IOWAIT_MAX] = iowait_max;
+    values[SLOT_CORE_IOWAIT_MIN] = iowait_min;
+
+    values[SLOT_MEM_USED] = percent_of(mem->total_kb - mem->available_kb, mem->total_kb);
+    values[SLOT_MEM_AVAILABLE] = percent_of(mem->available_kb, mem->total_kb);
+    values[SLOT_SWAP_USED] = percent_of(mem->swap_total_kb - mem->swap_free_kb, mem->swap_total_kb);
+    values[SLOT_LOAD1] = cur->load.load1;
+    values[SLOT_LOAD5] = cur->load.load5;
+    values[SLOT_LOAD15] = cur->load.load15;
+
+    values[SLOT_DISK_READ] = (double)(cur->io.read_sectors - prev->io.read_sectors) * 512.0 / 1e6 / seconds;
+    values[SLOT_DISK_WRITE] = (double)(cur->io.write_sectors - prev->io.write_sectors) * 512.0 / 1e6 / seconds;
+    values[SLOT_DISK_IOPS] = (double)(cur->io.reads - prev->io.reads + cur->io.writes - prev->io.writes) / seconds;
+    values[SLOT_DISK_BUSY] = (double)(cur->io.io_ms - prev->io.io_ms) / (seconds * 10.0);
+    values[SLOT_NET_RX] = (double)(cur->io.rx_bytes - prev->io.rx_bytes) / 1e6 / seconds;
+    values[SLOT_NET_TX] = (double)(cur->io.tx_bytes - prev->io.tx_bytes) / 1e6 / seconds;
+    values[SLOT_PROCS_RUNNING] = cur->cpu.procs_running;
+    values[SLOT_CTXT] = (double)(cur->cpu.context_switches - prev->cpu.context_switches) / seconds;
+}
+
+/* ------------------------------------------------------------------ */
+/* Rule compilation                                                    */
+/* ------------------------------------------------------------------ */
+
+static char *next_token(char **cursor) {
+    char *p = *cursor;
+
+    while (isspace((unsigned char)*p)) p++;
+    if (*p == '\0') {
+        *cursor = p;
+        return NULL;
+    }
+    char *start = p;
+    while (*p && !isspace((unsigned char)*p)) p++;
+    if (*p) *p++ = '\0';
+    *cursor = p;
+    return start;
+}
+
+/**
+ * Parse "30", "30s", "5m" or "1h" into milliseconds
+ */
+static bool parse_duration(const char *text, long long *ms) {
+    char *end;
+    double value = strtod(text, &end);
+
+    if (end == text || value < 0.0) {
+        return false;
+    }
+    double scale = 1000.0;
+    if (strcmp(end, "ms") == 0) scale = 1.0;
+    else if (strcmp(end, "m") == 0) scale = 60000.0;
+    else if (strcmp(end, "h") == 0) scale = 3600000.0;
+    else if (*end != '\0' && strcmp(end, "s") != 0) return false;
+
+    *ms = (long long)(value * scale);
+    return true;
+}
+
+static bool parse_threshold(const char *text, double *value) {
+    char *end;
+
+    *value = strtod(text, &end);
+    return end != text && (*end == '\0' || strcmp(end, "%") == 0);
+}
+
+static bool grow_rules(AlertRuleSet *set) {
+    if (set->count < set->capacity) {
+        return true;
+    }
+    int capacity = set->capacity > 0 ? set->capacity * 2 : 16;
+    AlertRule *rules = realloc(set->rules, (size_t)capacity * sizeof(AlertRule));
+    if (rules == NULL) {
+        return false;
+    }
+    set->rules = rules;
+    AlertRuleInfo *info = realloc(set->info, (size_t)capacity * sizeof(AlertRuleInfo));
+    if (info == NULL) {
+        return false;
+    }
+    set->info = info;
+    set->capacity = capacity;
+    return true;
+}
+
+/**
+ * Compile one rule line and append it to the set:
+ *   name: metric op value [for duration] [clear value] [exec command... | log path]
+ * Returns false with a message in err on a syntax error.
+ */
+bool alert_rule_compile(AlertRuleSet *set, const char *text, char *err, size_t err_size) {
+    char line[MAX_INPUT_LENGTH];
+    AlertRule rule;
+    AlertRuleInfo info;
+
+    snprintf(line, sizeof(line), "%s", text);
+    memset(&rule, 0, sizeof(rule));
+    memset(&info, 0, sizeof(info));
+
+    char *cursor = line;
+    char *name = next_token(&cursor);
+    char *metric = next_token(&cursor);
+    char *op = next_token(&cursor);
+    char *value = next_token(&cursor);
+    if (name == NULL || value == NULL || name[strlen(name) - 1] != ':') {
+        snprintf(err, err_size, "expected 'name: metric op value'");
+        return false;
+    }
+    name[strlen(name) - 1] = '\0';
+    snprintf(info.name, sizeof(info.name), "%s", name);
+
+    int m = 0;
+    while (m < ALERT_METRIC_COUNT && strcmp(alert_metrics[m].name, metric) != 0) m++;
+    if (m == ALERT_METRIC_COUNT) {
+        snprintf(err, err_size, "unknown metric '%s'", metric);
+        return false;
+    }
+    info.metric = m;
+
+    if (strcmp(op, ">") == 0) rule.op = ALERT_OP_GT;
+    else if (strcmp(op, ">=") == 0) rule.op = ALERT_OP_GE;
+    else if (strcmp(op, "<") == 0) rule.op = ALERT_OP_LT;
+    else if (strcmp(op, "<=") == 0) rule.op = ALERT_OP_LE;
+    else {
+        snprintf(err, err_size, "unknown operator '%s'", op);
+        return false;
+    }
+    bool above = rule.op == ALERT_OP_GT || rule.op == ALERT_OP_GE;
+    rule.slot = above ? alert_metrics[m].slot_above : alert_metrics[m].slot_below;
+
+    if (!parse_threshold(value, &rule.threshold)) {
+        snprintf(err, err_size, "bad threshold '%s'", value);
+        return false;
+    }
+    rule.clear = rule.threshold;
+
+    char *word;
+    while ((word = next_token(&cursor)) != NULL) {
+        if (strcmp(word, "for") == 0) {
+            char *arg = next_token(&cursor);
+            if (arg == NULL || !parse_duration(arg, &rule.duration_ms)) {
+                snprintf(err, err_size, "bad duration after 'for'");
+                return false;
+            }
+        } else if (strcmp(word, "clear") == 0) {
+            char *arg = next_token(&cursor);
+            if (arg == NULL || !parse_threshold(arg, &rule.clear)) {
+                snprintf(err, err_size, "bad value after 'clear'");
+                return false;
+            }
+        } else if (strcmp(word, "exec") == 0 || strcmp(word, "log") == 0) {
+            while (isspace((unsigned char)*cursor)) cursor++;
+            if (*cursor == '\0') {
+                snprintf(err, err_size, "'%s' needs an argument", word);
+                return false;
+            }
+            info.action = word[0] == 'e' ? ALERT_ACTION_EXEC : ALERT_ACTION_LOG;
+            snprintf(info.target, sizeof(info.target), "%s", cursor);
+            break;
+        } else {
+            snprintf(err, err_size, "unexpected '%s'", word);
+            return false;
+        }
+    }
+
+    // The clear level must sit on the safe side of the threshold
+    if ((above && rule.clear > rule.threshold) || (!above && rule.clear < rule.threshold)) {
+        snprintf(err, err_size, "clear level is on the wrong side of the threshold");
+        return false;
+    }
+
+    if (!grow_rules(set)) {
+        snprintf(err, err_size, "out of memory");
+        return false;
+    }
+    set->rules[set->count] = rule;
+    set->info[set->count] = info;
+    set->count++;
+    return true;
+}
+
+/**
+ * Load a rules file, reporting syntax errors with line numbers.
+ * Blank lines and lines starting with '#' are ignored.
+ */
+bool alert_rules_load(AlertRuleSet *set, const char *path) {
+    char line[MAX_INPUT_LENGTH];
+    char err[128];
+    int number = 0;
+    bool ok = true;
+
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        return false;
+    }
+
+    while (fgets(line, sizeof(line), file) != NULL) {
+        number++;
+        line[strcspn(line, "\r\n")] = '\0';
+        char *p = line;
+        while (isspace((unsigned char)*p)) p++;
+        if (*p == '\0' || *p == '#') {
+            continue;
+        }
+        if (!alert_rule_compile(set, p, err, sizeof(err))) {
+            printf("%s%s:%d: %s%s\n", COLOR_RED, path, number, err, COLOR_RESET);
+            ok = false;
+        }
+    }
+
+    fclose(file);
+    return ok;
+}
+
+void alert_rules_free(AlertRuleSet *set) {
+    free(set->rules);
+    free(set->info);
+    memset(set, 0, sizeof(*set));
+}
+
+/* ------------------------------------------------------------------ */
+/* Evaluation                                                          */
+/* ------------------------------------------------------------------ */
+
+#ifdef __linux__
+
+static void format_rule(const AlertRuleSet *set, int index, char *out, size_t size) {
+    static const char *ops[] = { ">", ">=", "<", "<=" };
+    const AlertRule *rule = &set->rules[index];
+    const AlertRuleInfo *info = &set->info[index];
+
+    snprintf(out, size, "%s %s %g%s for %llds", alert_metrics[info->metric].name, ops[rule->op],
+             rule->threshold, alert_metrics[info->metric].unit, rule->duration_ms / 1000);
+}
+
+/**
+ * Print a transition and run the rule's action: log lines are written
+ * for both firing and resolving, commands only run when a rule fires
+ */
+static void run_action(const AlertRuleSet *set, int index, bool firing, double value) {
+    const AlertRuleInfo *info = &set->info[index];
+    char when[32], rule_text[128], value_text[32];
+    time_t now = time(NULL);
+
+    strftime(when, sizeof(when), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+    format_rule(set, index, rule_text, sizeof(rule_text));
+    snprintf(value_text, sizeof(value_text), "%.2f", value);
+
+    printf("\r%s[%s] %s %s: %s=%s%s (%s)%s\n", firing ? COLOR_RED : COLOR_GREEN, when,
+           firing ? "FIRING  " : "RESOLVED", info->name, alert_metrics[info->metric].name,
+           value_text, alert_metrics[info->metric].unit, rule_text, COLOR_RESET);
+    fflush(stdout);
+
+    if (info->action == ALERT_ACTION_LOG) {
+        FILE *log = fopen(info->target, "a");
+        if (log != NULL) {
+            fprintf(log, "%s %s %s %s=%s (%s)\n", when, firing ? "FIRING" : "RESOLVED", info->name,
+                    alert_metrics[info->metric].name, value_text, rule_text);
+            fclose(log);
+        }
+    } else if (info->action == ALERT_ACTION_EXEC && firing) {
+        // Don't let a slow command stall sampling; children are reaped later
+        fflush(NULL);
+        pid_t pid = fork();
+        if (pid == 0) {
+            setenv("DEVHELPER_ALERT", info->name, 1);
+            setenv("DEVHELPER_ALERT_VALUE", value_text, 1);
+            execl("/bin/sh", "sh", "-c", info->target, (char *)NULL);
+            _exit(127);
+        }
+    }
+}
+
+#endif
+
+/**
+ * Evaluate every rule against one value vector, advancing each rule's
+ * OK -> PENDING -> FIRING state and running actions on transitions.
+ * Returns the number of rules currently firing.
+ */
+int alert_rules_evaluate(AlertRuleSet *set, const double *values, long long now_ms) {
+    int firing = 0;
+
+    for (int i = 0; i < set->count; i++) {
+        AlertRule *rule = &set->rules[i];
+        double v = values[rule->slot];
+        bool breach;
+
+        switch (rule->op) {
+            case ALERT_OP_GT: breach = v > rule->threshold; break;
+            case ALERT_OP_GE: breach = v >= rule->threshold; break;
+            case ALERT_OP_LT: breach = v < rule->threshold; break;
+            default:          breach = v <= rule->threshold; break;
+        }
+
+        switch (rule->state) {
+            case ALERT_OK:
+                if (!breach) break;
+                // A rule without a duration fires on this same sample
+                rule->state = ALERT_PENDING;
+                rule->since_ms = now_ms;
+                /* fall through */
+            case ALERT_PENDING:
+                if (!breach) {
+                    rule->state = ALERT_OK;
+                } else if (now_ms - rule->since_ms >= rule->duration_ms) {
+                    rule->state = ALERT_FIRING;
+#ifdef __linux__
+                    run_action(set, i, true, v);
+#endif
+                }
+                break;
+            case ALERT_FIRING: {
+                // Hysteresis: only resolve once past the clear level
+                bool above = rule->op == ALERT_OP_GT || rule->op == ALERT_OP_GE;
+                bool cleared = !breach && (above ? v <= rule->clear : v >= rule->clear);
+                if (cleared) {
+                    rule->state = ALERT_OK;
+#ifdef __linux__
+                    run_action(set, i, false, v);
+#endif
+                }
+                break;
+            }
+        }
+        firing += rule->state == ALERT_FIRING;
+    }
+    return firing;
+}
+
+/* ------------------------------------------------------------------ */
+/* Watch loop                                                          */
+/* ------------------------------------------------------------------ */
+
+#ifdef __linux__
+static volatile sig_atomic_t alert_interrupted = 0;
+
+static void alert_signal_handler(int sig) {
+    (void)sig;
+    alert_interrupted = 1;
+}
+#endif
+
+/**
+ * Sample every interval_ms and evaluate the rules in rules_path until a
+ * key is pressed, or SIGINT/SIGTERM when running without a terminal
+ */
+void sysmon_alert_watch(const char *rules_path, int interval_ms) {
+#ifndef __linux__
+    (void)rules_path;
+    (void)interval_ms;
+    print_warning("Alert rules read /proc and are only available on Linux.");
+#else
+    AlertRuleSet set;
+    double values[SLOT_COUNT];
+
+    if (interval_ms < 100) interval_ms = 100;
+    if (interval_ms > 60000) interval_ms = 60000;
+
+    memset(&set, 0, sizeof(set));
+    if (!alert_rules_load(&set, rules_path)) {
+        if (access(rules_path, R_OK) != 0) {
+            print_error("Could not open the rules file!");
+        }
+        print_info("Rule syntax: name: metric op value [for 30s] [clear value] [exec cmd | log file]");
+        printf("  Metrics:");
+        for (int m = 0; m < ALERT_METRIC_COUNT; m++) {
+            printf(" %s", alert_metrics[m].name);
+        }
+        printf("\n");
+        alert_rules_free(&set);
+        return;
+    }
+    if (set.count == 0) {
+        print_warning("The rules file has no rules.");
+        alert_rules_free(&set);
+        return;
+    }
+
+    LiveSample *samples = malloc(2 * sizeof(LiveSample));
+    if (samples == NULL || !sysmon_read_sample(&samples[0])) {
+        print_error("Could not read /proc!");
+        free(samples);
+        alert_rules_free(&set);
+        return;
+    }
+    LiveSample *prev = &samples[0];
+    LiveSample *cur = &samples[1];
+
+    struct sigaction sa, old_int, old_term;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = alert_signal_handler;
+    sigaction(SIGINT, &sa, &old_int);
+    sigaction(SIGTERM, &sa, &old_term);
+    alert_interrupted = 0;
+
+    // Unattended runs (stdin not a terminal) only stop on a signal
+    bool interactive = isatty(STDIN_FILENO);
+    printf("%sWatching %d rules every %d ms - %s%s\n", COLOR_CYAN, set.count, interval_ms,
+           interactive ? "press any key to stop" : "send SIGINT or SIGTERM to stop", COLOR_RESET);
+    if (interactive) {
+        terminal_set_raw(true);
+    }
+
+    long long next_tick = prev->time_ms + interval_ms;
+    while (!alert_interrupted) {
+        int wait = (int)(next_tick - monotonic_ms());
+        if (interactive) {
+            if (wait_for_key(wait) >= 0) {
+                break;
+            }
+        } else if (wait > 0) {
+            usleep((useconds_t)wait * 1000);
+        }
+        long long now = monotonic_ms();
+        if (alert_interrupted || now < next_tick) {
+            continue;
+        }
+        next_tick += interval_ms;
+        if (next_tick <= now) {
+            next_tick = now + interval_ms;
+        }
+
+        while (waitpid(-1, NULL, WNOHANG) > 0) {
+            // Reap finished exec actions
+        }
+        if (!sysmon_read_sample(cur)) {
+            continue;
+        }
+
+        struct timespec t0, t1;
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        compute_values(prev, cur, values);
+        int firing = alert_rules_evaluate(&set, values, cur->time_ms);
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        double eval_us = (double)(t1.tv_sec - t0.tv_sec) * 1e6 + (double)(t1.tv_nsec - t0.tv_nsec) / 1e3;
+
+        int pending = 0;
+        for (int i = 0; i < set.count; i++) {
+            pending += set.rules[i].state == ALERT_PENDING;
+        }
+        if (interactive) {
+            printf("\r  %s%d firing%s, %d pending, evaluated in %.1f us   ",
+                   firing > 0 ? COLOR_RED : COLOR_GREEN, firing, COLOR_RESET, pending, eval_us);
+            fflush(stdout);
+        }
+
+        LiveSample *swap = prev;
+        prev = cur;
+        cur = swap;
+    }
+
+    if (interactive) {
+        terminal_set_raw(false);
+    }
+    sigaction(SIGINT, &old_int, NULL);
+    sigaction(SIGTERM, &old_term, NULL);
+    printf("\n");
+
+    free(samples);
+    alert_rules_free(&set);
+#endif
+}
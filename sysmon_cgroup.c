@@ -0,0 +1,598 @@
+/**
+ * DevHelper+Portal CLI - Container (cgroup) Resources
+ *
+ * Finds the cgroup this process runs in and reports its CPU quota and
+ * throttling, memory limit and breakdown, and I/O totals, so they can be
+ * shown next to the host-wide numbers. cgroup v2 is preferred; on v1 or
+ * hybrid hosts the equivalent v1 controller files are used.
+ */
+
+#define _GNU_SOURCE
+#include "devhelper.h"
+
+#ifdef __linux__
+#include <limits.h>
+#endif
+
+#ifdef __linux__
+
+// v1 reports "no limit" as a huge page-aligned number
+#define CGROUP_V1_UNLIMITED (1ULL << 60)
+
+typedef struct {
+    bool detected;
+    char v2[MAX_PATH_LENGTH];       // Unified hierarchy directory, "" if none
+    char cpu[MAX_PATH_LENGTH];      // v1 controller directories
+    char cpuacct[MAX_PATH_LENGTH];
+    char memory[MAX_PATH_LENGTH];
+    char blkio[MAX_PATH_LENGTH];
+    char v2_mount[MAX_PATH_LENGTH];     // Mounts and their roots, for other pids
+    char v2_root[MAX_PATH_LENGTH];
+    char memory_mount[MAX_PATH_LENGTH];
+    char memory_root[MAX_PATH_LENGTH];
+} CgroupPaths;
+
+static CgroupPaths paths;
+
+/**
+ * Does a comma-separated option list contain the given word?
+ */
+static bool list_has(const char *list, const char *word) {
+    size_t len = strlen(word);
+
+    for (const char *p = list; p && *p; ) {
+        const char *comma = strchr(p, ',');
+        size_t n = comma ? (size_t)(comma - p) : strlen(p);
+        if (n == len && strncmp(p, word, len) == 0) {
+            return true;
+        }
+        p = comma ? comma + 1 : NULL;
+    }
+    return false;
+}
+
+/**
+ * Look up the cgroup path for a hierarchy ("" for v2, else a v1
+ * controller name) in the contents of a /proc/[pid]/cgroup file
+ */
+static bool find_cgroup_path(const char *buf, const char *controller, char *out, size_t size) {
+    char line[MAX_PATH_LENGTH + 64];
+
+    for (const char *p = buf; *p; ) {
+        const char *end = strchr(p, '\n');
+        size_t n = end ? (size_t)(end - p) : strlen(p);
+        if (n >= sizeof(line)) n = sizeof(line) - 1;
+        memcpy(line, p, n);
+        line[n] = '\0';
+        p = end ? end + 1 : p + n;
+
+        char *first = strchr(line, ':');
+        char *second = first ? strchr(first + 1, ':') : NULL;
+        if (second == NULL) {
+            continue;
+        }
+        *second = '\0';
+        const char *controllers = first + 1;
+        bool match = controller[0] == '\0' ? controllers[0] == '\0' : list_has(controllers, controller);
+        if (match) {
+            snprintf(out, size, "%s", second + 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Join a mount point with a cgroup path, dropping the mount's own root
+ * (inside a cgroup namespace the mount root is usually "/")
+ */
+static void join_mount(char *out, size_t size, const char *mount, const char *root, const char *cgroup) {
+    size_t root_len = strlen(root);
+
+    if (strcmp(root, "/") != 0 && strncmp(cgroup, root, root_len) == 0) {
+        cgroup += root_len;
+    }
+    if (strcmp(cgroup, "/") == 0) {
+        cgroup = "";
+    }
+    snprintf(out, size, "%s%s", mount, cgroup);
+}
+
+/**
+ * Resolve the cgroup directories for this process once
+ */
+static void detect_paths(void) {
+    static char cgroups[8192];
+    static char mountinfo[65536];
+
+    if (paths.detected) {
+        return;
+    }
+    paths.detected = true;
+
+    if (sysmon_read_file("/proc/self/cgroup", cgroups, sizeof(cgroups)) <= 0 ||
+        sysmon_read_file("/proc/self/mountinfo", mountinfo, sizeof(mountinfo)) <= 0) {
+        return;
+    }
+
+    char *line = mountinfo;
+    while (*line) {
+        char *next = strchr(line, '\n');
+        if (next) *next++ = '\0';
+        else next = line + strlen(line);
+
+        // "id parent major:minor root mount opts... - fstype source superopts"
+        char root[MAX_PATH_LENGTH], mount[MAX_PATH_LENGTH];
+        char fstype[32], source[64], superopts[256];
+        char *sep = strstr(line, " - ");
+        if (sep == NULL || sscanf(line, "%*d %*d %*s %1023s %1023s", root, mount) != 2 ||
+            sscanf(sep + 3, "%31s %63s %255s", fstype, source, superopts) != 3) {
+            line = next;
+            continue;
+        }
+
+        char cgroup[MAX_PATH_LENGTH];
+        if (strcmp(fstype, "cgroup2") == 0) {
+            snprintf(paths.v2_mount, sizeof(paths.v2_mount), "%s", mount);
+            snprintf(paths.v2_root, sizeof(paths.v2_root), "%s", root);
+            if (find_cgroup_path(cgroups, "", cgroup, sizeof(cgroup))) {
+                join_mount(paths.v2, sizeof(paths.v2), mount, root, cgroup);
+            }
+        } else if (strcmp(fstype, "cgroup") == 0) {
+            if (list_has(superopts, "memory")) {
+                snprintf(paths.memory_mount, sizeof(paths.memory_mount), "%s", mount);
+                snprintf(paths.memory_root, sizeof(paths.memory_root), "%s", root);
+            }
+            struct { const char *name; char *dest; } v1[] = {
+                { "cpu", paths.cpu }, { "cpuacct", paths.cpuacct },
+                { "memory", paths.memory }, { "blkio", paths.blkio }
+            };
+            for (size_t i = 0; i < sizeof(v1) / sizeof(v1[0]); i++) {
+                if (list_has(superopts, v1[i].name) &&
+                    find_cgroup_path(cgroups, v1[i].name, cgroup, sizeof(cgroup))) {
+                    join_mount(v1[i].dest, MAX_PATH_LENGTH, mount, root, cgroup);
+                }
+            }
+        }
+        line = next;
+    }
+}
+
+static long read_cgroup_file(const char *dir, const char *name, char *buf, size_t size) {
+    char path[MAX_PATH_LENGTH + 64];
+
+    if (dir[0] == '\0') {
+        return -1;
+    }
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    return sysmon_read_file(path, buf, size);
+}
+
+/**
+ * Read a single-number file. "max" (v2) and huge v1 values read as 0,
+ * meaning unlimited. Returns false if the file is missing.
+ */
+static bool read_limit(const char *dir, const char *name, unsigned long long *value) {
+    char buf[64];
+
+    if (read_cgroup_file(dir, name, buf, sizeof(buf)) <= 0) {
+        return false;
+    }
+    *value = strncmp(buf, "max", 3) == 0 ? 0 : strtoull(buf, NULL, 10);
+    if (*value >= CGROUP_V1_UNLIMITED) {
+        *value = 0;
+    }
+    return true;
+}
+
+/**
+ * Look up "key value" in a flat-keyed file such as cpu.stat or memory.stat
+ */
+static unsigned long long keyed_value(const char *buf, const char *key) {
+    size_t len = strlen(key);
+
+    for (const char *p = buf; p && *p; ) {
+        if (strncmp(p, key, len) == 0 && p[len] == ' ') {
+            return strtoull(p + len + 1, NULL, 10);
+        }
+        p = strchr(p, '\n');
+        if (p) p++;
+    }
+    return 0;
+}
+
+static void read_v2(CgroupSnapshot *snap) {
+    char buf[8192];
+    const char *dir = paths.v2;
+
+    if (read_cgroup_file(dir, "cpu.stat", buf, sizeof(buf)) > 0) {
+        snap->has_cpu = true;
+        snap->cpu_usage_usec = keyed_value(buf, "usage_usec");
+        snap->cpu_user_usec = keyed_value(buf, "user_usec");
+        snap->cpu_system_usec = keyed_value(buf, "system_usec");
+        snap->nr_periods = keyed_value(buf, "nr_periods");
+        snap->nr_throttled = keyed_value(buf, "nr_throttled");
+        snap->throttled_usec = keyed_value(buf, "throttled_usec");
+    }
+    if (read_cgroup_file(dir, "cpu.max", buf, sizeof(buf)) > 0 && strncmp(buf, "max", 3) != 0) {
+        unsigned long long quota = 0, period = 0;
+        if (sscanf(buf, "%llu %llu", &quota, &period) == 2 && period > 0) {
+            snap->cpu_quota_usec = quota;
+            snap->cpu_period_usec = period;
+        }
+    }
+
+    if (read_limit(dir, "memory.current", &snap->mem_current)) {
+        snap->has_memory = true;
+        read_limit(dir, "memory.max", &snap->mem_max);
+        read_limit(dir, "memory.high", &snap->mem_high);
+        read_limit(dir, "memory.swap.current", &snap->swap_current);
+        read_limit(dir, "memory.swap.max", &snap->swap_max);
+        if (read_cgroup_file(dir, "memory.stat", buf, sizeof(buf)) > 0) {
+            snap->mem_anon = keyed_value(buf, "anon");
+            snap->mem_file = keyed_value(buf, "file");
+            snap->mem_kernel = keyed_value(buf, "kernel");
+            if (snap->mem_kernel == 0) {
+                // Older kernels only split kernel memory into its parts
+                snap->mem_kernel = keyed_value(buf, "kernel_stack") + keyed_value(buf, "slab") +
+                                   keyed_value(buf, "pagetables");
+            }
+            snap->mem_shmem = keyed_value(buf, "shmem");
+            snap->mem_sock = keyed_value(buf, "sock");
+            snap->mem_dirty = keyed_value(buf, "file_dirty");
+            snap->mem_writeback = keyed_value(buf, "file_writeback");
+        }
+        if (read_cgroup_file(dir, "memory.events", buf, sizeof(buf)) > 0) {
+            snap->events_high = keyed_value(buf, "high");
+            snap->events_max = keyed_value(buf, "max");
+            snap->events_oom = keyed_value(buf, "oom");
+            snap->events_oom_kill = keyed_value(buf, "oom_kill");
+        }
+    }
+
+    // "8:0 rbytes=1 wbytes=2 rios=3 wios=4 dbytes=0 dios=0" per device
+    if (read_cgroup_file(dir, "io.stat", buf, sizeof(buf)) >= 0) {
+        snap->has_io = true;
+        for (const char *p = buf; p && *p; ) {
+            unsigned long long rbytes, wbytes, rios, wios;
+            if (sscanf(p, "%*s rbytes=%llu wbytes=%llu rios=%llu wios=%llu",
+                       &rbytes, &wbytes, &rios, &wios) == 4) {
+                snap->io_read_bytes += rbytes;
+                snap->io_write_bytes += wbytes;
+                snap->io_reads += rios;
+                snap->io_writes += wios;
+            }
+            p = strchr(p, '\n');
+            if (p) p++;
+        }
+    }
+}
+
+/**
+ * Sum the Read/Write rows of a v1 blkio "8:0 Read 1234" file
+ */
+static void sum_blkio(const char *buf, unsigned long long *reads, unsigned long long *writes) {
+    for (const char *p = buf; p && *p; ) {
+        char op[16];
+        unsigned long long value;
+        if (sscanf(p, "%*s %15s %llu", op, &value) == 2) {
+            if (strcmp(op, "Read") == 0) *reads += value;
+            else if (strcmp(op, "Write") == 0) *writes += value;
+        }
+        p = strchr(p, '\n');
+        if (p) p++;
+    }
+}
+
+static void read_v1(CgroupSnapshot *snap) {
+    char buf[8192];
+    unsigned long long value;
+
+    if (read_cgroup_file(paths.cpuacct, "cpuacct.usage", buf, sizeof(buf)) > 0) {
+        snap->has_cpu = true;
+        snap->cpu_usage_usec = strtoull(buf, NULL, 10) / 1000;
+        if (read_cgroup_file(paths.cpuacct, "cpuacct.stat", buf, sizeof(buf)) > 0) {
+            unsigned long long usec_per_tick = 1000000ULL / (unsigned long long)sysconf(_SC_CLK_TCK);
+            snap->cpu_user_usec = keyed_value(buf, "user") * usec_per_tick;
+            snap->cpu_system_usec = keyed_value(buf, "system") * usec_per_tick;
+        }
+    }
+    if (read_cgroup_file(paths.cpu, "cpu.stat", buf, sizeof(buf)) > 0) {
+        snap->nr_periods = keyed_value(buf, "nr_periods");
+        snap->nr_throttled = keyed_value(buf, "nr_throttled");
+        snap->throttled_usec = keyed_value(buf, "throttled_time") / 1000;
+    }
+    if (read_cgroup_file(paths.cpu, "cpu.cfs_quota_us", buf, sizeof(buf)) > 0 &&
+        strtoll(buf, NULL, 10) > 0 && read_limit(paths.cpu, "cpu.cfs_period_us", &value) && value > 0) {
+        snap->cpu_quota_usec = strtoull(buf, NULL, 10);
+        snap->cpu_period_usec = value;
+    }
+
+    if (read_limit(paths.memory, "memory.usage_in_bytes", &snap->mem_current)) {
+        snap->has_memory = true;
+        read_limit(paths.memory, "memory.limit_in_bytes", &snap->mem_max);
+        read_limit(paths.memory, "memory.soft_limit_in_bytes", &snap->mem_high);
+        read_limit(paths.memory, "memory.failcnt", &snap->events_max);
+        read_limit(paths.memory, "memory.kmem.usage_in_bytes", &snap->mem_kernel);
+        read_limit(paths.memory, "memory.kmem.tcp.usage_in_bytes", &snap->mem_sock);
+        if (read_cgroup_file(paths.memory, "memory.stat", buf, sizeof(buf)) > 0) {
+            snap->mem_anon = keyed_value(buf, "total_rss");
+            snap->mem_file = keyed_value(buf, "total_cache");
+            snap->mem_shmem = keyed_value(buf, "total_shmem");
+            snap->mem_dirty = keyed_value(buf, "total_dirty");
+            snap->mem_writeback = keyed_value(buf, "total_writeback");
+            snap->swap_current = keyed_value(buf, "total_swap");
+        }
+        if (read_cgroup_file(paths.memory, "memory.oom_control", buf, sizeof(buf)) > 0) {
+            snap->events_oom_kill = keyed_value(buf, "oom_kill");
+        }
+    }
+
+    if (read_cgroup_file(paths.blkio, "blkio.throttle.io_service_bytes", buf, sizeof(buf)) > 0) {
+        snap->has_io = true;
+        sum_blkio(buf, &snap->io_read_bytes, &snap->io_write_bytes);
+        if (read_cgroup_file(paths.blkio, "blkio.throttle.io_serviced", buf, sizeof(buf)) > 0) {
+            sum_blkio(buf, &snap->io_reads, &snap->io_writes);
+        }
+    }
+}
+
+#endif
+
+/**
+ * Read the CPU, memory and I/O accounting of this process's cgroup.
+ * Returns false when no cgroup information is available.
+ */
+bool cgroup_read(CgroupSnapshot *snap) {
+    memset(snap, 0, sizeof(*snap));
+#ifdef __linux__
+    detect_paths();
+
+    // v2 wins when its controllers are enabled for our cgroup
+    char probe[MAX_PATH_LENGTH + 32];
+    snprintf(probe, sizeof(probe), "%s/memory.current", paths.v2);
+    bool v2_memory = paths.v2[0] && access(probe, F_OK) == 0;
+    snprintf(probe, sizeof(probe), "%s/cpu.max", paths.v2);
+    bool v2_cpu = paths.v2[0] && access(probe, F_OK) == 0;
+
+    if (v2_memory || v2_cpu) {
+        snap->version = 2;
+        snprintf(snap->path, sizeof(snap->path), "%s", paths.v2);
+        read_v2(snap);
+    } else if (paths.memory[0] || paths.cpu[0]) {
+        snap->version = 1;
+        snprintf(snap->path, sizeof(snap->path), "%s", paths.memory[0] ? paths.memory : paths.cpu);
+        read_v1(snap);
+    }
+    return snap->has_cpu || snap->has_memory;
+#else
+    return false;
+#endif
+}
+
+/**
+ * Directory of this process's cgroup in the unified (v2) hierarchy,
+ * or "" if there is none
+ */
+const char *cgroup_v2_dir(void) {
+#ifdef __linux__
+    detect_paths();
+    return paths.v2;
+#else
+    return "";
+#endif
+}
+
+/**
+ * Find the tightest memory limit over the cgroup of any process and its
+ * ancestors, since a limit on any level can OOM it. Usage leaves out
+ * page cache, which reclaim drops before anything is killed. Returns
+ * false when no level is limited.
+ */
+bool cgroup_memory_limit(int pid, unsigned long long *limit, unsigned long long *used) {
+#ifdef __linux__
+    char path[64], cgroups[8192], cgroup[MAX_PATH_LENGTH], dir[MAX_PATH_LENGTH];
+    char buf[8192];
+    const char *mount;
+    bool v2 = false;
+
+    detect_paths();
+    snprintf(path, sizeof(path), "/proc/%d/cgroup", pid);
+    if (sysmon_read_file(path, cgroups, sizeof(cgroups)) <= 0) {
+        return false;
+    }
+
+    // On hybrid hosts the unified tree exists without the memory controller
+    if (paths.v2_mount[0] && read_cgroup_file(paths.v2_mount, "cgroup.controllers", buf, sizeof(buf)) > 0 &&
+        strstr(buf, "memory") != NULL && find_cgroup_path(cgroups, "", cgroup, sizeof(cgroup))) {
+        v2 = true;
+        mount = paths.v2_mount;
+        join_mount(dir, sizeof(dir), mount, paths.v2_root, cgroup);
+    } else if (paths.memory_mount[0] && find_cgroup_path(cgroups, "memory", cgroup, sizeof(cgroup))) {
+        mount = paths.memory_mount;
+        join_mount(dir, sizeof(dir), mount, paths.memory_root, cgroup);
+    } else {
+        return false;
+    }
+
+    bool found = false;
+    size_t mount_len = strlen(mount);
+    for (;;) {
+        unsigned long long max = 0, current = 0;
+        if (read_limit(dir, v2 ? "memory.max" : "memory.limit_in_bytes", &max) && max > 0 &&
+            read_limit(dir, v2 ? "memory.current" : "memory.usage_in_bytes", &current)) {
+            if (read_cgroup_file(dir, "memory.stat", buf, sizeof(buf)) > 0) {
+                unsigned long long cache = keyed_value(buf, v2 ? "file" : "total_cache");
+                current = current > cache ? current - cache : 0;
+            }
+            if (!found || (max > current ? max - current : 0) < (*limit > *used ? *limit - *used : 0)) {
+                *limit = max;
+                *used = current;
+                found = true;
+            }
+        }
+
+        char *slash = strrchr(dir, '/');
+        if (strlen(dir) <= mount_len || slash == NULL || (size_t)(slash - dir) < mount_len) {
+            break;
+        }
+        *slash = '\0';
+    }
+    return found;
+#else
+    (void)pid;
+    (void)limit;
+    (void)used;
+    return false;
+#endif
+}
+
+#ifdef __linux__
+
+static void print_bytes(const char *label, unsigned long long bytes) {
+    char text[32];
+    format_kb(bytes / 1024, text, sizeof(text));
+    printf("  %s %s", label, text);
+}
+
+static void print_cgroup_header(const CgroupSnapshot *snap) {
+    printf("\n%sContainer (cgroup v%d):%s %s\n", COLOR_CYAN, snap->version, COLOR_RESET, snap->path);
+}
+
+#endif
+
+/**
+ * CPU quota, usage and throttling of this cgroup next to the host numbers,
+ * measured over a short interval
+ */
+void display_cgroup_cpu(void) {
+#ifdef __linux__
+    static CpuSnapshot host_prev, host_cur;
+    CgroupSnapshot prev, cur;
+
+    if (!cgroup_read(&prev) || !prev.has_cpu) {
+        return;
+    }
+    sysmon_read_cpu(&host_prev);
+    long long start = monotonic_ms();
+    usleep(500000);
+    cgroup_read(&cur);
+    sysmon_read_cpu(&host_cur);
+    double seconds = (double)(monotonic_ms() - start) / 1000.0;
+
+    print_cgroup_header(&cur);
+
+    double used_cpus = (double)(cur.cpu_usage_usec - prev.cpu_usage_usec) / 1e6 / seconds;
+    double host_busy = sysmon_cpu_busy_percent(&host_prev.total, &host_cur.total);
+
+    if (cur.cpu_quota_usec > 0) {
+        double limit = (double)cur.cpu_quota_usec / (double)cur.cpu_period_usec;
+        double percent = 100.0 * used_cpus / limit;
+        printf("  CPU limit:  %.2f CPUs (quota %llu us per %llu us)   Host: %d CPUs\n",
+               limit, cur.cpu_quota_usec, cur.cpu_period_usec, host_cur.cpu_count);
+        printf("  CPU usage:  %s%.2f CPUs, %.1f%% of limit%s   Host busy: %.1f%%\n",
+               percent >= 90.0 ? COLOR_RED : percent >= 70.0 ? COLOR_YELLOW : COLOR_GREEN,
+               used_cpus, percent, COLOR_RESET, host_busy);
+    } else {
+        printf("  CPU limit:  none   Host: %d CPUs\n", host_cur.cpu_count);
+        printf("  CPU usage:  %.2f CPUs   Host busy: %.1f%%\n", used_cpus, host_busy);
+    }
+    printf("  CPU time:   user %.1f s  system %.1f s\n",
+           (double)cur.cpu_user_usec / 1e6, (double)cur.cpu_system_usec / 1e6);
+
+    // Throttling is the usual hidden cause of latency spikes, so make it loud
+    unsigned long long recent = cur.nr_throttled - prev.nr_throttled;
+    if (cur.nr_throttled > 0) {
+        printf("  %s%sThrottled:  %llu of %llu periods (%.1f%%), %.2f s total%s\n",
+               COLOR_BOLD, COLOR_RED, cur.nr_throttled, cur.nr_periods,
+               cur.nr_periods ? 100.0 * (double)cur.nr_throttled / (double)cur.nr_periods : 0.0,
+               (double)cur.throttled_usec / 1e6, COLOR_RESET);
+        if (recent > 0) {
+            printf("  %s%s            %llu periods throttled in the last %.1f s%s\n",
+                   COLOR_BOLD, COLOR_RED, recent, seconds, COLOR_RESET);
+        }
+    } else if (cur.cpu_quota_usec > 0) {
+        printf("  Throttled:  %snever%s\n", COLOR_GREEN, COLOR_RESET);
+    }
+#endif
+}
+
+/**
+ * Memory limit, usage breakdown and limit events of this cgroup next to
+ * the host numbers
+ */
+void display_cgroup_memory(void) {
+#ifdef __linux__
+    CgroupSnapshot snap;
+    MemorySnapshot host;
+
+    if (!cgroup_read(&snap) || !snap.has_memory) {
+        return;
+    }
+    print_cgroup_header(&snap);
+
+    char current[32], limit[32], host_used[32], host_total[32];
+    format_kb(snap.mem_current / 1024, current, sizeof(current));
+    if (sysmon_read_memory(&host)) {
+        format_kb(host.total_kb - host.available_kb, host_used, sizeof(host_used));
+        format_kb(host.total_kb, host_total, sizeof(host_total));
+    } else {
+        snprintf(host_used, sizeof(host_used), "?");
+        snprintf(host_total, sizeof(host_total), "?");
+    }
+
+    if (snap.mem_max > 0) {
+        double percent = 100.0 * (double)snap.mem_current / (double)snap.mem_max;
+        format_kb(snap.mem_max / 1024, limit, sizeof(limit));
+        printf("  Memory:  %s%s of %s limit (%.1f%%)%s   Host: %s of %s\n",
+               percent >= 90.0 ? COLOR_RED : percent >= 70.0 ? COLOR_YELLOW : COLOR_GREEN,
+               current, limit, percent, COLOR_RESET, host_used, host_total);
+    } else {
+        printf("  Memory:  %s (no limit)   Host: %s of %s\n", current, host_used, host_total);
+    }
+
+    if (snap.mem_high > 0) {
+        print_bytes(snap.version == 2 ? "High:" : "Soft limit:", snap.mem_high);
+    }
+    print_bytes("Swap:", snap.swap_current);
+    if (snap.swap_max > 0) {
+        print_bytes("of", snap.swap_max);
+    }
+    printf("\n");
+
+    print_bytes("anon", snap.mem_anon);
+    print_bytes("file", snap.mem_file);
+    print_bytes("kernel", snap.mem_kernel);
+    print_bytes("shmem", snap.mem_shmem);
+    print_bytes("sock", snap.mem_sock);
+    printf("\n");
+    print_bytes("dirty", snap.mem_dirty);
+    print_bytes("writeback", snap.mem_writeback);
+    printf("\n");
+
+    // Hitting high/max means the kernel is reclaiming or throttling us
+    bool pressure = snap.events_high > 0 || snap.events_max > 0 ||
+                    snap.events_oom > 0 || snap.events_oom_kill > 0;
+    printf("  %sLimit events: high %llu  max %llu  oom %llu  oom_kill %llu%s\n",
+           pressure ? COLOR_RED : COLOR_GREEN, snap.events_high, snap.events_max,
+           snap.events_oom, snap.events_oom_kill, COLOR_RESET);
+#endif
+}
+
+/**
+ * Cumulative block I/O of this cgroup
+ */
+void display_cgroup_io(void) {
+#ifdef __linux__
+    CgroupSnapshot snap;
+
+    if (!cgroup_read(&snap) || !snap.has_io) {
+        return;
+    }
+    print_cgroup_header(&snap);
+    print_bytes("Read:", snap.io_read_bytes);
+    printf(" in %llu ops", snap.io_reads);
+    print_bytes("Written:", snap.io_write_bytes);
+    printf(" in %llu ops\n", snap.io_writes);
+#endif
+}
@@ -0,0 +1,237 @@
+/**
+ * DevHelper+Portal CLI - Disk I/O Monitor
+ *
+ * Per-device IOPS, throughput, latency and utilization computed from
+ * /proc/diskstats deltas, with partitions listed under their disk.
+ */
+
+#define _GNU_SOURCE
+#include "devhelper.h"
+
+#ifdef __linux__
+#include <libgen.h>
+#include <limits.h>
+#endif
+
+#ifdef __linux__
+
+/**
+ * Work out whether a block device is a partition and, if so, which disk
+ * it belongs to. /sys/class/block/<part> links into its disk's directory.
+ */
+static void resolve_parent(DiskDevice *dev) {
+    char path[PATH_MAX];
+    char resolved[PATH_MAX];
+
+    dev->parent[0] = '\0';
+    snprintf(path, sizeof(path), "/sys/class/block/%s/partition", dev->name);
+    dev->is_partition = access(path, F_OK) == 0;
+    if (!dev->is_partition) {
+        return;
+    }
+
+    snprintf(path, sizeof(path), "/sys/class/block/%s", dev->name);
+    if (realpath(path, resolved) == NULL) {
+        return;
+    }
+    char *parent = basename(dirname(resolved));
+    snprintf(dev->parent, sizeof(dev->parent), "%s", parent);
+}
+
+static DiskDevice *find_or_add_device(DiskTable *table, const char *name) {
+    for (int i = 0; i < table->count; i++) {
+        if (strcmp(table->devices[i].name, name) == 0) {
+            return &table->devices[i];
+        }
+    }
+    if (table->count >= DISK_MAX_DEVICES) {
+        return NULL;
+    }
+
+    DiskDevice *dev = &table->devices[table->count++];
+    memset(dev, 0, sizeof(*dev));
+    snprintf(dev->name, sizeof(dev->name), "%s", name);
+    resolve_parent(dev);
+    return dev;
+}
+
+/**
+ * Counter growth between samples. A counter that went backwards (a device
+ * re-added under the same name, or a 32-bit field wrapping) counts as 0.
+ */
+static unsigned long long counter_delta(unsigned long long prev, unsigned long long cur) {
+    return cur > prev ? cur - prev : 0;
+}
+
+/**
+ * Sample /proc/diskstats and compute per-device rates since the last call
+ */
+bool disk_table_refresh(DiskTable *table) {
+    static _Thread_local char buf[65536];
+    long long now = monotonic_ms();
+
+    if (sysmon_read_file("/proc/diskstats", buf, sizeof(buf)) <= 0) {
+        return false;
+    }
+
+    double seconds = table->last_ms > 0 ? (double)(now - table->last_ms) / 1000.0 : 0.0;
+    for (int i = 0; i < table->count; i++) {
+        table->devices[i].present = false;
+    }
+
+    char *line = buf;
+    while (*line) {
+        char *next = strchr(line, '\n');
+        if (next) *next++ = '\0';
+        else next = line + strlen(line);
+
+        char name[32];
+        unsigned long long f[11];
+        unsigned int major, minor;
+        if (sscanf(line, "%u %u %31s %llu %llu %llu %llu %llu %llu %llu %llu %llu %llu %llu",
+                   &major, &minor, name, &f[0], &f[1], &f[2], &f[3], &f[4], &f[5],
+                   &f[6], &f[7], &f[8], &f[9], &f[10]) != 14) {
+            line = next;
+            continue;
+        }
+
+        DiskDevice *dev = find_or_add_device(table, name);
+        if (dev == NULL) {
+            line = next;
+            continue;
+        }
+
+        DiskCounters cur = {
+            .reads = f[0], .read_sectors = f[2], .read_ms = f[3],
+            .writes = f[4], .write_sectors = f[6], .write_ms = f[7],
+            .in_flight = f[8], .io_ms = f[9], .weighted_ms = f[10]
+        };
+        DiskCounters *prev = &dev->counters;
+
+        if (seconds > 0.0 && dev->sampled) {
+            unsigned long long reads = counter_delta(prev->reads, cur.reads);
+            unsigned long long writes = counter_delta(prev->writes, cur.writes);
+
+            dev->reads_per_sec = (double)reads / seconds;
+            dev->writes_per_sec = (double)writes / seconds;
+            dev->read_mb_per_sec = (double)counter_delta(prev->read_sectors, cur.read_sectors) * 512.0 / 1e6 / seconds;
+            dev->write_mb_per_sec = (double)counter_delta(prev->write_sectors, cur.write_sectors) * 512.0 / 1e6 / seconds;
+            dev->read_await_ms = reads > 0 ? (double)counter_delta(prev->read_ms, cur.read_ms) / (double)reads : 0.0;
+            dev->write_await_ms = writes > 0 ? (double)counter_delta(prev->write_ms, cur.write_ms) / (double)writes : 0.0;
+            dev->queue_depth = (double)counter_delta(prev->weighted_ms, cur.weighted_ms) / (seconds * 1000.0);
+            dev->util_percent = (double)counter_delta(prev->io_ms, cur.io_ms) / (seconds * 10.0);
+            if (dev->util_percent > 100.0) dev->util_percent = 100.0;
+        }
+
+        dev->counters = cur;
+        dev->sampled = true;
+        dev->present = true;
+        line = next;
+    }
+
+    table->last_ms = now;
+    return true;
+}
+
+/**
+ * Devices never used since boot (unused loop/ram devices) are hidden
+ */
+static bool device_is_idle(const DiskDevice *dev) {
+    return dev->counters.reads == 0 && dev->counters.writes == 0;
+}
+
+static int render_disk_row(LiveScreen *screen, int row, const DiskDevice *dev, bool indent) {
+    CellColor color = dev->util_percent >= 80.0 ? CELL_RED
+                    : dev->util_percent >= 50.0 ? CELL_YELLOW : CELL_DEFAULT;
+    live_screen_print(screen, row, 0, color,
+                      "%s%-*.*s %7.1f %7.1f %7.2f %7.2f %7.2f %7.2f %6.2f %5.1f",
+                      indent ? "  " : "", indent ? 10 : 12, indent ? 10 : 12, dev->name,
+                      dev->reads_per_sec, dev->writes_per_sec,
+                      dev->read_mb_per_sec, dev->write_mb_per_sec,
+                      dev->read_await_ms, dev->write_await_ms,
+                      dev->queue_depth, dev->util_percent);
+    return row + 1;
+}
+
+static void render_disk_frame(LiveScreen *screen, const DiskTable *table, int interval_ms) {
+    int row = 0;
+
+    live_screen_begin(screen);
+    live_screen_print(screen, row, 0, CELL_BOLD, "DevHelper Disk I/O");
+    live_screen_print(screen, row++, 20, CELL_CYAN, "interval %d ms  (press any key to exit)",
+                      interval_ms);
+    row++;
+    live_screen_print(screen, row++, 0, CELL_BOLD, "%-12s %7s %7s %7s %7s %7s %7s %6s %5s",
+                      "Device", "r/s", "w/s", "rMB/s", "wMB/s", "r_await", "w_await",
+                      "aqu-sz", "util%");
+
+    // Disks first, each followed by its partitions
+    for (int i = 0; i < table->count && row < screen->rows; i++) {
+        const DiskDevice *disk = &table->devices[i];
+        if (!disk->present || disk->is_partition || device_is_idle(disk)) {
+            continue;
+        }
+        row = render_disk_row(screen, row, disk, false);
+
+        for (int j = 0; j < table->count && row < screen->rows; j++) {
+            const DiskDevice *part = &table->devices[j];
+            if (part->present && part->is_partition && strcmp(part->parent, disk->name) == 0 &&
+                !device_is_idle(part)) {
+                row = render_disk_row(screen, row, part, true);
+            }
+        }
+    }
+}
+
+#endif
+
+/**
+ * Live per-device disk I/O view
+ */
+void sysmon_disk_io_view(int interval_ms) {
+#ifndef __linux__
+    (void)interval_ms;
+    print_warning("The disk I/O view reads /proc/diskstats and is only available on Linux.");
+#else
+    static DiskTable table;
+    LiveScreen screen;
+
+    if (interval_ms < 100) interval_ms = 100;
+    if (interval_ms > 5000) interval_ms = 5000;
+
+    memset(&table, 0, sizeof(table));
+    if (!disk_table_refresh(&table)) {
+        print_error("Could not read /proc/diskstats!");
+        return;
+    }
+    if (!live_screen_init(&screen)) {
+        print_error("Not enough memory for the disk I/O view!");
+        return;
+    }
+
+    terminal_set_raw(true);
+    render_disk_frame(&screen, &table, interval_ms);
+    live_screen_flush(&screen);
+
+    long long next_tick = monotonic_ms() + interval_ms;
+    while (wait_for_key((int)(next_tick - monotonic_ms())) < 0) {
+        long long now = monotonic_ms();
+        if (now < next_tick) {
+            continue;
+        }
+        next_tick += interval_ms;
+        if (next_tick <= now) {
+            next_tick = now + interval_ms;
+        }
+
+        disk_table_refresh(&table);
+        render_disk_frame(&screen, &table, interval_ms);
+        live_screen_flush(&screen);
+    }
+
+    terminal_set_raw(false);
+    printf("%s\033[H\033[2J", COLOR_RESET);
+    fflush(stdout);
+    live_screen_free(&screen);
+#endif
+}
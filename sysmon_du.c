@@ -0,0 +1,772 @@
+/**
+ * DevHelper+Portal CLI - Directory Size Analyzer
+ *
+ * A parallel `du` for drilling into a full filesystem. Directories are
+ * scanned by a pool of workers that each own a deque of pending
+ * directories and steal from one another when idle. Entries are read
+ * with getdents64 and sized with fstatat(AT_SYMLINK_NOFOLLOW); each
+ * directory is opened with openat() on its parent's fd, which stays open
+ * until the last of its subdirectories has been opened. Hardlinked
+ * files are counted once by (dev, inode). When a directory finishes, its
+ * sizes are added to every ancestor, so totals stream in while the tree
+ * can already be browsed.
+ */
+
+#define _GNU_SOURCE
+#include "devhelper.h"
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#endif
+
+#ifdef __linux__
+
+#define DU_MAX_THREADS 64
+#define DU_ARENA_CHUNK (1024 * 1024)
+#define DU_DENTS_BUFFER 65536
+#define DU_LINK_SHARDS 64
+
+typedef struct DuNode {
+    const char *name;
+    struct DuNode *parent;
+    _Atomic(struct DuNode *) first_child;   // Published by the scanning worker
+    struct DuNode *next_sibling;
+    unsigned long long self_apparent;       // The directory inode itself
+    unsigned long long self_allocated;
+    atomic_ullong apparent;                 // Subtree totals, growing during the scan
+    atomic_ullong allocated;
+    atomic_ullong files;
+    atomic_ullong dirs;
+    atomic_ullong own_allocated;            // Regular files directly inside
+    atomic_ullong own_apparent;
+    atomic_ullong own_files;
+    atomic_bool error;
+    int fd;                                 // Open while subdirectories still need it
+    atomic_int fd_users;                    // The scan itself plus unopened subdirectories
+} DuNode;
+
+typedef struct DuChunk {
+    struct DuChunk *next;
+    size_t used;
+    char data[];
+} DuChunk;
+
+// Ring buffer deque: the owner works at the tail, thieves take the head
+typedef struct {
+    pthread_mutex_t lock;
+    DuNode **items;
+    size_t head;
+    size_t count;
+    size_t capacity;
+} DuDeque;
+
+typedef struct {
+    pthread_mutex_t lock;
+    unsigned long long *keys;   // (dev, ino) pairs, 0/0 = empty
+    size_t count;
+    size_t capacity;
+} DuLinkShard;
+
+struct DuScan;
+
+typedef struct {
+    struct DuScan *scan;
+    int id;
+    pthread_t thread;
+    bool started;
+    DuDeque deque;
+    DuChunk *chunks;
+    unsigned int seed;
+    char *dents;
+} DuWorker;
+
+typedef struct DuScan {
+    DuWorker workers[DU_MAX_THREADS];
+    int count;
+    DuNode *root;
+    dev_t root_dev;
+    atomic_long pending;        // Directories queued or being scanned
+    atomic_bool cancel;
+    atomic_int running;
+    atomic_ullong errors;
+    DuLinkShard links[DU_LINK_SHARDS];
+    struct rlimit saved_nofile;
+    bool nofile_raised;
+} DuScan;
+
+/* ------------------------------------------------------------------ */
+/* Per-worker arena                                                    */
+/* ------------------------------------------------------------------ */
+
+static void *arena_alloc(DuWorker *worker, size_t size) {
+    size = (size + 15) & ~(size_t)15;
+    DuChunk *chunk = worker->chunks;
+
+    if (chunk == NULL || chunk->used + size > DU_ARENA_CHUNK) {
+        chunk = malloc(sizeof(DuChunk) + DU_ARENA_CHUNK);
+        if (chunk == NULL) {
+            return NULL;
+        }
+        chunk->next = worker->chunks;
+        chunk->used = 0;
+        worker->chunks = chunk;
+    }
+    void *ptr = chunk->data + chunk->used;
+    chunk->used += size;
+    return ptr;
+}
+
+static DuNode *new_node(DuWorker *worker, DuNode *parent, const char *name, const struct stat *st) {
+    size_t len = strlen(name);
+    DuNode *node = arena_alloc(worker, sizeof(DuNode) + len + 1);
+
+    if (node == NULL) {
+        return NULL;
+    }
+    memset(node, 0, sizeof(*node));
+    char *copy = (char *)(node + 1);
+    memcpy(copy, name, len + 1);
+    node->name = copy;
+    node->parent = parent;
+    node->self_apparent = (unsigned long long)st->st_size;
+    node->self_allocated = (unsigned long long)st->st_blocks * 512ULL;
+    return node;
+}
+
+/* ------------------------------------------------------------------ */
+/* Work-stealing deques                                                */
+/* ------------------------------------------------------------------ */
+
+static bool deque_push(DuDeque *dq, DuNode *node) {
+    pthread_mutex_lock(&dq->lock);
+    if (dq->count == dq->capacity) {
+        size_t capacity = dq->capacity > 0 ? dq->capacity * 2 : 256;
+        DuNode **items = malloc(capacity * sizeof(DuNode *));
+        if (items == NULL) {
+            pthread_mutex_unlock(&dq->lock);
+            return false;
+        }
+        for (size_t i = 0; i < dq->count; i++) {
+            items[i] = dq->items[(dq->head + i) % dq->capacity];
+        }
+        free(dq->items);
+        dq->items = items;
+        dq->head = 0;
+        dq->capacity = capacity;
+    }
+    dq->items[(dq->head + dq->count) % dq->capacity] = node;
+    dq->count++;
+    pthread_mutex_unlock(&dq->lock);
+    return true;
+}
+
+/**
+ * Owner pops the newest directory (depth first, warm caches); thieves
+ * steal the oldest, which tends to be the biggest remaining subtree
+ */
+static DuNode *deque_take(DuDeque *dq, bool steal) {
+    DuNode *node = NULL;
+
+    pthread_mutex_lock(&dq->lock);
+    if (dq->count > 0) {
+        if (steal) {
+            node = dq->items[dq->head];
+            dq->head = (dq->head + 1) % dq->capacity;
+        } else {
+            node = dq->items[(dq->head + dq->count - 1) % dq->capacity];
+        }
+        dq->count--;
+    }
+    pthread_mutex_unlock(&dq->lock);
+    return node;
+}
+
+/* ------------------------------------------------------------------ */
+/* Hardlink set                                                        */
+/* ------------------------------------------------------------------ */
+
+/**
+ * Remember a multiply-linked inode. Returns true the first time it is seen.
+ */
+static bool link_first_seen(DuScan *scan, dev_t dev, ino_t ino) {
+    unsigned long long key_dev = (unsigned long long)dev + 1;  // Never 0, so 0/0 marks empty
+    unsigned long long key_ino = (unsigned long long)ino;
+    unsigned long long hash = (key_ino * 0x9E3779B97F4A7C15ULL) ^ (key_dev * 0xC2B2AE3D27D4EB4FULL);
+    DuLinkShard *shard = &scan->links[hash % DU_LINK_SHARDS];
+    bool inserted = false;
+
+    pthread_mutex_lock(&shard->lock);
+    if ((shard->count + 1) * 2 > shard->capacity) {
+        size_t capacity = shard->capacity > 0 ? shard->capacity * 2 : 1024;
+        unsigned long long *keys = calloc(capacity * 2, sizeof(unsigned long long));
+        if (keys == NULL) {
+            pthread_mutex_unlock(&shard->lock);
+            return true;
+        }
+        for (size_t i = 0; i < shard->capacity; i++) {
+            unsigned long long d = shard->keys[2 * i], n = shard->keys[2 * i + 1];
+            if (d == 0) continue;
+            unsigned long long h = (n * 0x9E3779B97F4A7C15ULL) ^ (d * 0xC2B2AE3D27D4EB4FULL);
+            size_t slot = (h / DU_LINK_SHARDS) & (capacity - 1);
+            while (keys[2 * slot] != 0) slot = (slot + 1) & (capacity - 1);
+            keys[2 * slot] = d;
+            keys[2 * slot + 1] = n;
+        }
+        free(shard->keys);
+        shard->keys = keys;
+        shard->capacity = capacity;
+    }
+
+    size_t slot = (hash / DU_LINK_SHARDS) & (shard->capacity - 1);
+    for (;;) {
+        if (shard->keys[2 * slot] == 0) {
+            shard->keys[2 * slot] = key_dev;
+            shard->keys[2 * slot + 1] = key_ino;
+            shard->count++;
+            inserted = true;
+            break;
+        }
+        if (shard->keys[2 * slot] == key_dev && shard->keys[2 * slot + 1] == key_ino) {
+            break;
+        }
+        slot = (slot + 1) & (shard->capacity - 1);
+    }
+    pthread_mutex_unlock(&shard->lock);
+    return inserted;
+}
+
+/* ------------------------------------------------------------------ */
+/* Scanning                                                            */
+/* ------------------------------------------------------------------ */
+
+struct du_dirent64 {
+    unsigned long long d_ino;
+    long long d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[];
+};
+
+/**
+ * Rebuild a directory's path from the parent chain
+ */
+static bool node_path(const DuNode *node, char *out, size_t size) {
+    const DuNode *chain[PATH_MAX / 2];
+    int depth = 0;
+
+    for (const DuNode *n = node; n != NULL; n = n->parent) {
+        if (depth == (int)(sizeof(chain) / sizeof(chain[0]))) {
+            return false;
+        }
+        chain[depth++] = n;
+    }
+
+    size_t used = 0;
+    for (int i = depth - 1; i >= 0; i--) {
+        int n = snprintf(out + used, size - used, "%s%s",
+                         i == depth - 1 || out[used - 1] == '/' ? "" : "/", chain[i]->name);
+        if (n < 0 || (size_t)n >= size - used) {
+            return false;
+        }
+        used += (size_t)n;
+    }
+    return true;
+}
+
+/**
+ * Add a finished directory's sizes to itself and every ancestor
+ */
+static void propagate(DuNode *node, unsigned long long apparent, unsigned long long allocated,
+                      unsigned long long files) {
+    for (DuNode *n = node; n != NULL; n = n->parent) {
+        atomic_fetch_add_explicit(&n->apparent, apparent, memory_order_relaxed);
+        atomic_fetch_add_explicit(&n->allocated, allocated, memory_order_relaxed);
+        atomic_fetch_add_explicit(&n->files, files, memory_order_relaxed);
+        atomic_fetch_add_explicit(&n->dirs, 1, memory_order_relaxed);
+    }
+}
+
+/**
+ * Drop one user of a directory's fd, closing it after the last
+ */
+static void release_directory(DuNode *node) {
+    if (node != NULL && atomic_fetch_sub(&node->fd_users, 1) == 1 && node->fd >= 0) {
+        close(node->fd);
+        node->fd = -1;
+    }
+}
+
+static void scan_directory(DuWorker *worker, DuNode *node) {
+    DuScan *scan = worker->scan;
+    unsigned long long apparent = 0, allocated = 0, files = 0;
+    const int flags = O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC;
+
+    int fd = node->parent != NULL ? openat(node->parent->fd, node->name, flags) : open(node->name, flags);
+    release_directory(node->parent);
+    node->fd = fd;
+    atomic_store(&node->fd_users, 1);
+    if (fd < 0) {
+        atomic_store(&node->error, true);
+        atomic_fetch_add(&scan->errors, 1);
+    }
+
+    while (fd >= 0 && !atomic_load_explicit(&scan->cancel, memory_order_relaxed)) {
+        long n = syscall(SYS_getdents64, fd, worker->dents, DU_DENTS_BUFFER);
+        if (n <= 0) {
+            break;
+        }
+        for (long off = 0; off < n; ) {
+            struct du_dirent64 *d = (struct du_dirent64 *)(worker->dents + off);
+            off += d->d_reclen;
+
+            const char *name = d->d_name;
+            if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) {
+                continue;
+            }
+
+            struct stat st;
+            if (fstatat(fd, name, &st, AT_SYMLINK_NOFOLLOW) != 0) {
+                atomic_fetch_add(&scan->errors, 1);
+                continue;
+            }
+
+            if (S_ISDIR(st.st_mode)) {
+                // Stay on one filesystem, like du -x
+                if (st.st_dev != scan->root_dev) {
+                    continue;
+                }
+                DuNode *child = new_node(worker, node, name, &st);
+                if (child == NULL) {
+                    atomic_fetch_add(&scan->errors, 1);
+                    continue;
+                }
+                child->next_sibling = atomic_load_explicit(&node->first_child, memory_order_relaxed);
+                atomic_store_explicit(&node->first_child, child, memory_order_release);
+
+                atomic_fetch_add(&scan->pending, 1);
+                atomic_fetch_add(&node->fd_users, 1);
+                if (!deque_push(&worker->deque, child)) {
+                    atomic_fetch_sub(&scan->pending, 1);
+                    atomic_fetch_add(&scan->errors, 1);
+                    release_directory(node);
+                }
+                continue;
+            }
+
+            if (st.st_nlink > 1 && !link_first_seen(scan, st.st_dev, st.st_ino)) {
+                continue;
+            }
+            apparent += (unsigned long long)st.st_size;
+            allocated += (unsigned long long)st.st_blocks * 512ULL;
+            files++;
+        }
+    }
+    release_directory(node);
+
+    atomic_store_explicit(&node->own_apparent, apparent, memory_order_relaxed);
+    atomic_store_explicit(&node->own_allocated, allocated, memory_order_relaxed);
+    atomic_store_explicit(&node->own_files, files, memory_order_relaxed);
+    propagate(node, apparent + node->self_apparent, allocated + node->self_allocated, files);
+}
+
+static void *du_worker_main(void *arg) {
+    DuWorker *worker = arg;
+    DuScan *scan = worker->scan;
+    int idle_spins = 0;
+
+    while (atomic_load(&scan->pending) > 0) {
+        DuNode *node = deque_take(&worker->deque, false);
+
+        // Out of local work: try to steal from a random victim
+        for (int attempt = 0; node == NULL && attempt < scan->count; attempt++) {
+            int victim = (int)(rand_r(&worker->seed) % (unsigned int)scan->count);
+            if (victim != worker->id) {
+                node = deque_take(&scan->workers[victim].deque, true);
+            }
+        }
+
+        if (node == NULL) {
+            struct timespec pause = { 0, idle_spins < 100 ? 20000 : 1000000 };
+            idle_spins++;
+            nanosleep(&pause, NULL);
+            continue;
+        }
+        idle_spins = 0;
+
+        if (!atomic_load_explicit(&scan->cancel, memory_order_relaxed)) {
+            scan_directory(worker, node);
+        } else {
+            release_directory(node->parent);
+        }
+        atomic_fetch_sub(&scan->pending, 1);
+    }
+
+    atomic_fetch_sub(&scan->running, 1);
+    return NULL;
+}
+
+static DuScan *du_scan_start(const char *path, int threads) {
+    struct stat st;
+
+    if (stat(path, &st) != 0 || !S_ISDIR(st.st_mode)) {
+        return NULL;
+    }
+    DuScan *scan = calloc(1, sizeof(DuScan));
+    if (scan == NULL) {
+        return NULL;
+    }
+    scan->count = threads;
+    scan->root_dev = st.st_dev;
+
+    // A directory's fd stays open while its subdirectories wait in the
+    // deques, so deep trees on many threads can need more than 1024
+    struct rlimit nofile;
+    if (getrlimit(RLIMIT_NOFILE, &scan->saved_nofile) == 0 &&
+        scan->saved_nofile.rlim_cur < scan->saved_nofile.rlim_max) {
+        nofile = scan->saved_nofile;
+        nofile.rlim_cur = nofile.rlim_max;
+        scan->nofile_raised = setrlimit(RLIMIT_NOFILE, &nofile) == 0;
+    }
+    for (int i = 0; i < DU_LINK_SHARDS; i++) {
+        pthread_mutex_init(&scan->links[i].lock, NULL);
+    }
+
+    for (int i = 0; i < threads; i++) {
+        DuWorker *worker = &scan->workers[i];
+        worker->scan = scan;
+        worker->id = i;
+        worker->seed = (unsigned int)(i * 2654435761u + 1);
+        pthread_mutex_init(&worker->deque.lock, NULL);
+        worker->dents = malloc(DU_DENTS_BUFFER);
+    }
+
+    // Strip trailing slashes so child paths join cleanly, but keep "/"
+    char root_name[PATH_MAX];
+    snprintf(root_name, sizeof(root_name), "%s", path);
+    for (size_t len = strlen(root_name); len > 1 && root_name[len - 1] == '/'; len--) {
+        root_name[len - 1] = '\0';
+    }
+    scan->root = new_node(&scan->workers[0], NULL, root_name, &st);
+    if (scan->root == NULL) {
+        return scan;
+    }
+
+    atomic_store(&scan->pending, 1);
+    deque_push(&scan->workers[0].deque, scan->root);
+    for (int i = 0; i < threads; i++) {
+        if (scan->workers[i].dents == NULL) {
+            continue;
+        }
+        atomic_fetch_add(&scan->running, 1);
+        scan->workers[i].started =
+            pthread_create(&scan->workers[i].thread, NULL, du_worker_main, &scan->workers[i]) == 0;
+        if (!scan->workers[i].started) {
+            atomic_fetch_sub(&scan->running, 1);
+        }
+    }
+    return scan;
+}
+
+static void du_scan_free(DuScan *scan) {
+    atomic_store(&scan->cancel, true);
+    for (int i = 0; i < scan->count; i++) {
+        if (scan->workers[i].started) {
+            pthread_join(scan->workers[i].thread, NULL);
+        }
+    }
+    for (int i = 0; i < scan->count; i++) {
+        DuWorker *worker = &scan->workers[i];
+        while (worker->chunks != NULL) {
+            DuChunk *next = worker->chunks->next;
+            free(worker->chunks);
+            worker->chunks = next;
+        }
+        free(worker->deque.items);
+        free(worker->dents);
+        pthread_mutex_destroy(&worker->deque.lock);
+    }
+    for (int i = 0; i < DU_LINK_SHARDS; i++) {
+        free(scan->links[i].keys);
+        pthread_mutex_destroy(&scan->links[i].lock);
+    }
+    if (scan->nofile_raised) {
+        setrlimit(RLIMIT_NOFILE, &scan->saved_nofile);
+    }
+    free(scan);
+}
+
+/* ------------------------------------------------------------------ */
+/* Browsing                                                            */
+/* ------------------------------------------------------------------ */
+
+static bool sort_apparent;
+
+static unsigned long long node_size(DuNode *node) {
+    return sort_apparent ? atomic_load_explicit(&node->apparent, memory_order_relaxed)
+                         : atomic_load_explicit(&node->allocated, memory_order_relaxed);
+}
+
+typedef struct {
+    DuNode *node;
+    unsigned long long size;    // Taken once, so the sort sees fixed keys
+} DuChild;
+
+static int compare_children(const void *a, const void *b) {
+    unsigned long long x = ((const DuChild *)a)->size;
+    unsigned long long y = ((const DuChild *)b)->size;
+    return (x < y) - (x > y);
+}
+
+/**
+ * Snapshot and sort a directory's children. Workers keep adding to the
+ * sizes while the scan runs, so each size is copied before sorting.
+ */
+static int sorted_children(DuNode *node, DuChild **out, int *capacity) {
+    int count = 0;
+
+    for (DuNode *c = atomic_load_explicit(&node->first_child, memory_order_acquire); c; c = c->next_sibling) {
+        if (count == *capacity) {
+            int grown_capacity = *capacity > 0 ? *capacity * 2 : 64;
+            DuChild *grown = realloc(*out, (size_t)grown_capacity * sizeof(DuChild));
+            if (grown == NULL) break;
+            *out = grown;
+            *capacity = grown_capacity;
+        }
+        (*out)[count].node = c;
+        (*out)[count].size = node_size(c);
+        count++;
+    }
+    qsort(*out, (size_t)count, sizeof(DuChild), compare_children);
+    return count;
+}
+
+static void size_text(unsigned long long bytes, char *out, size_t size) {
+    format_kb(bytes / 1024, out, size);
+}
+
+static void render_du_frame(LiveScreen *screen, DuScan *scan, DuNode *current, const DuChild *children,
+                            int count, int selected, int *scroll, double elapsed_s) {
+    char total[16], path[PATH_MAX], size[16];
+    unsigned long long files = atomic_load(&scan->root->files);
+    bool scanning = atomic_load(&scan->running) > 0;
+    int row = 0;
+
+    live_screen_begin(screen);
+    size_text(node_size(scan->root), total, sizeof(total));
+    live_screen_print(screen, row, 0, CELL_BOLD, "DevHelper Disk Usage");
+    live_screen_print(screen, row++, 22, scanning ? CELL_YELLOW : CELL_GREEN,
+                      "%s %s, %llu files, %.0f files/s, %d threads%s",
+                      scanning ? "scanning" : "done", total, files,
+                      elapsed_s > 0 ? (double)files / elapsed_s : 0.0, scan->count,
+                      atomic_load(&scan->errors) ? ", some unreadable" : "");
+    live_screen_print(screen, row++, 0, CELL_CYAN,
+                      "%s  [j/k] move  [enter] open  [h] up  [a] %s  [q] quit",
+                      sort_apparent ? "apparent size" : "disk usage",
+                      sort_apparent ? "disk usage" : "apparent size");
+
+    if (!node_path(current, path, sizeof(path))) {
+        snprintf(path, sizeof(path), "%s", current->name);
+    }
+    size_text(node_size(current), size, sizeof(size));
+    live_screen_print(screen, row++, 0, CELL_BOLD, "%s  %s", path, size);
+    row++;
+
+    int visible = screen->rows - row - 1;
+    if (visible < 1) return;
+    if (selected < *scroll) *scroll = selected;
+    if (selected >= *scroll + visible) *scroll = selected - visible + 1;
+
+    unsigned long long parent_size = node_size(current);
+    for (int i = *scroll; i < count && row < screen->rows - 1; i++) {
+        unsigned long long bytes = children[i].size;
+        double percent = parent_size > 0 ? 100.0 * (double)bytes / (double)parent_size : 0.0;
+        CellColor color = i == selected ? CELL_CYAN : CELL_DEFAULT;
+
+        size_text(bytes, size, sizeof(size));
+        int col = live_screen_print(screen, row, 0, color, "%s%8s %5.1f%% ",
+                                    i == selected ? ">" : " ", size, percent);
+        col += live_screen_bar(screen, row, col, 16, percent);
+        live_screen_print(screen, row, col, atomic_load(&children[i].node->error) ? CELL_RED : color,
+                          " %s/", children[i].node->name);
+        row++;
+    }
+
+    unsigned long long own = sort_apparent ? atomic_load(&current->own_apparent)
+                                           : atomic_load(&current->own_allocated);
+    size_text(own, size, sizeof(size));
+    live_screen_print(screen, row, 0, CELL_DEFAULT, " %8s        (%llu files directly in this directory)",
+                      size, (unsigned long long)atomic_load(&current->own_files));
+}
+
+/**
+ * Read a key, folding arrow key escape sequences into j/k/l/h
+ */
+static int read_nav_key(int timeout_ms) {
+    int key = wait_for_key(timeout_ms);
+
+    if (key == 27) {
+        if (wait_for_key(20) == '[') {
+            switch (wait_for_key(20)) {
+                case 'A': return 'k';
+                case 'B': return 'j';
+                case 'C': return 'l';
+                case 'D': return 'h';
+            }
+        }
+        return -1;
+    }
+    return key;
+}
+
+/**
+ * Print the largest children of the root, for non-interactive use
+ */
+static void print_du_summary(DuScan *scan, double elapsed_s) {
+    DuChild *children = NULL;
+    int capacity = 0;
+    char size[16], apparent[16];
+    int count = sorted_children(scan->root, &children, &capacity);
+
+    for (int i = 0; i < count && i < 30; i++) {
+        size_text(atomic_load(&children[i].node->allocated), size, sizeof(size));
+        size_text(atomic_load(&children[i].node->apparent), apparent, sizeof(apparent));
+        const char *root = scan->root->name;
+        printf("%8s  %8s  %s%s%s\n", size, apparent, root,
+               root[strlen(root) - 1] == '/' ? "" : "/", children[i].node->name);
+    }
+    size_text(atomic_load(&scan->root->allocated), size, sizeof(size));
+    size_text(atomic_load(&scan->root->apparent), apparent, sizeof(apparent));
+    printf("%s%8s  %8s  %s (disk usage, apparent)%s\n", COLOR_BOLD, size, apparent,
+           scan->root->name, COLOR_RESET);
+    printf("%llu files, %llu directories in %.2f s with %d threads%s\n",
+           (unsigned long long)atomic_load(&scan->root->files),
+           (unsigned long long)atomic_load(&scan->root->dirs), elapsed_s, scan->count,
+           atomic_load(&scan->errors) ? " (some entries were unreadable)" : "");
+    free(children);
+}
+
+#endif
+
+/**
+ * Scan a directory tree in parallel and browse sizes while totals stream
+ * in. threads <= 0 picks a default from the CPU count.
+ */
+void sysmon_du_view(const char *path, int threads) {
+#ifndef __linux__
+    (void)path;
+    (void)threads;
+    print_warning("The directory size analyzer is only available on Linux.");
+#else
+    if (threads <= 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        // Scanning waits on metadata I/O, so use more threads than cores
+        threads = cpus > 0 ? (int)cpus * 2 : 4;
+        if (threads < 4) threads = 4;
+    }
+    if (threads > DU_MAX_THREADS) threads = DU_MAX_THREADS;
+
+    long long start = monotonic_ms();
+    DuScan *scan = du_scan_start(path, threads);
+    if (scan == NULL || scan->root == NULL) {
+        print_error("Not a readable directory!");
+        if (scan) du_scan_free(scan);
+        return;
+    }
+
+    if (!isatty(STDIN_FILENO) || !isatty(STDOUT_FILENO)) {
+        while (atomic_load(&scan->running) > 0) {
+            usleep(10000);
+        }
+        print_du_summary(scan, (double)(monotonic_ms() - start) / 1000.0);
+        du_scan_free(scan);
+        return;
+    }
+
+    LiveScreen screen;
+    if (!live_screen_init(&screen)) {
+        print_error("Not enough memory for the disk usage view!");
+        du_scan_free(scan);
+        return;
+    }
+
+    DuNode *current = scan->root;
+    DuNode *selected_node = NULL;
+    DuChild *children = NULL;
+    int capacity = 0, selected = 0, scroll = 0;
+    long long finished_ms = 0;
+    bool quit = false;
+
+    terminal_set_raw(true);
+    while (!quit) {
+        int count = sorted_children(current, &children, &capacity);
+
+        // Keep the selection on the same directory as sizes reorder
+        selected = 0;
+        for (int i = 0; i < count; i++) {
+            if (children[i].node == selected_node) {
+                selected = i;
+                break;
+            }
+        }
+        selected_node = count > 0 ? children[selected].node : NULL;
+
+        bool scanning = atomic_load(&scan->running) > 0;
+        if (!scanning && finished_ms == 0) {
+            finished_ms = monotonic_ms();
+        }
+        double elapsed = (double)((finished_ms ? finished_ms : monotonic_ms()) - start) / 1000.0;
+        render_du_frame(&screen, scan, current, children, count, selected, &scroll, elapsed);
+        live_screen_flush(&screen);
+
+        int key = read_nav_key(scanning ? 250 : 1000);
+        switch (key) {
+            case -1:
+                break;
+            case 'j':
+                if (selected + 1 < count) selected_node = children[selected + 1].node;
+                break;
+            case 'k':
+                if (selected > 0) selected_node = children[selected - 1].node;
+                break;
+            case 'l':
+            case '\r':
+            case '\n':
+                if (selected_node != NULL) {
+                    current = selected_node;
+                    selected_node = NULL;
+                    scroll = 0;
+                }
+                break;
+            case 'h':
+            case 127:
+            case '\b':
+                if (current->parent != NULL) {
+                    selected_node = current;
+                    current = current->parent;
+                    scroll = 0;
+                }
+                break;
+            case 'a':
+                sort_apparent = !sort_apparent;
+                break;
+            default:
+                quit = key == 'q' || key == 0 || key == 3;
+                break;
+        }
+    }
+
+    terminal_set_raw(false);
+    printf("%s\033[H\033[2J", COLOR_RESET);
+    fflush(stdout);
+    free(children);
+    live_screen_free(&screen);
+    du_scan_free(scan);
+#endif
+}
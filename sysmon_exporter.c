@@ -0,0 +1,894 @@
+/**
+ * DevHelper+Portal CLI - OpenMetrics Exporter
+ *
+ * Serves CPU, memory, load, disk, network, PSI and cgroup metrics over
+ * HTTP in the OpenMetrics text format, for a local Prometheus to scrape
+ * at /metrics. The server is a single epoll loop with keep-alive
+ * connections; it listens on 127.0.0.1 unless told otherwise.
+ *
+ * Metrics are read from /proc on each scrape, or, with a staleness
+ * setting, by a background thread that re-samples on that period. Text
+ * is rendered into buffers that are kept between scrapes, so with the
+ * background sampler a scrape is little more than one sendmsg().
+ */
+
+#define _GNU_SOURCE
+#include "devhelper.h"
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <time.h>
+
+#ifdef __linux__
+#include <errno.h>
+#include <netdb.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#endif
+
+#define EXPORTER_DEFAULT_PORT "9373"
+#define EXPORTER_MAX_CONNECTIONS 64
+#define EXPORTER_REQUEST_MAX 4096
+#define EXPORTER_IDLE_MS 120000     // Longer than any sane scrape interval
+
+#ifdef __linux__
+
+#define OPENMETRICS_TYPE "application/openmetrics-text; version=1.0.0; charset=utf-8"
+
+/* ------------------------------------------------------------------ */
+/* Rendering                                                           */
+/* ------------------------------------------------------------------ */
+
+typedef struct {
+    char *data;
+    size_t len;
+    size_t capacity;
+    bool failed;                // An allocation failed; the text is cut short
+} TextBuffer;
+
+static void text_printf(TextBuffer *text, const char *fmt, ...) {
+    for (;;) {
+        size_t room = text->capacity - text->len;
+        va_list args;
+        va_start(args, fmt);
+        int n = text->data ? vsnprintf(text->data + text->len, room, fmt, args) : -1;
+        va_end(args);
+        if (n >= 0 && (size_t)n < room) {
+            text->len += (size_t)n;
+            return;
+        }
+
+        size_t capacity = text->capacity ? text->capacity * 2 : 16384;
+        while (n >= 0 && capacity - text->len <= (size_t)n) capacity *= 2;
+        char *grown = realloc(text->data, capacity);
+        if (grown == NULL) {
+            text->failed = true;
+            return;
+        }
+        text->data = grown;
+        text->capacity = capacity;
+    }
+}
+
+/**
+ * Label values may only carry \, " and newline escaped
+ */
+static void text_label(TextBuffer *text, const char *value) {
+    if (strpbrk(value, "\\\"\n") == NULL) {
+        text_printf(text, "%s", value);
+        return;
+    }
+    for (const char *p = value; *p; p++) {
+        if (*p == '\\' || *p == '"') {
+            text_printf(text, "\\%c", *p);
+        } else if (*p == '\n') {
+            text_printf(text, "\\n");
+        } else {
+            text_printf(text, "%c", *p);
+        }
+    }
+}
+
+/**
+ * Family metadata. A unit, when given, must also end the family name.
+ */
+static void family(TextBuffer *text, const char *name, const char *type, const char *unit, const char *help) {
+    text_printf(text, "# TYPE %s %s\n", name, type);
+    if (unit != NULL) {
+        text_printf(text, "# UNIT %s %s\n", name, unit);
+    }
+    text_printf(text, "# HELP %s %s\n", name, help);
+}
+
+typedef struct {
+    CpuSnapshot cpu;
+    MemorySnapshot mem;
+    LoadSnapshot load;
+    DiskTable disks;
+    NetTable net;
+    PsiSnapshot psi;
+    CgroupSnapshot cgroup;
+    double clock_ticks;
+} ExporterSampler;
+
+// Counter columns of /proc/diskstats, with their scale to the unit
+static const struct {
+    const char *name;
+    const char *unit;
+    const char *help;
+    size_t offset;
+    double scale;
+} disk_counters[] = {
+    { "devhelper_disk_reads_completed", NULL, "Reads completed.", offsetof(DiskCounters, reads), 1 },
+    { "devhelper_disk_read_bytes", "bytes", "Bytes read.", offsetof(DiskCounters, read_sectors), 512 },
+    { "devhelper_disk_read_time_seconds", "seconds", "Time spent on reads.",
+      offsetof(DiskCounters, read_ms), 0.001 },
+    { "devhelper_disk_writes_completed", NULL, "Writes completed.", offsetof(DiskCounters, writes), 1 },
+    { "devhelper_disk_written_bytes", "bytes", "Bytes written.", offsetof(DiskCounters, write_sectors), 512 },
+    { "devhelper_disk_write_time_seconds", "seconds", "Time spent on writes.",
+      offsetof(DiskCounters, write_ms), 0.001 },
+    { "devhelper_disk_io_time_seconds", "seconds", "Time the device had I/O in flight.",
+      offsetof(DiskCounters, io_ms), 0.001 },
+    { "devhelper_disk_io_time_weighted_seconds", "seconds", "I/O time weighted by queue depth.",
+      offsetof(DiskCounters, weighted_ms), 0.001 },
+};
+
+static const struct {
+    const char *name;
+    const char *unit;
+    const char *help;
+    size_t offset;
+} net_counters[] = {
+    { "devhelper_network_receive_bytes", "bytes", "Bytes received.", offsetof(NetCounters, rx_bytes) },
+    { "devhelper_network_transmit_bytes", "bytes", "Bytes sent.", offsetof(NetCounters, tx_bytes) },
+    { "devhelper_network_receive_packets", NULL, "Packets received.", offsetof(NetCounters, rx_packets) },
+    { "devhelper_network_transmit_packets", NULL, "Packets sent.", offsetof(NetCounters, tx_packets) },
+    { "devhelper_network_receive_errors", NULL, "Receive errors.", offsetof(NetCounters, rx_errors) },
+    { "devhelper_network_transmit_errors", NULL, "Transmit errors.", offsetof(NetCounters, tx_errors) },
+    { "devhelper_network_receive_drops", NULL, "Received packets dropped.", offsetof(NetCounters, rx_drops) },
+    { "devhelper_network_transmit_drops", NULL, "Outgoing packets dropped.", offsetof(NetCounters, tx_drops) },
+};
+
+static void render_cpu(TextBuffer *text, const ExporterSampler *s) {
+    static const char *modes[] = { "user", "nice", "system", "idle", "iowait", "irq", "softirq", "steal" };
+
+    family(text, "devhelper_cpu_seconds", "counter", "seconds", "Time each CPU spent in each mode.");
+    for (int c = 0; c < s->cpu.cpu_count; c++) {
+        const CpuTimes *t = &s->cpu.cpu[c];
+        if (cpu_times_total(t) == 0) {
+            continue;       // Offline: not listed in this read of /proc/stat
+        }
+        const unsigned long long ticks[] = {
+            t->user, t->nice, t->system, t->idle, t->iowait, t->irq, t->softirq, t->steal
+        };
+        for (int m = 0; m < 8; m++) {
+            text_printf(text, "devhelper_cpu_seconds_total{cpu=\"%d\",mode=\"%s\"} %.2f\n",
+                        c, modes[m], (double)ticks[m] / s->clock_ticks);
+        }
+    }
+    family(text, "devhelper_context_switches", "counter", NULL, "Context switches on all CPUs.");
+    text_printf(text, "devhelper_context_switches_total %llu\n", s->cpu.context_switches);
+    family(text, "devhelper_procs_running", "gauge", NULL, "Runnable tasks.");
+    text_printf(text, "devhelper_procs_running %d\n", s->cpu.procs_running);
+    family(text, "devhelper_load_average", "gauge", NULL, "Run-queue load average.");
+    text_printf(text, "devhelper_load_average{period=\"1m\"} %.2f\n", s->load.load1);
+    text_printf(text, "devhelper_load_average{period=\"5m\"} %.2f\n", s->load.load5);
+    text_printf(text, "devhelper_load_average{period=\"15m\"} %.2f\n", s->load.load15);
+}
+
+static void render_memory(TextBuffer *text, const ExporterSampler *s) {
+    const struct { const char *state; unsigned long long kb; } rows[] = {
+        { "total", s->mem.total_kb }, { "free", s->mem.free_kb },
+        { "available", s->mem.available_kb }, { "buffers", s->mem.buffers_kb },
+        { "cached", s->mem.cached_kb }, { "swap_total", s->mem.swap_total_kb },
+        { "swap_free", s->mem.swap_free_kb }
+    };
+
+    family(text, "devhelper_memory_bytes", "gauge", "bytes", "Memory by state, from /proc/meminfo.");
+    for (size_t i = 0; i < sizeof(rows) / sizeof(rows[0]); i++) {
+        text_printf(text, "devhelper_memory_bytes{state=\"%s\"} %llu\n", rows[i].state, rows[i].kb * 1024);
+    }
+}
+
+static void render_disks(TextBuffer *text, const ExporterSampler *s) {
+    const DiskTable *disks = &s->disks;
+
+    // Devices never used since boot (unused loop/ram) are left out
+    for (size_t k = 0; k < sizeof(disk_counters) / sizeof(disk_counters[0]); k++) {
+        family(text, disk_counters[k].name, "counter", disk_counters[k].unit, disk_counters[k].help);
+        for (int i = 0; i < disks->count; i++) {
+            const DiskDevice *dev = &disks->devices[i];
+            if (!dev->present || dev->counters.reads + dev->counters.writes == 0) {
+                continue;
+            }
+            unsigned long long value = *(const unsigned long long *)((const char *)&dev->counters +
+                                                                    disk_counters[k].offset);
+            text_printf(text, "%s_total{device=\"", disk_counters[k].name);
+            text_label(text, dev->name);
+            if (disk_counters[k].scale >= 1.0) {
+                text_printf(text, "\"} %llu\n", value * (unsigned long long)disk_counters[k].scale);
+            } else {
+                text_printf(text, "\"} %.3f\n", (double)value * disk_counters[k].scale);
+            }
+        }
+    }
+    family(text, "devhelper_disk_io_now", "gauge", NULL, "I/Os currently in flight.");
+    for (int i = 0; i < disks->count; i++) {
+        const DiskDevice *dev = &disks->devices[i];
+        if (dev->present && dev->counters.reads + dev->counters.writes > 0) {
+            text_printf(text, "devhelper_disk_io_now{device=\"");
+            text_label(text, dev->name);
+            text_printf(text, "\"} %llu\n", dev->counters.in_flight);
+        }
+    }
+}
+
+static void render_network(TextBuffer *text, const ExporterSampler *s) {
+    for (size_t k = 0; k < sizeof(net_counters) / sizeof(net_counters[0]); k++) {
+        family(text, net_counters[k].name, "counter", net_counters[k].unit, net_counters[k].help);
+        for (int i = 0; i < s->net.count; i++) {
+            const NetInterface *iface = &s->net.ifaces[i];
+            if (!iface->present) {
+                continue;
+            }
+            text_printf(text, "%s_total{device=\"", net_counters[k].name);
+            text_label(text, iface->name);
+            text_printf(text, "\"} %llu\n",
+                        *(const unsigned long long *)((const char *)&iface->counters + net_counters[k].offset));
+        }
+    }
+}
+
+static void render_pressure(TextBuffer *text, const ExporterSampler *s) {
+    static const char *resources[PSI_RESOURCE_COUNT] = { "cpu", "memory", "io" };
+
+    if (!s->psi.has_host && !s->psi.has_cgroup) {
+        return;
+    }
+    family(text, "devhelper_pressure_stalled_seconds", "counter", "seconds",
+           "Wall time with some or all non-idle tasks stalled on a resource (PSI).");
+    for (int scope = 0; scope < 2; scope++) {
+        bool present = scope == 0 ? s->psi.has_host : s->psi.has_cgroup;
+        const PsiResource *res = scope == 0 ? s->psi.host : s->psi.cgroup;
+        for (int r = 0; present && r < PSI_RESOURCE_COUNT; r++) {
+            const PsiLine *lines[2] = { &res[r].some, &res[r].full };
+            for (int l = 0; l < 2; l++) {
+                if (lines[l]->valid) {
+                    text_printf(text,
+                                "devhelper_pressure_stalled_seconds_total{scope=\"%s\",resource=\"%s\",kind=\"%s\"} %.6f\n",
+                                scope == 0 ? "host" : "cgroup", resources[r], l == 0 ? "some" : "full",
+                                (double)lines[l]->total_usec / 1e6);
+                }
+            }
+        }
+    }
+}
+
+static void render_cgroup(TextBuffer *text, const ExporterSampler *s) {
+    const CgroupSnapshot *cg = &s->cgroup;
+
+    if (cg->version == 0) {
+        return;
+    }
+    family(text, "devhelper_cgroup", "info", NULL, "The cgroup this exporter runs in.");
+    text_printf(text, "devhelper_cgroup_info{version=\"%d\",path=\"", cg->version);
+    text_label(text, cg->path);
+    text_printf(text, "\"} 1\n");
+
+    if (cg->has_cpu) {
+        family(text, "devhelper_cgroup_cpu_usage_seconds", "counter", "seconds", "CPU time used by the cgroup.");
+        text_printf(text, "devhelper_cgroup_cpu_usage_seconds_total %.6f\n", (double)cg->cpu_usage_usec / 1e6);
+        family(text, "devhelper_cgroup_cpu_periods", "counter", NULL, "Enforcement periods elapsed.");
+        text_printf(text, "devhelper_cgroup_cpu_periods_total %llu\n", cg->nr_periods);
+        family(text, "devhelper_cgroup_cpu_throttled_periods", "counter", NULL, "Periods the quota ran out in.");
+        text_printf(text, "devhelper_cgroup_cpu_throttled_periods_total %llu\n", cg->nr_throttled);
+        family(text, "devhelper_cgroup_cpu_throttled_seconds", "counter", "seconds", "Time spent throttled.");
+        text_printf(text, "devhelper_cgroup_cpu_throttled_seconds_total %.6f\n", (double)cg->throttled_usec / 1e6);
+        if (cg->cpu_quota_usec > 0 && cg->cpu_period_usec > 0) {
+            family(text, "devhelper_cgroup_cpu_limit_cores", "gauge", NULL, "CPU quota in cores.");
+            text_printf(text, "devhelper_cgroup_cpu_limit_cores %.3f\n",
+                        (double)cg->cpu_quota_usec / (double)cg->cpu_period_usec);
+        }
+    }
+
+    if (cg->has_memory) {
+        family(text, "devhelper_cgroup_memory_usage_bytes", "gauge", "bytes", "Memory charged to the cgroup.");
+        text_printf(text, "devhelper_cgroup_memory_usage_bytes %llu\n", cg->mem_current);
+        if (cg->mem_max > 0) {
+            family(text, "devhelper_cgroup_memory_limit_bytes", "gauge", "bytes", "Hard memory limit.");
+            text_printf(text, "devhelper_cgroup_memory_limit_bytes %llu\n", cg->mem_max);
+        }
+        family(text, "devhelper_cgroup_memory_stat_bytes", "gauge", "bytes", "Charged memory by type.");
+        const struct { const char *type; unsigned long long bytes; } rows[] = {
+            { "anon", cg->mem_anon }, { "file", cg->mem_file }, { "kernel", cg->mem_kernel },
+            { "shmem", cg->mem_shmem }, { "sock", cg->mem_sock }, { "swap", cg->swap_current }
+        };
+        for (size_t i = 0; i < sizeof(rows) / sizeof(rows[0]); i++) {
+            text_printf(text, "devhelper_cgroup_memory_stat_bytes{type=\"%s\"} %llu\n", rows[i].type, rows[i].bytes);
+        }
+        family(text, "devhelper_cgroup_oom_kills", "counter", NULL, "Processes killed by the cgroup OOM killer.");
+        text_printf(text, "devhelper_cgroup_oom_kills_total %llu\n", cg->events_oom_kill);
+    }
+
+    if (cg->has_io) {
+        family(text, "devhelper_cgroup_io_read_bytes", "counter", "bytes", "Bytes read by the cgroup.");
+        text_printf(text, "devhelper_cgroup_io_read_bytes_total %llu\n", cg->io_read_bytes);
+        family(text, "devhelper_cgroup_io_written_bytes", "counter", "bytes", "Bytes written by the cgroup.");
+        text_printf(text, "devhelper_cgroup_io_written_bytes_total %llu\n", cg->io_write_bytes);
+    }
+}
+
+/**
+ * Read every source and render the whole exposition into `text`
+ */
+static void sample_and_render(ExporterSampler *s, TextBuffer *text) {
+    struct timespec wall, t0, t1;
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    // Only CPUs listed in /proc/stat are filled in, so clear what an
+    // earlier scrape left for CPUs that have since gone offline
+    memset(s->cpu.cpu, 0, sizeof(s->cpu.cpu));
+    bool has_cpu = sysmon_read_cpu(&s->cpu);
+    bool has_mem = sysmon_read_memory(&s->mem);
+    sysmon_read_load(&s->load);
+    bool has_disks = disk_table_refresh(&s->disks);
+    bool has_net = net_table_refresh(&s->net);
+    psi_read(&s->psi);
+    cgroup_read(&s->cgroup);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    clock_gettime(CLOCK_REALTIME, &wall);
+
+    text->len = 0;
+    text->failed = false;
+    if (has_cpu) render_cpu(text, s);
+    if (has_mem) render_memory(text, s);
+    if (has_disks) render_disks(text, s);
+    if (has_net) render_network(text, s);
+    render_pressure(text, s);
+    render_cgroup(text, s);
+
+    family(text, "devhelper_exporter_sample_timestamp_seconds", "gauge", "seconds",
+           "When these values were read (Unix time).");
+    text_printf(text, "devhelper_exporter_sample_timestamp_seconds %lld.%03ld\n",
+                (long long)wall.tv_sec, wall.tv_nsec / 1000000);
+    family(text, "devhelper_exporter_collect_seconds", "gauge", "seconds", "Time taken to read all sources.");
+    text_printf(text, "devhelper_exporter_collect_seconds %.6f\n",
+                (double)(t1.tv_sec - t0.tv_sec) + (double)(t1.tv_nsec - t0.tv_nsec) / 1e9);
+    text_printf(text, "# EOF\n");
+}
+
+/* ------------------------------------------------------------------ */
+/* HTTP server                                                         */
+/* ------------------------------------------------------------------ */
+
+// epoll tags: the listener, stdin, then connection slots
+#define TAG_LISTEN 0
+#define TAG_STDIN 1
+#define TAG_CONN 2
+
+typedef struct {
+    int fd;                     // -1 when the slot is free
+    char in[EXPORTER_REQUEST_MAX];
+    size_t in_len;
+    char *out;                  // Unsent tail of a response the socket had no room for
+    size_t out_len;
+    size_t out_off;
+    bool close_after;
+    long long last_ms;
+} ExporterConn;
+
+typedef struct {
+    int epoll_fd;
+    ExporterConn conns[EXPORTER_MAX_CONNECTIONS];
+    int conn_count;
+    ExporterSampler sampler;
+    TextBuffer text[2];         // The sampler thread renders into the one not in front
+    int front;
+    int staleness_ms;           // 0 = sample on every scrape
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    bool stopping;
+    unsigned long scrapes;
+    double last_scrape_us;
+} Exporter;
+
+static volatile sig_atomic_t exporter_interrupted = 0;
+
+static void exporter_signal_handler(int sig) {
+    (void)sig;
+    exporter_interrupted = 1;
+}
+
+/**
+ * Re-sample every staleness_ms into the back buffer, then swap it in
+ */
+static void *sampler_thread(void *arg) {
+    Exporter *ex = arg;
+
+    pthread_mutex_lock(&ex->lock);
+    while (!ex->stopping) {
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += ex->staleness_ms / 1000;
+        deadline.tv_nsec += (long)(ex->staleness_ms % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+        while (!ex->stopping && pthread_cond_timedwait(&ex->wake, &ex->lock, &deadline) != ETIMEDOUT) {
+            // Spurious wakeup; keep waiting for the deadline
+        }
+        if (ex->stopping) {
+            break;
+        }
+
+        int back = 1 - ex->front;
+        pthread_mutex_unlock(&ex->lock);
+        sample_and_render(&ex->sampler, &ex->text[back]);
+        pthread_mutex_lock(&ex->lock);
+        ex->front = back;
+    }
+    pthread_mutex_unlock(&ex->lock);
+    return NULL;
+}
+
+/**
+ * Listen on "port", "host:port" or "[v6]:port"; 127.0.0.1 when no host
+ * is given, all addresses for "*:port"
+ */
+static int exporter_listen(const char *spec, char *label, size_t label_size) {
+    char host[256] = "127.0.0.1";
+    const char *port = EXPORTER_DEFAULT_PORT;
+    int one = 1;
+
+    if (spec != NULL && spec[0] != '\0') {
+        const char *colon = strrchr(spec, ':');
+        if (colon == NULL) {
+            port = spec;
+        } else {
+            const char *start = spec[0] == '[' ? spec + 1 : spec;
+            size_t n = (size_t)(colon - start);
+            if (n > 0 && start[n - 1] == ']') n--;
+            if (n >= sizeof(host)) {
+                return -1;
+            }
+            memcpy(host, start, n);
+            host[n] = '\0';
+            port = colon + 1;
+        }
+    }
+    bool wildcard = host[0] == '\0' || strcmp(host, "*") == 0;
+
+    struct addrinfo hints, *result;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+    if (getaddrinfo(wildcard ? NULL : host, port, &hints, &result) != 0) {
+        return -1;
+    }
+    int fd = socket(result->ai_family, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    if (fd >= 0) {
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        if (bind(fd, result->ai_addr, result->ai_addrlen) < 0 || listen(fd, 128) < 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(result);
+
+    bool v6 = strchr(host, ':') != NULL;
+    snprintf(label, label_size, "http://%s%s%s:%s/metrics", v6 ? "[" : "", wildcard ? "*" : host,
+             v6 ? "]" : "", port);
+    return fd;
+}
+
+static void conn_watch(Exporter *ex, ExporterConn *conn, bool writing) {
+    struct epoll_event ev;
+
+    ev.events = writing ? EPOLLOUT : EPOLLIN;
+    ev.data.u64 = TAG_CONN + (uint64_t)(conn - ex->conns);
+    epoll_ctl(ex->epoll_fd, EPOLL_CTL_MOD, conn->fd, &ev);
+}
+
+static void conn_close(Exporter *ex, ExporterConn *conn) {
+    epoll_ctl(ex->epoll_fd, EPOLL_CTL_DEL, conn->fd, NULL);
+    close(conn->fd);
+    free(conn->out);
+    conn->out = NULL;
+    conn->fd = -1;
+    ex->conn_count--;
+}
+
+/**
+ * Send a response in one sendmsg(). Whatever the socket cannot take now
+ * is copied to the connection, since the render buffer it points into
+ * may be rewritten before the socket drains.
+ */
+static bool conn_respond(Exporter *ex, ExporterConn *conn, const char *status, const char *type,
+                         const char *body, size_t body_len, bool head_only) {
+    char header[256];
+    int header_len = snprintf(header, sizeof(header),
+                              "HTTP/1.1 %s\r\nContent-Type: %s\r\nContent-Length: %zu\r\n%s\r\n",
+                              status, type, body_len, conn->close_after ? "Connection: close\r\n" : "");
+    struct iovec iov[2] = {
+        { header, (size_t)header_len },
+        { (void *)body, head_only ? 0 : body_len }
+    };
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = iov;
+    msg.msg_iovlen = 2;
+
+    size_t total = iov[0].iov_len + iov[1].iov_len;
+    ssize_t sent;
+    do {
+        sent = sendmsg(conn->fd, &msg, MSG_NOSIGNAL | MSG_DONTWAIT);
+    } while (sent < 0 && errno == EINTR);
+    if (sent < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+        return false;
+    }
+    if (sent < 0) {
+        sent = 0;
+    }
+    if ((size_t)sent == total) {
+        return true;
+    }
+
+    conn->out = malloc(total - (size_t)sent);
+    if (conn->out == NULL) {
+        return false;
+    }
+    size_t skip = (size_t)sent, used = 0;
+    for (int i = 0; i < 2; i++) {
+        if (skip >= iov[i].iov_len) {
+            skip -= iov[i].iov_len;
+            continue;
+        }
+        memcpy(conn->out + used, (char *)iov[i].iov_base + skip, iov[i].iov_len - skip);
+        used += iov[i].iov_len - skip;
+        skip = 0;
+    }
+    conn->out_len = used;
+    conn->out_off = 0;
+    conn_watch(ex, conn, true);
+    return true;
+}
+
+static bool serve_metrics(Exporter *ex, ExporterConn *conn, bool head_only) {
+    struct timespec t0, t1;
+    bool ok;
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    if (ex->staleness_ms == 0) {
+        sample_and_render(&ex->sampler, &ex->text[0]);
+    } else {
+        pthread_mutex_lock(&ex->lock);
+    }
+    const TextBuffer *text = &ex->text[ex->staleness_ms == 0 ? 0 : ex->front];
+    if (text->failed) {
+        static const char failed[] = "Out of memory while rendering metrics\n";
+        ok = conn_respond(ex, conn, "500 Internal Server Error", "text/plain; charset=utf-8",
+                          failed, sizeof(failed) - 1, head_only);
+    } else {
+        ok = conn_respond(ex, conn, "200 OK", OPENMETRICS_TYPE, text->data, text->len, head_only);
+    }
+    if (ex->staleness_ms != 0) {
+        pthread_mutex_unlock(&ex->lock);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    ex->scrapes++;
+    ex->last_scrape_us = (double)(t1.tv_sec - t0.tv_sec) * 1e6 + (double)(t1.tv_nsec - t0.tv_nsec) / 1e3;
+    return ok;
+}
+
+/**
+ * Does the header block carry "Connection: <value>"?
+ */
+static bool connection_header_is(const char *headers, const char *value) {
+    const char *line = strcasestr(headers, "\nConnection:");
+
+    if (line == NULL) {
+        return false;
+    }
+    line += strlen("\nConnection:");
+    while (*line == ' ' || *line == '\t') line++;
+    return strncasecmp(line, value, strlen(value)) == 0;
+}
+
+/**
+ * Answer every complete request in the input buffer, stopping while a
+ * response is still queued. Returns false to close the connection.
+ */
+static bool conn_process(Exporter *ex, ExporterConn *conn) {
+    static const char index_text[] = "DevHelper exporter: metrics are at /metrics\n";
+    static const char not_found[] = "Not found\n";
+    static const char bad_method[] = "Only GET and HEAD are supported\n";
+
+    while (conn->out == NULL) {
+        char *end = memmem(conn->in, conn->in_len, "\r\n\r\n", 4);
+        if (end == NULL) {
+            if (conn->in_len < sizeof(conn->in)) {
+                return true;
+            }
+            conn->close_after = true;
+            conn->in_len = 0;
+            return conn_respond(ex, conn, "431 Request Header Fields Too Large", "text/plain; charset=utf-8",
+                                "", 0, false) && conn->out != NULL;
+        }
+        *end = '\0';
+        size_t used = (size_t)(end + 4 - conn->in);
+
+        char method[8], path[256], version[16];
+        bool ok;
+        if (sscanf(conn->in, "%7s %255s %15s", method, path, version) != 3) {
+            conn->close_after = true;
+            ok = conn_respond(ex, conn, "400 Bad Request", "text/plain; charset=utf-8", "", 0, false);
+        } else {
+            // HTTP/1.1 keeps the connection unless told otherwise; 1.0 only when asked
+            conn->close_after = strcmp(version, "HTTP/1.0") == 0 ? !connection_header_is(conn->in, "keep-alive")
+                                                                 : connection_header_is(conn->in, "close");
+            char *query = strchr(path, '?');
+            if (query != NULL) *query = '\0';
+            bool head_only = strcmp(method, "HEAD") == 0;
+
+            if (!head_only && strcmp(method, "GET") != 0) {
+                conn->close_after = true;
+                ok = conn_respond(ex, conn, "405 Method Not Allowed", "text/plain; charset=utf-8",
+                                  bad_method, sizeof(bad_method) - 1, false);
+            } else if (strcmp(path, "/metrics") == 0) {
+                ok = serve_metrics(ex, conn, head_only);
+            } else if (strcmp(path, "/") == 0) {
+                ok = conn_respond(ex, conn, "200 OK", "text/plain; charset=utf-8",
+                                  index_text, sizeof(index_text) - 1, head_only);
+            } else {
+                ok = conn_respond(ex, conn, "404 Not Found", "text/plain; charset=utf-8",
+                                  not_found, sizeof(not_found) - 1, head_only);
+            }
+        }
+
+        memmove(conn->in, conn->in + used, conn->in_len - used);
+        conn->in_len -= used;
+        if (!ok || (conn->close_after && conn->out == NULL)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool conn_read(Exporter *ex, ExporterConn *conn) {
+    while (conn->in_len < sizeof(conn->in)) {
+        ssize_t n = recv(conn->fd, conn->in + conn->in_len, sizeof(conn->in) - conn->in_len, 0);
+        if (n > 0) {
+            conn->in_len += (size_t)n;
+            continue;
+        }
+        if (n == 0) {
+            return false;
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            break;
+        }
+        return false;
+    }
+    conn->last_ms = monotonic_ms();
+    return conn_process(ex, conn);
+}
+
+/**
+ * Send more of a queued response; once it is out, go back to reading
+ * and answer anything pipelined behind it
+ */
+static bool conn_flush(Exporter *ex, ExporterConn *conn) {
+    while (conn->out_off < conn->out_len) {
+        ssize_t n = send(conn->fd, conn->out + conn->out_off, conn->out_len - conn->out_off,
+                         MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (n > 0) {
+            conn->out_off += (size_t)n;
+            continue;
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        return n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+    }
+
+    free(conn->out);
+    conn->out = NULL;
+    if (conn->close_after) {
+        return false;
+    }
+    conn_watch(ex, conn, false);
+    conn->last_ms = monotonic_ms();
+    return conn_process(ex, conn);
+}
+
+static void exporter_accept(Exporter *ex, int listen_fd) {
+    int fd;
+
+    while ((fd = accept4(listen_fd, NULL, NULL, SOCK_CLOEXEC | SOCK_NONBLOCK)) >= 0) {
+        ExporterConn *conn = NULL;
+        for (int i = 0; i < EXPORTER_MAX_CONNECTIONS && conn == NULL; i++) {
+            if (ex->conns[i].fd < 0) conn = &ex->conns[i];
+        }
+        if (conn == NULL) {
+            close(fd);
+            continue;
+        }
+
+        struct epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.u64 = TAG_CONN + (uint64_t)(conn - ex->conns);
+        if (epoll_ctl(ex->epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+            close(fd);
+            continue;
+        }
+        conn->fd = fd;
+        conn->in_len = 0;
+        conn->out = NULL;
+        conn->close_after = false;
+        conn->last_ms = monotonic_ms();
+        ex->conn_count++;
+    }
+}
+
+#endif
+
+/**
+ * Serve OpenMetrics on listen_spec until a key is pressed (or
+ * SIGINT/SIGTERM without a terminal). staleness_ms 0 samples on every
+ * scrape; otherwise a background thread re-samples on that period.
+ */
+void sysmon_exporter(const char *listen_spec, int staleness_ms) {
+#ifndef __linux__
+    (void)listen_spec;
+    (void)staleness_ms;
+    print_warning("The exporter is only available on Linux.");
+#else
+    static Exporter ex;
+    char label[320], message[400];
+
+    memset(&ex, 0, sizeof(ex));
+    for (int i = 0; i < EXPORTER_MAX_CONNECTIONS; i++) {
+        ex.conns[i].fd = -1;
+    }
+    ex.staleness_ms = staleness_ms > 0 ? staleness_ms : 0;
+    ex.sampler.clock_ticks = (double)sysconf(_SC_CLK_TCK);
+
+    int listen_fd = exporter_listen(listen_spec, label, sizeof(label));
+    if (listen_fd < 0) {
+        print_error("Could not listen on that address (is the port in use?)");
+        return;
+    }
+    ex.epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    struct epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.u64 = TAG_LISTEN;
+    if (ex.epoll_fd < 0 || epoll_ctl(ex.epoll_fd, EPOLL_CTL_ADD, listen_fd, &ev) < 0) {
+        print_error("Could not set up epoll!");
+        if (ex.epoll_fd >= 0) close(ex.epoll_fd);
+        close(listen_fd);
+        return;
+    }
+
+    // The first sample primes the tables and the background front buffer
+    sample_and_render(&ex.sampler, &ex.text[0]);
+    pthread_mutex_init(&ex.lock, NULL);
+    pthread_cond_init(&ex.wake, NULL);
+    pthread_t sampler;
+    bool sampler_started = ex.staleness_ms > 0 && pthread_create(&sampler, NULL, sampler_thread, &ex) == 0;
+    if (ex.staleness_ms > 0 && !sampler_started) {
+        print_warning("Could not start the background sampler; sampling on each scrape.");
+        ex.staleness_ms = 0;
+    }
+
+    struct sigaction sa, old_int, old_term;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = exporter_signal_handler;
+    sigaction(SIGINT, &sa, &old_int);
+    sigaction(SIGTERM, &sa, &old_term);
+    exporter_interrupted = 0;
+
+    // Unattended runs (stdin not a terminal) only stop on a signal
+    bool interactive = isatty(STDIN_FILENO);
+    if (ex.staleness_ms > 0) {
+        snprintf(message, sizeof(message), "sampled every %d ms in the background", ex.staleness_ms);
+    } else {
+        snprintf(message, sizeof(message), "sampled on each scrape");
+    }
+    printf("%sServing OpenMetrics on %s, %s - %s%s\n", COLOR_CYAN, label, message,
+           interactive ? "press any key to stop" : "send SIGINT or SIGTERM to stop", COLOR_RESET);
+    fflush(stdout);
+    if (interactive) {
+        terminal_set_raw(true);
+        ev.events = EPOLLIN;
+        ev.data.u64 = TAG_STDIN;
+        epoll_ctl(ex.epoll_fd, EPOLL_CTL_ADD, STDIN_FILENO, &ev);
+    }
+
+    struct epoll_event events[64];
+    long long next_status = monotonic_ms() + 1000;
+    bool running = true;
+    while (running && !exporter_interrupted) {
+        int n = epoll_wait(ex.epoll_fd, events, 64, 1000);
+        if (n < 0 && errno != EINTR) {
+            break;
+        }
+        for (int i = 0; i < n; i++) {
+            uint64_t tag = events[i].data.u64;
+            if (tag == TAG_LISTEN) {
+                exporter_accept(&ex, listen_fd);
+                continue;
+            }
+            if (tag == TAG_STDIN) {
+                wait_for_key(0);
+                running = false;
+                continue;
+            }
+            ExporterConn *conn = &ex.conns[tag - TAG_CONN];
+            if (conn->fd < 0) {
+                continue;
+            }
+            bool keep;
+            if (events[i].events & EPOLLERR) {
+                keep = false;
+            } else if (conn->out != NULL) {
+                keep = conn_flush(&ex, conn);
+            } else {
+                keep = conn_read(&ex, conn);
+            }
+            if (!keep) {
+                conn_close(&ex, conn);
+            }
+        }
+
+        long long now = monotonic_ms();
+        if (now < next_status) {
+            continue;
+        }
+        next_status = now + 1000;
+        for (int i = 0; i < EXPORTER_MAX_CONNECTIONS; i++) {
+            if (ex.conns[i].fd >= 0 && now - ex.conns[i].last_ms > EXPORTER_IDLE_MS) {
+                conn_close(&ex, &ex.conns[i]);
+            }
+        }
+        if (interactive) {
+            printf("\r  %lu scrapes, last served in %.0f us, %d connections   ",
+                   ex.scrapes, ex.last_scrape_us, ex.conn_count);
+            fflush(stdout);
+        }
+    }
+
+    if (sampler_started) {
+        pthread_mutex_lock(&ex.lock);
+        ex.stopping = true;
+        pthread_cond_signal(&ex.wake);
+        pthread_mutex_unlock(&ex.lock);
+        pthread_join(sampler, NULL);
+    }
+    for (int i = 0; i < EXPORTER_MAX_CONNECTIONS; i++) {
+        if (ex.conns[i].fd >= 0) conn_close(&ex, &ex.conns[i]);
+    }
+    if (interactive) {
+        terminal_set_raw(false);
+    }
+    sigaction(SIGINT, &old_int, NULL);
+    sigaction(SIGTERM, &old_term, NULL);
+    printf("\n");
+
+    close(ex.epoll_fd);
+    close(listen_fd);
+    pthread_mutex_destroy(&ex.lock);
+    pthread_cond_destroy(&ex.wake);
+    free(ex.text[0].data);
+    free(ex.text[1].data);
+    net_table_free(&ex.sampler.net);
+#endif
+}
@@ -0,0 +1,497 @@
+/**
+ * DevHelper+Portal CLI - Page-Cache Residency (fincore)
+ *
+ * Reports how much of each file, and of each directory tree, is in the
+ * page cache. Files are measured with cachestat(2) where the kernel has
+ * it (6.5+, also gives dirty and writeback pages) and with mmap+mincore
+ * otherwise. Trees are walked by a pool of threads sharing a directory
+ * queue, staying on one filesystem like du -x, and totals are kept per
+ * top-level entry. --warm reads files into the cache (readahead, then
+ * WILLNEED) and --evict writes back and drops them (DONTNEED), so cold
+ * and warm benchmark starts can be set up on purpose.
+ */
+
+#define _GNU_SOURCE
+#include "devhelper.h"
+
+#ifdef __linux__
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#endif
+
+#ifdef __linux__
+
+// New syscalls share one number on every architecture but alpha
+#if !defined(__NR_cachestat) && !defined(__alpha__)
+#define __NR_cachestat 451
+#endif
+
+#define FINCORE_MAX_THREADS 64
+#define FINCORE_MAX_ROWS 4096
+#define FINCORE_MAP_WINDOW (1024LL * 1024 * 1024)   // mincore in 1 GB mappings
+#define FINCORE_WARM_WINDOW (2 * 1024 * 1024)
+
+typedef struct {
+    unsigned long long off;
+    unsigned long long len;                 // 0 = to end of file
+} FincoreRange;
+
+typedef struct {
+    unsigned long long nr_cache;
+    unsigned long long nr_dirty;
+    unsigned long long nr_writeback;
+    unsigned long long nr_evicted;
+    unsigned long long nr_recently_evicted;
+} FincoreStat;
+
+// One per path argument, or per top-level entry of a directory argument
+typedef struct {
+    const char *base;                       // The path argument
+    char name[NAME_MAX + 1];                // Entry inside it, "" for the argument itself
+    bool is_dir;
+    atomic_ullong size;
+    atomic_ullong cached;                   // Bytes
+    atomic_ullong dirty;
+    atomic_ullong before;                   // Cached bytes before the action
+    atomic_ullong files;
+} FincoreRow;
+
+typedef struct FincoreDir {
+    struct FincoreDir *next;
+    int row;
+    dev_t dev;                              // Stay on the filesystem the walk started on
+    char path[];
+} FincoreDir;
+
+typedef struct {
+    FincoreRow *rows;
+    FincoreAction action;
+    bool measure_before;                    // First pass of a warm/evict run
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    FincoreDir *queue;
+    int busy;                               // Workers holding a directory
+    bool done;
+    atomic_ullong errors;
+} FincoreWalk;
+
+static atomic_int cachestat_state;          // 0 untried, 1 works, -1 unsupported
+static long page_size;
+
+/**
+ * Cached (and dirty, when known) bytes of an open file
+ */
+static bool measure_file(int fd, unsigned long long size, unsigned long long *cached,
+                         unsigned long long *dirty) {
+    *cached = 0;
+    *dirty = 0;
+    if (size == 0) {
+        return true;
+    }
+
+#ifdef __NR_cachestat
+    if (atomic_load_explicit(&cachestat_state, memory_order_relaxed) >= 0) {
+        FincoreRange range = { 0, 0 };
+        FincoreStat stat;
+        if (syscall(__NR_cachestat, fd, &range, &stat, 0) == 0) {
+            atomic_store_explicit(&cachestat_state, 1, memory_order_relaxed);
+            *cached = stat.nr_cache * (unsigned long long)page_size;
+            *dirty = stat.nr_dirty * (unsigned long long)page_size;
+            if (*cached > size) *cached = size;
+            return true;
+        }
+        if (errno == ENOSYS) {
+            atomic_store_explicit(&cachestat_state, -1, memory_order_relaxed);
+        }
+    }
+#endif
+
+    unsigned char vec[4096];
+    for (unsigned long long off = 0; off < size; off += FINCORE_MAP_WINDOW) {
+        size_t len = size - off < (unsigned long long)FINCORE_MAP_WINDOW ? (size_t)(size - off)
+                                                                         : (size_t)FINCORE_MAP_WINDOW;
+        void *map = mmap(NULL, len, PROT_READ, MAP_SHARED, fd, (off_t)off);
+        if (map == MAP_FAILED) {
+            return false;
+        }
+        // mincore needs one byte per page; do it in vec-sized pieces
+        size_t pages = (len + (size_t)page_size - 1) / (size_t)page_size;
+        for (size_t first = 0; first < pages; first += sizeof(vec)) {
+            size_t n = pages - first < sizeof(vec) ? pages - first : sizeof(vec);
+            size_t bytes = n * (size_t)page_size;
+            if (first * (size_t)page_size + bytes > len) {
+                bytes = len - first * (size_t)page_size;
+            }
+            if (mincore((char *)map + first * (size_t)page_size, bytes, vec) != 0) {
+                munmap(map, len);
+                return false;
+            }
+            for (size_t i = 0; i < n; i++) {
+                *cached += vec[i] & 1;
+            }
+        }
+        munmap(map, len);
+    }
+    *cached *= (unsigned long long)page_size;
+    if (*cached > size) {
+        *cached = size;     // The last page is only partly file
+    }
+    return true;
+}
+
+static void apply_action(int fd, unsigned long long size, FincoreAction action) {
+    if (action == FINCORE_WARM) {
+        // The kernel clamps each readahead() to the device's readahead
+        // window, so walk the file in windows; WILLNEED where it's refused
+        for (unsigned long long off = 0; off < size; off += FINCORE_WARM_WINDOW) {
+            if (readahead(fd, (off64_t)off, FINCORE_WARM_WINDOW) != 0) {
+                posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+                break;
+            }
+        }
+    } else if (action == FINCORE_EVICT) {
+        // Dirty pages survive DONTNEED, so write them back first
+        fdatasync(fd);
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    }
+}
+
+/**
+ * Measure (and act on) one regular file, adding it to its row
+ */
+static void visit_file(FincoreWalk *walk, int dirfd, const char *name, const struct stat *st, int row) {
+    int fd = openat(dirfd, name, O_RDONLY | O_NOATIME | O_NOFOLLOW | O_CLOEXEC);
+    if (fd < 0 && errno == EPERM) {
+        fd = openat(dirfd, name, O_RDONLY | O_NOFOLLOW | O_CLOEXEC);   // O_NOATIME needs ownership
+    }
+    if (fd < 0) {
+        atomic_fetch_add(&walk->errors, 1);
+        return;
+    }
+
+    unsigned long long size = (unsigned long long)st->st_size;
+    unsigned long long cached, dirty;
+    FincoreRow *r = &walk->rows[row];
+
+    if (walk->measure_before) {
+        if (measure_file(fd, size, &cached, &dirty)) {
+            atomic_fetch_add_explicit(&r->before, cached, memory_order_relaxed);
+        }
+        apply_action(fd, size, walk->action);
+    } else if (measure_file(fd, size, &cached, &dirty)) {
+        atomic_fetch_add_explicit(&r->size, size, memory_order_relaxed);
+        atomic_fetch_add_explicit(&r->cached, cached, memory_order_relaxed);
+        atomic_fetch_add_explicit(&r->dirty, dirty, memory_order_relaxed);
+        atomic_fetch_add_explicit(&r->files, 1, memory_order_relaxed);
+    } else {
+        atomic_fetch_add(&walk->errors, 1);
+    }
+    close(fd);
+}
+
+static void queue_dir(FincoreWalk *walk, const char *path, int row, dev_t dev) {
+    size_t len = strlen(path);
+    FincoreDir *dir = malloc(sizeof(FincoreDir) + len + 1);
+
+    if (dir == NULL) {
+        atomic_fetch_add(&walk->errors, 1);
+        return;
+    }
+    memcpy(dir->path, path, len + 1);
+    dir->row = row;
+    dir->dev = dev;
+    pthread_mutex_lock(&walk->lock);
+    dir->next = walk->queue;
+    walk->queue = dir;
+    pthread_cond_signal(&walk->wake);
+    pthread_mutex_unlock(&walk->lock);
+}
+
+static void scan_dir(FincoreWalk *walk, const FincoreDir *dir) {
+    char path[PATH_MAX];
+    int fd = open(dir->path, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+    DIR *d = fd >= 0 ? fdopendir(fd) : NULL;
+
+    if (d == NULL) {
+        if (fd >= 0) close(fd);
+        atomic_fetch_add(&walk->errors, 1);
+        return;
+    }
+
+    struct dirent *entry;
+    while ((entry = readdir(d)) != NULL) {
+        const char *name = entry->d_name;
+        struct stat st;
+
+        if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) {
+            continue;
+        }
+        if (fstatat(fd, name, &st, AT_SYMLINK_NOFOLLOW) != 0) {
+            atomic_fetch_add(&walk->errors, 1);
+            continue;
+        }
+        if (S_ISREG(st.st_mode)) {
+            visit_file(walk, fd, name, &st, dir->row);
+        } else if (S_ISDIR(st.st_mode) && st.st_dev == dir->dev) {
+            if (snprintf(path, sizeof(path), "%s/%s", dir->path, name) < (int)sizeof(path)) {
+                queue_dir(walk, path, dir->row, dir->dev);
+            } else {
+                atomic_fetch_add(&walk->errors, 1);
+            }
+        }
+    }
+    closedir(d);
+}
+
+static void *fincore_worker(void *arg) {
+    FincoreWalk *walk = arg;
+
+    pthread_mutex_lock(&walk->lock);
+    for (;;) {
+        while (walk->queue == NULL && !walk->done) {
+            pthread_cond_wait(&walk->wake, &walk->lock);
+        }
+        if (walk->queue == NULL) {
+            break;
+        }
+        FincoreDir *dir = walk->queue;
+        walk->queue = dir->next;
+        walk->busy++;
+        pthread_mutex_unlock(&walk->lock);
+
+        scan_dir(walk, dir);
+        free(dir);
+
+        pthread_mutex_lock(&walk->lock);
+        walk->busy--;
+        // Nothing queued and nobody left to queue more: the walk is over
+        if (walk->queue == NULL && walk->busy == 0) {
+            walk->done = true;
+            pthread_cond_broadcast(&walk->wake);
+        }
+    }
+    pthread_mutex_unlock(&walk->lock);
+    return NULL;
+}
+
+/**
+ * One pass over every row. Directory rows are walked by the pool; plain
+ * files are handled inline.
+ */
+static void fincore_pass(FincoreWalk *walk, int row_count, int threads) {
+    pthread_t pool[FINCORE_MAX_THREADS];
+    int started = 0;
+
+    walk->queue = NULL;
+    walk->busy = 0;
+    walk->done = false;
+
+    for (int r = 0; r < row_count; r++) {
+        const char *base = walk->rows[r].base;
+        char path[PATH_MAX];
+        struct stat st;
+        int rc;
+
+        // Path arguments were accepted with stat, so a symlinked argument is
+        // resolved once here; entries found inside directories are not followed
+        if (walk->rows[r].name[0] == '\0') {
+            rc = realpath(base, path) != NULL ? lstat(path, &st) : -1;   // The path argument itself
+        } else {
+            snprintf(path, sizeof(path), "%s/%s", base, walk->rows[r].name);
+            rc = lstat(path, &st);
+        }
+        if (rc != 0) {
+            atomic_fetch_add(&walk->errors, 1);
+        } else if (S_ISDIR(st.st_mode)) {
+            queue_dir(walk, path, r, st.st_dev);
+        } else if (S_ISREG(st.st_mode)) {
+            visit_file(walk, AT_FDCWD, path, &st, r);
+        }
+    }
+
+    pthread_mutex_lock(&walk->lock);
+    if (walk->queue == NULL) {
+        walk->done = true;
+    }
+    pthread_mutex_unlock(&walk->lock);
+
+    for (int i = 0; i < threads; i++) {
+        if (pthread_create(&pool[started], NULL, fincore_worker, walk) == 0) {
+            started++;
+        }
+    }
+    if (started == 0) {
+        fincore_worker(walk);
+    }
+    for (int i = 0; i < started; i++) {
+        pthread_join(pool[i], NULL);
+    }
+}
+
+static int compare_rows(const void *a, const void *b) {
+    unsigned long long x = atomic_load(&((const FincoreRow *)a)->cached);
+    unsigned long long y = atomic_load(&((const FincoreRow *)b)->cached);
+    return (x < y) - (x > y);
+}
+
+static void bytes_text(unsigned long long bytes, char *out, size_t size) {
+    format_kb(bytes / 1024, out, size);
+}
+
+#endif
+
+/**
+ * Report page-cache residency for files and directory trees, optionally
+ * warming or evicting them first. threads <= 0 picks a default.
+ */
+void sysmon_fincore(char **paths, int path_count, FincoreAction action, int threads) {
+#ifndef __linux__
+    (void)paths; (void)path_count; (void)action; (void)threads;
+    print_warning("Page-cache residency is only available on Linux.");
+#else
+    static FincoreRow rows[FINCORE_MAX_ROWS];
+    static FincoreWalk walk;
+    char message[PATH_MAX + 64];
+    int row_count = 0;
+    bool truncated = false;
+
+    page_size = sysconf(_SC_PAGESIZE);
+    if (threads <= 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        // Mostly waiting on metadata and mincore, like du
+        threads = cpus > 0 ? (int)cpus * 2 : 4;
+        if (threads < 4) threads = 4;
+    }
+    if (threads > FINCORE_MAX_THREADS) threads = FINCORE_MAX_THREADS;
+
+    // Rows: each file argument, and each top-level entry of a directory argument
+    memset(rows, 0, sizeof(rows));
+    for (int p = 0; p < path_count; p++) {
+        struct stat st;
+        if (stat(paths[p], &st) != 0) {
+            snprintf(message, sizeof(message), "Cannot access %s: %s", paths[p], strerror(errno));
+            print_error(message);
+            continue;
+        }
+        if (!S_ISDIR(st.st_mode)) {
+            if (row_count < FINCORE_MAX_ROWS) {
+                rows[row_count++].base = paths[p];
+            }
+            continue;
+        }
+
+        DIR *d = opendir(paths[p]);
+        struct dirent *entry;
+        while (d != NULL && (entry = readdir(d)) != NULL) {
+            if (entry->d_name[0] == '.' &&
+                (entry->d_name[1] == '\0' || (entry->d_name[1] == '.' && entry->d_name[2] == '\0'))) {
+                continue;
+            }
+            if (row_count == FINCORE_MAX_ROWS) {
+                truncated = true;
+                break;
+            }
+            snprintf(rows[row_count].name, sizeof(rows[row_count].name), "%s", entry->d_name);
+            rows[row_count].is_dir = entry->d_type == DT_DIR;
+            rows[row_count++].base = paths[p];
+        }
+        if (d != NULL) closedir(d);
+    }
+    if (row_count == 0) {
+        print_warning("Nothing to measure.");
+        return;
+    }
+
+    walk.rows = rows;
+    walk.action = action;
+    atomic_store(&walk.errors, 0);
+    pthread_mutex_init(&walk.lock, NULL);
+    pthread_cond_init(&walk.wake, NULL);
+
+    long long start = monotonic_ms();
+    if (action != FINCORE_REPORT) {
+        walk.measure_before = true;
+        fincore_pass(&walk, row_count, threads);
+    }
+    walk.measure_before = false;
+    fincore_pass(&walk, row_count, threads);
+    double elapsed = (double)(monotonic_ms() - start) / 1000.0;
+
+    pthread_cond_destroy(&walk.wake);
+    pthread_mutex_destroy(&walk.lock);
+
+    qsort(rows, (size_t)row_count, sizeof(FincoreRow), compare_rows);
+
+    bool show_dirty = atomic_load(&cachestat_state) > 0;
+    printf("%s%10s %10s %7s", COLOR_BOLD, "Cached", "Size", "Cached%");
+    if (show_dirty) printf(" %10s", "Dirty");
+    if (action != FINCORE_REPORT) printf(" %10s", "Before");
+    printf(" %8s  %s%s\n", "Files", "Path", COLOR_RESET);
+
+    unsigned long long total_size = 0, total_cached = 0, total_dirty = 0, total_before = 0, total_files = 0;
+    for (int r = 0; r < row_count; r++) {
+        FincoreRow *row = &rows[r];
+        unsigned long long size = atomic_load(&row->size), cached = atomic_load(&row->cached);
+        char size_text[16], cached_text[16], extra[16];
+
+        total_size += size;
+        total_cached += cached;
+        total_dirty += atomic_load(&row->dirty);
+        total_before += atomic_load(&row->before);
+        total_files += atomic_load(&row->files);
+        if (r >= 40) {
+            continue;       // Counted in the total, not listed
+        }
+
+        double percent = size > 0 ? 100.0 * (double)cached / (double)size : 0.0;
+        bytes_text(cached, cached_text, sizeof(cached_text));
+        bytes_text(size, size_text, sizeof(size_text));
+        printf("%10s %10s %s%6.1f%%%s", cached_text, size_text,
+               percent >= 90.0 ? COLOR_GREEN : percent > 0.0 ? COLOR_YELLOW : "", percent, COLOR_RESET);
+        if (show_dirty) {
+            bytes_text(atomic_load(&row->dirty), extra, sizeof(extra));
+            printf(" %10s", extra);
+        }
+        if (action != FINCORE_REPORT) {
+            bytes_text(atomic_load(&row->before), extra, sizeof(extra));
+            printf(" %10s", extra);
+        }
+        printf(" %8llu  %s%s\n", (unsigned long long)atomic_load(&row->files),
+               row->name[0] != '\0' ? row->name : row->base, row->is_dir ? "/" : "");
+    }
+    if (row_count > 40) {
+        printf("  ... %d more entries\n", row_count - 40);
+    }
+
+    char size_text[16], cached_text[16], extra[16];
+    bytes_text(total_cached, cached_text, sizeof(cached_text));
+    bytes_text(total_size, size_text, sizeof(size_text));
+    printf("%s%10s %10s %6.1f%%", COLOR_BOLD, cached_text, size_text,
+           total_size > 0 ? 100.0 * (double)total_cached / (double)total_size : 0.0);
+    if (show_dirty) {
+        bytes_text(total_dirty, extra, sizeof(extra));
+        printf(" %10s", extra);
+    }
+    if (action != FINCORE_REPORT) {
+        bytes_text(total_before, extra, sizeof(extra));
+        printf(" %10s", extra);
+    }
+    printf(" %8llu  total%s\n", total_files, COLOR_RESET);
+
+    snprintf(message, sizeof(message), "%llu files in %.2f s with %d threads via %s%s%s",
+             total_files, elapsed, threads, show_dirty ? "cachestat" : "mincore",
+             atomic_load(&walk.errors) ? ", some entries unreadable" : "",
+             truncated ? ", too many entries to list them all" : "");
+    print_info(message);
+    if (action == FINCORE_WARM && total_cached < total_size) {
+        print_info("Readahead continues in the background; run again to see the final state.");
+    }
+#endif
+}
@@ -0,0 +1,306 @@
+/**
+ * DevHelper+Portal CLI - Resource History
+ *
+ * Fixed-size, multi-resolution time series for the system monitor.
+ * Every metric keeps three ring buffers (per second, per minute, per hour)
+ * stored as separate min/max/avg arrays. Each tier rolls its samples up
+ * into the next one as they arrive, so memory stays constant no matter
+ * how long devhelper runs and inserting a sample never allocates.
+ */
+
+#define _GNU_SOURCE
+#include "devhelper.h"
+#include <math.h>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <time.h>
+#endif
+
+// Samples kept per tier: 10 minutes of seconds, a day of minutes, 30 days of hours
+static const int tier_capacity[HISTORY_TIER_COUNT] = { 600, 1440, 720 };
+#define TIER_POINTS_TOTAL (600 + 1440 + 720)
+
+// Points of a tier that make up one point of the next tier
+#define ROLLUP_FACTOR 60
+
+typedef struct {
+    float *min;
+    float *max;
+    float *avg;
+    int capacity;
+    int head;       // Next slot to write
+    int count;      // Valid points, up to capacity
+
+    // Running aggregate of points not yet rolled into the next tier
+    float acc_min;
+    float acc_max;
+    double acc_sum;
+    int acc_count;
+} HistoryTier;
+
+typedef struct {
+    HistoryTier tiers[HISTORY_TIER_COUNT];
+} MetricHistory;
+
+static const char *metric_names[HISTORY_METRIC_COUNT] = {
+    "CPU busy %",
+    "CPU iowait %",
+    "Memory used %",
+    "Swap used %",
+    "Load (1 min)"
+};
+
+// Struct-of-arrays storage: [metric][min|max|avg][all tiers back to back]
+static float history_pool[HISTORY_METRIC_COUNT][3][TIER_POINTS_TOTAL];
+static MetricHistory history[HISTORY_METRIC_COUNT];
+static bool history_ready = false;
+
+#ifdef __linux__
+static pthread_mutex_t history_lock = PTHREAD_MUTEX_INITIALIZER;
+#define HISTORY_LOCK() pthread_mutex_lock(&history_lock)
+#define HISTORY_UNLOCK() pthread_mutex_unlock(&history_lock)
+#else
+#define HISTORY_LOCK()
+#define HISTORY_UNLOCK()
+#endif
+
+/**
+ * Point the tier descriptors at their slices of the static pool
+ */
+static void history_init(void) {
+    for (int m = 0; m < HISTORY_METRIC_COUNT; m++) {
+        int offset = 0;
+        for (int t = 0; t < HISTORY_TIER_COUNT; t++) {
+            HistoryTier *tier = &history[m].tiers[t];
+            memset(tier, 0, sizeof(*tier));
+            tier->min = &history_pool[m][0][offset];
+            tier->max = &history_pool[m][1][offset];
+            tier->avg = &history_pool[m][2][offset];
+            tier->capacity = tier_capacity[t];
+            offset += tier_capacity[t];
+        }
+    }
+    history_ready = true;
+}
+
+/**
+ * Append one aggregated point to a tier and cascade the roll-up
+ */
+static void tier_push(MetricHistory *metric, int level, float min, float max, float avg) {
+    HistoryTier *tier = &metric->tiers[level];
+
+    tier->min[tier->head] = min;
+    tier->max[tier->head] = max;
+    tier->avg[tier->head] = avg;
+    tier->head = (tier->head + 1) % tier->capacity;
+    if (tier->count < tier->capacity) {
+        tier->count++;
+    }
+
+    if (level + 1 >= HISTORY_TIER_COUNT) {
+        return;
+    }
+
+    if (tier->acc_count == 0) {
+        tier->acc_min = min;
+        tier->acc_max = max;
+        tier->acc_sum = 0.0;
+    } else {
+        if (min < tier->acc_min) tier->acc_min = min;
+        if (max > tier->acc_max) tier->acc_max = max;
+    }
+    tier->acc_sum += avg;
+    tier->acc_count++;
+
+    if (tier->acc_count == ROLLUP_FACTOR) {
+        float rolled_avg = (float)(tier->acc_sum / ROLLUP_FACTOR);
+        tier->acc_count = 0;
+        tier_push(metric, level + 1, tier->acc_min, tier->acc_max, rolled_avg);
+    }
+}
+
+/**
+ * Record one per-second sample for every metric. O(1), allocation-free.
+ */
+void history_record(const float values[HISTORY_METRIC_COUNT]) {
+    HISTORY_LOCK();
+    if (!history_ready) {
+        history_init();
+    }
+    for (int m = 0; m < HISTORY_METRIC_COUNT; m++) {
+        tier_push(&history[m], 0, values[m], values[m], values[m]);
+    }
+    HISTORY_UNLOCK();
+}
+
+/**
+ * Copy the most recent points of a window, oldest first.
+ * The coarser windows end with the partially filled current bucket so
+ * a short session still shows something. Returns the number of points.
+ */
+int history_read(HistoryMetric metric, HistoryWindow window, HistoryPoint *out, int max_points) {
+    // Window -> (tier, points); the tier below feeds the in-progress bucket
+    static const int window_tier[] = { 0, 1, 2 };
+    static const int window_points[] = { 60, 60, 24 };
+    int count = 0;
+
+    HISTORY_LOCK();
+    if (!history_ready) {
+        HISTORY_UNLOCK();
+        return 0;
+    }
+
+    const MetricHistory *mh = &history[metric];
+    const HistoryTier *tier = &mh->tiers[window_tier[window]];
+    const HistoryTier *below = window_tier[window] > 0 ? &mh->tiers[window_tier[window] - 1] : NULL;
+    bool partial = below != NULL && below->acc_count > 0;
+
+    int wanted = window_points[window];
+    if (wanted > max_points) wanted = max_points;
+    int stored = tier->count;
+    if (stored > wanted - (partial ? 1 : 0)) stored = wanted - (partial ? 1 : 0);
+
+    for (int i = stored; i > 0; i--) {
+        int idx = (tier->head - i + tier->capacity) % tier->capacity;
+        out[count].min = tier->min[idx];
+        out[count].max = tier->max[idx];
+        out[count].avg = tier->avg[idx];
+        count++;
+    }
+    if (partial && count < max_points) {
+        out[count].min = below->acc_min;
+        out[count].max = below->acc_max;
+        out[count].avg = (float)(below->acc_sum / below->acc_count);
+        count++;
+    }
+    HISTORY_UNLOCK();
+
+    return count;
+}
+
+/**
+ * Human-readable metric name
+ */
+const char *history_metric_name(HistoryMetric metric) {
+    return metric_names[metric];
+}
+
+/**
+ * Render averages as a unicode sparkline scaled to [lo, hi]
+ */
+void format_sparkline(const HistoryPoint *points, int count, float lo, float hi,
+                      char *out, size_t size) {
+    static const char *blocks[] = { "▁", "▂", "▃", "▄", "▅", "▆", "▇", "█" };
+    size_t used = 0;
+
+    out[0] = '\0';
+    for (int i = 0; i < count; i++) {
+        float v = points[i].avg;
+        int level = hi > lo ? (int)((v - lo) / (hi - lo) * 7.0f + 0.5f) : 0;
+        if (level < 0) level = 0;
+        if (level > 7) level = 7;
+
+        size_t len = strlen(blocks[level]);
+        if (used + len + 1 > size) {
+            break;
+        }
+        memcpy(out + used, blocks[level], len);
+        used += len;
+    }
+    out[used] = '\0';
+}
+
+/**
+ * Print minute/hour/day sparklines for a metric with min/avg/max
+ */
+void display_metric_history(HistoryMetric metric, float lo, float hi) {
+    static const char *labels[] = { "last min ", "last hour", "last day " };
+    HistoryPoint points[64];
+    char spark[64 * 4 + 1];
+
+    printf("%s%s:%s\n", COLOR_CYAN, history_metric_name(metric), COLOR_RESET);
+    for (int w = 0; w < HISTORY_WINDOW_COUNT; w++) {
+        int n = history_read(metric, (HistoryWindow)w, points, 64);
+        if (n == 0) {
+            printf("  %s  (no samples yet)\n", labels[w]);
+            continue;
+        }
+
+        float min = points[0].min, max = points[0].max;
+        double sum = 0.0;
+        for (int i = 0; i < n; i++) {
+            if (points[i].min < min) min = points[i].min;
+            if (points[i].max > max) max = points[i].max;
+            sum += points[i].avg;
+        }
+
+        float top = hi;
+        if (isnan(top)) {
+            top = max > 0.0f ? max : 1.0f;  // Auto-scale unbounded metrics
+        }
+        format_sparkline(points, n, lo, top, spark, sizeof(spark));
+        printf("  %s  %s%s%s  min %.1f  avg %.1f  max %.1f\n", labels[w],
+               COLOR_GREEN, spark, COLOR_RESET, min, sum / n, max);
+    }
+}
+
+#ifdef __linux__
+/**
+ * Background sampler feeding the history once per second
+ */
+static void *history_sampler_thread(void *arg) {
+    static CpuSnapshot prev, cur;
+    MemorySnapshot mem;
+    LoadSnapshot load;
+    struct timespec next;
+
+    (void)arg;
+    sysmon_read_cpu(&prev);
+    clock_gettime(CLOCK_MONOTONIC, &next);
+
+    for (;;) {
+        next.tv_sec += 1;
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+
+        if (!sysmon_read_cpu(&cur) || !sysmon_read_memory(&mem) || !sysmon_read_load(&load)) {
+            continue;
+        }
+
+        float values[HISTORY_METRIC_COUNT];
+        unsigned long long total = cpu_times_total(&cur.total) - cpu_times_total(&prev.total);
+        values[HIST_CPU_BUSY] = (float)sysmon_cpu_busy_percent(&prev.total, &cur.total);
+        values[HIST_CPU_IOWAIT] = total > 0
+            ? (float)(100.0 * (double)(cur.total.iowait - prev.total.iowait) / (double)total) : 0.0f;
+        values[HIST_MEM_USED] = mem.total_kb > 0
+            ? (float)(100.0 * (double)(mem.total_kb - mem.available_kb) / (double)mem.total_kb) : 0.0f;
+        values[HIST_SWAP_USED] = mem.swap_total_kb > 0
+            ? (float)(100.0 * (double)(mem.swap_total_kb - mem.swap_free_kb) /
+                      (double)mem.swap_total_kb) : 0.0f;
+        values[HIST_LOAD1] = (float)load.load1;
+
+        history_record(values);
+        prev = cur;
+    }
+
+    return NULL;
+}
+
+static pthread_once_t sampler_once = PTHREAD_ONCE_INIT;
+
+static void start_sampler_once(void) {
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, history_sampler_thread, NULL) == 0) {
+        pthread_detach(thread);
+    }
+}
+#endif
+
+/**
+ * Start the once-per-second history sampler (idempotent)
+ */
+void history_start_sampler(void) {
+#ifdef __linux__
+    pthread_once(&sampler_once, start_sampler_once);
+#endif
+}
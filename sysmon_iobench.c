@@ -0,0 +1,579 @@
+/**
+ * DevHelper+Portal CLI - Disk I/O Benchmark
+ *
+ * Sequential and random reads and writes against a scratch file on the
+ * filesystem under test, at a given block size and queue depth. I/O is
+ * O_DIRECT so the page cache stays out of the numbers, driven by
+ * io_uring through the raw syscalls (no liburing needed); when io_uring
+ * is missing or disabled, a pool of queue-depth threads doing
+ * pread/pwrite keeps the same number of requests in flight. Each test
+ * reports IOPS, MB/s and per-request latency percentiles from a
+ * QuantileSketch, plus a log2 latency histogram.
+ */
+
+#define _GNU_SOURCE
+#include "devhelper.h"
+
+#ifdef __linux__
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/statvfs.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <time.h>
+#if defined(__NR_io_uring_setup) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#define IOBENCH_HAVE_URING 1
+#endif
+#endif
+
+#ifdef __linux__
+
+#define IOBENCH_MAX_DEPTH 256
+#define IOBENCH_HIST_BUCKETS 24             // log2 microseconds, up to ~8 s
+#define IOBENCH_LATENCY_SCALE 10.0          // 0.1 us resolution
+#define IOBENCH_LATENCY_MAX_US 10000000.0
+
+typedef struct {
+    const char *name;
+    bool write;
+    bool random;
+} IoBenchTest;
+
+static const IoBenchTest io_bench_tests[] = {
+    { "seq read",   false, false },
+    { "rand read",  false, true },
+    { "seq write",  true,  false },
+    { "rand write", true,  true },
+};
+
+typedef struct {
+    unsigned long long ops;
+    unsigned long long errors;
+    int first_errno;
+    unsigned long long hist[IOBENCH_HIST_BUCKETS];
+    QuantileSketch latency;                 // Microseconds
+} IoBenchResult;
+
+typedef struct {
+    int fd;
+    off_t file_size;
+    size_t block;
+    int depth;
+    const IoBenchTest *test;
+    long long deadline_ns;
+    atomic_ullong next_offset;              // Sequential tests share one cursor
+} IoBenchJob;
+
+static long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static uint64_t xorshift64(uint64_t *state) {
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *state = x;
+}
+
+/**
+ * Offset of the next request: the shared cursor for sequential tests,
+ * a block-aligned random position otherwise
+ */
+static off_t next_offset(IoBenchJob *job, uint64_t *rng) {
+    unsigned long long blocks = (unsigned long long)job->file_size / job->block;
+    unsigned long long index;
+
+    if (job->test->random) {
+        index = xorshift64(rng) % blocks;
+    } else {
+        index = atomic_fetch_add_explicit(&job->next_offset, 1, memory_order_relaxed) % blocks;
+    }
+    return (off_t)(index * job->block);
+}
+
+static void record_latency(IoBenchResult *result, long long ns) {
+    double us = (double)ns / 1000.0;
+    unsigned long long whole = (unsigned long long)us;
+    int bucket = 0;
+
+    while (whole > 1 && bucket < IOBENCH_HIST_BUCKETS - 1) {
+        whole >>= 1;
+        bucket++;
+    }
+    result->hist[bucket]++;
+    sketch_add(&result->latency, us);
+    result->ops++;
+}
+
+static void record_error(IoBenchResult *result, int error) {
+    if (result->errors++ == 0) {
+        result->first_errno = error;
+    }
+}
+
+static bool result_init(IoBenchResult *result) {
+    memset(result, 0, sizeof(*result));
+    return sketch_init(&result->latency, "latency", IOBENCH_LATENCY_SCALE, IOBENCH_LATENCY_MAX_US);
+}
+
+static void result_merge(IoBenchResult *dst, const IoBenchResult *src) {
+    dst->ops += src->ops;
+    if (dst->errors == 0 && src->errors > 0) {
+        dst->first_errno = src->first_errno;
+    }
+    dst->errors += src->errors;
+    for (int i = 0; i < IOBENCH_HIST_BUCKETS; i++) {
+        dst->hist[i] += src->hist[i];
+    }
+    sketch_merge(&dst->latency, &src->latency);
+}
+
+#ifdef IOBENCH_HAVE_URING
+
+typedef struct {
+    int fd;
+    unsigned *sq_head, *sq_tail, *sq_mask, *sq_array;
+    unsigned *cq_head, *cq_tail, *cq_mask;
+    struct io_uring_sqe *sqes;
+    struct io_uring_cqe *cqes;
+    void *sq_map, *cq_map;
+    size_t sq_map_size, cq_map_size, sqes_size;
+} IoUring;
+
+static void io_uring_release(IoUring *ring) {
+    if (ring->sqes != NULL) munmap(ring->sqes, ring->sqes_size);
+    if (ring->cq_map != NULL && ring->cq_map != ring->sq_map) munmap(ring->cq_map, ring->cq_map_size);
+    if (ring->sq_map != NULL) munmap(ring->sq_map, ring->sq_map_size);
+    if (ring->fd >= 0) close(ring->fd);
+    memset(ring, 0, sizeof(*ring));
+    ring->fd = -1;
+}
+
+/**
+ * Create a ring with `entries` slots and map its queues. Returns false
+ * with errno set when the kernel has no (or a disabled) io_uring.
+ */
+static bool io_uring_open(IoUring *ring, unsigned entries) {
+    struct io_uring_params params;
+
+    memset(ring, 0, sizeof(*ring));
+    memset(&params, 0, sizeof(params));
+    ring->fd = (int)syscall(__NR_io_uring_setup, entries, &params);
+    if (ring->fd < 0) {
+        return false;
+    }
+
+    ring->sq_map_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cq_map_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        if (ring->cq_map_size > ring->sq_map_size) ring->sq_map_size = ring->cq_map_size;
+        ring->cq_map_size = ring->sq_map_size;
+    }
+
+    ring->sq_map = mmap(NULL, ring->sq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                        ring->fd, IORING_OFF_SQ_RING);
+    if (ring->sq_map == MAP_FAILED) {
+        ring->sq_map = NULL;
+        goto fail;
+    }
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        ring->cq_map = ring->sq_map;
+    } else {
+        ring->cq_map = mmap(NULL, ring->cq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                            ring->fd, IORING_OFF_CQ_RING);
+        if (ring->cq_map == MAP_FAILED) {
+            ring->cq_map = NULL;
+            goto fail;
+        }
+    }
+    ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    ring->sqes = mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      ring->fd, IORING_OFF_SQES);
+    if (ring->sqes == MAP_FAILED) {
+        ring->sqes = NULL;
+        goto fail;
+    }
+
+    char *sq = ring->sq_map;
+    char *cq = ring->cq_map;
+    ring->sq_head = (unsigned *)(sq + params.sq_off.head);
+    ring->sq_tail = (unsigned *)(sq + params.sq_off.tail);
+    ring->sq_mask = (unsigned *)(sq + params.sq_off.ring_mask);
+    ring->sq_array = (unsigned *)(sq + params.sq_off.array);
+    ring->cq_head = (unsigned *)(cq + params.cq_off.head);
+    ring->cq_tail = (unsigned *)(cq + params.cq_off.tail);
+    ring->cq_mask = (unsigned *)(cq + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe *)(cq + params.cq_off.cqes);
+    return true;
+
+fail: {
+        int saved = errno;
+        io_uring_release(ring);
+        errno = saved;
+        return false;
+    }
+}
+
+/**
+ * Queue one readv/writev for `slot`; published on the next enter
+ */
+static void io_uring_queue(IoUring *ring, const IoBenchJob *job, struct iovec *iov, unsigned slot,
+                           off_t offset) {
+    unsigned tail = *ring->sq_tail;
+    unsigned index = tail & *ring->sq_mask;
+    struct io_uring_sqe *sqe = &ring->sqes[index];
+
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = job->test->write ? IORING_OP_WRITEV : IORING_OP_READV;
+    sqe->fd = job->fd;
+    sqe->off = (unsigned long long)offset;
+    sqe->addr = (unsigned long long)(uintptr_t)iov;
+    sqe->len = 1;
+    sqe->user_data = slot;
+    ring->sq_array[index] = index;
+    __atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * Keep `depth` requests in flight until the deadline, then drain
+ */
+static bool run_io_uring(IoBenchJob *job, char *buffers, IoBenchResult *result) {
+    IoUring ring;
+    struct iovec iov[IOBENCH_MAX_DEPTH];
+    long long started[IOBENCH_MAX_DEPTH];
+    uint64_t rng = 0x9E3779B97F4A7C15ULL;
+    unsigned in_flight = 0, to_submit = 0;
+
+    if (!io_uring_open(&ring, (unsigned)job->depth)) {
+        return false;
+    }
+
+    for (int slot = 0; slot < job->depth; slot++) {
+        iov[slot].iov_base = buffers + (size_t)slot * job->block;
+        iov[slot].iov_len = job->block;
+        started[slot] = now_ns();
+        io_uring_queue(&ring, job, &iov[slot], (unsigned)slot, next_offset(job, &rng));
+        to_submit++;
+    }
+
+    while (to_submit > 0 || in_flight > 0) {
+        long ret = syscall(__NR_io_uring_enter, ring.fd, to_submit, 1, IORING_ENTER_GETEVENTS, NULL, 0);
+        if (ret < 0) {
+            if (errno == EINTR) continue;
+            record_error(result, errno);
+            break;
+        }
+        in_flight += (unsigned)ret;
+        to_submit -= (unsigned)ret;
+
+        long long now = now_ns();
+        bool more = now < job->deadline_ns;
+        unsigned head = *ring.cq_head;
+        unsigned tail = __atomic_load_n(ring.cq_tail, __ATOMIC_ACQUIRE);
+
+        while (head != tail) {
+            struct io_uring_cqe *cqe = &ring.cqes[head & *ring.cq_mask];
+            unsigned slot = (unsigned)cqe->user_data;
+            if (cqe->res < 0) {
+                record_error(result, -cqe->res);
+                more = false;       // A failing device fails fast, not for the whole run
+            } else {
+                record_latency(result, now - started[slot]);
+            }
+            in_flight--;
+            head++;
+            if (more) {
+                started[slot] = now;
+                io_uring_queue(&ring, job, &iov[slot], slot, next_offset(job, &rng));
+                to_submit++;
+            }
+        }
+        __atomic_store_n(ring.cq_head, head, __ATOMIC_RELEASE);
+    }
+
+    io_uring_release(&ring);
+    return true;
+}
+
+#endif
+
+typedef struct {
+    IoBenchJob *job;
+    char *buffer;
+    uint64_t rng;
+    IoBenchResult result;
+} IoBenchWorker;
+
+/**
+ * Thread-pool fallback: one synchronous request in flight per thread
+ */
+static void *io_bench_worker(void *arg) {
+    IoBenchWorker *worker = arg;
+    IoBenchJob *job = worker->job;
+
+    while (now_ns() < job->deadline_ns) {
+        off_t offset = next_offset(job, &worker->rng);
+        long long start = now_ns();
+        ssize_t n = job->test->write ? pwrite(job->fd, worker->buffer, job->block, offset)
+                                     : pread(job->fd, worker->buffer, job->block, offset);
+        if (n < 0) {
+            record_error(&worker->result, errno);
+            break;
+        }
+        record_latency(&worker->result, now_ns() - start);
+    }
+    return NULL;
+}
+
+static bool run_thread_pool(IoBenchJob *job, char *buffers, IoBenchResult *result) {
+    IoBenchWorker *workers = calloc((size_t)job->depth, sizeof(IoBenchWorker));
+    pthread_t *threads = calloc((size_t)job->depth, sizeof(pthread_t));
+    bool *started = calloc((size_t)job->depth, sizeof(bool));
+    bool ok = workers != NULL && threads != NULL && started != NULL;
+
+    for (int i = 0; ok && i < job->depth; i++) {
+        workers[i].job = job;
+        workers[i].buffer = buffers + (size_t)i * job->block;
+        workers[i].rng = 0x9E3779B97F4A7C15ULL * (uint64_t)(i + 1);
+        if (!result_init(&workers[i].result)) {
+            ok = false;
+            break;
+        }
+        started[i] = pthread_create(&threads[i], NULL, io_bench_worker, &workers[i]) == 0;
+    }
+    for (int i = 0; workers != NULL && i < job->depth; i++) {
+        if (started != NULL && started[i]) {
+            pthread_join(threads[i], NULL);
+            result_merge(result, &workers[i].result);
+        }
+        sketch_free(&workers[i].result.latency);
+    }
+    free(workers);
+    free(threads);
+    free(started);
+    return ok;
+}
+
+/**
+ * Write the whole scratch file once so reads hit real blocks, not holes
+ */
+static bool fill_scratch_file(int fd, off_t size, char *buffer, size_t chunk) {
+    uint64_t rng = 0x2545F4914F6CDD1DULL;
+
+    for (size_t i = 0; i < chunk / sizeof(uint64_t); i++) {
+        ((uint64_t *)buffer)[i] = xorshift64(&rng);    // Incompressible
+    }
+    for (off_t offset = 0; offset < size; offset += (off_t)chunk) {
+        size_t len = (size_t)(size - offset) < chunk ? (size_t)(size - offset) : chunk;
+        if (pwrite(fd, buffer, len, offset) != (ssize_t)len) {
+            return false;
+        }
+    }
+    return fdatasync(fd) == 0;
+}
+
+static void print_histogram(const IoBenchResult *result) {
+    int first = -1, last = -1;
+    unsigned long long peak = 0;
+
+    for (int i = 0; i < IOBENCH_HIST_BUCKETS; i++) {
+        if (result->hist[i] == 0) continue;
+        if (first < 0) first = i;
+        last = i;
+        if (result->hist[i] > peak) peak = result->hist[i];
+    }
+    for (int i = first; i >= 0 && i <= last; i++) {
+        char range[48];
+        char bar[41];
+        int width = (int)(40 * result->hist[i] / peak);
+
+        if (i == 0) {
+            snprintf(range, sizeof(range), "< 2 us");
+        } else {
+            snprintf(range, sizeof(range), "%llu-%llu us", 1ULL << i, (1ULL << (i + 1)) - 1);
+        }
+        memset(bar, '#', (size_t)width);
+        bar[width] = '\0';
+        printf("    %16s %6.2f%% %s\n", range, 100.0 * (double)result->hist[i] / (double)result->ops, bar);
+    }
+}
+
+#endif
+
+/**
+ * Run the four tests against a scratch file in `dir`. block_kb 0 uses
+ * 1 MB for sequential and 4 KB for random tests.
+ */
+void sysmon_io_bench(const char *dir, int block_kb, int queue_depth, int file_mb, int seconds,
+                     bool use_threads) {
+#ifndef __linux__
+    (void)dir; (void)block_kb; (void)queue_depth; (void)file_mb; (void)seconds; (void)use_threads;
+    print_warning("The disk benchmark is only available on Linux.");
+#else
+    char path[MAX_PATH_LENGTH + 32];
+    char message[MAX_PATH_LENGTH + 128];
+    struct statvfs fs;
+    IoBenchResult results[4];
+    IoBenchJob job;
+    bool direct;
+    bool uring_failed = use_threads;
+
+    if (dir == NULL || dir[0] == '\0') dir = ".";
+    if (queue_depth < 1) queue_depth = 1;
+    if (queue_depth > IOBENCH_MAX_DEPTH) queue_depth = IOBENCH_MAX_DEPTH;
+    if (file_mb < 16) file_mb = 16;
+    if (seconds < 1) seconds = 5;
+    if (block_kb < 0 || block_kb > 16384) {
+        print_error("Block size must be between 4 KB and 16 MB!");
+        return;
+    }
+    if (block_kb % 4 != 0) {
+        print_error("Block size must be a multiple of 4 KB for O_DIRECT!");
+        return;
+    }
+
+    if (statvfs(dir, &fs) != 0) {
+        snprintf(message, sizeof(message), "Cannot access %s: %s", dir, strerror(errno));
+        print_error(message);
+        return;
+    }
+    if ((unsigned long long)fs.f_bavail * fs.f_frsize < (unsigned long long)file_mb * 2 * 1024 * 1024) {
+        snprintf(message, sizeof(message), "Not enough free space in %s for a %d MB scratch file.", dir, file_mb);
+        print_error(message);
+        return;
+    }
+
+    // Unlinked right away so an interrupted run leaves nothing behind
+    snprintf(path, sizeof(path), "%s/.devhelper-iobench-XXXXXX", dir);
+    job.fd = mkostemp(path, O_CLOEXEC);
+    if (job.fd < 0) {
+        snprintf(message, sizeof(message), "Cannot create a scratch file in %s: %s", dir, strerror(errno));
+        print_error(message);
+        return;
+    }
+    unlink(path);
+    job.file_size = (off_t)file_mb * 1024 * 1024;
+
+    size_t max_block = block_kb > 0 ? (size_t)block_kb * 1024 : 1024 * 1024;
+    size_t buffer_size = max_block * (size_t)queue_depth;
+    if (buffer_size < 1024 * 1024) buffer_size = 1024 * 1024;
+    void *buffers = NULL;
+    if (posix_memalign(&buffers, 4096, buffer_size) != 0) {
+        print_error("Not enough memory for the I/O buffers!");
+        close(job.fd);
+        return;
+    }
+
+    printf("%sPreparing a %d MB scratch file in %s...%s\n", COLOR_CYAN, file_mb, dir, COLOR_RESET);
+    fflush(stdout);
+    if (!fill_scratch_file(job.fd, job.file_size, buffers, 1024 * 1024)) {
+        snprintf(message, sizeof(message), "Writing the scratch file failed: %s", strerror(errno));
+        print_error(message);
+        free(buffers);
+        close(job.fd);
+        return;
+    }
+
+    int flags = fcntl(job.fd, F_GETFL);
+    direct = fcntl(job.fd, F_SETFL, flags | O_DIRECT) == 0;
+    if (!direct) {
+        print_warning("This filesystem refuses O_DIRECT; results include the page cache.");
+    }
+
+    const char *engine = use_threads ? "threads" : "io_uring";
+#ifndef IOBENCH_HAVE_URING
+    uring_failed = true;
+    engine = "threads";
+#endif
+    int tests = (int)(sizeof(io_bench_tests) / sizeof(io_bench_tests[0]));
+    for (int t = 0; t < tests; t++) {
+        const IoBenchTest *test = &io_bench_tests[t];
+        IoBenchResult *result = &results[t];
+
+        if (!result_init(result)) {
+            print_error("Not enough memory for the latency histogram!");
+            for (int i = 0; i < t; i++) sketch_free(&results[i].latency);
+            free(buffers);
+            close(job.fd);
+            return;
+        }
+        job.test = test;
+        job.depth = queue_depth;
+        job.block = block_kb > 0 ? (size_t)block_kb * 1024 : (test->random ? 4096 : 1024 * 1024);
+        atomic_init(&job.next_offset, 0);
+        if (!direct && !test->write) {
+            posix_fadvise(job.fd, 0, 0, POSIX_FADV_DONTNEED);
+        }
+
+        if (isatty(STDOUT_FILENO)) {
+            printf("  %-10s %3d s...\r", test->name, seconds);
+            fflush(stdout);
+        }
+        long long start = now_ns();
+        job.deadline_ns = start + (long long)seconds * 1000000000LL;
+
+        bool ran = false;
+#ifdef IOBENCH_HAVE_URING
+        if (!uring_failed) {
+            ran = run_io_uring(&job, buffers, result);
+            if (!ran) {
+                snprintf(message, sizeof(message), "io_uring unavailable (%s), using a pread/pwrite thread pool.",
+                         strerror(errno));
+                print_warning(message);
+                uring_failed = true;
+                engine = "threads";
+                start = now_ns();
+                job.deadline_ns = start + (long long)seconds * 1000000000LL;
+            }
+        }
+#endif
+        if (!ran) {
+            run_thread_pool(&job, buffers, result);
+        }
+        double elapsed = (double)(now_ns() - start) / 1e9;
+
+        // The row is printed as each test finishes; histograms follow the table
+        if (t == 0) {
+            printf("%s%-10s %-8s %6s %4s %10s %9s %9s %9s %9s %9s %9s%s\n", COLOR_BOLD, "Test", "Engine",
+                   "Block", "QD", "IOPS", "MB/s", "avg us", "p50 us", "p99 us", "p99.9 us", "max us",
+                   COLOR_RESET);
+        }
+        char block_text[16];
+        if (job.block >= 1024 * 1024) {
+            snprintf(block_text, sizeof(block_text), "%zuM", job.block / (1024 * 1024));
+        } else {
+            snprintf(block_text, sizeof(block_text), "%zuK", job.block / 1024);
+        }
+        double iops = elapsed > 0.0 ? (double)result->ops / elapsed : 0.0;
+        double avg = result->ops > 0 ? result->latency.sum / (double)result->ops : 0.0;
+        printf("%-10s %-8s %6s %4d %10.0f %9.1f %9.1f %9.1f %9.1f %9.1f %9.1f\n", test->name, engine,
+               block_text, queue_depth, iops, iops * (double)job.block / 1048576.0, avg,
+               sketch_quantile(&result->latency, 0.50), sketch_quantile(&result->latency, 0.99),
+               sketch_quantile(&result->latency, 0.999), result->latency.max);
+        if (result->errors > 0) {
+            snprintf(message, sizeof(message), "%s: %llu failed requests (%s)", test->name, result->errors,
+                     strerror(result->first_errno));
+            print_error(message);
+        }
+        fflush(stdout);
+    }
+
+    for (int t = 0; t < tests; t++) {
+        if (results[t].ops > 0) {
+            printf("\n%s%s latency:%s\n", COLOR_CYAN, io_bench_tests[t].name, COLOR_RESET);
+            print_histogram(&results[t]);
+        }
+        sketch_free(&results[t].latency);
+    }
+
+    free(buffers);
+    close(job.fd);
+#endif
+}
@@ -0,0 +1,411 @@
+/**
+ * DevHelper+Portal CLI - Per-process I/O (iotop)
+ *
+ * Ranks processes by storage read/write rate and I/O syscall rate from
+ * /proc/[pid]/io. The process table already parses every stat file, so
+ * a pid whose CPU ticks have not moved since the last scan is assumed to
+ * have done no I/O and keeps its previous counters without opening its
+ * io file. Idle pids are still re-read in rotation, so I/O done in less
+ * than a tick of CPU time shows up a few scans late rather than never.
+ * Pids whose io file could not be opened (other users' processes, when
+ * not root) are only retried on that same rotation. On hosts with tens
+ * of thousands of mostly idle processes this skips most of the reads;
+ * the rest are spread over threads.
+ */
+
+#define _GNU_SOURCE
+#include "devhelper.h"
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#endif
+
+// Idle pids are re-read once every this many scans
+#define IOTOP_RECHECK 8
+#define IOTOP_PARALLEL_THRESHOLD 2048
+#define IOTOP_MAX_THREADS 8
+#define IOTOP_BATCH 64
+
+#ifdef __linux__
+
+/**
+ * Parse /proc/[pid]/io. Its seven lines always come in the same order
+ * (rchar, wchar, syscr, syscw, read_bytes, write_bytes,
+ * cancelled_write_bytes), so values are taken by position. Returns
+ * false when the file cannot be read.
+ */
+static bool parse_pid_io(int proc_fd, IoEntry *entry) {
+    static _Thread_local char buf[512];
+    char path[32];
+    unsigned long long values[7];
+
+    snprintf(path, sizeof(path), "%d/io", entry->pid);
+    int fd = openat(proc_fd, path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    ssize_t n = read(fd, buf, sizeof(buf) - 1);
+    close(fd);
+    if (n <= 0) {
+        return false;
+    }
+    buf[n] = '\0';
+
+    char *p = buf;
+    for (int i = 0; i < 7; i++) {
+        p = strchr(p, ':');
+        if (p == NULL) {
+            return false;
+        }
+        values[i] = strtoull(p + 1, &p, 10);
+    }
+    entry->syscr = values[2];
+    entry->syscw = values[3];
+    entry->read_bytes = values[4];
+    entry->write_bytes = values[5];
+    return true;
+}
+
+typedef struct {
+    IoTable *table;
+    atomic_int *next;
+} IoJob;
+
+/**
+ * Workers claim batches of entries; read_ms is 0 on those still to parse
+ */
+static void *io_worker(void *arg) {
+    IoJob *job = arg;
+    IoTable *table = job->table;
+
+    for (;;) {
+        int start = atomic_fetch_add(job->next, IOTOP_BATCH);
+        if (start >= table->count) {
+            break;
+        }
+        int end = start + IOTOP_BATCH < table->count ? start + IOTOP_BATCH : table->count;
+        for (int i = start; i < end; i++) {
+            IoEntry *entry = &table->entries[i];
+            if (entry->read_ms == 0) {
+                entry->readable = parse_pid_io(table->procs.proc_fd, entry);
+            }
+        }
+    }
+    return NULL;
+}
+
+static bool io_table_reserve(IoTable *table, int needed) {
+    if (needed <= table->capacity) {
+        return true;
+    }
+
+    int capacity = needed + needed / 2 + 64;
+    IoEntry *entries = realloc(table->entries, (size_t)capacity * sizeof(IoEntry));
+    if (entries == NULL) return false;
+    table->entries = entries;
+
+    IoEntry *previous = realloc(table->previous, (size_t)capacity * sizeof(IoEntry));
+    if (previous == NULL) return false;
+    table->previous = previous;
+
+    table->capacity = capacity;
+    return true;
+}
+
+static double per_second(unsigned long long prev, unsigned long long cur, double seconds) {
+    return cur > prev && seconds > 0.0 ? (double)(cur - prev) / seconds : 0.0;
+}
+
+#endif
+
+bool io_table_init(IoTable *table) {
+    memset(table, 0, sizeof(*table));
+#ifdef __linux__
+    return proc_table_init(&table->procs);
+#else
+    return false;
+#endif
+}
+
+void io_table_free(IoTable *table) {
+#ifdef __linux__
+    proc_table_free(&table->procs);
+#endif
+    free(table->entries);
+    free(table->previous);
+    memset(table, 0, sizeof(*table));
+}
+
+/**
+ * Rescan processes and update I/O rates, reading /proc/[pid]/io only
+ * for pids that ran since the last scan (or are due a recheck).
+ * Returns the number of processes, or -1 on error.
+ */
+int io_table_refresh(IoTable *table) {
+#ifndef __linux__
+    (void)table;
+    return -1;
+#else
+    long long started = monotonic_ms();
+    int count = proc_table_refresh(&table->procs);
+    if (count < 0 || !io_table_reserve(table, count)) {
+        return -1;
+    }
+
+    // Swap so the last scan becomes `previous`
+    IoEntry *swap = table->previous;
+    table->previous = table->entries;
+    table->entries = swap;
+    int prev_count = table->count;
+    table->count = count;
+    table->scans++;
+
+    // Merge-join with the previous scan (both sorted by pid). Entries
+    // left with read_ms == 0 are parsed below.
+    int j = 0;
+    for (int i = 0; i < count; i++) {
+        const ProcEntry *proc = &table->procs.entries[i];
+        IoEntry *entry = &table->entries[i];
+        memset(entry, 0, sizeof(*entry));
+        entry->pid = proc->pid;
+        entry->start_time = proc->start_time;
+        entry->cpu_ticks = proc->cpu_ticks;
+
+        while (j < prev_count && table->previous[j].pid < proc->pid) j++;
+        const IoEntry *old = j < prev_count && table->previous[j].pid == proc->pid &&
+                             table->previous[j].start_time == proc->start_time ? &table->previous[j] : NULL;
+        if (old == NULL || ((unsigned long)proc->pid + table->scans) % IOTOP_RECHECK == 0) {
+            continue;
+        }
+        if (!old->readable) {
+            entry->read_ms = old->read_ms;      // Still unreadable until the recheck
+        } else if (old->cpu_ticks == proc->cpu_ticks) {
+            entry->readable = true;
+            entry->syscr = old->syscr;
+            entry->syscw = old->syscw;
+            entry->read_bytes = old->read_bytes;
+            entry->write_bytes = old->write_bytes;
+            entry->read_ms = old->read_ms;
+        }
+    }
+
+    int pending = 0;
+    for (int i = 0; i < count; i++) {
+        pending += table->entries[i].read_ms == 0;
+    }
+    atomic_int next = 0;
+    IoJob job = { table, &next };
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int workers = pending > IOTOP_PARALLEL_THRESHOLD ? (int)cpus : 1;
+    if (workers > IOTOP_MAX_THREADS) workers = IOTOP_MAX_THREADS;
+
+    pthread_t threads[IOTOP_MAX_THREADS];
+    bool started_thread[IOTOP_MAX_THREADS] = { false };
+    for (int w = 1; w < workers; w++) {
+        started_thread[w] = pthread_create(&threads[w], NULL, io_worker, &job) == 0;
+    }
+    io_worker(&job);
+    for (int w = 1; w < workers; w++) {
+        if (started_thread[w]) pthread_join(threads[w], NULL);
+    }
+
+    // Rates for freshly parsed entries cover the time since their last
+    // parse, so a late recheck spreads its I/O instead of spiking. Failed
+    // parses are stamped too, so the next scan carries them forward.
+    table->parsed = pending;
+    table->unreadable = 0;
+    table->total_read_rate = 0.0;
+    table->total_write_rate = 0.0;
+    j = 0;
+    for (int i = 0; i < count; i++) {
+        IoEntry *entry = &table->entries[i];
+        bool fresh = entry->read_ms == 0;
+        if (fresh) {
+            entry->read_ms = started;
+        }
+        if (!entry->readable) {
+            table->unreadable++;
+            continue;
+        }
+        if (!fresh) {
+            continue;
+        }
+
+        while (j < prev_count && table->previous[j].pid < entry->pid) j++;
+        const IoEntry *old = &table->previous[j];
+        if (j < prev_count && old->pid == entry->pid && old->start_time == entry->start_time &&
+            old->readable) {
+            double seconds = (double)(started - old->read_ms) / 1000.0;
+            entry->read_rate = per_second(old->read_bytes, entry->read_bytes, seconds);
+            entry->write_rate = per_second(old->write_bytes, entry->write_bytes, seconds);
+            entry->syscr_rate = per_second(old->syscr, entry->syscr, seconds);
+            entry->syscw_rate = per_second(old->syscw, entry->syscw, seconds);
+            table->total_read_rate += entry->read_rate;
+            table->total_write_rate += entry->write_rate;
+        }
+    }
+
+    table->scan_ms = monotonic_ms() - started;
+    return count;
+#endif
+}
+
+/**
+ * Select the top N entries by the given rate, largest first.
+ * `out` receives indexes into table->entries.
+ */
+int io_table_top(const IoTable *table, IoSortKey key, TopNItem *out, int n) {
+    TopNHeap heap;
+
+    topn_init(&heap, out, n);
+    for (int i = 0; i < table->count; i++) {
+        const IoEntry *e = &table->entries[i];
+        double value;
+        switch (key) {
+            case IOTOP_SORT_READ:     value = e->read_rate; break;
+            case IOTOP_SORT_WRITE:    value = e->write_rate; break;
+            case IOTOP_SORT_SYSCALLS: value = e->syscr_rate + e->syscw_rate; break;
+            default:                  value = e->read_rate + e->write_rate; break;
+        }
+        if (value > 0.0) {
+            topn_offer(&heap, value, i);
+        }
+    }
+    return topn_finish(&heap);
+}
+
+#ifdef __linux__
+
+static const char *io_sort_name(IoSortKey key) {
+    switch (key) {
+        case IOTOP_SORT_READ:     return "disk read";
+        case IOTOP_SORT_WRITE:    return "disk write";
+        case IOTOP_SORT_SYSCALLS: return "I/O syscalls";
+        default:                  return "disk read + write";
+    }
+}
+
+static void format_rate(double bytes_per_s, char *out, size_t size) {
+    char text[16];
+
+    format_kb((unsigned long long)(bytes_per_s / 1024.0), text, sizeof(text));
+    snprintf(out, size, "%s/s", text);
+}
+
+static void render_iotop_frame(LiveScreen *screen, const IoTable *table, IoSortKey key,
+                               TopNItem *top, int interval_ms) {
+    char read_text[24], write_text[24], total_read[16], total_written[16];
+    int row = 0;
+
+    live_screen_begin(screen);
+    format_rate(table->total_read_rate, read_text, sizeof(read_text));
+    format_rate(table->total_write_rate, write_text, sizeof(write_text));
+    live_screen_print(screen, row, 0, CELL_BOLD, "DevHelper Process I/O");
+    live_screen_print(screen, row++, 23, CELL_CYAN, "read %s  write %s  %d processes, %d io files read  scan %lld/%d ms",
+                      read_text, write_text, table->count, table->parsed, table->scan_ms, interval_ms);
+    live_screen_print(screen, row++, 0, CELL_DEFAULT,
+                      "Sorted by %s  [t] total [r] read [w] write [s] syscalls  any other key exits",
+                      io_sort_name(key));
+    if (table->unreadable > 0) {
+        live_screen_print(screen, row, 0, CELL_YELLOW,
+                          "%d processes not readable (other users' processes need root)",
+                          table->unreadable);
+    }
+    row++;
+
+    live_screen_print(screen, row++, 0, CELL_BOLD, "%7s %10s %10s %9s %9s %9s %9s  %s",
+                      "PID", "READ", "WRITE", "SYSCR/s", "SYSCW/s", "READ TOT", "WRIT TOT", "COMMAND");
+
+    int n = screen->rows - row;
+    if (n > PROC_TOP_MAX) n = PROC_TOP_MAX;
+    if (n < 1) return;
+
+    int count = io_table_top(table, key, top, n);
+    for (int i = 0; i < count; i++) {
+        const IoEntry *e = &table->entries[top[i].index];
+        format_rate(e->read_rate, read_text, sizeof(read_text));
+        format_rate(e->write_rate, write_text, sizeof(write_text));
+        format_kb(e->read_bytes / 1024, total_read, sizeof(total_read));
+        format_kb(e->write_bytes / 1024, total_written, sizeof(total_written));
+
+        // Anything over 50 MB/s is a likely cause of a busy disk
+        CellColor color = e->read_rate + e->write_rate >= 50e6 ? CELL_RED : CELL_DEFAULT;
+        live_screen_print(screen, row++, 0, color, "%7d %10s %10s %9.0f %9.0f %9s %9s  %s",
+                          e->pid, read_text, write_text, e->syscr_rate, e->syscw_rate, total_read, total_written,
+                          table->procs.entries[top[i].index].comm);
+    }
+    if (count == 0) {
+        live_screen_print(screen, row, 0, CELL_CYAN, "No process did any I/O in the last interval");
+    }
+}
+
+#endif
+
+/**
+ * Live per-process I/O view, refreshed like iotop
+ */
+void sysmon_iotop_view(int interval_ms) {
+#ifndef __linux__
+    (void)interval_ms;
+    print_warning("The process I/O view reads /proc and is only available on Linux.");
+#else
+    static TopNItem top[PROC_TOP_MAX];
+    IoTable table;
+    LiveScreen screen;
+    IoSortKey key = IOTOP_SORT_TOTAL;
+
+    if (interval_ms < 250) interval_ms = 250;
+    if (interval_ms > 10000) interval_ms = 10000;
+
+    if (!io_table_init(&table)) {
+        print_error("Could not open /proc!");
+        return;
+    }
+    if (!live_screen_init(&screen)) {
+        print_error("Not enough memory for the process I/O view!");
+        io_table_free(&table);
+        return;
+    }
+
+    terminal_set_raw(true);
+    io_table_refresh(&table);
+    render_iotop_frame(&screen, &table, key, top, interval_ms);
+    live_screen_flush(&screen);
+
+    long long next_tick = monotonic_ms() + interval_ms;
+    for (;;) {
+        int k = wait_for_key((int)(next_tick - monotonic_ms()));
+        if (k == 't' || k == 'T') {
+            key = IOTOP_SORT_TOTAL;
+        } else if (k == 'r' || k == 'R') {
+            key = IOTOP_SORT_READ;
+        } else if (k == 'w' || k == 'W') {
+            key = IOTOP_SORT_WRITE;
+        } else if (k == 's' || k == 'S') {
+            key = IOTOP_SORT_SYSCALLS;
+        } else if (k >= 0) {
+            break;
+        }
+
+        if (k < 0) {
+            if (io_table_refresh(&table) < 0) {
+                break;
+            }
+            next_tick += interval_ms;
+            if (next_tick <= monotonic_ms()) {
+                next_tick = monotonic_ms() + interval_ms;
+            }
+        }
+        render_iotop_frame(&screen, &table, key, top, interval_ms);
+        live_screen_flush(&screen);
+    }
+
+    terminal_set_raw(false);
+    printf("%s\033[H\033[2J", COLOR_RESET);
+    fflush(stdout);
+    live_screen_free(&screen);
+    io_table_free(&table);
+#endif
+}
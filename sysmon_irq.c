@@ -0,0 +1,533 @@
+/**
+ * DevHelper+Portal CLI - Interrupt, SoftIRQ and Scheduler View
+ *
+ * Per-CPU rates from /proc/interrupts, /proc/softirqs and
+ * /proc/schedstat, for latency that doesn't show up as CPU%: an IRQ or
+ * softirq storm pinned to one core, or tasks queueing for a CPU. The
+ * CPU taking most of the NIC interrupts is highlighted. NIC IRQs are
+ * found once at start, from the devices' msi_irqs and from interface
+ * names in the IRQ descriptions, and kept in a bitmap.
+ *
+ * /proc/interrupts grows to megabytes on many-core hosts, so the files
+ * are read into one buffer that only grows when a read fills it, and
+ * parsed in place into fixed arrays: steady-state sampling allocates
+ * nothing. Offline CPUs have no column in /proc/interrupts or
+ * /proc/softirqs, so columns are mapped to CPU numbers through the
+ * "CPUn" headers and every per-CPU array is indexed by CPU number.
+ */
+
+#define _GNU_SOURCE
+#include "devhelper.h"
+
+#ifdef __linux__
+#include <dirent.h>
+#include <limits.h>
+#endif
+
+#ifdef __linux__
+
+#define IRQ_MAX_SOURCES 2048
+#define IRQ_MAX_NUMBER 16384                // Bitmap range for numbered IRQs
+#define SOFTIRQ_MAX_TYPES 12
+#define IRQ_TOP_SOURCES 6
+#define IRQ_NIC_NAME 24
+#define IRQ_MAX_NICS 32
+
+typedef struct {
+    char name[16];                          // "24", "NMI", "LOC"
+    char desc[64];
+    unsigned long long total;
+    bool net;
+} IrqSource;
+
+typedef struct {
+    long long time_ms;
+    int cpu_count;                          // Online CPUs, one per column
+    int cpus[SYSMON_MAX_CPUS];              // Their CPU numbers
+    unsigned long long irq[SYSMON_MAX_CPUS];
+    unsigned long long net_irq[SYSMON_MAX_CPUS];
+    int softirq_types;
+    char softirq_names[SOFTIRQ_MAX_TYPES][12];
+    unsigned long long softirq[SOFTIRQ_MAX_TYPES][SYSMON_MAX_CPUS];
+    bool has_schedstat;
+    unsigned long long wait_ns[SYSMON_MAX_CPUS];        // Runnable but not running
+    unsigned long long slices[SYSMON_MAX_CPUS];         // Times a task was switched in
+    int source_count;
+    IrqSource sources[IRQ_MAX_SOURCES];
+    CpuSnapshot cpu;
+} IrqSnapshot;
+
+typedef struct {
+    char *buf;                              // Shared by all three files
+    size_t capacity;
+    unsigned char net_irqs[IRQ_MAX_NUMBER / 8];
+    char net_names[IRQ_MAX_NICS][IRQ_NIC_NAME];     // Matched against IRQ descriptions
+    int net_name_count;
+} IrqReader;
+
+/**
+ * Read a /proc file whole, growing the buffer only when it was too small
+ */
+static long read_whole(IrqReader *reader, const char *path) {
+    for (;;) {
+        long n = sysmon_read_file(path, reader->buf, reader->capacity);
+        if (n < 0 || (size_t)n + 1 < reader->capacity) {
+            return n;
+        }
+        char *grown = realloc(reader->buf, reader->capacity * 2);
+        if (grown == NULL) {
+            return n;
+        }
+        reader->buf = grown;
+        reader->capacity *= 2;
+    }
+}
+
+static void mark_net_irq(IrqReader *reader, long irq) {
+    if (irq >= 0 && irq < IRQ_MAX_NUMBER) {
+        reader->net_irqs[irq / 8] |= (unsigned char)(1u << (irq % 8));
+    }
+}
+
+static bool is_net_irq(const IrqReader *reader, long irq) {
+    return irq >= 0 && irq < IRQ_MAX_NUMBER && (reader->net_irqs[irq / 8] & (1u << (irq % 8)));
+}
+
+/**
+ * Add every IRQ listed in <dir>/msi_irqs
+ */
+static bool mark_msi_irqs(IrqReader *reader, const char *dir) {
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s/msi_irqs", dir);
+    DIR *d = opendir(path);
+    if (d == NULL) {
+        return false;
+    }
+    struct dirent *entry;
+    while ((entry = readdir(d)) != NULL) {
+        if (entry->d_name[0] >= '0' && entry->d_name[0] <= '9') {
+            mark_net_irq(reader, atol(entry->d_name));
+        }
+    }
+    closedir(d);
+    return true;
+}
+
+/**
+ * Find NIC interrupts: MSI vectors of each physical interface's device
+ * (or its PCI parent, for virtio), plus IRQs whose description names
+ * the interface or its virtio device ("eth0-TxRx-0", "virtio3-input.0")
+ */
+static void find_net_irqs(IrqReader *reader) {
+    DIR *d = opendir("/sys/class/net");
+    struct dirent *entry;
+
+    memset(reader->net_irqs, 0, sizeof(reader->net_irqs));
+    reader->net_name_count = 0;
+    while (d != NULL && (entry = readdir(d)) != NULL) {
+        char link[PATH_MAX], device[PATH_MAX];
+        if (entry->d_name[0] == '.') {
+            continue;
+        }
+        snprintf(link, sizeof(link), "/sys/class/net/%s/device", entry->d_name);
+        if (realpath(link, device) == NULL) {
+            continue;               // Virtual interface: lo, bridges, tunnels
+        }
+        if (!mark_msi_irqs(reader, device)) {
+            char *slash = strrchr(device, '/');
+            if (slash != NULL && strncmp(slash + 1, "virtio", 6) == 0) {
+                if (reader->net_name_count < IRQ_MAX_NICS) {
+                    snprintf(reader->net_names[reader->net_name_count++], IRQ_NIC_NAME, "%.22s-", slash + 1);
+                }
+                *slash = '\0';
+                mark_msi_irqs(reader, device);
+            }
+        }
+        if (reader->net_name_count < IRQ_MAX_NICS) {
+            snprintf(reader->net_names[reader->net_name_count++], IRQ_NIC_NAME, "%.23s", entry->d_name);
+        }
+    }
+    if (d != NULL) closedir(d);
+}
+
+static bool desc_names_nic(const IrqReader *reader, const char *desc) {
+    for (int i = 0; i < reader->net_name_count; i++) {
+        if (strstr(desc, reader->net_names[i]) != NULL) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static const char *skip_spaces(const char *p) {
+    while (*p == ' ' || *p == '\t') p++;
+    return p;
+}
+
+/**
+ * Map the "CPU0 CPU1 CPU3" header line to CPU numbers, one per column
+ * (-1 for CPU numbers past SYSMON_MAX_CPUS). Returns the column count.
+ */
+static int parse_cpu_header(const char *line, const char *eol, int *column_cpu) {
+    int columns = 0;
+
+    for (const char *c = line; columns < SYSMON_MAX_CPUS && (c = strstr(c, "CPU")) != NULL &&
+                               (eol == NULL || c < eol); c += 3) {
+        int cpu = atoi(c + 3);
+        column_cpu[columns++] = cpu >= 0 && cpu < SYSMON_MAX_CPUS ? cpu : -1;
+    }
+    return columns;
+}
+
+/**
+ * Parse /proc/interrupts in place into per-CPU totals and per-source sums
+ */
+static bool read_interrupts(IrqReader *reader, IrqSnapshot *snap, bool classify) {
+    if (read_whole(reader, "/proc/interrupts") <= 0) {
+        return false;
+    }
+
+    // Header: one "CPUn" per online CPU column
+    const char *p = reader->buf;
+    const char *eol = strchr(p, '\n');
+    int column_cpu[SYSMON_MAX_CPUS];
+    int columns = parse_cpu_header(p, eol, column_cpu);
+    snap->cpu_count = 0;
+    for (int i = 0; i < columns; i++) {
+        if (column_cpu[i] >= 0) snap->cpus[snap->cpu_count++] = column_cpu[i];
+    }
+    memset(snap->irq, 0, sizeof(snap->irq));
+    memset(snap->net_irq, 0, sizeof(snap->net_irq));
+    snap->source_count = 0;
+
+    for (p = eol != NULL ? eol + 1 : p + strlen(p); *p != '\0'; ) {
+        eol = strchr(p, '\n');
+        const char *end = eol != NULL ? eol : p + strlen(p);
+        const char *colon = memchr(p, ':', (size_t)(end - p));
+        if (colon == NULL) {
+            p = eol != NULL ? eol + 1 : end;
+            continue;
+        }
+
+        const char *name = skip_spaces(p);
+        long number = (*name >= '0' && *name <= '9') ? atol(name) : -1;
+        IrqSource *source = snap->source_count < IRQ_MAX_SOURCES ? &snap->sources[snap->source_count++] : NULL;
+        bool net = is_net_irq(reader, number);
+        // ERR: and MIS: are single machine-wide counts, not per-CPU columns
+        bool per_cpu = strncmp(name, "ERR:", 4) != 0 && strncmp(name, "MIS:", 4) != 0;
+
+        const char *q = colon + 1;
+        unsigned long long total = 0;
+        for (int column = 0; column < columns; column++) {
+            q = skip_spaces(q);
+            if (q >= end || *q < '0' || *q > '9') {
+                break;              // ERR:, MIS: have a single column
+            }
+            char *after;
+            unsigned long long count = strtoull(q, &after, 10);
+            q = after;
+            total += count;
+            int cpu = column_cpu[column];
+            if (cpu < 0) continue;
+            if (per_cpu) snap->irq[cpu] += count;
+            if (net) snap->net_irq[cpu] += count;
+        }
+
+        if (source != NULL) {
+            size_t name_len = (size_t)(colon - name);
+            if (name_len >= sizeof(source->name)) name_len = sizeof(source->name) - 1;
+            memcpy(source->name, name, name_len);
+            source->name[name_len] = '\0';
+            // Description: the chip and hwirq fields, then the handler names;
+            // runs of padding collapsed so the handler names fit
+            q = skip_spaces(q);
+            size_t desc_len = 0;
+            for (; q < end && desc_len + 1 < sizeof(source->desc); q++) {
+                if (*q == ' ' && desc_len > 0 && source->desc[desc_len - 1] == ' ') {
+                    continue;
+                }
+                source->desc[desc_len++] = *q;
+            }
+            source->desc[desc_len] = '\0';
+            source->total = total;
+            if (classify && number >= 0 && !net && desc_names_nic(reader, source->desc)) {
+                // Only the first read classifies; later ones use the bitmap
+                mark_net_irq(reader, number);
+                net = true;
+            }
+            source->net = net;
+        }
+        p = eol != NULL ? eol + 1 : end;
+    }
+    return true;
+}
+
+static void read_softirqs(IrqReader *reader, IrqSnapshot *snap) {
+    int column_cpu[SYSMON_MAX_CPUS];
+
+    snap->softirq_types = 0;
+    memset(snap->softirq, 0, sizeof(snap->softirq));
+    if (read_whole(reader, "/proc/softirqs") <= 0) {
+        return;
+    }
+    const char *p = strchr(reader->buf, '\n');
+    int columns = parse_cpu_header(reader->buf, p, column_cpu);
+    while (p != NULL && *++p != '\0' && snap->softirq_types < SOFTIRQ_MAX_TYPES) {
+        const char *name = skip_spaces(p);
+        const char *colon = strchr(name, ':');
+        const char *eol = strchr(name, '\n');
+        if (colon == NULL || (eol != NULL && colon > eol)) {
+            break;
+        }
+        int t = snap->softirq_types++;
+        size_t len = (size_t)(colon - name);
+        if (len >= sizeof(snap->softirq_names[t])) len = sizeof(snap->softirq_names[t]) - 1;
+        memcpy(snap->softirq_names[t], name, len);
+        snap->softirq_names[t][len] = '\0';
+
+        const char *q = colon + 1;
+        for (int column = 0; column < columns; column++) {
+            char *after;
+            q = skip_spaces(q);
+            if (*q < '0' || *q > '9') {
+                break;
+            }
+            unsigned long long count = strtoull(q, &after, 10);
+            q = after;
+            if (column_cpu[column] >= 0) {
+                snap->softirq[t][column_cpu[column]] = count;
+            }
+        }
+        p = eol;
+    }
+}
+
+/**
+ * cpuN lines of /proc/schedstat: field 8 is run-queue wait in ns and
+ * field 9 the number of timeslices run. Absent without CONFIG_SCHEDSTATS.
+ */
+static void read_schedstat(IrqReader *reader, IrqSnapshot *snap) {
+    snap->has_schedstat = false;
+    if (read_whole(reader, "/proc/schedstat") <= 0) {
+        return;
+    }
+    for (const char *p = reader->buf; *p != '\0'; ) {
+        const char *eol = strchr(p, '\n');
+        const char *line = p;
+        int cpu;
+        p = eol != NULL ? eol + 1 : line + strlen(line);
+        unsigned long long f[9];
+        if (strncmp(line, "cpu", 3) != 0 ||
+            sscanf(line, "cpu%d %llu %llu %llu %llu %llu %llu %llu %llu %llu", &cpu, &f[0], &f[1], &f[2], &f[3],
+                   &f[4], &f[5], &f[6], &f[7], &f[8]) != 10) {
+            continue;
+        }
+        if (cpu >= 0 && cpu < SYSMON_MAX_CPUS) {
+            snap->wait_ns[cpu] = f[7];
+            snap->slices[cpu] = f[8];
+            snap->has_schedstat = true;
+        }
+    }
+}
+
+static bool irq_sample(IrqReader *reader, IrqSnapshot *snap, bool classify) {
+    snap->time_ms = monotonic_ms();
+    if (!read_interrupts(reader, snap, classify)) {
+        return false;
+    }
+    read_softirqs(reader, snap);
+    read_schedstat(reader, snap);
+    sysmon_read_cpu(&snap->cpu);
+    return true;
+}
+
+static int softirq_index(const IrqSnapshot *snap, const char *name) {
+    for (int t = 0; t < snap->softirq_types; t++) {
+        if (strcmp(snap->softirq_names[t], name) == 0) return t;
+    }
+    return -1;
+}
+
+static double rate(unsigned long long prev, unsigned long long cur, double seconds) {
+    return cur >= prev && seconds > 0.0 ? (double)(cur - prev) / seconds : 0.0;
+}
+
+static unsigned long long softirq_sum(const IrqSnapshot *snap, int cpu) {
+    unsigned long long sum = 0;
+    for (int t = 0; t < snap->softirq_types; t++) sum += snap->softirq[t][cpu];
+    return sum;
+}
+
+static void render_irq_frame(LiveScreen *screen, const IrqSnapshot *prev, const IrqSnapshot *cur,
+                             int interval_ms) {
+    static TopNItem top[SYSMON_MAX_CPUS];
+    static TopNItem top_sources[IRQ_TOP_SOURCES];
+    TopNHeap heap;
+    double seconds = (double)(cur->time_ms - prev->time_ms) / 1000.0;
+    int cpus = cur->cpu_count;
+    int net_rx = softirq_index(cur, "NET_RX"), net_tx = softirq_index(cur, "NET_TX");
+    int timer = softirq_index(cur, "TIMER"), rcu = softirq_index(cur, "RCU");
+    double irq_total = 0.0, net_total = 0.0, soft_total = 0.0, net_max = 0.0;
+    int net_cpu = -1, row = 0;
+
+    for (int i = 0; i < cpus; i++) {
+        int c = cur->cpus[i];
+        double net = rate(prev->net_irq[c], cur->net_irq[c], seconds);
+        irq_total += rate(prev->irq[c], cur->irq[c], seconds);
+        soft_total += rate(softirq_sum(prev, c), softirq_sum(cur, c), seconds);
+        net_total += net;
+        if (net > net_max) {
+            net_max = net;
+            net_cpu = c;
+        }
+    }
+    double net_share = net_total > 0.0 ? net_max / net_total : 0.0;
+    // One CPU taking most NIC interrupts on a multi-core box is worth shouting about
+    bool imbalance = cpus > 1 && net_total >= 100.0 && net_share >= 0.6;
+
+    live_screen_begin(screen);
+    live_screen_print(screen, row, 0, CELL_BOLD, "DevHelper IRQ / SoftIRQ / Scheduler");
+    live_screen_print(screen, row++, 38, CELL_CYAN, "every %d ms, %d CPUs (any key quits)", interval_ms, cpus);
+    live_screen_print(screen, row++, 0, CELL_DEFAULT,
+                      "IRQ %.0f/s   NIC IRQ %.0f/s   SoftIRQ %.0f/s   ctx switches %.0f/s   runnable %d",
+                      irq_total, net_total, soft_total,
+                      rate(prev->cpu.context_switches, cur->cpu.context_switches, seconds),
+                      cur->cpu.procs_running);
+    if (imbalance) {
+        live_screen_print(screen, row++, 0, CELL_RED,
+                          "CPU %d takes %.0f%% of NIC interrupts - spread queues (RSS, smp_affinity, irqbalance)",
+                          net_cpu, net_share * 100.0);
+    } else if (!cur->has_schedstat) {
+        live_screen_print(screen, row++, 0, CELL_YELLOW,
+                          "/proc/schedstat unavailable (CONFIG_SCHEDSTATS off): no per-CPU run-queue wait");
+    } else {
+        row++;
+    }
+    row++;
+
+    live_screen_print(screen, row++, 0, CELL_BOLD, "%-5s %6s %10s %10s %10s %9s %9s %9s %9s %11s %9s",
+                      "CPU", "Busy%", "IRQ/s", "NIC IRQ/s", "SIRQ/s", "NET_RX/s", "NET_TX/s", "TIMER/s",
+                      "RCU/s", "RQwait ms/s", "Sched/s");
+
+    // Busiest CPUs by interrupt + softirq load first, as many as fit
+    int room = screen->rows - row - IRQ_TOP_SOURCES - 3;
+    if (room < 1) room = 1;
+    if (room > cpus) room = cpus;
+    topn_init(&heap, top, room);
+    for (int i = 0; i < cpus; i++) {
+        int c = cur->cpus[i];
+        topn_offer(&heap, rate(prev->irq[c], cur->irq[c], seconds) +
+                          rate(softirq_sum(prev, c), softirq_sum(cur, c), seconds) - c * 1e-9, c);
+    }
+    int shown = topn_finish(&heap);
+    for (int i = 0; i < shown; i++) {
+        int c = top[i].index;
+        double busy = c < cur->cpu.cpu_count ? sysmon_cpu_busy_percent(&prev->cpu.cpu[c], &cur->cpu.cpu[c]) : 0.0;
+        CellColor color = imbalance && c == net_cpu ? CELL_RED : CELL_DEFAULT;
+        char sched[32] = "-", wait[32] = "-";
+        if (cur->has_schedstat && prev->has_schedstat) {
+            snprintf(wait, sizeof(wait), "%.1f", rate(prev->wait_ns[c], cur->wait_ns[c], seconds) / 1e6);
+            snprintf(sched, sizeof(sched), "%.0f", rate(prev->slices[c], cur->slices[c], seconds));
+        }
+        live_screen_print(screen, row++, 0, color, "%-5d %6.1f %10.0f %10.0f %10.0f %9.0f %9.0f %9.0f %9.0f %11s %9s",
+                          c, busy, rate(prev->irq[c], cur->irq[c], seconds),
+                          rate(prev->net_irq[c], cur->net_irq[c], seconds),
+                          rate(softirq_sum(prev, c), softirq_sum(cur, c), seconds),
+                          net_rx >= 0 ? rate(prev->softirq[net_rx][c], cur->softirq[net_rx][c], seconds) : 0.0,
+                          net_tx >= 0 ? rate(prev->softirq[net_tx][c], cur->softirq[net_tx][c], seconds) : 0.0,
+                          timer >= 0 ? rate(prev->softirq[timer][c], cur->softirq[timer][c], seconds) : 0.0,
+                          rcu >= 0 ? rate(prev->softirq[rcu][c], cur->softirq[rcu][c], seconds) : 0.0,
+                          wait, sched);
+    }
+    if (shown < cpus) {
+        live_screen_print(screen, row++, 0, CELL_CYAN, "... %d quieter CPUs not shown", cpus - shown);
+    }
+
+    // Busiest interrupt sources; rows keep their order between reads
+    row++;
+    live_screen_print(screen, row++, 0, CELL_BOLD, "%-8s %10s  %s", "IRQ", "Rate/s", "Source");
+    topn_init(&heap, top_sources, IRQ_TOP_SOURCES);
+    for (int i = 0; i < cur->source_count; i++) {
+        const IrqSource *source = &cur->sources[i];
+        const IrqSource *old = i < prev->source_count && strcmp(prev->sources[i].name, source->name) == 0
+                             ? &prev->sources[i] : NULL;
+        if (old != NULL && source->total > old->total) {
+            topn_offer(&heap, rate(old->total, source->total, seconds), i);
+        }
+    }
+    shown = topn_finish(&heap);
+    for (int i = 0; i < shown && row < screen->rows; i++) {
+        const IrqSource *source = &cur->sources[top_sources[i].index];
+        live_screen_print(screen, row++, 0, source->net ? CELL_GREEN : CELL_DEFAULT, "%-8s %10.0f  %s%s",
+                          source->name, top_sources[i].key, source->desc, source->net ? "  [NIC]" : "");
+    }
+}
+
+#endif
+
+/**
+ * Live per-CPU interrupt, softirq and run-queue rates
+ */
+void sysmon_irq_view(int interval_ms) {
+#ifndef __linux__
+    (void)interval_ms;
+    print_warning("The interrupt view reads /proc and is only available on Linux.");
+#else
+    static IrqSnapshot snaps[2];
+    static IrqReader reader;
+    LiveScreen screen;
+
+    if (interval_ms < 100) interval_ms = 100;
+    if (interval_ms > 5000) interval_ms = 5000;
+
+    reader.capacity = 64 * 1024;
+    reader.buf = malloc(reader.capacity);
+    if (reader.buf == NULL || !live_screen_init(&screen)) {
+        print_error("Not enough memory for the interrupt view!");
+        free(reader.buf);
+        return;
+    }
+    find_net_irqs(&reader);
+
+    IrqSnapshot *prev = &snaps[0], *cur = &snaps[1];
+    if (!irq_sample(&reader, prev, true)) {
+        print_error("Could not read /proc/interrupts!");
+        free(reader.buf);
+        live_screen_free(&screen);
+        return;
+    }
+    // The first read may have found more NIC IRQs by name; count them from here
+    irq_sample(&reader, prev, false);
+    *cur = *prev;
+
+    terminal_set_raw(true);
+    render_irq_frame(&screen, prev, cur, interval_ms);
+    live_screen_flush(&screen);
+
+    long long next_tick = monotonic_ms() + interval_ms;
+    while (wait_for_key((int)(next_tick - monotonic_ms())) < 0) {
+        long long now = monotonic_ms();
+        if (now < next_tick) {
+            continue;
+        }
+        next_tick += interval_ms;
+        if (next_tick <= now) {
+            next_tick = now + interval_ms;
+        }
+
+        IrqSnapshot *swap = prev;
+        prev = cur;
+        cur = swap;
+        irq_sample(&reader, cur, false);
+        render_irq_frame(&screen, prev, cur, interval_ms);
+        live_screen_flush(&screen);
+    }
+
+    terminal_set_raw(false);
+    printf("%s\033[H\033[2J", COLOR_RESET);
+    fflush(stdout);
+    free(reader.buf);
+    reader.buf = NULL;
+    live_screen_free(&screen);
+#endif
+}
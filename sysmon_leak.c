@@ -0,0 +1,576 @@
+/**
+ * DevHelper+Portal CLI - Memory Growth (Leak) Watch
+ *
+ * Samples RSS, PSS and anonymous memory of a few processes from
+ * /proc/[pid]/smaps_rollup, usually every 30 seconds for hours. Each
+ * metric keeps a fixed number of points per pid: when the buffer fills
+ * before it spans the requested window, neighbouring points are merged
+ * and later samples are averaged in pairs, fours and so on; once the
+ * window is covered the oldest point is dropped instead.
+ *
+ * The trend is a Theil-Sen fit (median of the slopes between every pair
+ * of points), which a GC pause or a cache flush cannot drag the way one
+ * outlier drags least squares. Growth is flagged as a suspected leak
+ * when the slope is positive, most point pairs agree, and the total
+ * growth is significant, with a time to OOM against the tightest of the
+ * cgroup limit and the memory the system has available.
+ */
+
+#define _GNU_SOURCE
+#include "devhelper.h"
+
+#include <time.h>
+
+#ifdef __linux__
+#include <signal.h>
+#endif
+
+#define LEAK_MAX_PIDS 32
+#define LEAK_POINTS 96                      // Per pid, whatever the watch length
+#define LEAK_PAIRS (LEAK_POINTS * (LEAK_POINTS - 1) / 2)
+#define LEAK_MIN_POINTS 12                  // Before any verdict
+#define LEAK_MIN_GROWTH_KB 1024             // Over the window, and ...
+#define LEAK_MIN_GROWTH_SHARE 0.02          // ... relative to the starting size
+#define LEAK_SUSPECT_RISING 0.8             // Share of point pairs that went up
+#define LEAK_GROWING_RISING 0.6
+
+#ifdef __linux__
+
+enum {
+    LEAK_RSS = 0,
+    LEAK_PSS,
+    LEAK_ANON,
+    LEAK_METRICS
+};
+
+typedef enum {
+    LEAK_COLLECTING = 0,
+    LEAK_STEADY,
+    LEAK_GROWING,
+    LEAK_SUSPECT,
+    LEAK_EXITED
+} LeakVerdict;
+
+typedef struct {
+    double t;                   // Seconds since the watch started
+    double kb[LEAK_METRICS];
+} LeakPoint;
+
+typedef struct {
+    double slope;               // kB per second
+    double rising;              // Share of point pairs that went up
+} LeakTrend;
+
+typedef struct {
+    int pid;
+    char name[32];
+    unsigned long long start_time;  // Catches pid reuse after an exit
+    LeakPoint points[LEAK_POINTS];
+    int count;
+    int stride;                 // Raw samples averaged into each point
+    LeakPoint pending;
+    int pending_count;
+    LeakPoint last;             // Latest raw sample
+    LeakTrend trend[LEAK_METRICS];
+    LeakVerdict verdict;
+    double oom_seconds;         // < 0 when there is nothing to project
+    bool oom_cgroup;            // Which limit the projection is against
+} LeakWatch;
+
+static volatile sig_atomic_t leak_interrupted = 0;
+
+static void leak_signal_handler(int sig) {
+    (void)sig;
+    leak_interrupted = 1;
+}
+
+/**
+ * Read the command name and start time from /proc/[pid]/stat.
+ * The name may contain spaces and parentheses, so fields are counted
+ * from the last ')'.
+ */
+static bool read_identity(int pid, char *name, size_t size, unsigned long long *start_time) {
+    char path[32], buf[1024];
+
+    snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+    if (sysmon_read_file(path, buf, sizeof(buf)) <= 0) {
+        return false;
+    }
+    char *open = strchr(buf, '(');
+    char *close = strrchr(buf, ')');
+    if (open == NULL || close == NULL || close < open) {
+        return false;
+    }
+    if (name != NULL) {
+        snprintf(name, size, "%.*s", (int)(close - open - 1), open + 1);
+    }
+
+    // starttime is field 22; the text after ')' starts at field 3
+    char *p = close + 2;
+    for (int field = 3; field < 22 && p != NULL; field++) {
+        p = strchr(p, ' ');
+        if (p) p++;
+    }
+    if (p == NULL) {
+        return false;
+    }
+    *start_time = strtoull(p, NULL, 10);
+    return true;
+}
+
+/**
+ * Read RSS, PSS and anonymous memory (kB) from smaps_rollup
+ */
+static bool read_rollup(int pid, double kb[LEAK_METRICS]) {
+    static const char *keys[LEAK_METRICS] = { "Rss:", "Pss:", "Anonymous:" };
+    char path[40], buf[4096];
+
+    snprintf(path, sizeof(path), "/proc/%d/smaps_rollup", pid);
+    if (sysmon_read_file(path, buf, sizeof(buf)) <= 0) {
+        return false;
+    }
+    int found = 0;
+    for (char *line = buf; line != NULL && *line; line = strchr(line, '\n')) {
+        if (*line == '\n') line++;
+        for (int m = 0; m < LEAK_METRICS; m++) {
+            size_t len = strlen(keys[m]);
+            if (strncmp(line, keys[m], len) == 0) {
+                kb[m] = (double)strtoull(line + len, NULL, 10);
+                found++;
+                break;
+            }
+        }
+    }
+    return found == LEAK_METRICS;
+}
+
+/**
+ * Append an averaged point, merging neighbours or sliding the window
+ * when the buffer is full
+ */
+static void push_point(LeakWatch *watch, const LeakPoint *point, double window_s) {
+    if (watch->count == LEAK_POINTS) {
+        double span = watch->points[watch->count - 1].t - watch->points[0].t;
+        if (span < window_s) {
+            for (int i = 0; i < LEAK_POINTS / 2; i++) {
+                const LeakPoint *a = &watch->points[2 * i], *b = &watch->points[2 * i + 1];
+                watch->points[i].t = (a->t + b->t) / 2.0;
+                for (int m = 0; m < LEAK_METRICS; m++) {
+                    watch->points[i].kb[m] = (a->kb[m] + b->kb[m]) / 2.0;
+                }
+            }
+            watch->count = LEAK_POINTS / 2;
+            watch->stride *= 2;
+        } else {
+            memmove(watch->points, watch->points + 1, (LEAK_POINTS - 1) * sizeof(LeakPoint));
+            watch->count--;
+        }
+    }
+    watch->points[watch->count++] = *point;
+}
+
+/**
+ * Fold a raw sample into the pending point; emits one point per stride
+ */
+static void add_sample(LeakWatch *watch, const LeakPoint *sample, double window_s) {
+    watch->last = *sample;
+    watch->pending.t += sample->t;
+    for (int m = 0; m < LEAK_METRICS; m++) {
+        watch->pending.kb[m] += sample->kb[m];
+    }
+    if (++watch->pending_count < watch->stride) {
+        return;
+    }
+
+    LeakPoint point;
+    point.t = watch->pending.t / watch->pending_count;
+    for (int m = 0; m < LEAK_METRICS; m++) {
+        point.kb[m] = watch->pending.kb[m] / watch->pending_count;
+    }
+    memset(&watch->pending, 0, sizeof(watch->pending));
+    watch->pending_count = 0;
+    push_point(watch, &point, window_s);
+}
+
+/**
+ * k-th smallest value (quickselect); reorders the array
+ */
+static double select_kth(double *values, int count, int k) {
+    int lo = 0, hi = count - 1;
+
+    while (lo < hi) {
+        double pivot = values[lo + (hi - lo) / 2];
+        int i = lo, j = hi;
+        while (i <= j) {
+            while (values[i] < pivot) i++;
+            while (values[j] > pivot) j--;
+            if (i <= j) {
+                double tmp = values[i];
+                values[i++] = values[j];
+                values[j--] = tmp;
+            }
+        }
+        if (k <= j) {
+            hi = j;
+        } else if (k >= i) {
+            lo = i;
+        } else {
+            break;
+        }
+    }
+    return values[k];
+}
+
+/**
+ * Theil-Sen slope of one metric: the median of all pairwise slopes
+ */
+static LeakTrend theil_sen(const LeakWatch *watch, int metric) {
+    static double slopes[LEAK_PAIRS];
+    LeakTrend trend = { 0.0, 0.0 };
+    int pairs = 0, rising = 0;
+
+    for (int i = 0; i < watch->count; i++) {
+        for (int j = i + 1; j < watch->count; j++) {
+            double dt = watch->points[j].t - watch->points[i].t;
+            if (dt <= 0.0) {
+                continue;
+            }
+            double slope = (watch->points[j].kb[metric] - watch->points[i].kb[metric]) / dt;
+            rising += slope > 0.0;
+            slopes[pairs++] = slope;
+        }
+    }
+    if (pairs == 0) {
+        return trend;
+    }
+
+    int mid = pairs / 2;
+    trend.slope = select_kth(slopes, pairs, mid);
+    if (pairs % 2 == 0) {
+        // Everything left of mid is now <= the upper median
+        double lower = slopes[0];
+        for (int i = 1; i < mid; i++) {
+            if (slopes[i] > lower) lower = slopes[i];
+        }
+        trend.slope = (trend.slope + lower) / 2.0;
+    }
+    trend.rising = (double)rising / pairs;
+    return trend;
+}
+
+/**
+ * Classify the anonymous-memory trend and project the time to OOM
+ */
+static void judge(LeakWatch *watch, unsigned long long available_kb) {
+    for (int m = 0; m < LEAK_METRICS; m++) {
+        watch->trend[m] = theil_sen(watch, m);
+    }
+    watch->oom_seconds = -1.0;
+    if (watch->count < LEAK_MIN_POINTS) {
+        watch->verdict = LEAK_COLLECTING;
+        return;
+    }
+
+    const LeakTrend *anon = &watch->trend[LEAK_ANON];
+    double span = watch->points[watch->count - 1].t - watch->points[0].t;
+    double growth = anon->slope * span;
+    double threshold = watch->points[0].kb[LEAK_ANON] * LEAK_MIN_GROWTH_SHARE;
+    if (threshold < LEAK_MIN_GROWTH_KB) threshold = LEAK_MIN_GROWTH_KB;
+
+    if (anon->slope > 0.0 && anon->rising >= LEAK_SUSPECT_RISING && growth >= threshold) {
+        watch->verdict = LEAK_SUSPECT;
+    } else if (anon->slope > 0.0 && anon->rising >= LEAK_GROWING_RISING) {
+        watch->verdict = LEAK_GROWING;
+    } else {
+        watch->verdict = LEAK_STEADY;
+        return;
+    }
+
+    double headroom_kb = (double)available_kb;
+    unsigned long long limit, used;
+    watch->oom_cgroup = false;
+    if (cgroup_memory_limit(watch->pid, &limit, &used)) {
+        double cgroup_kb = limit > used ? (double)(limit - used) / 1024.0 : 0.0;
+        if (cgroup_kb < headroom_kb) {
+            headroom_kb = cgroup_kb;
+            watch->oom_cgroup = true;
+        }
+    }
+    watch->oom_seconds = headroom_kb / anon->slope;
+}
+
+/**
+ * Take one sample of every live pid and update its verdict
+ */
+static void sample_all(LeakWatch *watches, int count, double t, double window_s) {
+    MemorySnapshot mem;
+    unsigned long long available_kb = sysmon_read_memory(&mem) ? mem.available_kb : 0;
+
+    for (int i = 0; i < count; i++) {
+        LeakWatch *watch = &watches[i];
+        if (watch->verdict == LEAK_EXITED) {
+            continue;
+        }
+
+        unsigned long long start_time;
+        LeakPoint sample = { .t = t };
+        if (!read_identity(watch->pid, NULL, 0, &start_time) || start_time != watch->start_time ||
+            !read_rollup(watch->pid, sample.kb)) {
+            watch->verdict = LEAK_EXITED;
+            watch->oom_seconds = -1.0;
+            continue;
+        }
+        add_sample(watch, &sample, window_s);
+        judge(watch, available_kb);
+    }
+}
+
+static void format_span(double seconds, char *out, size_t size) {
+    long s = (long)seconds;
+
+    if (s < 60) {
+        snprintf(out, size, "%lds", s);
+    } else if (s < 3600) {
+        snprintf(out, size, "%ldm%02lds", s / 60, s % 60);
+    } else if (s < 86400) {
+        snprintf(out, size, "%ldh%02ldm", s / 3600, s % 3600 / 60);
+    } else {
+        snprintf(out, size, "%ldd%02ldh", s / 86400, s % 86400 / 3600);
+    }
+}
+
+/**
+ * Growth per hour with a sign, e.g. "+12.3M"
+ */
+static void format_rate(double kb_per_s, char *out, size_t size) {
+    double per_hour = kb_per_s * 3600.0;
+    char text[24];
+
+    format_kb((unsigned long long)(per_hour < 0 ? -per_hour : per_hour), text, sizeof(text));
+    snprintf(out, size, "%c%.22s", per_hour < 0 ? '-' : '+', text);
+}
+
+static const char *verdict_name(LeakVerdict verdict) {
+    static const char *names[] = { "collect", "steady", "growing", "LEAK?", "exited" };
+    return names[verdict];
+}
+
+/**
+ * Fill the per-pid text columns shared by the screen and the log
+ */
+static void format_row(const LeakWatch *watch, char rss[32], char pss[32], char anon[32],
+                       char rate[32], char span[32], char oom[40]) {
+    format_kb((unsigned long long)watch->last.kb[LEAK_RSS], rss, 32);
+    format_kb((unsigned long long)watch->last.kb[LEAK_PSS], pss, 32);
+    format_kb((unsigned long long)watch->last.kb[LEAK_ANON], anon, 32);
+    format_rate(watch->trend[LEAK_ANON].slope, rate, 32);
+    format_span(watch->count > 1 ? watch->points[watch->count - 1].t - watch->points[0].t : 0.0, span, 32);
+    if (watch->oom_seconds < 0.0) {
+        snprintf(oom, 40, "-");
+    } else {
+        char text[32];
+        format_span(watch->oom_seconds, text, sizeof(text));
+        snprintf(oom, 40, "%s %s", text, watch->oom_cgroup ? "cg" : "sys");
+    }
+}
+
+static void render_leak_frame(LiveScreen *screen, const LeakWatch *watches, int count,
+                              int interval_s, double window_s, double elapsed) {
+    static HistoryPoint points[LEAK_POINTS];
+    char window[32], running[32];
+    int row = 0, suspects = 0;
+
+    for (int i = 0; i < count; i++) {
+        suspects += watches[i].verdict == LEAK_SUSPECT;
+    }
+    format_span(window_s, window, sizeof(window));
+    format_span(elapsed, running, sizeof(running));
+
+    live_screen_begin(screen);
+    live_screen_print(screen, row, 0, CELL_BOLD, "DevHelper Leak Watch");
+    live_screen_print(screen, row++, 38, CELL_CYAN, "every %ds, window %s (any key quits)", interval_s, window);
+    live_screen_print(screen, row++, 0, suspects > 0 ? CELL_RED : CELL_DEFAULT,
+                      "%d processes, running %s, %d suspected leaks", count, running, suspects);
+    row++;
+
+    int col = live_screen_print(screen, row, 0, CELL_BOLD, "%-7s %-15s %7s %7s %7s %8s %6s %7s %-7s %-11s ",
+                                "PID", "Name", "RSS", "PSS", "Anon", "Anon/h", "Rising", "Span",
+                                "Status", "OOM in");
+    live_screen_print(screen, row++, col, CELL_BOLD, "Anon trend");
+
+    for (int i = 0; i < count && row < screen->rows - 2; i++) {
+        const LeakWatch *watch = &watches[i];
+        char rss[32], pss[32], anon[32], rate[32], span[32], oom[40], rising[16] = "-";
+        format_row(watch, rss, pss, anon, rate, span, oom);
+        if (watch->count >= 2) {
+            snprintf(rising, sizeof(rising), "%.0f%%", watch->trend[LEAK_ANON].rising * 100.0);
+        }
+
+        CellColor color = watch->verdict == LEAK_SUSPECT ? CELL_RED
+                        : watch->verdict == LEAK_GROWING ? CELL_YELLOW
+                        : watch->verdict == LEAK_EXITED ? CELL_CYAN : CELL_DEFAULT;
+        live_screen_print(screen, row, 0, color, "%-7d %-15.15s %7s %7s %7s %8s %6s %7s %-7s %-11s ",
+                          watch->pid, watch->name, rss, pss, anon, rate, rising, span,
+                          verdict_name(watch->verdict), oom);
+
+        // The newest points that fit, scaled to their own range
+        int shown = screen->cols - col;
+        if (shown > watch->count) shown = watch->count;
+        if (shown > 0) {
+            const LeakPoint *first = &watch->points[watch->count - shown];
+            float lo = (float)first->kb[LEAK_ANON], hi = lo;
+            for (int p = 0; p < shown; p++) {
+                float v = (float)first[p].kb[LEAK_ANON];
+                points[p].avg = v;
+                if (v < lo) lo = v;
+                if (v > hi) hi = v;
+            }
+            char spark[LEAK_POINTS * 3 + 1];
+            format_sparkline(points, shown, lo, hi > lo ? hi : lo + 1.0f, spark, sizeof(spark));
+            live_screen_print(screen, row, col, CELL_GREEN, "%s", spark);
+        }
+        row++;
+    }
+    live_screen_print(screen, screen->rows - 1, 0, CELL_CYAN,
+                      "Anon/h: Theil-Sen slope over the window   Rising: share of point pairs that grew");
+}
+
+/**
+ * One line per pid and sample, for unattended runs logging to a file
+ */
+static void log_samples(const LeakWatch *watches, int count) {
+    char stamp[16];
+    time_t now = time(NULL);
+    struct tm tm;
+
+    localtime_r(&now, &tm);
+    strftime(stamp, sizeof(stamp), "%H:%M:%S", &tm);
+    for (int i = 0; i < count; i++) {
+        const LeakWatch *watch = &watches[i];
+        char rss[32], pss[32], anon[32], rate[32], span[32], oom[40];
+        format_row(watch, rss, pss, anon, rate, span, oom);
+        printf("%s pid %d (%s) rss %s pss %s anon %s trend %s/h rising %.0f%% over %s: %s, oom in %s\n",
+               stamp, watch->pid, watch->name, rss, pss, anon, rate,
+               watch->trend[LEAK_ANON].rising * 100.0, span, verdict_name(watch->verdict), oom);
+    }
+    fflush(stdout);
+}
+
+#endif
+
+/**
+ * Watch memory growth of up to LEAK_MAX_PIDS processes until a key is
+ * pressed (or SIGINT/SIGTERM when not on a terminal). window_s is how
+ * much history the trend covers; storage per pid is fixed regardless.
+ */
+void sysmon_leak_watch(const int *pids, int count, int interval_s, int window_s) {
+#ifndef __linux__
+    (void)pids;
+    (void)count;
+    (void)interval_s;
+    (void)window_s;
+    print_warning("The leak watch reads /proc and is only available on Linux.");
+#else
+    char message[128];
+
+    if (count > LEAK_MAX_PIDS) {
+        snprintf(message, sizeof(message), "Watching only the first %d processes.", LEAK_MAX_PIDS);
+        print_warning(message);
+        count = LEAK_MAX_PIDS;
+    }
+    if (interval_s < 1) interval_s = 1;
+    if (window_s < interval_s * LEAK_MIN_POINTS) window_s = interval_s * LEAK_MIN_POINTS;
+
+    LeakWatch *watches = calloc((size_t)count, sizeof(LeakWatch));
+    if (watches == NULL) {
+        print_error("Not enough memory for the leak watch!");
+        return;
+    }
+    for (int i = 0; i < count; i++) {
+        double kb[LEAK_METRICS];
+        watches[i].pid = pids[i];
+        watches[i].stride = 1;
+        watches[i].oom_seconds = -1.0;
+        if (!read_identity(pids[i], watches[i].name, sizeof(watches[i].name), &watches[i].start_time)) {
+            snprintf(message, sizeof(message), "No process with pid %d!", pids[i]);
+            print_error(message);
+            free(watches);
+            return;
+        }
+        if (!read_rollup(pids[i], kb)) {
+            snprintf(message, sizeof(message), "Cannot read /proc/%d/smaps_rollup (needs the same user or root)!",
+                     pids[i]);
+            print_error(message);
+            free(watches);
+            return;
+        }
+    }
+
+    struct sigaction sa, old_int, old_term;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = leak_signal_handler;
+    sigaction(SIGINT, &sa, &old_int);
+    sigaction(SIGTERM, &sa, &old_term);
+    leak_interrupted = 0;
+
+    // Unattended runs (no terminal) log a line per pid instead of drawing
+    bool interactive = isatty(STDIN_FILENO) && isatty(STDOUT_FILENO);
+    LiveScreen screen;
+    if (interactive && !live_screen_init(&screen)) {
+        interactive = false;
+    }
+    if (!interactive) {
+        printf("Watching %d processes every %d s - send SIGINT or SIGTERM to stop\n", count, interval_s);
+    }
+
+    long long interval_ms = (long long)interval_s * 1000;
+    long long start = monotonic_ms();
+    sample_all(watches, count, 0.0, window_s);
+    if (interactive) {
+        terminal_set_raw(true);
+        render_leak_frame(&screen, watches, count, interval_s, window_s, 0.0);
+        live_screen_flush(&screen);
+    } else {
+        log_samples(watches, count);
+    }
+
+    long long next_tick = start + interval_ms;
+    while (!leak_interrupted) {
+        int wait = (int)(next_tick - monotonic_ms());
+        if (interactive) {
+            if (wait_for_key(wait) >= 0) {
+                break;
+            }
+        } else if (wait > 0) {
+            usleep((useconds_t)wait * 1000);
+        }
+        long long now = monotonic_ms();
+        if (leak_interrupted || now < next_tick) {
+            continue;
+        }
+        next_tick += interval_ms;
+        if (next_tick <= now) {
+            next_tick = now + interval_ms;
+        }
+
+        double elapsed = (double)(now - start) / 1000.0;
+        sample_all(watches, count, elapsed, window_s);
+        if (interactive) {
+            render_leak_frame(&screen, watches, count, interval_s, window_s, elapsed);
+            live_screen_flush(&screen);
+        } else {
+            log_samples(watches, count);
+        }
+    }
+
+    if (interactive) {
+        terminal_set_raw(false);
+        printf("%s\033[H\033[2J", COLOR_RESET);
+        fflush(stdout);
+        live_screen_free(&screen);
+    }
+    sigaction(SIGINT, &old_int, NULL);
+    sigaction(SIGTERM, &old_term, NULL);
+    free(watches);
+#endif
+}
@@ -0,0 +1,520 @@
+/**
+ * DevHelper+Portal CLI - Live System Monitor
+ *
+ * A top-like view that refreshes in place. Frames are drawn into an
+ * off-screen cell grid and only the cells that changed since the last
+ * frame are written to the terminal.
+ */
+
+#define _GNU_SOURCE
+#include "devhelper.h"
+#include <stdarg.h>
+#include <signal.h>
+
+#define LIVE_MAX_ROWS 200
+#define LIVE_MAX_COLS 400
+#define LIVE_MIN_INTERVAL_MS 100
+#define LIVE_MAX_INTERVAL_MS 5000
+
+static const char *cell_color_codes[] = {
+    COLOR_RESET,
+    COLOR_RED,
+    COLOR_GREEN,
+    COLOR_YELLOW,
+    COLOR_BLUE,
+    COLOR_MAGENTA,
+    COLOR_CYAN,
+    COLOR_BOLD
+};
+
+static volatile sig_atomic_t live_interrupted = 0;
+
+static void live_sigint_handler(int sig) {
+    (void)sig;
+    live_interrupted = 1;
+}
+
+/**
+ * Length of a UTF-8 sequence from its lead byte
+ */
+static int utf8_length(unsigned char lead) {
+    if (lead < 0x80) return 1;
+    if ((lead & 0xE0) == 0xC0) return 2;
+    if ((lead & 0xF0) == 0xE0) return 3;
+    if ((lead & 0xF8) == 0xF0) return 4;
+    return 1;
+}
+
+static void set_blank(ScreenCell *cell) {
+    memset(cell, 0, sizeof(*cell));
+    cell->glyph[0] = ' ';
+}
+
+/**
+ * Size the cell grids to the current terminal. On failure the screen
+ * keeps its old grids and size.
+ */
+static bool live_screen_resize(LiveScreen *screen, int rows, int cols) {
+    if (rows > LIVE_MAX_ROWS) rows = LIVE_MAX_ROWS;
+    if (cols > LIVE_MAX_COLS) cols = LIVE_MAX_COLS;
+
+    // Both grids are redrawn from blank, so allocate fresh ones and only
+    // swap them in once all three allocations succeeded
+    size_t cells = (size_t)rows * (size_t)cols;
+    size_t out_cap = cells * 24 + 64;   // Worst case: cursor move, color and glyph per cell
+    ScreenCell *front = malloc(cells * sizeof(ScreenCell));
+    ScreenCell *back = malloc(cells * sizeof(ScreenCell));
+    char *out = malloc(out_cap);
+    if (front == NULL || back == NULL || out == NULL) {
+        free(front);
+        free(back);
+        free(out);
+        return false;
+    }
+
+    free(screen->front);
+    free(screen->back);
+    free(screen->out);
+    screen->front = front;
+    screen->back = back;
+    screen->out = out;
+    screen->out_cap = out_cap;
+
+    screen->rows = rows;
+    screen->cols = cols;
+    for (size_t i = 0; i < cells; i++) {
+        set_blank(&screen->front[i]);
+    }
+    screen->force_redraw = true;
+    return true;
+}
+
+/**
+ * Allocate the front and back buffers for a live screen
+ */
+bool live_screen_init(LiveScreen *screen) {
+    int rows, cols;
+
+    memset(screen, 0, sizeof(*screen));
+    get_terminal_size(&rows, &cols);
+    return live_screen_resize(screen, rows, cols);
+}
+
+/**
+ * Release the cell grids
+ */
+void live_screen_free(LiveScreen *screen) {
+    free(screen->front);
+    free(screen->back);
+    free(screen->out);
+    memset(screen, 0, sizeof(*screen));
+}
+
+/**
+ * Start a new frame: pick up terminal resizes and blank the back buffer.
+ * If the grids cannot be resized the frame is drawn at the old size.
+ */
+void live_screen_begin(LiveScreen *screen) {
+    int rows, cols;
+
+    get_terminal_size(&rows, &cols);
+    if (rows > LIVE_MAX_ROWS) rows = LIVE_MAX_ROWS;
+    if (cols > LIVE_MAX_COLS) cols = LIVE_MAX_COLS;
+    if ((rows != screen->rows || cols != screen->cols) && !live_screen_resize(screen, rows, cols)) {
+        // The grids still match the old size; repaint it in full since
+        // the terminal reflowed
+        screen->force_redraw = true;
+    }
+
+    size_t cells = (size_t)screen->rows * (size_t)screen->cols;
+    for (size_t i = 0; i < cells; i++) {
+        set_blank(&screen->back[i]);
+    }
+}
+
+/**
+ * Print formatted text into the back buffer at (row, col).
+ * Text past the right edge is clipped. Returns the number of cells used.
+ */
+int live_screen_print(LiveScreen *screen, int row, int col, CellColor color, const char *fmt, ...) {
+    char text[1024];
+    va_list args;
+
+    if (row < 0 || row >= screen->rows || col < 0) {
+        return 0;
+    }
+
+    va_start(args, fmt);
+    vsnprintf(text, sizeof(text), fmt, args);
+    va_end(args);
+
+    int start = col;
+    const unsigned char *p = (const unsigned char *)text;
+    while (*p && col < screen->cols) {
+        int len = utf8_length(*p);
+        ScreenCell *cell = &screen->back[row * screen->cols + col];
+
+        memset(cell, 0, sizeof(*cell));
+        for (int i = 0; i < len && p[i]; i++) {
+            cell->glyph[i] = (char)p[i];
+        }
+        cell->color = (unsigned char)color;
+
+        for (int i = 0; i < len && *p; i++) p++;
+        col++;
+    }
+
+    return col - start;
+}
+
+/**
+ * Draw a usage bar like [||||||    ] coloured by severity
+ */
+int live_screen_bar(LiveScreen *screen, int row, int col, int width, double percent) {
+    char bar[LIVE_MAX_COLS + 1];
+    int inner = width - 2;
+
+    if (inner < 1) {
+        return 0;
+    }
+    if (inner > LIVE_MAX_COLS) inner = LIVE_MAX_COLS;
+    if (percent < 0.0) percent = 0.0;
+    if (percent > 100.0) percent = 100.0;
+
+    int filled = (int)(percent * inner / 100.0 + 0.5);
+    memset(bar, '|', (size_t)filled);
+    memset(bar + filled, ' ', (size_t)(inner - filled));
+    bar[inner] = '\0';
+
+    CellColor color = percent >= 90.0 ? CELL_RED : percent >= 70.0 ? CELL_YELLOW : CELL_GREEN;
+    live_screen_print(screen, row, col, CELL_DEFAULT, "[");
+    live_screen_print(screen, row, col + 1, color, "%s", bar);
+    live_screen_print(screen, row, col + 1 + inner, CELL_DEFAULT, "]");
+    return width;
+}
+
+/**
+ * Write only the cells that differ from the previous frame
+ */
+void live_screen_flush(LiveScreen *screen) {
+    char *out = screen->out;
+    size_t len = 0;
+    int current_color = -1;
+
+    if (screen->force_redraw) {
+        len += (size_t)snprintf(out + len, screen->out_cap - len, "\033[0m\033[H\033[2J");
+        current_color = CELL_DEFAULT;
+    }
+
+    for (int row = 0; row < screen->rows; row++) {
+        int cursor_col = -1;
+
+        for (int col = 0; col < screen->cols; col++) {
+            size_t idx = (size_t)row * screen->cols + col;
+            ScreenCell *cell = &screen->back[idx];
+
+            if (!screen->force_redraw &&
+                memcmp(cell, &screen->front[idx], sizeof(*cell)) == 0) {
+                continue;
+            }
+
+            if (cursor_col != col) {
+                len += (size_t)snprintf(out + len, screen->out_cap - len,
+                                        "\033[%d;%dH", row + 1, col + 1);
+            }
+            if (cell->color != current_color) {
+                len += (size_t)snprintf(out + len, screen->out_cap - len, "%s%s",
+                                        COLOR_RESET, cell_color_codes[cell->color]);
+                current_color = cell->color;
+            }
+
+            int glyph_len = utf8_length((unsigned char)cell->glyph[0]);
+            memcpy(out + len, cell->glyph, (size_t)glyph_len);
+            len += (size_t)glyph_len;
+            cursor_col = col + 1;
+        }
+    }
+
+    if (len > 0) {
+        len += (size_t)snprintf(out + len, screen->out_cap - len, "%s", COLOR_RESET);
+        fwrite(out, 1, len, stdout);
+        fflush(stdout);
+    }
+
+    ScreenCell *swap = screen->front;
+    screen->front = screen->back;
+    screen->back = swap;
+    screen->force_redraw = false;
+}
+
+/**
+ * Render one frame of the live monitor into the back buffer
+ */
+static void render_live_frame(LiveScreen *screen, const char *title, const char *status,
+                              const LiveSample *prev_sample, const LiveSample *cur_sample,
+                              bool show_history) {
+    const CpuSnapshot *prev = &prev_sample->cpu;
+    const CpuSnapshot *cur = &cur_sample->cpu;
+    const MemorySnapshot *mem = &cur_sample->mem;
+    const LoadSnapshot *load = &cur_sample->load;
+    char used[16], total[16], avail[16], cache[16];
+    int row = 0;
+
+    live_screen_begin(screen);
+
+    int title_len = live_screen_print(screen, row, 0, CELL_BOLD, "%s", title);
+    live_screen_print(screen, row++, title_len + 2, CELL_CYAN, "%s  cores %d", status, cur->cpu_count);
+
+    long long elapsed_ms = cur_sample->time_ms - prev_sample->time_ms;
+    double per_second = elapsed_ms > 0 ? 1000.0 / (double)elapsed_ms : 0.0;
+    double ctxt_rate = (double)(cur->context_switches - prev->context_switches) * per_second;
+    live_screen_print(screen, row++, 0, CELL_DEFAULT,
+                      "Load %.2f %.2f %.2f   Tasks %d running / %d total   Ctx switches %.0f/s",
+                      load->load1, load->load5, load->load15,
+                      cur->procs_running, load->total_tasks, ctxt_rate);
+    row++;
+
+    // Aggregate CPU with a user/system/iowait breakdown
+    unsigned long long delta = cpu_times_total(&cur->total) - cpu_times_total(&prev->total);
+    double scale = delta > 0 ? 100.0 / (double)delta : 0.0;
+    double user = (double)((cur->total.user + cur->total.nice) -
+                           (prev->total.user + prev->total.nice)) * scale;
+    double sys = (double)((cur->total.system + cur->total.irq + cur->total.softirq) -
+                          (prev->total.system + prev->total.irq + prev->total.softirq)) * scale;
+    double iowait = (double)(cur->total.iowait - prev->total.iowait) * scale;
+    double steal = (double)(cur->total.steal - prev->total.steal) * scale;
+    double busy = sysmon_cpu_busy_percent(&prev->total, &cur->total);
+
+    live_screen_print(screen, row, 0, CELL_CYAN, "CPU");
+    live_screen_bar(screen, row, 6, 32, busy);
+    live_screen_print(screen, row++, 39, CELL_DEFAULT,
+                      "%5.1f%%  usr %5.1f  sys %5.1f  iow %5.1f  steal %4.1f",
+                      busy, user, sys, iowait, steal);
+
+    // Per-core bars, laid out in as many columns as the terminal allows
+    const int cell_width = 34;
+    int columns = screen->cols / cell_width;
+    if (columns < 1) columns = 1;
+    int core_rows = (cur->cpu_count + columns - 1) / columns;
+    int max_core_rows = screen->rows - row - 8;
+    if (max_core_rows < 1) max_core_rows = 1;
+    if (core_rows > max_core_rows) core_rows = max_core_rows;
+
+    int shown = 0;
+    for (int i = 0; i < cur->cpu_count && i < core_rows * columns; i++) {
+        int r = row + i % core_rows;
+        int c = (i / core_rows) * cell_width;
+        double pct = sysmon_cpu_busy_percent(&prev->cpu[i], &cur->cpu[i]);
+
+        live_screen_print(screen, r, c, CELL_DEFAULT, "%3d", i);
+        live_screen_bar(screen, r, c + 4, 22, pct);
+        live_screen_print(screen, r, c + 27, CELL_DEFAULT, "%5.1f%%", pct);
+        shown++;
+    }
+    row += core_rows;
+    if (shown < cur->cpu_count) {
+        live_screen_print(screen, row++, 0, CELL_YELLOW,
+                          "... %d more cores (enlarge the terminal to see them)",
+                          cur->cpu_count - shown);
+    }
+    row++;
+
+    // Memory and swap
+    unsigned long long mem_used = mem->available_kb > 0
+        ? mem->total_kb - mem->available_kb
+        : mem->total_kb - mem->free_kb - mem->buffers_kb - mem->cached_kb;
+    double mem_pct = mem->total_kb > 0 ? 100.0 * (double)mem_used / (double)mem->total_kb : 0.0;
+    format_kb(mem_used, used, sizeof(used));
+    format_kb(mem->total_kb, total, sizeof(total));
+    format_kb(mem->available_kb, avail, sizeof(avail));
+    format_kb(mem->buffers_kb + mem->cached_kb, cache, sizeof(cache));
+
+    live_screen_print(screen, row, 0, CELL_CYAN, "Mem");
+    live_screen_bar(screen, row, 6, 32, mem_pct);
+    live_screen_print(screen, row++, 39, CELL_DEFAULT, "%7s / %-7s avail %s  cache %s",
+                      used, total, avail, cache);
+
+    unsigned long long swap_used = mem->swap_total_kb - mem->swap_free_kb;
+    double swap_pct = mem->swap_total_kb > 0
+        ? 100.0 * (double)swap_used / (double)mem->swap_total_kb : 0.0;
+    format_kb(swap_used, used, sizeof(used));
+    format_kb(mem->swap_total_kb, total, sizeof(total));
+
+    live_screen_print(screen, row, 0, CELL_CYAN, "Swap");
+    live_screen_bar(screen, row, 6, 32, swap_pct);
+    live_screen_print(screen, row++, 39, CELL_DEFAULT, "%7s / %-7s", used, total);
+
+    // Disk and network throughput from the aggregate counters
+    const IoSnapshot *pio = &prev_sample->io;
+    const IoSnapshot *io = &cur_sample->io;
+    live_screen_print(screen, row++, 0, CELL_CYAN,
+                      "Disk  read %7.1f MB/s  write %7.1f MB/s   Net  rx %7.1f MB/s  tx %7.1f MB/s",
+                      (double)(io->read_sectors - pio->read_sectors) * 512.0 / 1e6 * per_second,
+                      (double)(io->write_sectors - pio->write_sectors) * 512.0 / 1e6 * per_second,
+                      (double)(io->rx_bytes - pio->rx_bytes) / 1e6 * per_second,
+                      (double)(io->tx_bytes - pio->tx_bytes) / 1e6 * per_second);
+
+    if (!show_history) {
+        return;
+    }
+
+    // Last minute from the background history sampler
+    HistoryPoint points[60];
+    char spark[60 * 4 + 1];
+    int n = history_read(HIST_CPU_BUSY, HISTORY_MINUTE, points, 60);
+    format_sparkline(points, n, 0.0f, 100.0f, spark, sizeof(spark));
+    live_screen_print(screen, row, 0, CELL_CYAN, "CPU 60s");
+    live_screen_print(screen, row++, 9, CELL_GREEN, "%s", spark);
+    n = history_read(HIST_MEM_USED, HISTORY_MINUTE, points, 60);
+    format_sparkline(points, n, 0.0f, 100.0f, spark, sizeof(spark));
+    live_screen_print(screen, row, 0, CELL_CYAN, "Mem 60s");
+    live_screen_print(screen, row, 9, CELL_GREEN, "%s", spark);
+}
+
+/**
+ * Ask the user for a refresh interval within the supported range
+ */
+int prompt_interval_ms(void) {
+    char input[MAX_INPUT_LENGTH];
+    char prompt[128];
+
+    snprintf(prompt, sizeof(prompt), "Refresh interval in ms [%d-%d, default 1000]: ",
+             LIVE_MIN_INTERVAL_MS, LIVE_MAX_INTERVAL_MS);
+    get_user_input(input, sizeof(input), prompt);
+
+    int interval = atoi(input);
+    if (interval <= 0) interval = 1000;
+    if (interval < LIVE_MIN_INTERVAL_MS) interval = LIVE_MIN_INTERVAL_MS;
+    if (interval > LIVE_MAX_INTERVAL_MS) interval = LIVE_MAX_INTERVAL_MS;
+    return interval;
+}
+
+/**
+ * Sample source for the live view: read everything from /proc
+ */
+static bool proc_sample_source(void *ctx, LiveSample *sample) {
+    (void)ctx;
+    return sysmon_read_sample(sample);
+}
+
+/**
+ * Drive the live view from any sample source until a key is pressed.
+ * When `speed` is given (replays), '+' and '-' change it and the status
+ * line shows the recording clock instead of the refresh interval.
+ */
+void live_monitor_run(const char *title, LiveSampleSource source, void *ctx,
+                      int interval_ms, double *speed) {
+    LiveSample *samples = calloc(2, sizeof(LiveSample));
+    LiveScreen screen;
+    char status[128];
+
+    if (samples == NULL || !live_screen_init(&screen)) {
+        free(samples);
+        print_error("Not enough memory for the live view!");
+        return;
+    }
+    LiveSample *prev = &samples[0];
+    LiveSample *cur = &samples[1];
+
+    if (!source(ctx, prev)) {
+        live_screen_free(&screen);
+        free(samples);
+        print_error("No samples available!");
+        return;
+    }
+
+    struct sigaction sa, old_sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = live_sigint_handler;
+    sigaction(SIGINT, &sa, &old_sa);
+    live_interrupted = 0;
+
+    terminal_set_raw(true);
+    live_screen_begin(&screen);
+    live_screen_print(&screen, 0, 0, CELL_BOLD, "%s", title);
+    live_screen_print(&screen, 1, 0, CELL_CYAN, "Collecting first sample...");
+    live_screen_flush(&screen);
+
+    bool finished = false;
+    long long next_tick = monotonic_ms() + interval_ms;
+    while (!live_interrupted) {
+        long long now = monotonic_ms();
+        int key = wait_for_key(finished ? 1000 : (int)(next_tick - now));
+        if (key >= 0) {
+            if (speed != NULL && key == '+') {
+                *speed *= 2.0;
+            } else if (speed != NULL && key == '-') {
+                *speed /= 2.0;
+            } else {
+                break;
+            }
+        }
+        if (live_interrupted) {
+            break;
+        }
+        if (finished) {
+            continue;
+        }
+
+        now = monotonic_ms();
+        if (now < next_tick) {
+            continue;  // Woken early by a key or signal; keep the schedule
+        }
+        int step = speed != NULL ? (int)(interval_ms / *speed) : interval_ms;
+        if (step < 1) step = 1;
+        next_tick += step;
+        if (next_tick <= now) {
+            next_tick = now + step;  // We fell behind; don't burst
+        }
+
+        if (!source(ctx, cur)) {
+            if (speed == NULL) {
+                continue;
+            }
+            // End of a recording: keep the last frame up until a key
+            finished = true;
+            memcpy(screen.back, screen.front, (size_t)screen.rows * screen.cols * sizeof(ScreenCell));
+            live_screen_print(&screen, 0, 0, CELL_YELLOW,
+                              "End of recording - press any key to exit");
+            live_screen_flush(&screen);
+            continue;
+        }
+
+        if (speed != NULL) {
+            long long secs = cur->time_ms / 1000;
+            snprintf(status, sizeof(status), "replay x%g  t+%02lld:%02lld:%02lld  [+/-] speed",
+                     *speed, secs / 3600, secs / 60 % 60, secs % 60);
+        } else {
+            snprintf(status, sizeof(status), "interval %d ms  (press any key to exit)", interval_ms);
+        }
+        render_live_frame(&screen, title, status, prev, cur, speed == NULL);
+        live_screen_flush(&screen);
+
+        LiveSample *swap = prev;
+        prev = cur;
+        cur = swap;
+    }
+
+    terminal_set_raw(false);
+    sigaction(SIGINT, &old_sa, NULL);
+    printf("%s\033[H\033[2J", COLOR_RESET);
+    fflush(stdout);
+    live_screen_free(&screen);
+    free(samples);
+}
+
+/**
+ * Run the live monitor until a key is pressed
+ */
+void sysmon_live_view(int interval_ms) {
+#ifndef __linux__
+    (void)interval_ms;
+    print_warning("The live monitor reads /proc and is only available on Linux.");
+#else
+    if (interval_ms < LIVE_MIN_INTERVAL_MS) interval_ms = LIVE_MIN_INTERVAL_MS;
+    if (interval_ms > LIVE_MAX_INTERVAL_MS) interval_ms = LIVE_MAX_INTERVAL_MS;
+
+    history_start_sampler();
+    live_monitor_run("DevHelper Live Monitor", proc_sample_source, NULL, interval_ms, NULL);
+#endif
+}
@@ -0,0 +1,455 @@
+/**
+ * DevHelper+Portal CLI - Memory Bandwidth and Latency Benchmark
+ *
+ * Runs once per NUMA node with every thread pinned to one of that
+ * node's CPUs and the arrays first-touched (and, on multi-node hosts,
+ * mbind'ed) there, so each result is node-local.
+ *
+ * Bandwidth: the four STREAM kernels (copy, scale, add, triad) over
+ * arrays several times the last-level cache, split across threads and
+ * released together by a barrier; best of a few repetitions. On x86-64
+ * the loops use SSE2 with non-temporal stores, which skips the
+ * read-for-ownership so the byte counts match what the bus moves.
+ *
+ * Latency: a pointer chase through a random cyclic permutation of cache
+ * lines, for working sets from 4 KB up past the LLC. Each load depends
+ * on the previous one, so ns/load steps up at every cache level.
+ */
+
+#define _GNU_SOURCE
+#include "devhelper.h"
+
+#ifdef __linux__
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__SSE2__)
+#include <emmintrin.h>
+#define MEMBENCH_HAVE_SSE2 1
+#endif
+#endif
+
+#ifdef __linux__
+
+#define MEMBENCH_MAX_NODES 64
+#define MEMBENCH_MAX_CPUS 1024
+#define MEMBENCH_REPEATS 5
+#define MEMBENCH_SCALAR 3.0
+#define MEMBENCH_MPOL_BIND 2                // From <numaif.h>, which needs libnuma
+#define MEMBENCH_LINE 64
+
+enum { KERNEL_COPY, KERNEL_SCALE, KERNEL_ADD, KERNEL_TRIAD, KERNEL_COUNT };
+
+static const char *kernel_names[KERNEL_COUNT] = { "Copy", "Scale", "Add", "Triad" };
+static const int kernel_arrays[KERNEL_COUNT] = { 2, 2, 3, 3 };     // Arrays touched per element
+
+typedef struct {
+    double *a, *b, *c;
+    size_t elements;                        // Per array
+    int thread_count;
+    bool abort;                             // Not every thread started
+    pthread_mutex_t gate;                   // Held until the barrier is sized
+    pthread_barrier_t barrier;
+} StreamArrays;
+
+typedef struct {
+    StreamArrays *arrays;
+    int cpu;
+    size_t lo, hi;
+    pthread_t thread;
+} StreamWorker;
+
+static long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void pin_to_cpu(int cpu) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+
+/**
+ * Prefer `node` for pages faulted in later. Only needed when there is
+ * more than one node; failures just leave first-touch placement.
+ */
+static void bind_to_node(void *addr, size_t len, int node) {
+#ifdef __NR_mbind
+    unsigned long mask[MEMBENCH_MAX_NODES / (8 * sizeof(unsigned long)) + 1] = { 0 };
+    if (node < 0 || node >= MEMBENCH_MAX_NODES) {
+        return;
+    }
+    mask[node / (8 * sizeof(unsigned long))] |= 1UL << (node % (8 * sizeof(unsigned long)));
+    syscall(__NR_mbind, addr, len, MEMBENCH_MPOL_BIND, mask, (unsigned long)MEMBENCH_MAX_NODES + 1, 0);
+#else
+    (void)addr; (void)len; (void)node;
+#endif
+}
+
+/**
+ * One kernel over [lo, hi). lo and hi are multiples of 8 elements and
+ * the arrays are page aligned, so aligned SSE2 loads/stores are safe.
+ */
+static void run_kernel(int kernel, double *a, double *b, double *c, size_t lo, size_t hi) {
+#ifdef MEMBENCH_HAVE_SSE2
+    const __m128d s = _mm_set1_pd(MEMBENCH_SCALAR);
+    switch (kernel) {
+        case KERNEL_COPY:
+            for (size_t i = lo; i < hi; i += 4) {
+                _mm_stream_pd(c + i, _mm_load_pd(a + i));
+                _mm_stream_pd(c + i + 2, _mm_load_pd(a + i + 2));
+            }
+            break;
+        case KERNEL_SCALE:
+            for (size_t i = lo; i < hi; i += 4) {
+                _mm_stream_pd(b + i, _mm_mul_pd(s, _mm_load_pd(c + i)));
+                _mm_stream_pd(b + i + 2, _mm_mul_pd(s, _mm_load_pd(c + i + 2)));
+            }
+            break;
+        case KERNEL_ADD:
+            for (size_t i = lo; i < hi; i += 4) {
+                _mm_stream_pd(c + i, _mm_add_pd(_mm_load_pd(a + i), _mm_load_pd(b + i)));
+                _mm_stream_pd(c + i + 2, _mm_add_pd(_mm_load_pd(a + i + 2), _mm_load_pd(b + i + 2)));
+            }
+            break;
+        case KERNEL_TRIAD:
+            for (size_t i = lo; i < hi; i += 4) {
+                _mm_stream_pd(a + i, _mm_add_pd(_mm_load_pd(b + i), _mm_mul_pd(s, _mm_load_pd(c + i))));
+                _mm_stream_pd(a + i + 2,
+                              _mm_add_pd(_mm_load_pd(b + i + 2), _mm_mul_pd(s, _mm_load_pd(c + i + 2))));
+            }
+            break;
+    }
+    _mm_sfence();
+#else
+    // Plain loops; the compiler vectorizes these at -O2 and above
+    const double s = MEMBENCH_SCALAR;
+    switch (kernel) {
+        case KERNEL_COPY:  for (size_t i = lo; i < hi; i++) c[i] = a[i]; break;
+        case KERNEL_SCALE: for (size_t i = lo; i < hi; i++) b[i] = s * c[i]; break;
+        case KERNEL_ADD:   for (size_t i = lo; i < hi; i++) c[i] = a[i] + b[i]; break;
+        case KERNEL_TRIAD: for (size_t i = lo; i < hi; i++) a[i] = b[i] + s * c[i]; break;
+    }
+#endif
+}
+
+/**
+ * Pin, first-touch our slice, then run each kernel between two barrier
+ * waits so the main thread can time all threads together
+ */
+static void *stream_worker(void *arg) {
+    StreamWorker *worker = arg;
+    StreamArrays *arrays = worker->arrays;
+
+    pthread_mutex_lock(&arrays->gate);
+    pthread_mutex_unlock(&arrays->gate);
+    if (arrays->abort) {
+        return NULL;
+    }
+
+    pin_to_cpu(worker->cpu);
+    for (size_t i = worker->lo; i < worker->hi; i++) {
+        arrays->a[i] = 1.0;
+        arrays->b[i] = 2.0;
+        arrays->c[i] = 0.0;
+    }
+    pthread_barrier_wait(&arrays->barrier);
+
+    for (int rep = 0; rep < MEMBENCH_REPEATS; rep++) {
+        for (int k = 0; k < KERNEL_COUNT; k++) {
+            pthread_barrier_wait(&arrays->barrier);
+            run_kernel(k, arrays->a, arrays->b, arrays->c, worker->lo, worker->hi);
+            pthread_barrier_wait(&arrays->barrier);
+        }
+    }
+    return NULL;
+}
+
+/**
+ * STREAM on `node` with `thread_count` threads over arrays of
+ * `array_bytes` each. Fills best/avg MB/s per kernel.
+ */
+static bool run_stream(int node, const int *cpus, int cpu_count, int thread_count, size_t array_bytes,
+                       bool multi_node, double *best_mbps, double *avg_mbps) {
+    StreamArrays arrays;
+    StreamWorker *workers;
+    size_t elements = array_bytes / sizeof(double);
+    size_t map_bytes;
+    char *region;
+    int started = 0;
+
+    elements -= elements % (8 * (size_t)thread_count);
+    if (elements == 0) {
+        return false;
+    }
+    map_bytes = ((elements * sizeof(double) + 4095) & ~(size_t)4095) * 3;
+    region = mmap(NULL, map_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (region == MAP_FAILED) {
+        return false;
+    }
+    if (multi_node) {
+        bind_to_node(region, map_bytes, node);
+    }
+    workers = calloc((size_t)thread_count, sizeof(StreamWorker));
+    if (workers == NULL) {
+        munmap(region, map_bytes);
+        return false;
+    }
+
+    arrays.a = (double *)region;
+    arrays.b = (double *)(region + map_bytes / 3);
+    arrays.c = (double *)(region + 2 * (map_bytes / 3));
+    arrays.elements = elements;
+    arrays.thread_count = thread_count;
+    arrays.abort = false;
+    pthread_mutex_init(&arrays.gate, NULL);
+    pthread_mutex_lock(&arrays.gate);
+
+    size_t slice = elements / (size_t)thread_count;
+    for (int i = 0; i < thread_count; i++) {
+        workers[i].arrays = &arrays;
+        workers[i].cpu = cpus[i % cpu_count];
+        workers[i].lo = slice * (size_t)i;
+        workers[i].hi = slice * (size_t)(i + 1);
+        if (pthread_create(&workers[i].thread, NULL, stream_worker, &workers[i]) != 0) {
+            break;
+        }
+        started++;
+    }
+    // The slices assume every thread runs; don't measure short-handed
+    arrays.abort = started < thread_count;
+    if (!arrays.abort) {
+        pthread_barrier_init(&arrays.barrier, NULL, (unsigned)thread_count + 1);
+    }
+    pthread_mutex_unlock(&arrays.gate);
+    if (arrays.abort) {
+        for (int i = 0; i < started; i++) {
+            pthread_join(workers[i].thread, NULL);
+        }
+        pthread_mutex_destroy(&arrays.gate);
+        free(workers);
+        munmap(region, map_bytes);
+        return false;
+    }
+
+    double total_mbps[KERNEL_COUNT] = { 0 };
+    for (int k = 0; k < KERNEL_COUNT; k++) best_mbps[k] = 0.0;
+
+    pthread_barrier_wait(&arrays.barrier);      // Arrays initialized
+    for (int rep = 0; rep < MEMBENCH_REPEATS; rep++) {
+        for (int k = 0; k < KERNEL_COUNT; k++) {
+            pthread_barrier_wait(&arrays.barrier);
+            long long start = now_ns();
+            pthread_barrier_wait(&arrays.barrier);
+            double seconds = (double)(now_ns() - start) / 1e9;
+            double mbps = (double)kernel_arrays[k] * (double)(elements * sizeof(double)) / seconds / 1e6;
+            if (rep > 0) {
+                // The first pass also pays for page faults and cold TLBs
+                total_mbps[k] += mbps;
+            }
+            if (mbps > best_mbps[k]) best_mbps[k] = mbps;
+        }
+    }
+    for (int k = 0; k < KERNEL_COUNT; k++) {
+        avg_mbps[k] = total_mbps[k] / (MEMBENCH_REPEATS - 1);
+    }
+
+    for (int i = 0; i < started; i++) {
+        pthread_join(workers[i].thread, NULL);
+    }
+    pthread_barrier_destroy(&arrays.barrier);
+    pthread_mutex_destroy(&arrays.gate);
+    free(workers);
+    munmap(region, map_bytes);
+    return true;
+}
+
+/**
+ * Link the first `bytes` of `region` into one random cycle of cache
+ * lines (Sattolo's shuffle) and return the start
+ */
+static void **build_chase(char *region, size_t bytes, size_t *order) {
+    size_t lines = bytes / MEMBENCH_LINE;
+    uint64_t rng = 0x9E3779B97F4A7C15ULL ^ bytes;
+
+    for (size_t i = 0; i < lines; i++) {
+        order[i] = i;
+    }
+    for (size_t i = lines - 1; i > 0; i--) {
+        rng ^= rng << 13;
+        rng ^= rng >> 7;
+        rng ^= rng << 17;
+        size_t j = (size_t)(rng % i);
+        size_t tmp = order[i];
+        order[i] = order[j];
+        order[j] = tmp;
+    }
+    for (size_t i = 0; i < lines; i++) {
+        void **slot = (void **)(region + order[i] * MEMBENCH_LINE);
+        *slot = region + order[(i + 1) % lines] * MEMBENCH_LINE;
+    }
+    return (void **)(region + order[0] * MEMBENCH_LINE);
+}
+
+/**
+ * Average ns per dependent load, chasing for about 100 ms
+ */
+static double chase_ns(void **start) {
+    void **p = start;
+    unsigned long long loads = 0;
+    long long begin = now_ns();
+    long long elapsed;
+
+    do {
+        for (int i = 0; i < 1 << 16; i++) {
+            p = (void **)*p; p = (void **)*p; p = (void **)*p; p = (void **)*p;
+            p = (void **)*p; p = (void **)*p; p = (void **)*p; p = (void **)*p;
+        }
+        loads += 8ULL << 16;
+        elapsed = now_ns() - begin;
+    } while (elapsed < 100000000LL);
+
+    // Keep the chain live so the loop can't be dropped
+    __asm__ volatile("" : : "r"(p) : "memory");
+    return (double)elapsed / (double)loads;
+}
+
+static const char *cache_level_for(size_t bytes, const long long *levels) {
+    static const char *names[] = { "L1", "L2", "L3", "L4" };
+    for (int i = 0; i < 4; i++) {
+        if (levels[i] > 0 && (long long)bytes <= levels[i]) {
+            return names[i];
+        }
+    }
+    return "DRAM";
+}
+
+static void format_size(size_t bytes, char *out, size_t size) {
+    if (bytes >= 1024 * 1024) {
+        snprintf(out, size, "%zu MB", bytes / (1024 * 1024));
+    } else {
+        snprintf(out, size, "%zu KB", bytes / 1024);
+    }
+}
+
+/**
+ * Pointer-chase latency on the node's first CPU, 4 KB .. max_bytes
+ */
+static void run_latency(int node, int cpu, size_t max_bytes, bool multi_node) {
+    long long levels[4];
+    for (int i = 0; i < 4; i++) {
+        levels[i] = cpu_data_cache_size(cpu, i + 1);
+    }
+
+    char *region = mmap(NULL, max_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    size_t *order = malloc(max_bytes / MEMBENCH_LINE * sizeof(size_t));
+    if (region == MAP_FAILED || order == NULL) {
+        print_error("Not enough memory for the latency test!");
+        if (region != MAP_FAILED) munmap(region, max_bytes);
+        free(order);
+        return;
+    }
+    if (multi_node) {
+        bind_to_node(region, max_bytes, node);
+    }
+    // Huge pages where available, so the steps show caches rather than TLB misses
+    madvise(region, max_bytes, MADV_HUGEPAGE);
+
+    cpu_set_t saved;
+    pthread_getaffinity_np(pthread_self(), sizeof(saved), &saved);
+    pin_to_cpu(cpu);
+
+    printf("\n  %s%-10s %10s  %-5s%s\n", COLOR_BOLD, "Working set", "ns/load", "Level", COLOR_RESET);
+    double peak = 0.0;
+    double results[40];
+    int count = 0;
+    for (size_t bytes = 4096; bytes <= max_bytes && count < 40; bytes *= 2) {
+        results[count] = chase_ns(build_chase(region, bytes, order));
+        if (results[count] > peak) peak = results[count];
+        count++;
+    }
+    size_t bytes = 4096;
+    for (int i = 0; i < count; i++, bytes *= 2) {
+        char size_text[32];
+        char bar[41];
+        int width = peak > 0.0 ? (int)(40.0 * results[i] / peak) : 0;
+        format_size(bytes, size_text, sizeof(size_text));
+        memset(bar, '#', (size_t)width);
+        bar[width] = '\0';
+        printf("  %-11s %10.2f  %-5s %s\n", size_text, results[i], cache_level_for(bytes, levels), bar);
+    }
+
+    pthread_setaffinity_np(pthread_self(), sizeof(saved), &saved);
+    free(order);
+    munmap(region, max_bytes);
+}
+
+#endif
+
+/**
+ * Bandwidth and latency on every NUMA node. array_mb 0 sizes each
+ * STREAM array at 4x the LLC (at least 32 MB); threads 0 uses every CPU
+ * of the node.
+ */
+void sysmon_mem_bench(int array_mb, int threads) {
+#ifndef __linux__
+    (void)array_mb; (void)threads;
+    print_warning("The memory benchmark is only available on Linux.");
+#else
+    static int cpus[MEMBENCH_MAX_CPUS];
+    int nodes[MEMBENCH_MAX_NODES];
+    int node_count = numa_node_list(nodes, MEMBENCH_MAX_NODES);
+    bool multi_node = node_count > 1;
+    char message[160];
+
+    for (int n = 0; n < node_count; n++) {
+        int cpu_count = numa_node_cpus(nodes[n], cpus, MEMBENCH_MAX_CPUS);
+        if (cpu_count == 0) {
+            // Memory-only node (CXL, PMEM): nothing to run on it locally
+            printf("\n%sNode %d has no CPUs, skipped.%s\n", COLOR_YELLOW, nodes[n], COLOR_RESET);
+            continue;
+        }
+
+        long long llc = 0;
+        for (int level = 1; level <= 4; level++) {
+            long long size = cpu_data_cache_size(cpus[0], level);
+            if (size > 0) llc = size;
+        }
+        size_t array_bytes = array_mb > 0 ? (size_t)array_mb * 1024 * 1024 : (size_t)llc * 4;
+        if (array_bytes < 32 * 1024 * 1024) array_bytes = 32 * 1024 * 1024;
+        int thread_count = threads > 0 ? threads : cpu_count;
+
+        char llc_text[32];
+        format_size((size_t)llc, llc_text, sizeof(llc_text));
+        printf("\n%sNode %d%s: %d CPU%s, %d thread%s pinned, LLC %s, 3 x %zu MB arrays%s\n", COLOR_CYAN,
+               nodes[n], COLOR_RESET, cpu_count, cpu_count == 1 ? "" : "s", thread_count,
+               thread_count == 1 ? "" : "s", llc > 0 ? llc_text : "unknown", array_bytes / (1024 * 1024),
+               multi_node ? ", memory bound to the node" : "");
+        fflush(stdout);
+
+        double best[KERNEL_COUNT], avg[KERNEL_COUNT];
+        if (!run_stream(nodes[n], cpus, cpu_count, thread_count, array_bytes, multi_node, best, avg)) {
+            snprintf(message, sizeof(message), "Could not set up %zu MB and %d threads on node %d.",
+                     array_bytes * 3 / (1024 * 1024), thread_count, nodes[n]);
+            print_error(message);
+            continue;
+        }
+        printf("\n  %s%-10s %12s %12s%s\n", COLOR_BOLD, "Kernel", "Best MB/s", "Avg MB/s", COLOR_RESET);
+        for (int k = 0; k < KERNEL_COUNT; k++) {
+            printf("  %-10s %12.0f %12.0f\n", kernel_names[k], best[k], avg[k]);
+        }
+        fflush(stdout);
+
+        size_t chase_max = (size_t)llc * 4;
+        if (chase_max < 64 * 1024 * 1024) chase_max = 64 * 1024 * 1024;
+        if (chase_max > 1024 * 1024 * 1024) chase_max = 1024 * 1024 * 1024;
+        run_latency(nodes[n], cpus[0], chase_max, multi_node);
+    }
+#endif
+}
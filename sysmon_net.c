@@ -0,0 +1,557 @@
+/**
+ * DevHelper+Portal CLI - Network Monitor
+ *
+ * Interfaces and addresses come straight from the kernel over rtnetlink,
+ * routes from /proc/net/route and traffic rates from /proc/net/dev, so no
+ * external `ip` binary is needed. The counter table is kept across
+ * refreshes and matched by position first, which keeps sampling cheap on
+ * hosts with hundreds of veth interfaces.
+ */
+
+#define _GNU_SOURCE
+#include "devhelper.h"
+
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <net/if.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <linux/if_arp.h>
+#include <sys/socket.h>
+#endif
+
+#ifdef __linux__
+
+/* ------------------------------------------------------------------ */
+/* /proc/net/dev counters                                              */
+/* ------------------------------------------------------------------ */
+
+/**
+ * Find an interface, trying the slot it had last time first
+ */
+static NetInterface *find_or_add_interface(NetTable *table, const char *name, int hint) {
+    if (hint < table->count && strcmp(table->ifaces[hint].name, name) == 0) {
+        return &table->ifaces[hint];
+    }
+    for (int i = 0; i < table->count; i++) {
+        if (strcmp(table->ifaces[i].name, name) == 0) {
+            return &table->ifaces[i];
+        }
+    }
+
+    if (table->count == table->capacity) {
+        int capacity = table->capacity > 0 ? table->capacity * 2 : 32;
+        NetInterface *grown = realloc(table->ifaces, (size_t)capacity * sizeof(NetInterface));
+        if (grown == NULL) {
+            return NULL;
+        }
+        table->ifaces = grown;
+        table->capacity = capacity;
+    }
+
+    NetInterface *iface = &table->ifaces[table->count++];
+    memset(iface, 0, sizeof(*iface));
+    snprintf(iface->name, sizeof(iface->name), "%s", name);
+    return iface;
+}
+
+static double rate(unsigned long long cur, unsigned long long prev, double seconds) {
+    return cur >= prev ? (double)(cur - prev) / seconds : 0.0;
+}
+
+/**
+ * Sample /proc/net/dev and compute per-interface rates since the last call
+ */
+bool net_table_refresh(NetTable *table) {
+    static _Thread_local char buf[262144];
+    long long now = monotonic_ms();
+
+    if (sysmon_read_file("/proc/net/dev", buf, sizeof(buf)) <= 0) {
+        return false;
+    }
+
+    double seconds = table->last_ms > 0 ? (double)(now - table->last_ms) / 1000.0 : 0.0;
+    for (int i = 0; i < table->count; i++) {
+        table->ifaces[i].present = false;
+    }
+
+    int position = 0;
+    char *line = buf;
+    while (*line) {
+        char *next = strchr(line, '\n');
+        if (next) *next++ = '\0';
+        else next = line + strlen(line);
+
+        char *colon = strchr(line, ':');
+        if (colon == NULL) {
+            line = next;  // Header lines
+            continue;
+        }
+        *colon = '\0';
+        char *name = line;
+        while (*name == ' ') name++;
+
+        NetCounters c;
+        unsigned long long skip;
+        if (sscanf(colon + 1, "%llu %llu %llu %llu %llu %llu %llu %llu %llu %llu %llu %llu",
+                   &c.rx_bytes, &c.rx_packets, &c.rx_errors, &c.rx_drops, &skip, &skip, &skip,
+                   &skip, &c.tx_bytes, &c.tx_packets, &c.tx_errors, &c.tx_drops) != 12) {
+            line = next;
+            continue;
+        }
+
+        NetInterface *iface = find_or_add_interface(table, name, position++);
+        if (iface == NULL) {
+            break;
+        }
+
+        if (seconds > 0.0 && iface->sampled) {
+            const NetCounters *p = &iface->counters;
+            iface->rx_bytes_per_sec = rate(c.rx_bytes, p->rx_bytes, seconds);
+            iface->tx_bytes_per_sec = rate(c.tx_bytes, p->tx_bytes, seconds);
+            iface->rx_packets_per_sec = rate(c.rx_packets, p->rx_packets, seconds);
+            iface->tx_packets_per_sec = rate(c.tx_packets, p->tx_packets, seconds);
+            iface->drops_per_sec = rate(c.rx_drops + c.tx_drops, p->rx_drops + p->tx_drops, seconds);
+            iface->errors_per_sec = rate(c.rx_errors + c.tx_errors, p->rx_errors + p->tx_errors, seconds);
+        }
+        iface->counters = c;
+        iface->sampled = true;
+        iface->present = true;
+        line = next;
+    }
+
+    // Drop interfaces that disappeared, keeping /proc order for the hints
+    int kept = 0;
+    for (int i = 0; i < table->count; i++) {
+        if (table->ifaces[i].present) {
+            if (kept != i) table->ifaces[kept] = table->ifaces[i];
+            kept++;
+        }
+    }
+    table->count = kept;
+    table->last_ms = now;
+    return true;
+}
+
+void net_table_free(NetTable *table) {
+    free(table->ifaces);
+    memset(table, 0, sizeof(*table));
+}
+
+/* ------------------------------------------------------------------ */
+/* rtnetlink                                                           */
+/* ------------------------------------------------------------------ */
+
+typedef void (*NetlinkCallback)(struct nlmsghdr *msg, void *ctx);
+
+/**
+ * Send a dump request (RTM_GETLINK / RTM_GETADDR) and hand every reply
+ * message to the callback
+ */
+static bool netlink_dump(int type, NetlinkCallback callback, void *ctx) {
+    struct {
+        struct nlmsghdr hdr;
+        struct rtgenmsg gen;
+    } req;
+    char buf[16384];
+
+    int fd = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+    if (fd < 0) {
+        return false;
+    }
+
+    memset(&req, 0, sizeof(req));
+    req.hdr.nlmsg_len = NLMSG_LENGTH(sizeof(struct rtgenmsg));
+    req.hdr.nlmsg_type = (unsigned short)type;
+    req.hdr.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+    req.hdr.nlmsg_seq = 1;
+    req.gen.rtgen_family = AF_UNSPEC;
+
+    if (send(fd, &req, req.hdr.nlmsg_len, 0) < 0) {
+        close(fd);
+        return false;
+    }
+
+    bool done = false;
+    bool ok = true;
+    while (!done) {
+        ssize_t len = recv(fd, buf, sizeof(buf), 0);
+        if (len <= 0) {
+            ok = false;
+            break;
+        }
+
+        for (struct nlmsghdr *msg = (struct nlmsghdr *)buf; NLMSG_OK(msg, (unsigned int)len);
+             msg = NLMSG_NEXT(msg, len)) {
+            if (msg->nlmsg_type == NLMSG_DONE) {
+                done = true;
+                break;
+            }
+            if (msg->nlmsg_type == NLMSG_ERROR) {
+                done = true;
+                ok = false;
+                break;
+            }
+            callback(msg, ctx);
+        }
+    }
+
+    close(fd);
+    return ok;
+}
+
+typedef struct {
+    int index;
+    char name[IFNAMSIZ];
+    unsigned int flags;
+    unsigned int mtu;
+    unsigned char operstate;
+    char mac[24];
+} LinkInfo;
+
+typedef struct {
+    LinkInfo *links;
+    int count;
+    int capacity;
+} LinkList;
+
+static void collect_link(struct nlmsghdr *msg, void *ctx) {
+    LinkList *list = ctx;
+
+    if (msg->nlmsg_type != RTM_NEWLINK) {
+        return;
+    }
+    if (list->count == list->capacity) {
+        int capacity = list->capacity > 0 ? list->capacity * 2 : 16;
+        LinkInfo *grown = realloc(list->links, (size_t)capacity * sizeof(LinkInfo));
+        if (grown == NULL) {
+            return;
+        }
+        list->links = grown;
+        list->capacity = capacity;
+    }
+
+    struct ifinfomsg *ifi = NLMSG_DATA(msg);
+    LinkInfo *link = &list->links[list->count];
+    memset(link, 0, sizeof(*link));
+    link->index = ifi->ifi_index;
+    link->flags = ifi->ifi_flags;
+
+    int attr_len = (int)IFLA_PAYLOAD(msg);
+    for (struct rtattr *attr = IFLA_RTA(ifi); RTA_OK(attr, attr_len);
+         attr = RTA_NEXT(attr, attr_len)) {
+        switch (attr->rta_type) {
+            case IFLA_IFNAME:
+                snprintf(link->name, sizeof(link->name), "%s", (char *)RTA_DATA(attr));
+                break;
+            case IFLA_MTU:
+                link->mtu = *(unsigned int *)RTA_DATA(attr);
+                break;
+            case IFLA_OPERSTATE:
+                link->operstate = *(unsigned char *)RTA_DATA(attr);
+                break;
+            case IFLA_ADDRESS:
+                if (RTA_PAYLOAD(attr) == 6) {
+                    unsigned char *m = RTA_DATA(attr);
+                    snprintf(link->mac, sizeof(link->mac), "%02x:%02x:%02x:%02x:%02x:%02x",
+                             m[0], m[1], m[2], m[3], m[4], m[5]);
+                }
+                break;
+        }
+    }
+    list->count++;
+}
+
+typedef struct {
+    int index;
+    int seq;                // Dump order, keeps addresses stable when sorted
+    int family;
+    unsigned int prefix;
+    char text[INET6_ADDRSTRLEN];
+} AddrInfo;
+
+typedef struct {
+    AddrInfo *addrs;
+    int count;
+    int capacity;
+} AddrList;
+
+static void collect_addr(struct nlmsghdr *msg, void *ctx) {
+    AddrList *list = ctx;
+
+    if (msg->nlmsg_type != RTM_NEWADDR) {
+        return;
+    }
+    struct ifaddrmsg *ifa = NLMSG_DATA(msg);
+
+    void *addr = NULL;
+    int attr_len = (int)IFA_PAYLOAD(msg);
+    for (struct rtattr *attr = IFA_RTA(ifa); RTA_OK(attr, attr_len);
+         attr = RTA_NEXT(attr, attr_len)) {
+        // IFA_LOCAL is the interface's own address on point-to-point links
+        if (attr->rta_type == IFA_LOCAL || (attr->rta_type == IFA_ADDRESS && addr == NULL)) {
+            addr = RTA_DATA(attr);
+        }
+    }
+    if (addr == NULL) {
+        return;
+    }
+
+    if (list->count == list->capacity) {
+        int capacity = list->capacity > 0 ? list->capacity * 2 : 16;
+        AddrInfo *grown = realloc(list->addrs, (size_t)capacity * sizeof(AddrInfo));
+        if (grown == NULL) {
+            return;
+        }
+        list->addrs = grown;
+        list->capacity = capacity;
+    }
+
+    AddrInfo *info = &list->addrs[list->count];
+    if (inet_ntop(ifa->ifa_family, addr, info->text, sizeof(info->text)) != NULL) {
+        info->index = (int)ifa->ifa_index;
+        info->seq = list->count;
+        info->family = ifa->ifa_family;
+        info->prefix = ifa->ifa_prefixlen;
+        list->count++;
+    }
+}
+
+static int compare_addrs(const void *a, const void *b) {
+    const AddrInfo *x = a, *y = b;
+    if (x->index != y->index) return x->index < y->index ? -1 : 1;
+    return x->seq - y->seq;
+}
+
+static int compare_links(const void *a, const void *b) {
+    const LinkInfo *x = a, *y = b;
+    return (x->index > y->index) - (x->index < y->index);
+}
+
+static const char *operstate_name(unsigned char state) {
+    static const char *names[] = {
+        "UNKNOWN", "NOTPRESENT", "DOWN", "LOWERLAYERDOWN", "TESTING", "DORMANT", "UP"
+    };
+    return state < sizeof(names) / sizeof(names[0]) ? names[state] : "UNKNOWN";
+}
+
+/**
+ * Print interfaces with their addresses, asking the kernel directly
+ */
+static void print_interfaces(void) {
+    LinkList list;
+    AddrList addrs;
+
+    memset(&list, 0, sizeof(list));
+    memset(&addrs, 0, sizeof(addrs));
+    if (!netlink_dump(RTM_GETLINK, collect_link, &list) ||
+        !netlink_dump(RTM_GETADDR, collect_addr, &addrs)) {
+        print_error("Could not query interfaces over rtnetlink!");
+        free(list.links);
+        free(addrs.addrs);
+        return;
+    }
+
+    // One dump each, then a merge walk by interface index
+    qsort(list.links, (size_t)list.count, sizeof(LinkInfo), compare_links);
+    qsort(addrs.addrs, (size_t)addrs.count, sizeof(AddrInfo), compare_addrs);
+
+    int a = 0;
+    for (int i = 0; i < list.count; i++) {
+        const LinkInfo *link = &list.links[i];
+        const char *color = link->operstate == 6 || (link->flags & IFF_LOOPBACK) ? COLOR_GREEN : COLOR_YELLOW;
+
+        printf("  %s%-16s%s %-8s mtu %-6u %s\n", color, link->name, COLOR_RESET,
+               (link->flags & IFF_LOOPBACK) ? "LOOPBACK" : operstate_name(link->operstate),
+               link->mtu, link->mac);
+
+        while (a < addrs.count && addrs.addrs[a].index < link->index) a++;
+        for (; a < addrs.count && addrs.addrs[a].index == link->index; a++) {
+            printf("      %-6s %s/%u\n", addrs.addrs[a].family == AF_INET6 ? "inet6" : "inet",
+                   addrs.addrs[a].text, addrs.addrs[a].prefix);
+        }
+    }
+
+    free(list.links);
+    free(addrs.addrs);
+}
+
+/**
+ * Print the IPv4 routing table from /proc/net/route
+ */
+static void print_routes(void) {
+    char buf[65536];
+
+    if (sysmon_read_file("/proc/net/route", buf, sizeof(buf)) <= 0) {
+        print_error("Could not read /proc/net/route!");
+        return;
+    }
+
+    char *line = strchr(buf, '\n');  // Skip the header
+    while (line && *++line) {
+        char *next = strchr(line, '\n');
+        if (next) *next = '\0';
+
+        char iface[IFNAMSIZ + 1];
+        unsigned int dest, gateway, flags, refcnt, use, metric, mask;
+        if (sscanf(line, "%16s %x %x %x %u %u %u %x", iface, &dest, &gateway, &flags,
+                   &refcnt, &use, &metric, &mask) == 8) {
+            char dest_text[INET_ADDRSTRLEN], gw_text[INET_ADDRSTRLEN];
+            struct in_addr d = { dest }, g = { gateway };
+            int prefix = __builtin_popcount(mask);
+
+            inet_ntop(AF_INET, &d, dest_text, sizeof(dest_text));
+            inet_ntop(AF_INET, &g, gw_text, sizeof(gw_text));
+            if (dest == 0 && mask == 0) {
+                printf("  default via %s dev %s metric %u\n", gw_text, iface, metric);
+            } else if (gateway != 0) {
+                printf("  %s/%d via %s dev %s metric %u\n", dest_text, prefix, gw_text, iface, metric);
+            } else {
+                printf("  %s/%d dev %s metric %u\n", dest_text, prefix, iface, metric);
+            }
+        }
+        line = next;
+    }
+}
+
+/* ------------------------------------------------------------------ */
+/* Views                                                               */
+/* ------------------------------------------------------------------ */
+
+static void render_net_frame(LiveScreen *screen, NetTable *table, int interval_ms) {
+    static TopNItem top[PROC_TOP_MAX];
+    TopNHeap heap;
+    double rx_total = 0.0, tx_total = 0.0;
+    int row = 0;
+
+    for (int i = 0; i < table->count; i++) {
+        if (strcmp(table->ifaces[i].name, "lo") != 0) {
+            rx_total += table->ifaces[i].rx_bytes_per_sec;
+            tx_total += table->ifaces[i].tx_bytes_per_sec;
+        }
+    }
+
+    live_screen_begin(screen);
+    live_screen_print(screen, row, 0, CELL_BOLD, "DevHelper Network");
+    live_screen_print(screen, row++, 19, CELL_CYAN,
+                      "%d ifaces  rx %.2f  tx %.2f MB/s  %d ms  (any key exits)",
+                      table->count, rx_total / 1e6, tx_total / 1e6, interval_ms);
+    row++;
+    live_screen_print(screen, row++, 0, CELL_BOLD, "%-16s %10s %10s %10s %10s %8s %8s",
+                      "Interface", "rx MB/s", "tx MB/s", "rx pkt/s", "tx pkt/s", "drop/s", "err/s");
+
+    // Busiest interfaces first; unchanged order among idle ones
+    int n = screen->rows - row;
+    if (n > PROC_TOP_MAX) n = PROC_TOP_MAX;
+    if (n < 1) return;
+    topn_init(&heap, top, n);
+    for (int i = 0; i < table->count; i++) {
+        const NetInterface *iface = &table->ifaces[i];
+        topn_offer(&heap, iface->rx_bytes_per_sec + iface->tx_bytes_per_sec +
+                          (double)(table->count - i) * 1e-9, i);
+    }
+    int count = topn_finish(&heap);
+
+    for (int i = 0; i < count; i++) {
+        const NetInterface *iface = &table->ifaces[top[i].index];
+        CellColor color = iface->errors_per_sec > 0.0 || iface->drops_per_sec > 0.0 ? CELL_RED
+                        : iface->rx_bytes_per_sec + iface->tx_bytes_per_sec > 0.0 ? CELL_GREEN
+                        : CELL_DEFAULT;
+        live_screen_print(screen, row++, 0, color, "%-16s %10.3f %10.3f %10.0f %10.0f %8.0f %8.0f",
+                          iface->name, iface->rx_bytes_per_sec / 1e6, iface->tx_bytes_per_sec / 1e6,
+                          iface->rx_packets_per_sec, iface->tx_packets_per_sec,
+                          iface->drops_per_sec, iface->errors_per_sec);
+    }
+}
+
+/**
+ * One-shot report: interfaces, routes and a one-second traffic sample
+ */
+void display_network_native(void) {
+    NetTable table;
+
+    printf("%sNetwork Interfaces:%s\n", COLOR_CYAN, COLOR_RESET);
+    print_interfaces();
+
+    printf("\n%sRouting Table (IPv4):%s\n", COLOR_CYAN, COLOR_RESET);
+    print_routes();
+
+    printf("\n%sActive Connections:%s\n", COLOR_CYAN, COLOR_RESET);
+    display_socket_summary();
+
+    printf("\n%sTraffic (1 second sample):%s\n", COLOR_CYAN, COLOR_RESET);
+    memset(&table, 0, sizeof(table));
+    if (!net_table_refresh(&table)) {
+        print_error("Could not read /proc/net/dev!");
+        return;
+    }
+    fflush(stdout);
+    sleep(1);
+    net_table_refresh(&table);
+
+    printf("  %-16s %10s %10s %10s %10s %8s %8s\n",
+           "Interface", "rx MB/s", "tx MB/s", "rx pkt/s", "tx pkt/s", "drop/s", "err/s");
+    for (int i = 0; i < table.count; i++) {
+        const NetInterface *iface = &table.ifaces[i];
+        printf("  %-16s %10.3f %10.3f %10.0f %10.0f %8.0f %8.0f\n", iface->name,
+               iface->rx_bytes_per_sec / 1e6, iface->tx_bytes_per_sec / 1e6,
+               iface->rx_packets_per_sec, iface->tx_packets_per_sec,
+               iface->drops_per_sec, iface->errors_per_sec);
+    }
+    net_table_free(&table);
+}
+
+#endif
+
+/**
+ * Continuously refreshed per-interface throughput
+ */
+void sysmon_net_view(int interval_ms) {
+#ifndef __linux__
+    (void)interval_ms;
+    print_warning("The network view reads /proc/net/dev and is only available on Linux.");
+#else
+    NetTable table;
+    LiveScreen screen;
+
+    if (interval_ms < 100) interval_ms = 100;
+    if (interval_ms > 5000) interval_ms = 5000;
+
+    memset(&table, 0, sizeof(table));
+    if (!net_table_refresh(&table)) {
+        print_error("Could not read /proc/net/dev!");
+        return;
+    }
+    if (!live_screen_init(&screen)) {
+        print_error("Not enough memory for the network view!");
+        net_table_free(&table);
+        return;
+    }
+
+    terminal_set_raw(true);
+    render_net_frame(&screen, &table, interval_ms);
+    live_screen_flush(&screen);
+
+    long long next_tick = monotonic_ms() + interval_ms;
+    while (wait_for_key((int)(next_tick - monotonic_ms())) < 0) {
+        long long now = monotonic_ms();
+        if (now < next_tick) {
+            continue;
+        }
+        next_tick += interval_ms;
+        if (next_tick <= now) {
+            next_tick = now + interval_ms;
+        }
+
+        net_table_refresh(&table);
+        render_net_frame(&screen, &table, interval_ms);
+        live_screen_flush(&screen);
+    }
+
+    terminal_set_raw(false);
+    printf("%s\033[H\033[2J", COLOR_RESET);
+    fflush(stdout);
+    live_screen_free(&screen);
+    net_table_free(&table);
+#endif
+}
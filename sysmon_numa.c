@@ -0,0 +1,469 @@
+/**
+ * DevHelper+Portal CLI - NUMA Nodes and CPU Caches
+ *
+ * Readers for /sys/devices/system/node and /sys/devices/system/cpu:
+ * which nodes are online, which CPUs belong to each, and the cache
+ * hierarchy a CPU sees. Kernels built without NUMA have no node
+ * directory; they are reported as a single node 0 holding every online
+ * CPU, so callers never need a special case for single-node hosts.
+ */
+
+#define _GNU_SOURCE
+#include "devhelper.h"
+
+#ifdef __linux__
+#include <sys/utsname.h>
+#endif
+
+/**
+ * Parse a kernel CPU/node list such as "0-3,8-11" into `out`.
+ * Returns how many entries were stored.
+ */
+int parse_cpu_list(const char *text, int *out, int max) {
+    int count = 0;
+    const char *p = text;
+
+    while (*p != '\0' && count < max) {
+        char *end;
+        long first = strtol(p, &end, 10);
+        if (end == p) {
+            break;
+        }
+        long last = first;
+        p = end;
+        if (*p == '-') {
+            last = strtol(p + 1, &end, 10);
+            p = end;
+        }
+        for (long i = first; i <= last && count < max; i++) {
+            out[count++] = (int)i;
+        }
+        if (*p != ',') {
+            break;
+        }
+        p++;
+    }
+    return count;
+}
+
+/**
+ * Online NUMA nodes; a single node 0 when the kernel has no NUMA support
+ */
+int numa_node_list(int *nodes, int max) {
+    char buf[256];
+
+    if (max < 1) {
+        return 0;
+    }
+    if (sysmon_read_file("/sys/devices/system/node/online", buf, sizeof(buf)) > 0) {
+        int count = parse_cpu_list(buf, nodes, max);
+        if (count > 0) {
+            return count;
+        }
+    }
+    nodes[0] = 0;
+    return 1;
+}
+
+/**
+ * CPUs on `node`; every online CPU when the node directory is missing
+ */
+int numa_node_cpus(int node, int *cpus, int max) {
+    char path[96];
+    char buf[1024];
+
+    snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+    if (sysmon_read_file(path, buf, sizeof(buf)) > 0) {
+        return parse_cpu_list(buf, cpus, max);
+    }
+    if (sysmon_read_file("/sys/devices/system/cpu/online", buf, sizeof(buf)) > 0) {
+        int count = parse_cpu_list(buf, cpus, max);
+        if (count > 0) {
+            return count;
+        }
+    }
+
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    if (online < 1) {
+        online = 1;
+    }
+    int count = 0;
+    for (long i = 0; i < online && count < max; i++) {
+        cpus[count++] = (int)i;
+    }
+    return count;
+}
+
+/**
+ * Cache levels seen by `cpu` from cpuN/cache/indexN, in index order
+ */
+int read_cpu_caches(int cpu, CpuCache *caches, int max) {
+    int count = 0;
+
+    for (int index = 0; count < max; index++) {
+        char path[128];
+        char buf[256];
+
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cache/index%d/level", cpu, index);
+        if (sysmon_read_file(path, buf, sizeof(buf)) <= 0) {
+            break;
+        }
+        CpuCache *cache = &caches[count];
+        memset(cache, 0, sizeof(*cache));
+        cache->level = atoi(buf);
+
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cache/index%d/type", cpu, index);
+        if (sysmon_read_file(path, buf, sizeof(buf)) > 0) {
+            buf[strcspn(buf, "\n")] = '\0';
+            snprintf(cache->type, sizeof(cache->type), "%.15s", buf);
+        }
+
+        // "48K", "2048K", occasionally "32M"
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cache/index%d/size", cpu, index);
+        if (sysmon_read_file(path, buf, sizeof(buf)) > 0) {
+            char *end;
+            long long size = strtoll(buf, &end, 10);
+            if (*end == 'K') size *= 1024;
+            else if (*end == 'M') size *= 1024 * 1024;
+            cache->size_bytes = size;
+        }
+
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cache/index%d/coherency_line_size",
+                 cpu, index);
+        if (sysmon_read_file(path, buf, sizeof(buf)) > 0) {
+            cache->line_size = atoi(buf);
+        }
+
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cache/index%d/shared_cpu_list", cpu, index);
+        if (sysmon_read_file(path, buf, sizeof(buf)) > 0) {
+            buf[strcspn(buf, "\n")] = '\0';
+            snprintf(cache->shared_cpus, sizeof(cache->shared_cpus), "%.63s", buf);
+        }
+        count++;
+    }
+    return count;
+}
+
+/**
+ * Size of the data (or unified) cache at `level` for `cpu`, 0 if none
+ */
+long long cpu_data_cache_size(int cpu, int level) {
+    CpuCache caches[8];
+    int count = read_cpu_caches(cpu, caches, 8);
+
+    for (int i = 0; i < count; i++) {
+        if (caches[i].level == level && strcmp(caches[i].type, "Instruction") != 0) {
+            return caches[i].size_bytes;
+        }
+    }
+    return 0;
+}
+
+#ifdef __linux__
+
+#define TOPO_MAX_CPUS 1024
+#define TOPO_MAX_NODES 64
+#define TOPO_MAX_CACHES 8
+
+typedef struct {
+    int cpu;
+    int package;
+    int core;                       // core_id, unique within a package
+    int node;
+} CpuPlace;
+
+static int read_sys_int(const char *path, int fallback) {
+    char buf[32];
+    return sysmon_read_file(path, buf, sizeof(buf)) > 0 ? atoi(buf) : fallback;
+}
+
+/**
+ * Value of "Node N <key>:" in nodeN/meminfo, in kB; 0 if missing
+ */
+static unsigned long long node_meminfo(const char *text, const char *key) {
+    size_t key_len = strlen(key);
+
+    for (const char *line = text; line != NULL && *line != '\0'; ) {
+        const char *field = strchr(line, ' ');
+        field = field != NULL ? strchr(field + 1, ' ') : NULL;      // Skip "Node N"
+        if (field != NULL) {
+            while (*field == ' ') field++;
+            if (strncmp(field, key, key_len) == 0 && field[key_len] == ':') {
+                return strtoull(field + key_len + 1, NULL, 10);
+            }
+        }
+        line = strchr(line, '\n');
+        if (line != NULL) line++;
+    }
+    return 0;
+}
+
+static unsigned long long numastat_value(const char *text, const char *key) {
+    const char *p = strstr(text, key);
+    return p != NULL ? strtoull(p + strlen(key), NULL, 10) : 0;
+}
+
+static int compare_places(const void *a, const void *b) {
+    const CpuPlace *x = a, *y = b;
+    if (x->package != y->package) return x->package - y->package;
+    if (x->core != y->core) return x->core - y->core;
+    return x->cpu - y->cpu;
+}
+
+/**
+ * Cache levels of cpu0 with how many separate instances of each exist
+ * (one per distinct shared_cpu_list across all CPUs)
+ */
+static void print_cache_levels(const CpuPlace *places, int count) {
+    static char seen[TOPO_MAX_CACHES][TOPO_MAX_CPUS][64];
+    int instances[TOPO_MAX_CACHES] = { 0 };
+    CpuCache first[TOPO_MAX_CACHES];
+    int levels = read_cpu_caches(places[0].cpu, first, TOPO_MAX_CACHES);
+
+    if (levels == 0) {
+        return;
+    }
+    for (int i = 0; i < count; i++) {
+        CpuCache caches[TOPO_MAX_CACHES];
+        int n = read_cpu_caches(places[i].cpu, caches, TOPO_MAX_CACHES);
+        for (int c = 0; c < n && c < levels; c++) {
+            bool known = false;
+            for (int k = 0; k < instances[c] && !known; k++) {
+                known = strcmp(seen[c][k], caches[c].shared_cpus) == 0;
+            }
+            if (!known && instances[c] < TOPO_MAX_CPUS) {
+                snprintf(seen[c][instances[c]++], 64, "%s", caches[c].shared_cpus);
+            }
+        }
+    }
+
+    printf("  Caches:     ");
+    for (int c = 0; c < levels; c++) {
+        char size[32];
+        const char *kind = strcmp(first[c].type, "Data") == 0 ? "d"
+                         : strcmp(first[c].type, "Instruction") == 0 ? "i" : "";
+        format_kb((unsigned long long)first[c].size_bytes / 1024, size, sizeof(size));
+        printf("%sL%d%s %s x%d", c > 0 ? ", " : "", first[c].level, kind, size, instances[c]);
+    }
+    printf("\n");
+}
+
+/**
+ * Kernel line (what `uname -a` used to print), then sockets, cores,
+ * SMT siblings, caches and per-node memory
+ */
+void display_cpu_topology(void) {
+    static CpuPlace places[TOPO_MAX_CPUS];
+    static int cpu_ids[TOPO_MAX_CPUS];
+    int nodes[TOPO_MAX_NODES];
+    char path[128];
+    char buf[4096];
+    int count = 0;
+
+    if (sysmon_read_file("/sys/devices/system/cpu/online", buf, sizeof(buf)) > 0) {
+        count = parse_cpu_list(buf, cpu_ids, TOPO_MAX_CPUS);
+    }
+    if (count == 0) {
+        count = numa_node_cpus(-1, cpu_ids, TOPO_MAX_CPUS);
+    }
+    for (int i = 0; i < count; i++) {
+        places[i].cpu = cpu_ids[i];
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/physical_package_id", cpu_ids[i]);
+        places[i].package = read_sys_int(path, 0);
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/core_id", cpu_ids[i]);
+        places[i].core = read_sys_int(path, cpu_ids[i]);
+        places[i].node = 0;
+    }
+
+    int node_count = numa_node_list(nodes, TOPO_MAX_NODES);
+    for (int n = 0; n < node_count; n++) {
+        int node_cpus[TOPO_MAX_CPUS];
+        int ncpus = numa_node_cpus(nodes[n], node_cpus, TOPO_MAX_CPUS);
+        for (int c = 0; c < ncpus; c++) {
+            for (int i = 0; i < count; i++) {
+                if (places[i].cpu == node_cpus[c]) places[i].node = nodes[n];
+            }
+        }
+    }
+
+    qsort(places, (size_t)count, sizeof(CpuPlace), compare_places);
+    int sockets = 0, cores = 0, max_threads = 1, threads = 0;
+    for (int i = 0; i < count; i++) {
+        bool new_socket = i == 0 || places[i].package != places[i - 1].package;
+        bool new_core = new_socket || places[i].core != places[i - 1].core;
+        if (new_socket) sockets++;
+        if (new_core) {
+            cores++;
+            threads = 0;
+        }
+        if (++threads > max_threads) max_threads = threads;
+    }
+
+    char model[128] = "";
+    if (sysmon_read_file("/proc/cpuinfo", buf, sizeof(buf)) > 0) {
+        const char *p = strstr(buf, "model name");
+        if (p != NULL && (p = strchr(p, ':')) != NULL) {
+            snprintf(model, sizeof(model), "%.*s", (int)strcspn(p + 2, "\n"), p + 2);
+        }
+    }
+
+    struct utsname uts;
+    if (uname(&uts) == 0) {
+        printf("%sKernel:%s %s %s %s (%s)\n\n", COLOR_CYAN, COLOR_RESET, uts.sysname, uts.release,
+               uts.machine, uts.nodename);
+    }
+
+    printf("%sCPU Topology:%s\n", COLOR_CYAN, COLOR_RESET);
+    if (model[0] != '\0') {
+        printf("  Model:      %s\n", model);
+    }
+    printf("  Layout:     %d socket%s, %d core%s, %d CPU%s", sockets, sockets == 1 ? "" : "s", cores,
+           cores == 1 ? "" : "s", count, count == 1 ? "" : "s");
+    if (max_threads > 1) {
+        printf(" (SMT, %d threads per core)\n", max_threads);
+    } else {
+        printf(" (no SMT)\n");
+    }
+
+    // One line per socket; SMT siblings grouped as "0+8"
+    for (int i = 0; i < count; ) {
+        int package = places[i].package;
+        printf("  Socket %d:   ", package);
+        int shown = 0;
+        while (i < count && places[i].package == package) {
+            int core = places[i].core;
+            if (shown == 16) {
+                printf(" ...");
+                while (i < count && places[i].package == package) i++;
+                break;
+            }
+            printf("%s%d", shown++ > 0 ? " " : "", places[i].cpu);
+            for (i++; i < count && places[i].package == package && places[i].core == core; i++) {
+                printf("+%d", places[i].cpu);
+            }
+        }
+        printf("\n");
+    }
+    if (count > 0) {
+        print_cache_levels(places, count);
+    }
+
+    printf("\n%sNUMA Memory:%s\n", COLOR_CYAN, COLOR_RESET);
+    if (node_count == 1) {
+        printf("  Single node: all memory is local to every CPU\n");
+    }
+    printf("  %-6s %-16s %10s %10s %10s %7s", "Node", "CPUs", "Total", "Used", "Free", "Used%");
+    if (node_count > 1) {
+        printf(" %12s %12s", "numa_miss", "other_node");
+    }
+    printf("\n");
+    for (int n = 0; n < node_count; n++) {
+        char cpus[17] = "-";
+        char total[16], used[16], free_text[16];
+
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", nodes[n]);
+        if (sysmon_read_file(path, buf, sizeof(buf)) > 1) {
+            snprintf(cpus, sizeof(cpus), "%.16s", buf);
+            cpus[strcspn(cpus, "\n")] = '\0';
+        }
+
+        unsigned long long mem_total = 0, mem_free = 0;
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/meminfo", nodes[n]);
+        if (sysmon_read_file(path, buf, sizeof(buf)) > 0) {
+            mem_total = node_meminfo(buf, "MemTotal");
+            mem_free = node_meminfo(buf, "MemFree");
+        } else {
+            // No NUMA in this kernel: the one node is the whole machine
+            MemorySnapshot mem;
+            if (sysmon_read_memory(&mem)) {
+                mem_total = mem.total_kb;
+                mem_free = mem.free_kb;
+            }
+        }
+        unsigned long long mem_used = mem_total > mem_free ? mem_total - mem_free : 0;
+        double percent = mem_total > 0 ? 100.0 * (double)mem_used / (double)mem_total : 0.0;
+        format_kb(mem_total, total, sizeof(total));
+        format_kb(mem_used, used, sizeof(used));
+        format_kb(mem_free, free_text, sizeof(free_text));
+
+        printf("  %-6d %-16s %10s %10s %10s %s%6.1f%%%s", nodes[n], cpus, total, used, free_text,
+               percent >= 90.0 ? COLOR_RED : percent >= 70.0 ? COLOR_YELLOW : COLOR_GREEN, percent, COLOR_RESET);
+        if (node_count > 1) {
+            snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/numastat", nodes[n]);
+            if (sysmon_read_file(path, buf, sizeof(buf)) > 0) {
+                printf(" %12llu %12llu", numastat_value(buf, "numa_miss "), numastat_value(buf, "other_node "));
+            }
+        }
+        printf("\n");
+    }
+}
+
+/**
+ * How a process's resident memory is spread across nodes, from the
+ * N<node>=<pages> fields of /proc/<pid>/numa_maps
+ */
+void display_numa_process(int pid) {
+    static unsigned long long total_kb[TOPO_MAX_NODES], anon_kb[TOPO_MAX_NODES];
+    char path[64];
+    char message[128];
+    char line[4096];
+    int nodes[TOPO_MAX_NODES];
+    int node_count = numa_node_list(nodes, TOPO_MAX_NODES);
+    unsigned long long sum = 0;
+
+    memset(total_kb, 0, sizeof(total_kb));
+    memset(anon_kb, 0, sizeof(anon_kb));
+    snprintf(path, sizeof(path), "/proc/%d/numa_maps", pid);
+    FILE *fp = fopen(path, "r");
+    if (fp == NULL) {
+        snprintf(message, sizeof(message), "Cannot read %s (no such process, or no NUMA support).", path);
+        print_error(message);
+        return;
+    }
+
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        unsigned long long pages[TOPO_MAX_NODES] = { 0 };
+        unsigned long long page_kb = 4;
+        bool anon = false;
+
+        for (char *token = strtok(line, " \n"); token != NULL; token = strtok(NULL, " \n")) {
+            if (token[0] == 'N' && token[1] >= '0' && token[1] <= '9') {
+                int node = atoi(token + 1);
+                char *eq = strchr(token, '=');
+                if (eq != NULL && node >= 0 && node < TOPO_MAX_NODES) {
+                    pages[node] += strtoull(eq + 1, NULL, 10);
+                }
+            } else if (strncmp(token, "kernelpagesize_kB=", 18) == 0) {
+                page_kb = strtoull(token + 18, NULL, 10);
+            } else if (strncmp(token, "anon=", 5) == 0) {
+                anon = true;
+            }
+        }
+        for (int n = 0; n < TOPO_MAX_NODES; n++) {
+            unsigned long long kb = pages[n] * page_kb;
+            total_kb[n] += kb;
+            if (anon) anon_kb[n] += kb;
+            sum += kb;
+        }
+    }
+    fclose(fp);
+
+    printf("\n%sMemory of pid %d by node:%s\n", COLOR_CYAN, pid, COLOR_RESET);
+    if (node_count == 1) {
+        char total[16];
+        format_kb(sum, total, sizeof(total));
+        printf("  Single node: all %s resident on node %d\n", total, nodes[0]);
+        return;
+    }
+    printf("  %-6s %10s %10s %7s\n", "Node", "Resident", "Anon", "Share");
+    for (int i = 0; i < node_count; i++) {
+        int n = nodes[i];
+        char total[16], anon[16];
+        format_kb(total_kb[n], total, sizeof(total));
+        format_kb(anon_kb[n], anon, sizeof(anon));
+        printf("  %-6d %10s %10s %6.1f%%\n", n, total, anon,
+               sum > 0 ? 100.0 * (double)total_kb[n] / (double)sum : 0.0);
+    }
+}
+
+#endif
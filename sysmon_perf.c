@@ -0,0 +1,599 @@
+/**
+ * DevHelper+Portal CLI - CPU Efficiency (perf counters)
+ *
+ * Opens perf_event_open counters per online core, or for one process and
+ * its threads, and reports IPC, cache and branch miss rates next to CPU
+ * time. A process gets counters on each of its threads, found by
+ * rescanning /proc/[pid]/task every sample, and the rows are summed;
+ * threads that start and exit between two samples are not seen.
+ * Hardware counters are often missing in VMs; then only the software
+ * events (cpu-clock, context switches, page faults) are shown.
+ * Counters are opened individually rather than as a group, so each one
+ * is scaled by its own time_enabled / time_running when the kernel has
+ * to multiplex them onto too few PMU slots.
+ */
+
+#define _GNU_SOURCE
+#include "devhelper.h"
+
+#ifdef __linux__
+#include <dirent.h>
+#include <errno.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#endif
+
+#define PERF_MAX_THREADS 4096
+
+#ifdef __linux__
+
+// Ten fds per thread soon passes the usual 1024 soft limit
+static struct rlimit saved_nofile;
+static bool nofile_raised = false;
+
+typedef struct {
+    const char *name;
+    unsigned int type;
+    unsigned long long config;
+    bool hardware;
+} PerfEventSpec;
+
+static const PerfEventSpec perf_specs[PERF_COUNTER_COUNT] = {
+    { "cycles",         PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES,          true },
+    { "instructions",   PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS,        true },
+    { "cache-refs",     PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES,    true },
+    { "cache-misses",   PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES,        true },
+    { "branches",       PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_INSTRUCTIONS, true },
+    { "branch-misses",  PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES,       true },
+    { "cpu-clock",      PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CPU_CLOCK,           false },
+    { "ctx-switches",   PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES,    false },
+    { "page-faults",    PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS,         false },
+    { "migrations",     PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CPU_MIGRATIONS,      false },
+};
+
+static int perf_open(const PerfEventSpec *spec, int pid, int cpu) {
+    struct perf_event_attr attr;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = spec->type;
+    attr.config = spec->config;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    attr.exclude_guest = 1;
+
+    return (int)syscall(SYS_perf_event_open, &attr, pid, cpu, -1, PERF_FLAG_FD_CLOEXEC);
+}
+
+/**
+ * Value, time_enabled, time_running for one counter
+ */
+static bool perf_read_counter(int fd, unsigned long long out[3]) {
+    return fd >= 0 && read(fd, out, 3 * sizeof(unsigned long long)) == 3 * sizeof(unsigned long long);
+}
+
+/**
+ * Per-core busy time from /proc/stat, matched to targets by CPU number.
+ * In per-core mode cpu-clock ticks through idle too, so it can't give CPU%.
+ */
+static void read_core_times(PerfSession *session) {
+    static char buf[65536];
+    const char *line = buf;
+
+    if (sysmon_read_file("/proc/stat", buf, sizeof(buf)) <= 0) {
+        return;
+    }
+    while ((line = strstr(line, "\ncpu")) != NULL) {
+        int cpu;
+        CpuTimes t;
+        line += 4;
+        if (sscanf(line, "%d %llu %llu %llu %llu %llu %llu %llu %llu", &cpu, &t.user, &t.nice,
+                   &t.system, &t.idle, &t.iowait, &t.irq, &t.softirq, &t.steal) != 9) {
+            continue;
+        }
+        for (int i = 0; i < session->target_count; i++) {
+            PerfTarget *target = &session->targets[i];
+            if (target->cpu == cpu) {
+                target->busy_percent = sysmon_cpu_busy_percent(&target->times, &t);
+                target->times = t;
+                break;
+            }
+        }
+    }
+}
+
+static void close_target(PerfTarget *target) {
+    for (int c = 0; c < PERF_COUNTER_COUNT; c++) {
+        if (target->fds[c] >= 0) {
+            close(target->fds[c]);
+            target->fds[c] = -1;
+        }
+    }
+    target->online = false;
+}
+
+/**
+ * Open one target's counters. Software events go first: cpu-clock
+ * failing with ENODEV means the CPU went offline, so the target is
+ * skipped, while a hardware event failing with ENOENT, EOPNOTSUPP or
+ * ENODEV means there is no usable PMU and hardware events are dropped
+ * for every target.
+ */
+static void open_target(PerfSession *session, PerfTarget *target) {
+    int pid = session->pid > 0 ? target->tid : -1;
+
+    target->online = false;
+    memset(target->raw, 0, sizeof(target->raw));
+    for (int c = 0; c < PERF_COUNTER_COUNT; c++) {
+        target->fds[c] = -1;
+    }
+    for (int pass = 0; pass < 2; pass++) {
+        for (int c = 0; c < PERF_COUNTER_COUNT; c++) {
+            bool hardware = perf_specs[c].hardware;
+            if (hardware != (pass == 1) || (hardware && !session->hardware)) {
+                continue;
+            }
+            target->fds[c] = perf_open(&perf_specs[c], pid, target->cpu);
+            if (target->fds[c] >= 0) {
+                target->online = true;
+                continue;
+            }
+            session->last_errno = errno;
+            if (!hardware && (errno == ENODEV || errno == ESRCH)) {
+                close_target(target);   // CPU offline, or the thread exited
+                return;
+            }
+            if (hardware && (errno == ENOENT || errno == EOPNOTSUPP || errno == ENODEV)) {
+                session->hardware = false;
+            }
+        }
+    }
+}
+
+/**
+ * A PMU may be present but refuse some events; close the strays
+ */
+static void drop_hardware_strays(PerfSession *session) {
+    if (session->hardware) {
+        return;
+    }
+    for (int t = 0; t < session->target_count; t++) {
+        for (int c = 0; c < PERF_COUNTER_COUNT; c++) {
+            if (perf_specs[c].hardware && session->targets[t].fds[c] >= 0) {
+                close(session->targets[t].fds[c]);
+                session->targets[t].fds[c] = -1;
+            }
+        }
+    }
+}
+
+/**
+ * Close a thread that exited, keeping its final window for the totals
+ */
+static void retire_target(PerfSession *session, PerfTarget *target) {
+    for (int c = 0; c < PERF_COUNTER_COUNT; c++) {
+        session->exited[c] += target->delta[c];
+    }
+    close_target(target);
+}
+
+static int compare_int(const void *a, const void *b) {
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+static int compare_target_tid(const void *a, const void *b) {
+    return compare_int(&((const PerfTarget *)a)->tid, &((const PerfTarget *)b)->tid);
+}
+
+/**
+ * List the threads of `pid` into tids, ascending
+ */
+static int list_tids(int pid, int *tids, int max) {
+    char path[64];
+    struct dirent *entry;
+    int count = 0;
+
+    snprintf(path, sizeof(path), "/proc/%d/task", pid);
+    DIR *dir = opendir(path);
+    if (dir == NULL) {
+        return -1;
+    }
+    while ((entry = readdir(dir)) != NULL && count < max) {
+        if (entry->d_name[0] >= '1' && entry->d_name[0] <= '9') {
+            tids[count++] = atoi(entry->d_name);
+        }
+    }
+    closedir(dir);
+    qsort(tids, (size_t)count, sizeof(int), compare_int);
+    return count;
+}
+
+/**
+ * Drop threads that exited and give new ones counters. Call after a
+ * sample, so the final counts of exited threads were already read.
+ * Targets are kept sorted by tid so this is a merge-join with the
+ * task listing. Returns false once the process is gone.
+ */
+static bool attach_threads(PerfSession *session) {
+    static int tids[PERF_MAX_THREADS];
+    static int fresh[PERF_MAX_THREADS];
+
+    int count = list_tids(session->pid, tids, PERF_MAX_THREADS);
+    if (count <= 0) {
+        session->last_errno = ESRCH;
+        return false;
+    }
+
+    // Merge-join (both sorted by tid): compact the survivors in order and
+    // collect the tids that have no target yet
+    memset(session->exited, 0, sizeof(session->exited));
+    int fresh_count = 0;
+    int live = 0;
+    int t = 0;
+    for (int i = 0; i < count; i++) {
+        while (t < session->target_count && session->targets[t].tid < tids[i]) {
+            retire_target(session, &session->targets[t++]);
+        }
+        if (t < session->target_count && session->targets[t].tid == tids[i]) {
+            if (live != t) {
+                session->targets[live] = session->targets[t];
+            }
+            live++;
+            t++;
+        } else {
+            fresh[fresh_count++] = tids[i];
+        }
+    }
+    while (t < session->target_count) {
+        retire_target(session, &session->targets[t++]);
+    }
+    session->target_count = live;
+
+    session->threads_missed = 0;
+    for (int i = 0; i < fresh_count; i++) {
+        if (session->target_count == session->target_capacity) {
+            int capacity = session->target_capacity * 2;
+            PerfTarget *grown = realloc(session->targets, (size_t)capacity * sizeof(PerfTarget));
+            if (grown == NULL) {
+                session->threads_missed += fresh_count - i;
+                break;
+            }
+            session->targets = grown;
+            session->target_capacity = capacity;
+        }
+
+        PerfTarget *target = &session->targets[session->target_count];
+        memset(target, 0, sizeof(*target));
+        target->cpu = -1;
+        target->tid = fresh[i];
+        open_target(session, target);
+        if (target->online) {
+            session->target_count++;
+        } else if (session->last_errno != ESRCH) {
+            session->threads_missed++;  // Usually out of fds
+        }
+    }
+    // New threads were appended; restore the order for the next join
+    if (session->target_count > live) {
+        qsort(session->targets, (size_t)session->target_count, sizeof(PerfTarget), compare_target_tid);
+    }
+    drop_hardware_strays(session);
+    return true;
+}
+
+#endif
+
+/**
+ * Open counters for every online core (pid <= 0) or for each thread of
+ * one process. Hardware events are dropped together as soon as the
+ * first one fails, so a VM without a PMU falls back to software events
+ * only.
+ */
+bool perf_session_open(PerfSession *session, int pid) {
+    memset(session, 0, sizeof(*session));
+#ifndef __linux__
+    (void)pid;
+    return false;
+#else
+    session->pid = pid > 0 ? pid : -1;
+    session->hardware = true;
+
+    struct rlimit nofile;
+    if (!nofile_raised && getrlimit(RLIMIT_NOFILE, &saved_nofile) == 0 &&
+        saved_nofile.rlim_cur < saved_nofile.rlim_max) {
+        nofile = saved_nofile;
+        nofile.rlim_cur = nofile.rlim_max;
+        nofile_raised = setrlimit(RLIMIT_NOFILE, &nofile) == 0;
+    }
+
+    if (pid > 0) {
+        session->target_capacity = 16;
+        session->targets = calloc((size_t)session->target_capacity, sizeof(PerfTarget));
+        if (session->targets == NULL) {
+            perf_session_close(session);
+            return false;
+        }
+        attach_threads(session);
+    } else {
+        // Only online CPUs have a PMU to open; the list can have holes
+        static char buf[4096];
+        int max = (int)sysconf(_SC_NPROCESSORS_CONF);
+        if (max < 1) max = 1;
+        int *cpus = malloc((size_t)max * sizeof(int));
+        session->targets = calloc((size_t)max, sizeof(PerfTarget));
+        if (cpus == NULL || session->targets == NULL) {
+            free(cpus);
+            perf_session_close(session);
+            return false;
+        }
+        int count = 0;
+        if (sysmon_read_file("/sys/devices/system/cpu/online", buf, sizeof(buf)) > 0) {
+            count = parse_cpu_list(buf, cpus, max);
+        }
+        if (count == 0) {
+            count = (int)sysconf(_SC_NPROCESSORS_ONLN);
+            for (int i = 0; i < count && i < max; i++) cpus[i] = i;
+        }
+        for (int i = 0; i < count && i < max; i++) {
+            PerfTarget *target = &session->targets[session->target_count];
+            target->cpu = cpus[i];
+            open_target(session, target);
+            if (target->online) {
+                session->target_count++;
+            }
+        }
+        free(cpus);
+        drop_hardware_strays(session);
+    }
+
+    for (int t = 0; t < session->target_count; t++) {
+        if (session->targets[t].online) {
+            session->last_ms = monotonic_ms();
+            perf_session_sample(session);
+            return true;
+        }
+    }
+    int saved_errno = session->last_errno;
+    perf_session_close(session);
+    session->last_errno = saved_errno;
+    return false;
+#endif
+}
+
+/**
+ * Read every counter and turn the change since the last call into
+ * multiplex-scaled deltas
+ */
+void perf_session_sample(PerfSession *session) {
+#ifdef __linux__
+    long long now = monotonic_ms();
+    session->elapsed_ms = now - session->last_ms;
+    session->last_ms = now;
+    if (session->pid <= 0) {
+        read_core_times(session);
+    }
+
+    for (int t = 0; t < session->target_count; t++) {
+        PerfTarget *target = &session->targets[t];
+        for (int c = 0; c < PERF_COUNTER_COUNT; c++) {
+            unsigned long long raw[3];
+            target->delta[c] = 0.0;
+            target->running_share[c] = 0.0;
+            if (!perf_read_counter(target->fds[c], raw)) {
+                continue;
+            }
+
+            unsigned long long value = raw[0] - target->raw[c][0];
+            unsigned long long enabled = raw[1] - target->raw[c][1];
+            unsigned long long running = raw[2] - target->raw[c][2];
+            memcpy(target->raw[c], raw, sizeof(raw));
+
+            // Counted for running of enabled ns; extrapolate to the full window
+            if (running > 0) {
+                target->delta[c] = (double)value * (double)enabled / (double)running;
+                target->running_share[c] = (double)running / (double)enabled;
+            }
+        }
+    }
+    if (session->pid > 0) {
+        attach_threads(session);
+    }
+#else
+    (void)session;
+#endif
+}
+
+void perf_session_close(PerfSession *session) {
+#ifdef __linux__
+    for (int t = 0; t < session->target_count; t++) {
+        close_target(&session->targets[t]);
+    }
+    if (nofile_raised) {
+        setrlimit(RLIMIT_NOFILE, &saved_nofile);
+        nofile_raised = false;
+    }
+#endif
+    free(session->targets);
+    memset(session, 0, sizeof(*session));
+}
+
+#ifdef __linux__
+
+static double ratio(double num, double den) {
+    return den > 0.0 ? num / den : 0.0;
+}
+
+/**
+ * One row of derived metrics for a target's deltas
+ */
+static void render_perf_row(LiveScreen *screen, int row, const char *label, const double *delta,
+                            double cpu, double share, bool hardware, long long elapsed_ms) {
+    double seconds = elapsed_ms > 0 ? (double)elapsed_ms / 1000.0 : 1.0;
+    int col = live_screen_print(screen, row, 0, CELL_DEFAULT, "%-8s %6.1f ", label, cpu);
+
+    if (hardware) {
+        double ipc = ratio(delta[PERF_INSTRUCTIONS], delta[PERF_CYCLES]);
+        double cache_miss = 100.0 * ratio(delta[PERF_CACHE_MISSES], delta[PERF_CACHE_REFS]);
+        double branch_miss = 100.0 * ratio(delta[PERF_BRANCH_MISSES], delta[PERF_BRANCHES]);
+        // Low IPC with a busy core is the "stalled on memory" signature
+        CellColor color = delta[PERF_CYCLES] <= 0.0 ? CELL_DEFAULT
+                        : ipc < 0.7 ? CELL_RED : ipc < 1.2 ? CELL_YELLOW : CELL_GREEN;
+        col += live_screen_print(screen, row, col, CELL_DEFAULT, "%8.0f ", delta[PERF_CYCLES] / seconds / 1e6);
+        col += live_screen_print(screen, row, col, color, "%5.2f ", ipc);
+        col += live_screen_print(screen, row, col, cache_miss >= 10.0 ? CELL_YELLOW : CELL_DEFAULT,
+                                 "%7.2f ", cache_miss);
+        col += live_screen_print(screen, row, col, branch_miss >= 5.0 ? CELL_YELLOW : CELL_DEFAULT,
+                                 "%7.2f ", branch_miss);
+    }
+    col += live_screen_print(screen, row, col, CELL_DEFAULT, "%9.0f %9.0f %7.0f",
+                             delta[PERF_CONTEXT_SWITCHES] / seconds, delta[PERF_PAGE_FAULTS] / seconds,
+                             delta[PERF_MIGRATIONS] / seconds);
+    if (hardware && share > 0.0 && share < 0.995) {
+        live_screen_print(screen, row, col, CELL_CYAN, " %3.0f%%", share * 100.0);
+    }
+}
+
+static void render_perf_frame(LiveScreen *screen, const PerfSession *session, int interval_ms) {
+    double total[PERF_COUNTER_COUNT] = { 0 };
+    char label[16];
+    double total_busy = 0.0;
+    int row = 0;
+    int online = 0;
+
+    live_screen_begin(screen);
+    live_screen_print(screen, row, 0, CELL_BOLD, "DevHelper CPU Efficiency");
+    if (session->pid > 0) {
+        live_screen_print(screen, row++, 26, CELL_CYAN, "pid %d  %d threads  interval %d ms  (any key exits)",
+                          session->pid, session->target_count, interval_ms);
+    } else {
+        live_screen_print(screen, row++, 26, CELL_CYAN, "per core  interval %d ms  (any key exits)",
+                          interval_ms);
+    }
+    if (!session->hardware) {
+        live_screen_print(screen, row++, 0, CELL_YELLOW,
+                          "No hardware PMU (VM?): software events only, no IPC or miss rates");
+    }
+    if (session->threads_missed > 0) {
+        live_screen_print(screen, row++, 0, CELL_YELLOW, "%d threads could not get counters (out of fds?)",
+                          session->threads_missed);
+    }
+    row++;
+
+    int col = live_screen_print(screen, row, 0, CELL_BOLD, "%-8s %6s ", "Target", "CPU%");
+    if (session->hardware) {
+        col += live_screen_print(screen, row, col, CELL_BOLD, "%8s %5s %7s %7s ",
+                                 "Mcyc/s", "IPC", "cache%", "branch%");
+    }
+    col += live_screen_print(screen, row, col, CELL_BOLD, "%9s %9s %7s", "ctxsw/s", "faults/s", "migr/s");
+    if (session->hardware) {
+        live_screen_print(screen, row, col, CELL_BOLD, " mux");
+    }
+    row++;
+
+    // Threads of a process are summed into one row; cpu-clock is task
+    // time then, so CPU% is ns counted per window
+    if (session->pid > 0) {
+        double share = 0.0;
+        for (int c = 0; c < PERF_COUNTER_COUNT; c++) {
+            total[c] = session->exited[c];
+        }
+        for (int t = 0; t < session->target_count; t++) {
+            const PerfTarget *target = &session->targets[t];
+            for (int c = 0; c < PERF_COUNTER_COUNT; c++) {
+                total[c] += target->delta[c];
+            }
+            // Show the most multiplexed thread
+            double thread_share = target->running_share[PERF_CYCLES];
+            if (thread_share > 0.0 && (share == 0.0 || thread_share < share)) share = thread_share;
+        }
+        double cpu = session->elapsed_ms > 0 ? total[PERF_CPU_CLOCK] / ((double)session->elapsed_ms * 1e4) : 0.0;
+        snprintf(label, sizeof(label), "%d", session->pid);
+        render_perf_row(screen, row, label, total, cpu, share, session->hardware, session->elapsed_ms);
+        return;
+    }
+
+    for (int t = 0; t < session->target_count; t++) {
+        const PerfTarget *target = &session->targets[t];
+        total_busy += target->busy_percent;
+        online++;
+        for (int c = 0; c < PERF_COUNTER_COUNT; c++) {
+            total[c] += target->delta[c];
+        }
+        // Keep the last row for the total
+        if (row >= screen->rows - 1) {
+            continue;
+        }
+        snprintf(label, sizeof(label), "cpu%d", target->cpu);
+        render_perf_row(screen, row++, label, target->delta, target->busy_percent,
+                        target->running_share[PERF_CYCLES], session->hardware, session->elapsed_ms);
+    }
+
+    if (online > 1 && row < screen->rows) {
+        render_perf_row(screen, row, "all", total, total_busy / online, 0.0, session->hardware,
+                        session->elapsed_ms);
+    }
+}
+
+#endif
+
+/**
+ * Live IPC / miss-rate view per core (pid <= 0) or for one process
+ */
+void sysmon_perf_view(int interval_ms, int pid) {
+#ifndef __linux__
+    (void)interval_ms;
+    (void)pid;
+    print_warning("perf counters are only available on Linux.");
+#else
+    PerfSession session;
+    LiveScreen screen;
+
+    if (interval_ms < 100) interval_ms = 100;
+    if (interval_ms > 5000) interval_ms = 5000;
+
+    if (!perf_session_open(&session, pid)) {
+        if (session.last_errno == EACCES || session.last_errno == EPERM) {
+            print_error("Not allowed to open perf counters. Run as root or lower "
+                        "/proc/sys/kernel/perf_event_paranoid.");
+        } else if (session.last_errno == ESRCH) {
+            print_error("No such process!");
+        } else {
+            print_error("Could not open perf counters!");
+        }
+        return;
+    }
+    if (!live_screen_init(&screen)) {
+        print_error("Not enough memory for the CPU efficiency view!");
+        perf_session_close(&session);
+        return;
+    }
+
+    terminal_set_raw(true);
+    render_perf_frame(&screen, &session, interval_ms);
+    live_screen_flush(&screen);
+
+    long long next_tick = monotonic_ms() + interval_ms;
+    while (wait_for_key((int)(next_tick - monotonic_ms())) < 0) {
+        long long now = monotonic_ms();
+        if (now < next_tick) {
+            continue;
+        }
+        next_tick += interval_ms;
+        if (next_tick <= now) {
+            next_tick = now + interval_ms;
+        }
+
+        perf_session_sample(&session);
+        render_perf_frame(&screen, &session, interval_ms);
+        live_screen_flush(&screen);
+    }
+
+    terminal_set_raw(false);
+    printf("%s\033[H\033[2J", COLOR_RESET);
+    fflush(stdout);
+    live_screen_free(&screen);
+    perf_session_close(&session);
+#endif
+}
@@ -0,0 +1,563 @@
+/**
+ * DevHelper+Portal CLI - Process Table
+ *
+ * Incremental /proc/[pid] scanner for the process view. Per-pid state is
+ * kept in an array sorted by pid and merged with each new /proc listing,
+ * so CPU% comes from tick deltas without a lookup structure. Only the top
+ * N rows are selected (bounded heap) and only those get their statm read.
+ */
+
+#define _GNU_SOURCE
+#include "devhelper.h"
+
+#ifdef __linux__
+#include <dirent.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <pwd.h>
+#include <sys/stat.h>
+#endif
+
+// Above this many pids the stat parsing is split across threads
+#define PROC_PARALLEL_THRESHOLD 10000
+#define PROC_MAX_THREADS 8
+
+/* ------------------------------------------------------------------ */
+/* Bounded top-N heap                                                  */
+/* ------------------------------------------------------------------ */
+
+/**
+ * Prepare a heap that keeps the `capacity` largest keys offered to it
+ */
+void topn_init(TopNHeap *heap, TopNItem *storage, int capacity) {
+    heap->items = storage;
+    heap->size = 0;
+    heap->capacity = capacity;
+}
+
+static void topn_sift_down(TopNItem *items, int size, int i) {
+    for (;;) {
+        int smallest = i;
+        int left = 2 * i + 1;
+        int right = left + 1;
+
+        if (left < size && items[left].key < items[smallest].key) smallest = left;
+        if (right < size && items[right].key < items[smallest].key) smallest = right;
+        if (smallest == i) {
+            return;
+        }
+
+        TopNItem tmp = items[i];
+        items[i] = items[smallest];
+        items[smallest] = tmp;
+        i = smallest;
+    }
+}
+
+/**
+ * Offer a candidate. O(log N) when it displaces the current minimum.
+ */
+void topn_offer(TopNHeap *heap, double key, int index) {
+    if (heap->capacity <= 0) {
+        return;
+    }
+
+    if (heap->size < heap->capacity) {
+        // Sift the new item up the min-heap
+        int i = heap->size++;
+        heap->items[i].key = key;
+        heap->items[i].index = index;
+        while (i > 0) {
+            int parent = (i - 1) / 2;
+            if (heap->items[parent].key <= heap->items[i].key) {
+                break;
+            }
+            TopNItem tmp = heap->items[i];
+            heap->items[i] = heap->items[parent];
+            heap->items[parent] = tmp;
+            i = parent;
+        }
+    } else if (key > heap->items[0].key) {
+        heap->items[0].key = key;
+        heap->items[0].index = index;
+        topn_sift_down(heap->items, heap->size, 0);
+    }
+}
+
+/**
+ * Sort the heap contents largest first (in place) and return the count
+ */
+int topn_finish(TopNHeap *heap) {
+    int count = heap->size;
+
+    // Heap sort on a min-heap leaves the items in descending order
+    for (int end = count - 1; end > 0; end--) {
+        TopNItem tmp = heap->items[0];
+        heap->items[0] = heap->items[end];
+        heap->items[end] = tmp;
+        topn_sift_down(heap->items, end, 0);
+    }
+    heap->size = 0;
+    return count;
+}
+
+#ifdef __linux__
+
+/* ------------------------------------------------------------------ */
+/* /proc scanning                                                      */
+/* ------------------------------------------------------------------ */
+
+/**
+ * Grow the entry arrays and pid list to hold at least `needed` processes
+ */
+static bool proc_table_reserve(ProcTable *table, int needed) {
+    if (needed <= table->capacity) {
+        return true;
+    }
+
+    int capacity = table->capacity > 0 ? table->capacity : 1024;
+    while (capacity < needed) capacity *= 2;
+
+    ProcEntry *entries = realloc(table->entries, (size_t)capacity * sizeof(ProcEntry));
+    if (entries == NULL) return false;
+    table->entries = entries;
+
+    ProcEntry *previous = realloc(table->previous, (size_t)capacity * sizeof(ProcEntry));
+    if (previous == NULL) return false;
+    table->previous = previous;
+
+    int *pids = realloc(table->pids, (size_t)capacity * sizeof(int));
+    if (pids == NULL) return false;
+    table->pids = pids;
+
+    table->capacity = capacity;
+    return true;
+}
+
+/**
+ * Open the /proc directory and size the tables
+ */
+bool proc_table_init(ProcTable *table) {
+    memset(table, 0, sizeof(*table));
+
+    table->proc_fd = open("/proc", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (table->proc_fd < 0) {
+        return false;
+    }
+
+    table->clock_ticks = sysconf(_SC_CLK_TCK);
+    table->page_size = sysconf(_SC_PAGESIZE);
+    return proc_table_reserve(table, 1024);
+}
+
+/**
+ * Release everything owned by the table
+ */
+void proc_table_free(ProcTable *table) {
+    if (table->proc_fd >= 0) {
+        close(table->proc_fd);
+    }
+    free(table->entries);
+    free(table->previous);
+    free(table->pids);
+    memset(table, 0, sizeof(*table));
+    table->proc_fd = -1;
+}
+
+static int compare_int(const void *a, const void *b) {
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * List the numeric entries of /proc into table->pids, ascending
+ */
+static int list_pids(ProcTable *table) {
+    int dup_fd = openat(table->proc_fd, ".", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dup_fd < 0) {
+        return -1;
+    }
+    DIR *dir = fdopendir(dup_fd);
+    if (dir == NULL) {
+        close(dup_fd);
+        return -1;
+    }
+
+    int count = 0;
+    bool sorted = true;
+    struct dirent *de;
+    while ((de = readdir(dir)) != NULL) {
+        if (de->d_name[0] < '1' || de->d_name[0] > '9') {
+            continue;
+        }
+        if (count >= table->capacity && !proc_table_reserve(table, count + 1)) {
+            break;
+        }
+        int pid = atoi(de->d_name);
+        if (count > 0 && pid < table->pids[count - 1]) {
+            sorted = false;
+        }
+        table->pids[count++] = pid;
+    }
+    closedir(dir);
+
+    // The kernel lists pids in order already; only sort if it didn't
+    if (!sorted) {
+        qsort(table->pids, (size_t)count, sizeof(int), compare_int);
+    }
+    return count;
+}
+
+/**
+ * Parse /proc/[pid]/stat into an entry. Returns false if the pid is gone.
+ */
+static bool parse_pid_stat(int proc_fd, ProcEntry *entry) {
+    char path[32];
+    char buf[1024];
+
+    snprintf(path, sizeof(path), "%d/stat", entry->pid);
+    int fd = openat(proc_fd, path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    ssize_t n = read(fd, buf, sizeof(buf) - 1);
+    close(fd);
+    if (n <= 0) {
+        return false;
+    }
+    buf[n] = '\0';
+
+    // comm may contain spaces and parentheses; it ends at the last ')'
+    char *open_paren = strchr(buf, '(');
+    char *close_paren = strrchr(buf, ')');
+    if (open_paren == NULL || close_paren == NULL || close_paren < open_paren) {
+        return false;
+    }
+    size_t comm_len = (size_t)(close_paren - open_paren - 1);
+    if (comm_len >= sizeof(entry->comm)) comm_len = sizeof(entry->comm) - 1;
+    memcpy(entry->comm, open_paren + 1, comm_len);
+    entry->comm[comm_len] = '\0';
+
+    // Fields from 3 (state) onwards, numbered as in proc(5)
+    char *p = close_paren + 2;
+    entry->state = *p;
+    p += 2;
+
+    unsigned long long utime = 0, stime = 0;
+    for (int field = 4; field <= 24 && *p; field++) {
+        char *end;
+        unsigned long long value = strtoull(p, &end, 10);
+        switch (field) {
+            case 4:  entry->ppid = (int)value; break;
+            case 14: utime = value; break;
+            case 15: stime = value; break;
+            case 19: entry->nice = (int)(long long)value; break;
+            case 20: entry->threads = (int)value; break;
+            case 22: entry->start_time = value; break;
+            case 23: entry->vsize_bytes = value; break;
+            case 24: entry->rss_pages = (long)value; break;
+        }
+        p = end;
+        while (*p == ' ') p++;
+    }
+
+    entry->cpu_ticks = utime + stime;
+    return true;
+}
+
+typedef struct {
+    ProcTable *table;
+    int start;
+    int end;
+} ParseJob;
+
+static void parse_range(ProcTable *table, int start, int end) {
+    for (int i = start; i < end; i++) {
+        ProcEntry *entry = &table->entries[i];
+        entry->alive = parse_pid_stat(table->proc_fd, entry);
+    }
+}
+
+static void *parse_worker(void *arg) {
+    ParseJob *job = arg;
+    parse_range(job->table, job->start, job->end);
+    return NULL;
+}
+
+/**
+ * Parse stat for every listed pid, fanning out over threads on big hosts
+ */
+static void parse_all(ProcTable *table, int count) {
+    if (count <= PROC_PARALLEL_THRESHOLD) {
+        parse_range(table, 0, count);
+        return;
+    }
+
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int workers = cpus > PROC_MAX_THREADS ? PROC_MAX_THREADS : (int)cpus;
+    if (workers < 2) {
+        parse_range(table, 0, count);
+        return;
+    }
+
+    pthread_t threads[PROC_MAX_THREADS];
+    ParseJob jobs[PROC_MAX_THREADS];
+    bool started[PROC_MAX_THREADS] = { false };
+    int chunk = (count + workers - 1) / workers;
+
+    // Worker 0's slice runs on this thread
+    for (int w = 1; w < workers; w++) {
+        jobs[w].table = table;
+        jobs[w].start = w * chunk;
+        jobs[w].end = (w + 1) * chunk < count ? (w + 1) * chunk : count;
+        started[w] = pthread_create(&threads[w], NULL, parse_worker, &jobs[w]) == 0;
+        if (!started[w]) {
+            parse_range(table, jobs[w].start, jobs[w].end);
+        }
+    }
+    parse_range(table, 0, chunk < count ? chunk : count);
+
+    for (int w = 1; w < workers; w++) {
+        if (started[w]) pthread_join(threads[w], NULL);
+    }
+}
+
+/**
+ * Rescan /proc and update CPU% from the previous scan.
+ * Returns the number of live processes, or -1 on error.
+ */
+int proc_table_refresh(ProcTable *table) {
+    long long started = monotonic_ms();
+    int listed = list_pids(table);
+    if (listed < 0) {
+        return -1;
+    }
+
+    // Swap so the last scan becomes `previous`
+    ProcEntry *swap = table->previous;
+    table->previous = table->entries;
+    table->entries = swap;
+    int prev_count = table->count;
+
+    for (int i = 0; i < listed; i++) {
+        memset(&table->entries[i], 0, sizeof(ProcEntry));
+        table->entries[i].pid = table->pids[i];
+    }
+    parse_all(table, listed);
+
+    // Merge-join with the previous scan (both sorted by pid) and compact
+    double elapsed = (double)(started - table->last_scan_ms) / 1000.0;
+    bool have_previous = table->last_scan_ms > 0 && elapsed > 0.0;
+    int j = 0;
+    int live = 0;
+    table->total_threads = 0;
+
+    for (int i = 0; i < listed; i++) {
+        ProcEntry *entry = &table->entries[i];
+        if (!entry->alive) {
+            continue;
+        }
+
+        while (j < prev_count && table->previous[j].pid < entry->pid) j++;
+        entry->cpu_percent = 0.0;
+        if (have_previous && j < prev_count && table->previous[j].pid == entry->pid &&
+            table->previous[j].start_time == entry->start_time &&
+            entry->cpu_ticks >= table->previous[j].cpu_ticks) {
+            double ticks = (double)(entry->cpu_ticks - table->previous[j].cpu_ticks);
+            entry->cpu_percent = 100.0 * ticks / ((double)table->clock_ticks * elapsed);
+        }
+
+        table->total_threads += entry->threads;
+        if (live != i) {
+            table->entries[live] = *entry;
+        }
+        live++;
+    }
+
+    table->count = live;
+    table->last_scan_ms = started;
+    table->scan_ms = monotonic_ms() - started;
+    return live;
+}
+
+/**
+ * Read /proc/[pid]/statm shared pages for a single entry
+ */
+static void read_statm(const ProcTable *table, ProcEntry *entry) {
+    char path[32];
+    char buf[128];
+
+    snprintf(path, sizeof(path), "%d/statm", entry->pid);
+    int fd = openat(table->proc_fd, path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return;
+    }
+    ssize_t n = read(fd, buf, sizeof(buf) - 1);
+    close(fd);
+    if (n <= 0) {
+        return;
+    }
+    buf[n] = '\0';
+
+    long size, resident, shared;
+    if (sscanf(buf, "%ld %ld %ld", &size, &resident, &shared) == 3) {
+        entry->rss_pages = resident;
+        entry->shared_pages = shared;
+    }
+}
+
+/**
+ * Select the top N entries by CPU% or RSS and fill their statm details.
+ * `out` receives indexes into table->entries, largest first.
+ */
+int proc_table_top(ProcTable *table, ProcSortKey key, TopNItem *out, int n) {
+    TopNHeap heap;
+
+    topn_init(&heap, out, n);
+    for (int i = 0; i < table->count; i++) {
+        const ProcEntry *entry = &table->entries[i];
+        double value = key == PROC_SORT_MEMORY ? (double)entry->rss_pages
+                                               : entry->cpu_percent + entry->rss_pages * 1e-12;
+        topn_offer(&heap, value, i);
+    }
+
+    int count = topn_finish(&heap);
+    for (int i = 0; i < count; i++) {
+        read_statm(table, &table->entries[out[i].index]);
+    }
+    return count;
+}
+
+/* ------------------------------------------------------------------ */
+/* Process view                                                        */
+/* ------------------------------------------------------------------ */
+
+/**
+ * Look up a user name for the owner of /proc/[pid]
+ */
+static void pid_owner(const ProcTable *table, int pid, char *out, size_t size) {
+    char path[16];
+    struct stat st;
+
+    snprintf(path, sizeof(path), "%d", pid);
+    if (fstatat(table->proc_fd, path, &st, 0) != 0) {
+        snprintf(out, size, "?");
+        return;
+    }
+
+    struct passwd pw, *result = NULL;
+    char pwbuf[1024];
+    if (getpwuid_r(st.st_uid, &pw, pwbuf, sizeof(pwbuf), &result) == 0 && result != NULL) {
+        snprintf(out, size, "%s", pw.pw_name);
+    } else {
+        snprintf(out, size, "%u", (unsigned)st.st_uid);
+    }
+}
+
+static void render_process_frame(LiveScreen *screen, ProcTable *table, ProcSortKey key,
+                                 TopNItem *top, int interval_ms) {
+    char rss[16], shr[16], virt[16], owner[16];
+    int row = 0;
+
+    live_screen_begin(screen);
+    live_screen_print(screen, row, 0, CELL_BOLD, "DevHelper Processes");
+    live_screen_print(screen, row++, 21, CELL_CYAN,
+                      "%d processes, %d threads  scan %lld ms  every %d ms",
+                      table->count, table->total_threads, table->scan_ms, interval_ms);
+    live_screen_print(screen, row++, 0, CELL_DEFAULT,
+                      "Sorted by %s   [c] CPU  [m] memory  any other key exits",
+                      key == PROC_SORT_MEMORY ? "memory" : "CPU");
+    row++;
+
+    live_screen_print(screen, row++, 0, CELL_BOLD,
+                      "%7s %-9s %1s %4s %6s %8s %8s %8s  %s",
+                      "PID", "USER", "S", "THR", "CPU%", "RSS", "SHR", "VIRT", "COMMAND");
+
+    int n = screen->rows - row;
+    if (n > PROC_TOP_MAX) n = PROC_TOP_MAX;
+    if (n < 1) return;
+
+    int count = proc_table_top(table, key, top, n);
+    for (int i = 0; i < count; i++) {
+        const ProcEntry *e = &table->entries[top[i].index];
+        long page_kb = table->page_size / 1024;
+
+        format_kb((unsigned long long)e->rss_pages * page_kb, rss, sizeof(rss));
+        format_kb((unsigned long long)e->shared_pages * page_kb, shr, sizeof(shr));
+        format_kb(e->vsize_bytes / 1024, virt, sizeof(virt));
+        pid_owner(table, e->pid, owner, sizeof(owner));
+
+        CellColor color = e->cpu_percent >= 90.0 ? CELL_RED
+                        : e->state == 'R' ? CELL_GREEN : CELL_DEFAULT;
+        live_screen_print(screen, row++, 0, color,
+                          "%7d %-9.9s %c %4d %6.1f %8s %8s %8s  %s",
+                          e->pid, owner, e->state, e->threads, e->cpu_percent,
+                          rss, shr, virt, e->comm);
+    }
+}
+
+#endif
+
+/**
+ * Live process table, refreshed like top
+ */
+void sysmon_process_view(int interval_ms) {
+#ifndef __linux__
+    (void)interval_ms;
+    print_warning("The process view reads /proc and is only available on Linux.");
+#else
+    static TopNItem top[PROC_TOP_MAX];
+    ProcTable table;
+    LiveScreen screen;
+    ProcSortKey key = PROC_SORT_CPU;
+
+    if (interval_ms < 100) interval_ms = 100;
+    if (interval_ms > 5000) interval_ms = 5000;
+
+    if (!proc_table_init(&table)) {
+        print_error("Could not open /proc!");
+        return;
+    }
+    if (!live_screen_init(&screen)) {
+        print_error("Not enough memory for the process view!");
+        proc_table_free(&table);
+        return;
+    }
+
+    terminal_set_raw(true);
+    proc_table_refresh(&table);
+    render_process_frame(&screen, &table, key, top, interval_ms);
+    live_screen_flush(&screen);
+
+    long long next_tick = monotonic_ms() + interval_ms;
+    for (;;) {
+        int wait = (int)(next_tick - monotonic_ms());
+        int k = wait_for_key(wait);
+        if (k == 'c' || k == 'C') {
+            key = PROC_SORT_CPU;
+        } else if (k == 'm' || k == 'M') {
+            key = PROC_SORT_MEMORY;
+        } else if (k >= 0) {
+            break;
+        }
+
+        if (k < 0) {
+            if (proc_table_refresh(&table) < 0) {
+                break;
+            }
+            next_tick += interval_ms;
+            if (next_tick <= monotonic_ms()) {
+                next_tick = monotonic_ms() + interval_ms;
+            }
+        }
+        render_process_frame(&screen, &table, key, top, interval_ms);
+        live_screen_flush(&screen);
+    }
+
+    terminal_set_raw(false);
+    printf("%s\033[H\033[2J", COLOR_RESET);
+    fflush(stdout);
+    live_screen_free(&screen);
+    proc_table_free(&table);
+#endif
+}
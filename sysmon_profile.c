@@ -0,0 +1,1235 @@
+/**
+ * DevHelper+Portal CLI - Sampling Stack Profiler
+ *
+ * Samples the user stacks of every thread of a pid and writes them in
+ * collapsed-stack format ("thread;main;work;leaf 42"), ready for
+ * flamegraph.pl or speedscope. Stacks come from perf_event_open with
+ * PERF_SAMPLE_CALLCHAIN when allowed; otherwise the threads are seized
+ * with ptrace, briefly interrupted while on CPU, and unwound through
+ * their frame pointers. Both rely on frame pointers in the target.
+ *
+ * Raw addresses are aggregated while sampling and only symbolized at
+ * the end, against /proc/[pid]/maps and the ELF symtab (or dynsym) of
+ * each binary, which is loaded once and cached.
+ */
+
+#define _GNU_SOURCE
+#include "devhelper.h"
+
+#ifdef __linux__
+#include <dirent.h>
+#include <elf.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/ptrace.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <sys/user.h>
+#include <sys/wait.h>
+#include <time.h>
+#endif
+
+#ifdef __linux__
+
+#define PROFILE_MAX_FRAMES 128
+#define PROFILE_MAX_THREADS 1024
+#define PROFILE_RING_PAGES 8        // Per thread, must be a power of two
+#define PROFILE_MAX_LOADS 16
+
+#if defined(__x86_64__) || defined(__aarch64__)
+#define PROFILE_HAVE_PTRACE 1
+#endif
+
+static volatile sig_atomic_t profile_interrupted = 0;
+
+static void profile_sigint_handler(int sig) {
+    (void)sig;
+    profile_interrupted = 1;
+}
+
+/* ------------------------------------------------------------------ */
+/* Stack aggregation                                                   */
+/* ------------------------------------------------------------------ */
+
+typedef struct {
+    int tid;
+    int name;                   // Index into names, -1 = empty slot
+} ThreadSlot;
+
+typedef struct {
+    unsigned long long hash;
+    unsigned int offset;        // Into frames; leaf first
+    unsigned short depth;
+    unsigned short name;
+    unsigned long count;
+} StackSlot;
+
+typedef struct {
+    int pid;
+    StackSlot *slots;
+    size_t capacity;
+    size_t used;
+    unsigned long long *frames;
+    size_t frame_count;
+    size_t frame_capacity;
+    ThreadSlot *threads;
+    size_t thread_capacity;
+    size_t thread_used;
+    char (*names)[16];
+    int name_count;
+    unsigned long samples;
+    unsigned long lost;
+} StackTable;
+
+static unsigned long long hash_words(const unsigned long long *words, int count, unsigned long long seed) {
+    unsigned long long h = 1469598103934665603ULL ^ seed;
+    for (int i = 0; i < count; i++) {
+        h = (h ^ words[i]) * 1099511628211ULL;
+        h ^= h >> 29;
+    }
+    return h;
+}
+
+/**
+ * Thread comm interned into a small name list, looked up by tid
+ */
+static int thread_name(StackTable *table, int tid) {
+    if (table->thread_used * 2 >= table->thread_capacity) {
+        size_t capacity = table->thread_capacity ? table->thread_capacity * 2 : 256;
+        ThreadSlot *slots = malloc(capacity * sizeof(ThreadSlot));
+        if (slots == NULL) {
+            return 0;
+        }
+        for (size_t i = 0; i < capacity; i++) slots[i].name = -1;
+        for (size_t i = 0; i < table->thread_capacity; i++) {
+            if (table->threads[i].name < 0) continue;
+            size_t j = ((size_t)table->threads[i].tid * 2654435761u) & (capacity - 1);
+            while (slots[j].name >= 0) j = (j + 1) & (capacity - 1);
+            slots[j] = table->threads[i];
+        }
+        free(table->threads);
+        table->threads = slots;
+        table->thread_capacity = capacity;
+    }
+
+    size_t mask = table->thread_capacity - 1;
+    size_t i = ((size_t)tid * 2654435761u) & mask;
+    for (; table->threads[i].name >= 0; i = (i + 1) & mask) {
+        if (table->threads[i].tid == tid) {
+            return table->threads[i].name;
+        }
+    }
+
+    char path[64];
+    char comm[16];
+    snprintf(path, sizeof(path), "/proc/%d/task/%d/comm", table->pid, tid);
+    if (sysmon_read_file(path, comm, sizeof(comm)) <= 0) {
+        snprintf(path, sizeof(path), "/proc/%d/comm", table->pid);
+        if (sysmon_read_file(path, comm, sizeof(comm)) <= 0) {
+            snprintf(comm, sizeof(comm), "%d", table->pid);
+        }
+    }
+    comm[strcspn(comm, "\n")] = '\0';
+    // Collapsed stacks use ';' and ' ' as separators
+    for (char *c = comm; *c; c++) {
+        if (*c == ';' || *c == ' ') *c = '_';
+    }
+
+    int name = 0;
+    while (name < table->name_count && strcmp(table->names[name], comm) != 0) name++;
+    if (name == table->name_count) {
+        char (*grown)[16] = realloc(table->names, (size_t)(name + 1) * sizeof(*grown));
+        if (grown == NULL) {
+            return 0;
+        }
+        table->names = grown;
+        memcpy(table->names[name], comm, sizeof(comm));
+        table->name_count++;
+    }
+
+    table->threads[i].tid = tid;
+    table->threads[i].name = name;
+    table->thread_used++;
+    return name;
+}
+
+static bool stack_table_grow(StackTable *table) {
+    size_t capacity = table->capacity ? table->capacity * 2 : 4096;
+    StackSlot *slots = calloc(capacity, sizeof(StackSlot));
+    if (slots == NULL) {
+        return false;
+    }
+    for (size_t i = 0; i < table->capacity; i++) {
+        if (table->slots[i].count == 0) continue;
+        size_t j = table->slots[i].hash & (capacity - 1);
+        while (slots[j].count != 0) j = (j + 1) & (capacity - 1);
+        slots[j] = table->slots[i];
+    }
+    free(table->slots);
+    table->slots = slots;
+    table->capacity = capacity;
+    return true;
+}
+
+/**
+ * Count one sample; frames are leaf first
+ */
+static void stack_table_add(StackTable *table, int tid, const unsigned long long *frames, int depth) {
+    if (depth <= 0) {
+        return;
+    }
+    if (table->used * 10 >= table->capacity * 7 && !stack_table_grow(table)) {
+        return;
+    }
+
+    unsigned short name = (unsigned short)thread_name(table, tid);
+    unsigned long long hash = hash_words(frames, depth, name);
+    size_t mask = table->capacity - 1;
+    size_t i = hash & mask;
+    for (; table->slots[i].count != 0; i = (i + 1) & mask) {
+        StackSlot *slot = &table->slots[i];
+        if (slot->hash == hash && slot->depth == depth && slot->name == name &&
+            memcmp(&table->frames[slot->offset], frames, (size_t)depth * sizeof(*frames)) == 0) {
+            slot->count++;
+            table->samples++;
+            return;
+        }
+    }
+
+    if (table->frame_count + (size_t)depth > table->frame_capacity) {
+        size_t capacity = table->frame_capacity ? table->frame_capacity * 2 : 65536;
+        while (capacity < table->frame_count + (size_t)depth) capacity *= 2;
+        unsigned long long *grown = realloc(table->frames, capacity * sizeof(*grown));
+        if (grown == NULL) {
+            return;
+        }
+        table->frames = grown;
+        table->frame_capacity = capacity;
+    }
+    memcpy(&table->frames[table->frame_count], frames, (size_t)depth * sizeof(*frames));
+
+    StackSlot *slot = &table->slots[i];
+    slot->hash = hash;
+    slot->offset = (unsigned int)table->frame_count;
+    slot->depth = (unsigned short)depth;
+    slot->name = name;
+    slot->count = 1;
+    table->frame_count += (size_t)depth;
+    table->used++;
+    table->samples++;
+}
+
+static void stack_table_free(StackTable *table) {
+    free(table->slots);
+    free(table->frames);
+    free(table->threads);
+    free(table->names);
+    memset(table, 0, sizeof(*table));
+}
+
+/* ------------------------------------------------------------------ */
+/* Symbols                                                             */
+/* ------------------------------------------------------------------ */
+
+typedef struct {
+    unsigned long long addr;
+    unsigned long long size;
+    unsigned int name;          // Offset into strings
+} ElfSymbol;
+
+typedef struct {
+    unsigned long long offset;
+    unsigned long long vaddr;
+    unsigned long long filesz;
+} ElfLoad;
+
+typedef struct {
+    char *path;
+    char *fallback;             // "[libfoo.so]" for addresses without a symbol
+    bool loaded;
+    ElfSymbol *symbols;
+    int symbol_count;
+    char *strings;
+    ElfLoad loads[PROFILE_MAX_LOADS];
+    int load_count;
+} ElfBinary;
+
+typedef struct {
+    unsigned long long start;
+    unsigned long long end;
+    unsigned long long offset;
+    int binary;                 // -1 for anonymous or special mappings
+} MapRange;
+
+typedef struct {
+    int pid;
+    MapRange *ranges;
+    int range_count;
+    int range_capacity;
+    ElfBinary *binaries;
+    int binary_count;
+    int binary_capacity;
+} SymbolCache;
+
+static int compare_symbols(const void *a, const void *b) {
+    const ElfSymbol *x = a;
+    const ElfSymbol *y = b;
+    return x->addr < y->addr ? -1 : x->addr > y->addr;
+}
+
+/**
+ * Read function symbols and PT_LOAD segments of a 64-bit ELF file.
+ * .symtab is preferred; stripped binaries fall back to .dynsym.
+ */
+static void elf_load(ElfBinary *binary, int pid) {
+    char path[MAX_PATH_LENGTH + 32];
+    struct stat st;
+
+    binary->loaded = true;
+    // Through the target's root so binaries inside containers resolve
+    snprintf(path, sizeof(path), "/proc/%d/root%s", pid, binary->path);
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        fd = open(binary->path, O_RDONLY | O_CLOEXEC);
+    }
+    if (fd < 0) {
+        return;
+    }
+    if (fstat(fd, &st) < 0 || st.st_size < (off_t)sizeof(Elf64_Ehdr)) {
+        close(fd);
+        return;
+    }
+    size_t size = (size_t)st.st_size;
+    const unsigned char *image = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (image == MAP_FAILED) {
+        return;
+    }
+
+    const Elf64_Ehdr *ehdr = (const Elf64_Ehdr *)image;
+    if (memcmp(ehdr->e_ident, ELFMAG, SELFMAG) != 0 || ehdr->e_ident[EI_CLASS] != ELFCLASS64 ||
+        ehdr->e_phoff + (size_t)ehdr->e_phnum * sizeof(Elf64_Phdr) > size ||
+        ehdr->e_shoff + (size_t)ehdr->e_shnum * sizeof(Elf64_Shdr) > size) {
+        munmap((void *)image, size);
+        return;
+    }
+
+    const Elf64_Phdr *phdrs = (const Elf64_Phdr *)(image + ehdr->e_phoff);
+    for (int i = 0; i < ehdr->e_phnum && binary->load_count < PROFILE_MAX_LOADS; i++) {
+        if (phdrs[i].p_type == PT_LOAD) {
+            ElfLoad *load = &binary->loads[binary->load_count++];
+            load->offset = phdrs[i].p_offset;
+            load->vaddr = phdrs[i].p_vaddr;
+            load->filesz = phdrs[i].p_filesz;
+        }
+    }
+
+    const Elf64_Shdr *shdrs = (const Elf64_Shdr *)(image + ehdr->e_shoff);
+    const Elf64_Shdr *symtab = NULL;
+    for (int i = 0; i < ehdr->e_shnum; i++) {
+        if (shdrs[i].sh_type == SHT_SYMTAB || (shdrs[i].sh_type == SHT_DYNSYM && symtab == NULL)) {
+            symtab = &shdrs[i];
+        }
+    }
+    if (symtab == NULL || symtab->sh_link >= ehdr->e_shnum ||
+        symtab->sh_offset + symtab->sh_size > size) {
+        munmap((void *)image, size);
+        return;
+    }
+    const Elf64_Shdr *strtab = &shdrs[symtab->sh_link];
+    if (strtab->sh_offset + strtab->sh_size > size) {
+        munmap((void *)image, size);
+        return;
+    }
+
+    const Elf64_Sym *syms = (const Elf64_Sym *)(image + symtab->sh_offset);
+    const char *names = (const char *)(image + strtab->sh_offset);
+    size_t sym_count = symtab->sh_size / sizeof(Elf64_Sym);
+    size_t string_bytes = 0;
+    int count = 0;
+
+    for (size_t i = 0; i < sym_count; i++) {
+        if (ELF64_ST_TYPE(syms[i].st_info) == STT_FUNC && syms[i].st_value != 0 &&
+            syms[i].st_name < strtab->sh_size) {
+            count++;
+            string_bytes += strnlen(names + syms[i].st_name, strtab->sh_size - syms[i].st_name) + 1;
+        }
+    }
+
+    binary->symbols = malloc((size_t)(count > 0 ? count : 1) * sizeof(ElfSymbol));
+    binary->strings = malloc(string_bytes > 0 ? string_bytes : 1);
+    if (binary->symbols == NULL || binary->strings == NULL) {
+        free(binary->symbols);
+        free(binary->strings);
+        binary->symbols = NULL;
+        binary->strings = NULL;
+        munmap((void *)image, size);
+        return;
+    }
+
+    size_t used = 0;
+    for (size_t i = 0; i < sym_count; i++) {
+        if (ELF64_ST_TYPE(syms[i].st_info) != STT_FUNC || syms[i].st_value == 0 ||
+            syms[i].st_name >= strtab->sh_size) {
+            continue;
+        }
+        const char *name = names + syms[i].st_name;
+        size_t len = strnlen(name, strtab->sh_size - syms[i].st_name);
+        ElfSymbol *sym = &binary->symbols[binary->symbol_count++];
+        sym->addr = syms[i].st_value;
+        sym->size = syms[i].st_size;
+        sym->name = (unsigned int)used;
+        memcpy(binary->strings + used, name, len);
+        binary->strings[used + len] = '\0';
+        used += len + 1;
+    }
+    qsort(binary->symbols, (size_t)binary->symbol_count, sizeof(ElfSymbol), compare_symbols);
+    munmap((void *)image, size);
+}
+
+static int symbol_cache_binary(SymbolCache *cache, const char *path) {
+    for (int i = 0; i < cache->binary_count; i++) {
+        if (strcmp(cache->binaries[i].path, path) == 0) {
+            return i;
+        }
+    }
+    if (cache->binary_count == cache->binary_capacity) {
+        int capacity = cache->binary_capacity ? cache->binary_capacity * 2 : 32;
+        ElfBinary *grown = realloc(cache->binaries, (size_t)capacity * sizeof(ElfBinary));
+        if (grown == NULL) {
+            return -1;
+        }
+        cache->binaries = grown;
+        cache->binary_capacity = capacity;
+    }
+
+    const char *base = strrchr(path, '/');
+    base = base != NULL ? base + 1 : path;
+    ElfBinary *binary = &cache->binaries[cache->binary_count];
+    memset(binary, 0, sizeof(*binary));
+    binary->path = strdup(path);
+    binary->fallback = malloc(strlen(base) + 3);
+    if (binary->path == NULL || binary->fallback == NULL) {
+        free(binary->path);
+        free(binary->fallback);
+        return -1;
+    }
+    sprintf(binary->fallback, "[%s]", base);
+    return cache->binary_count++;
+}
+
+/**
+ * Re-read the executable mappings. Binaries already seen keep their
+ * cached symbols. Returns false if the process is gone.
+ */
+static bool symbol_cache_load_maps(SymbolCache *cache) {
+    char path[64];
+    char line[MAX_PATH_LENGTH + 128];
+
+    snprintf(path, sizeof(path), "/proc/%d/maps", cache->pid);
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        return false;
+    }
+
+    cache->range_count = 0;
+    while (fgets(line, sizeof(line), file) != NULL) {
+        unsigned long long start, end, offset;
+        char perms[8];
+        int name_at = 0;
+        if (sscanf(line, "%llx-%llx %7s %llx %*s %*s %n", &start, &end, perms, &offset, &name_at) < 4 ||
+            perms[2] != 'x') {
+            continue;
+        }
+        if (cache->range_count == cache->range_capacity) {
+            int capacity = cache->range_capacity ? cache->range_capacity * 2 : 64;
+            MapRange *grown = realloc(cache->ranges, (size_t)capacity * sizeof(MapRange));
+            if (grown == NULL) {
+                break;
+            }
+            cache->ranges = grown;
+            cache->range_capacity = capacity;
+        }
+
+        char *name = line + name_at;
+        name[strcspn(name, "\n")] = '\0';
+        MapRange *range = &cache->ranges[cache->range_count++];
+        range->start = start;
+        range->end = end;
+        range->offset = offset;
+        range->binary = name[0] == '/' && strstr(name, " (deleted)") == NULL
+                      ? symbol_cache_binary(cache, name) : -1;
+    }
+    fclose(file);
+    return true;
+}
+
+/**
+ * Name for one address: "function", "[binary]" or "[unknown]"
+ */
+static const char *symbol_cache_lookup(SymbolCache *cache, unsigned long long addr) {
+    int lo = 0, hi = cache->range_count - 1;
+    const MapRange *range = NULL;
+
+    // /proc/pid/maps is sorted by address
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+        if (addr < cache->ranges[mid].start) {
+            hi = mid - 1;
+        } else if (addr >= cache->ranges[mid].end) {
+            lo = mid + 1;
+        } else {
+            range = &cache->ranges[mid];
+            break;
+        }
+    }
+    if (range == NULL || range->binary < 0) {
+        return "[unknown]";
+    }
+
+    ElfBinary *binary = &cache->binaries[range->binary];
+    if (!binary->loaded) {
+        elf_load(binary, cache->pid);
+    }
+
+    // Address -> file offset -> link-time virtual address
+    unsigned long long file_offset = addr - range->start + range->offset;
+    unsigned long long vaddr = 0;
+    bool found = false;
+    for (int i = 0; i < binary->load_count; i++) {
+        const ElfLoad *load = &binary->loads[i];
+        if (file_offset >= load->offset && file_offset < load->offset + load->filesz) {
+            vaddr = file_offset - load->offset + load->vaddr;
+            found = true;
+            break;
+        }
+    }
+    if (!found || binary->symbol_count == 0) {
+        return binary->fallback;
+    }
+
+    lo = 0;
+    hi = binary->symbol_count - 1;
+    int best = -1;
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+        if (binary->symbols[mid].addr <= vaddr) {
+            best = mid;
+            lo = mid + 1;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    if (best < 0) {
+        return binary->fallback;
+    }
+    const ElfSymbol *sym = &binary->symbols[best];
+    if (sym->size > 0 ? vaddr >= sym->addr + sym->size
+                      : best + 1 < binary->symbol_count && vaddr >= binary->symbols[best + 1].addr) {
+        return binary->fallback;
+    }
+    return binary->strings + sym->name;
+}
+
+static void symbol_cache_free(SymbolCache *cache) {
+    for (int i = 0; i < cache->binary_count; i++) {
+        free(cache->binaries[i].path);
+        free(cache->binaries[i].fallback);
+        free(cache->binaries[i].symbols);
+        free(cache->binaries[i].strings);
+    }
+    free(cache->binaries);
+    free(cache->ranges);
+    memset(cache, 0, sizeof(*cache));
+}
+
+/* ------------------------------------------------------------------ */
+/* perf_event_open sampling                                            */
+/* ------------------------------------------------------------------ */
+
+typedef struct {
+    int pid;
+    int hz;
+    int tids[PROFILE_MAX_THREADS];
+    int fds[PROFILE_MAX_THREADS];
+    void *rings[PROFILE_MAX_THREADS];
+    int count;
+    size_t ring_bytes;
+    long page_size;
+} PerfSampler;
+
+static int list_threads(int pid, int *tids, int max) {
+    char path[64];
+    struct dirent *entry;
+    int count = 0;
+
+    snprintf(path, sizeof(path), "/proc/%d/task", pid);
+    DIR *dir = opendir(path);
+    if (dir == NULL) {
+        return -1;
+    }
+    while ((entry = readdir(dir)) != NULL && count < max) {
+        if (entry->d_name[0] >= '1' && entry->d_name[0] <= '9') {
+            tids[count++] = atoi(entry->d_name);
+        }
+    }
+    closedir(dir);
+    return count;
+}
+
+static bool tid_listed(const int *tids, int count, int tid) {
+    for (int i = 0; i < count; i++) {
+        if (tids[i] == tid) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void perf_sampler_drop(PerfSampler *sampler, int i) {
+    munmap(sampler->rings[i], sampler->ring_bytes + (size_t)sampler->page_size);
+    close(sampler->fds[i]);
+    sampler->count--;
+    sampler->tids[i] = sampler->tids[sampler->count];
+    sampler->fds[i] = sampler->fds[sampler->count];
+    sampler->rings[i] = sampler->rings[sampler->count];
+}
+
+static void perf_sampler_close(PerfSampler *sampler) {
+    while (sampler->count > 0) {
+        perf_sampler_drop(sampler, sampler->count - 1);
+    }
+}
+
+/**
+ * Give every new thread a cpu-clock sampling event and ring buffer, and
+ * release the buffers of threads that exited (call after draining).
+ * The kernel refuses to mmap inherited per-task events, so threads are
+ * picked up by rescanning instead. Returns 0 or an errno.
+ */
+static int perf_sampler_attach(PerfSampler *sampler) {
+    static int tids[PROFILE_MAX_THREADS];
+    struct perf_event_attr attr;
+
+    int count = list_threads(sampler->pid, tids, PROFILE_MAX_THREADS);
+    if (count <= 0) {
+        return ESRCH;
+    }
+    for (int i = sampler->count - 1; i >= 0; i--) {
+        if (!tid_listed(tids, count, sampler->tids[i])) {
+            perf_sampler_drop(sampler, i);
+        }
+    }
+
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_SOFTWARE;
+    attr.config = PERF_COUNT_SW_CPU_CLOCK;
+    attr.freq = 1;
+    attr.sample_freq = (unsigned long long)sampler->hz;
+    attr.sample_type = PERF_SAMPLE_TID | PERF_SAMPLE_CALLCHAIN;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.exclude_callchain_kernel = 1;
+
+    for (int i = 0; i < count && sampler->count < PROFILE_MAX_THREADS; i++) {
+        if (tid_listed(sampler->tids, sampler->count, tids[i])) {
+            continue;
+        }
+        int fd = (int)syscall(SYS_perf_event_open, &attr, tids[i], -1, -1, PERF_FLAG_FD_CLOEXEC);
+        if (fd < 0) {
+            if (errno == ESRCH) {
+                continue;   // Thread exited while we were listing
+            }
+            return errno;
+        }
+        void *ring = mmap(NULL, sampler->ring_bytes + (size_t)sampler->page_size,
+                          PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (ring == MAP_FAILED) {
+            int error = errno;
+            close(fd);
+            return error;
+        }
+        sampler->tids[sampler->count] = tids[i];
+        sampler->fds[sampler->count] = fd;
+        sampler->rings[sampler->count] = ring;
+        sampler->count++;
+    }
+    return 0;
+}
+
+static bool perf_sampler_open(PerfSampler *sampler, int pid, int hz, int *error) {
+    memset(sampler, 0, sizeof(*sampler));
+    sampler->pid = pid;
+    sampler->hz = hz;
+    sampler->page_size = sysconf(_SC_PAGESIZE);
+    sampler->ring_bytes = (size_t)PROFILE_RING_PAGES * (size_t)sampler->page_size;
+
+    *error = perf_sampler_attach(sampler);
+    if (*error != 0 || sampler->count == 0) {
+        perf_sampler_close(sampler);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Drain every ring buffer into the stack table
+ */
+static void perf_sampler_drain(PerfSampler *sampler, StackTable *table) {
+    unsigned long long frames[PROFILE_MAX_FRAMES];
+    unsigned char record[PROFILE_MAX_FRAMES * 8 + 64];
+    size_t mask = sampler->ring_bytes - 1;
+
+    for (int r = 0; r < sampler->count; r++) {
+        struct perf_event_mmap_page *meta = sampler->rings[r];
+        unsigned char *data = (unsigned char *)sampler->rings[r] + sampler->page_size;
+        unsigned long long head = __atomic_load_n(&meta->data_head, __ATOMIC_ACQUIRE);
+        unsigned long long tail = meta->data_tail;
+
+        while (tail < head) {
+            struct perf_event_header header;
+            size_t at = (size_t)tail & mask;
+            for (size_t i = 0; i < sizeof(header); i++) {
+                ((unsigned char *)&header)[i] = data[(at + i) & mask];
+            }
+            if (header.size < sizeof(header)) {
+                tail = head;    // Corrupt ring; resynchronise
+                break;
+            }
+
+            size_t size = header.size < sizeof(record) ? header.size : sizeof(record);
+            if (at + size <= sampler->ring_bytes) {
+                memcpy(record, data + at, size);
+            } else {
+                size_t first = sampler->ring_bytes - at;
+                memcpy(record, data + at, first);
+                memcpy(record + first, data, size - first);
+            }
+            tail += header.size;
+
+            if (header.type == PERF_RECORD_LOST) {
+                unsigned long long lost;
+                memcpy(&lost, record + sizeof(header) + 8, sizeof(lost));
+                table->lost += (unsigned long)lost;
+                continue;
+            }
+            if (header.type != PERF_RECORD_SAMPLE || size < sizeof(header) + 16) {
+                continue;
+            }
+
+            // PERF_SAMPLE_TID, then PERF_SAMPLE_CALLCHAIN: nr, ips[nr]
+            unsigned int ids[2];
+            unsigned long long nr;
+            memcpy(ids, record + sizeof(header), sizeof(ids));
+            memcpy(&nr, record + sizeof(header) + 8, sizeof(nr));
+            const unsigned char *ips = record + sizeof(header) + 16;
+            size_t available = (size - sizeof(header) - 16) / 8;
+            if (nr > available) nr = available;
+
+            int depth = 0;
+            for (unsigned long long i = 0; i < nr && depth < PROFILE_MAX_FRAMES; i++) {
+                unsigned long long ip;
+                memcpy(&ip, ips + i * 8, sizeof(ip));
+                if (ip >= (unsigned long long)PERF_CONTEXT_MAX) {
+                    continue;   // PERF_CONTEXT_USER and friends
+                }
+                frames[depth++] = ip;
+            }
+            stack_table_add(table, (int)ids[1], frames, depth);
+        }
+        __atomic_store_n(&meta->data_tail, tail, __ATOMIC_RELEASE);
+    }
+}
+
+/* ------------------------------------------------------------------ */
+/* ptrace sampling                                                     */
+/* ------------------------------------------------------------------ */
+
+#ifdef PROFILE_HAVE_PTRACE
+
+typedef struct {
+    int tid;
+    int stat_fd;
+    bool alive;
+} TracedThread;
+
+typedef struct {
+    int pid;
+    TracedThread threads[PROFILE_MAX_THREADS];
+    int count;
+    long long stopped_us;       // Summed over sampled threads
+    unsigned long samples;
+} PtraceSampler;
+
+static void ptrace_sampler_seize(PtraceSampler *sampler) {
+    static int tids[PROFILE_MAX_THREADS];
+    char path[64];
+
+    int count = list_threads(sampler->pid, tids, PROFILE_MAX_THREADS);
+    for (int i = 0; i < count && sampler->count < PROFILE_MAX_THREADS; i++) {
+        bool known = false;
+        for (int j = 0; j < sampler->count && !known; j++) {
+            known = sampler->threads[j].tid == tids[i];
+        }
+        if (known || ptrace(PTRACE_SEIZE, tids[i], NULL, NULL) < 0) {
+            continue;
+        }
+        snprintf(path, sizeof(path), "/proc/%d/task/%d/stat", sampler->pid, tids[i]);
+        TracedThread *thread = &sampler->threads[sampler->count++];
+        thread->tid = tids[i];
+        thread->stat_fd = open(path, O_RDONLY | O_CLOEXEC);
+        thread->alive = true;
+    }
+}
+
+/**
+ * Only threads on (or waiting for) a CPU are sampled, as with cpu-clock
+ */
+static bool thread_running(const TracedThread *thread) {
+    char buf[512];
+    ssize_t n = pread(thread->stat_fd, buf, sizeof(buf) - 1, 0);
+    if (n <= 0) {
+        return false;
+    }
+    buf[n] = '\0';
+    const char *close_paren = strrchr(buf, ')');
+    return close_paren != NULL && close_paren[1] == ' ' && close_paren[2] == 'R';
+}
+
+static long long now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static bool read_frame(int tid, unsigned long long addr, unsigned long long out[2]) {
+    struct iovec local = { out, 2 * sizeof(unsigned long long) };
+    struct iovec remote = { (void *)(uintptr_t)addr, 2 * sizeof(unsigned long long) };
+    return process_vm_readv(tid, &local, 1, &remote, 1, 0) == (ssize_t)sizeof(unsigned long long) * 2;
+}
+
+/**
+ * Frame-pointer unwind of a stopped thread: [fp] = caller's fp, [fp+8] = return address
+ */
+static int unwind_thread(int tid, unsigned long long *frames) {
+    unsigned long long pc, fp;
+    int depth = 0;
+
+#if defined(__x86_64__)
+    struct user_regs_struct regs;
+    if (ptrace(PTRACE_GETREGS, tid, NULL, &regs) < 0) {
+        return 0;
+    }
+    pc = regs.rip;
+    fp = regs.rbp;
+#else
+    struct user_pt_regs regs;
+    struct iovec iov = { &regs, sizeof(regs) };
+    if (ptrace(PTRACE_GETREGSET, tid, (void *)NT_PRSTATUS, &iov) < 0) {
+        return 0;
+    }
+    pc = regs.pc;
+    fp = regs.regs[29];
+#endif
+
+    frames[depth++] = pc;
+    while (depth < PROFILE_MAX_FRAMES && fp != 0 && (fp & 7) == 0) {
+        unsigned long long frame[2];
+        if (!read_frame(tid, fp, frame) || frame[1] == 0) {
+            break;
+        }
+        frames[depth++] = frame[1];
+        if (frame[0] <= fp) {
+            break;      // Stacks grow down; callers live higher up
+        }
+        fp = frame[0];
+    }
+    return depth;
+}
+
+/**
+ * Wait for the stop our PTRACE_INTERRUPT asked for. Signals that arrive
+ * first are handed straight back to the target; a job-control stop is
+ * left in place. Returns true if the thread is stopped for us.
+ */
+static bool wait_interrupt_stop(TracedThread *thread) {
+    int status;
+
+    for (;;) {
+        if (waitpid(thread->tid, &status, __WALL) < 0 || !WIFSTOPPED(status)) {
+            thread->alive = false;
+            return false;
+        }
+        int sig = WSTOPSIG(status);
+        if (status >> 16 != PTRACE_EVENT_STOP) {
+            ptrace(PTRACE_CONT, thread->tid, NULL, (void *)(uintptr_t)sig);
+            continue;
+        }
+        if (sig == SIGSTOP || sig == SIGTSTP || sig == SIGTTIN || sig == SIGTTOU) {
+            ptrace(PTRACE_LISTEN, thread->tid, NULL, NULL);
+            return false;
+        }
+        return true;
+    }
+}
+
+/**
+ * Interrupt every thread that is on a CPU first, then unwind them one by
+ * one, so their stops overlap instead of adding up
+ */
+static void ptrace_sampler_tick(PtraceSampler *sampler, StackTable *table) {
+    static bool pending[PROFILE_MAX_THREADS];
+    unsigned long long frames[PROFILE_MAX_FRAMES];
+    long long stop_start = now_us();
+    int stopped = 0;
+
+    for (int i = 0; i < sampler->count; i++) {
+        TracedThread *thread = &sampler->threads[i];
+        pending[i] = thread->alive && thread_running(thread) &&
+                     ptrace(PTRACE_INTERRUPT, thread->tid, NULL, NULL) == 0;
+    }
+    for (int i = 0; i < sampler->count; i++) {
+        TracedThread *thread = &sampler->threads[i];
+        if (!pending[i] || !wait_interrupt_stop(thread)) {
+            continue;
+        }
+        int depth = unwind_thread(thread->tid, frames);
+        ptrace(PTRACE_CONT, thread->tid, NULL, NULL);
+        stack_table_add(table, thread->tid, frames, depth);
+        sampler->stopped_us += now_us() - stop_start;
+        stopped++;
+    }
+    sampler->samples += stopped;
+}
+
+static void ptrace_sampler_detach(PtraceSampler *sampler) {
+    for (int i = 0; i < sampler->count; i++) {
+        TracedThread *thread = &sampler->threads[i];
+        if (thread->alive && ptrace(PTRACE_INTERRUPT, thread->tid, NULL, NULL) == 0) {
+            wait_interrupt_stop(thread);
+            ptrace(PTRACE_DETACH, thread->tid, NULL, NULL);
+        }
+        if (thread->stat_fd >= 0) {
+            close(thread->stat_fd);
+        }
+    }
+    sampler->count = 0;
+}
+
+#endif
+
+/* ------------------------------------------------------------------ */
+/* Output                                                              */
+/* ------------------------------------------------------------------ */
+
+typedef struct {
+    char *line;
+    unsigned long count;
+} FoldedLine;
+
+static int compare_folded(const void *a, const void *b) {
+    return strcmp(((const FoldedLine *)a)->line, ((const FoldedLine *)b)->line);
+}
+
+typedef struct {
+    const char *name;
+    unsigned long count;
+} SelfCount;
+
+/**
+ * Symbolize every distinct stack, merge stacks that resolve to the same
+ * functions, write them collapsed and print the hottest leaf functions
+ */
+static bool write_folded(StackTable *table, SymbolCache *symbols, FILE *out, bool summary) {
+    FoldedLine *lines = malloc((table->used > 0 ? table->used : 1) * sizeof(FoldedLine));
+    size_t self_capacity = 1024;
+    while (self_capacity < table->used * 2) self_capacity *= 2;
+    SelfCount *self = calloc(self_capacity, sizeof(SelfCount));
+    size_t line_count = 0;
+
+    if (lines == NULL || self == NULL) {
+        free(lines);
+        free(self);
+        return false;
+    }
+
+    size_t buf_size = 4096;
+    char *buf = malloc(buf_size);
+    for (size_t s = 0; buf != NULL && s < table->capacity; s++) {
+        const StackSlot *slot = &table->slots[s];
+        if (slot->count == 0) {
+            continue;
+        }
+        const unsigned long long *frames = &table->frames[slot->offset];
+        size_t len = (size_t)snprintf(buf, buf_size, "%s", table->names[slot->name]);
+
+        // Root first; return addresses point after the call, so step back one
+        for (int f = slot->depth - 1; f >= 0; f--) {
+            const char *name = symbol_cache_lookup(symbols, f == 0 ? frames[f] : frames[f] - 1);
+            size_t need = len + strlen(name) + 2;
+            if (need > buf_size) {
+                char *grown = realloc(buf, need * 2);
+                if (grown == NULL) break;
+                buf = grown;
+                buf_size = need * 2;
+            }
+            buf[len++] = ';';
+            strcpy(buf + len, name);
+            len += strlen(name);
+
+            if (f == 0) {
+                // Names are interned per binary, so the pointer is the key
+                size_t i = ((uintptr_t)name >> 3) & (self_capacity - 1);
+                while (self[i].name != NULL && self[i].name != name) i = (i + 1) & (self_capacity - 1);
+                self[i].name = name;
+                self[i].count += slot->count;
+            }
+        }
+        lines[line_count].line = strdup(buf);
+        lines[line_count].count = slot->count;
+        if (lines[line_count].line != NULL) {
+            line_count++;
+        }
+    }
+    free(buf);
+
+    qsort(lines, line_count, sizeof(FoldedLine), compare_folded);
+    size_t written = 0;
+    for (size_t i = 0; i < line_count; i++) {
+        unsigned long count = lines[i].count;
+        while (i + 1 < line_count && strcmp(lines[i].line, lines[i + 1].line) == 0) {
+            free(lines[i].line);
+            count += lines[++i].count;
+        }
+        fprintf(out, "%s %lu\n", lines[i].line, count);
+        free(lines[i].line);
+        written++;
+    }
+    free(lines);
+
+    static TopNItem top[15];
+    TopNHeap heap;
+    topn_init(&heap, top, 15);
+    for (size_t i = 0; i < self_capacity; i++) {
+        if (self[i].name != NULL) {
+            topn_offer(&heap, (double)self[i].count, (int)i);
+        }
+    }
+    int shown = summary ? topn_finish(&heap) : 0;
+    if (shown > 0) {
+        printf("\n%sHottest functions (self samples):%s\n", COLOR_CYAN, COLOR_RESET);
+    }
+    for (int i = 0; i < shown; i++) {
+        const SelfCount *entry = &self[top[i].index];
+        printf("  %6.2f%%  %8lu  %s\n", 100.0 * (double)entry->count / (double)table->samples,
+               entry->count, entry->name);
+    }
+    free(self);
+    return written > 0;
+}
+
+#endif
+
+/**
+ * Profile a pid for duration_s seconds (0 = until a key or SIGINT) at
+ * hz samples per second, writing collapsed stacks to out_path ("-" for
+ * stdout). use_ptrace skips perf_event_open.
+ */
+void sysmon_profile(int pid, int duration_s, int hz, const char *out_path, bool use_ptrace) {
+#ifndef __linux__
+    (void)pid;
+    (void)duration_s;
+    (void)hz;
+    (void)out_path;
+    (void)use_ptrace;
+    print_warning("The stack profiler uses perf_event_open and ptrace and is only available on Linux.");
+#else
+    StackTable table;
+    SymbolCache symbols;
+    PerfSampler *perf = NULL;
+    char default_path[64];
+    int error = 0;
+
+    if (hz < 1) hz = 99;
+    if (hz > 1000) hz = 1000;
+    if (pid <= 0 || kill(pid, 0) < 0) {
+        print_error("No such process!");
+        return;
+    }
+    if (out_path == NULL || out_path[0] == '\0') {
+        snprintf(default_path, sizeof(default_path), "profile-%d.folded", pid);
+        out_path = default_path;
+    }
+    // With the stacks on stdout, progress goes to stderr
+    bool to_stdout = strcmp(out_path, "-") == 0;
+    FILE *status = to_stdout ? stderr : stdout;
+
+    memset(&table, 0, sizeof(table));
+    memset(&symbols, 0, sizeof(symbols));
+    table.pid = pid;
+    symbols.pid = pid;
+    symbol_cache_load_maps(&symbols);
+
+    if (!use_ptrace) {
+        perf = malloc(sizeof(PerfSampler));
+        if (perf != NULL && !perf_sampler_open(perf, pid, hz, &error)) {
+            free(perf);
+            perf = NULL;
+        }
+    }
+
+#ifdef PROFILE_HAVE_PTRACE
+    PtraceSampler *traced = NULL;
+    if (perf == NULL) {
+        if (!use_ptrace) {
+            char message[128];
+            snprintf(message, sizeof(message), "perf_event_open sampling unavailable (%s), falling back to ptrace.",
+                     strerror(error));
+            print_warning(message);
+        }
+        traced = calloc(1, sizeof(PtraceSampler));
+        if (traced != NULL) {
+            traced->pid = pid;
+            ptrace_sampler_seize(traced);
+            if (traced->count == 0) {
+                free(traced);
+                traced = NULL;
+            }
+        }
+    }
+    if (perf == NULL && traced == NULL) {
+#else
+    if (perf == NULL) {
+#endif
+        print_error("Could not attach to the process. Run as root, or check "
+                    "perf_event_paranoid and ptrace_scope.");
+        symbol_cache_free(&symbols);
+        return;
+    }
+
+    struct sigaction sa, old_sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = profile_sigint_handler;
+    sigaction(SIGINT, &sa, &old_sa);
+    profile_interrupted = 0;
+
+    bool interactive = isatty(STDIN_FILENO);
+    fprintf(status, "%sSampling pid %d at %d Hz via %s - %s%s\n", COLOR_CYAN, pid, hz,
+           perf != NULL ? "perf_event_open" : "ptrace",
+           interactive ? "press any key to stop" : "send SIGINT to stop", COLOR_RESET);
+    if (interactive) {
+        terminal_set_raw(true);
+    }
+
+    long long start = monotonic_ms();
+    long long next_tick = start;
+    long long next_maps = start + 1000;
+    int tick_ms = perf != NULL ? 100 : 1000 / hz;
+    if (tick_ms < 1) tick_ms = 1;
+
+    while (!profile_interrupted) {
+        int wait_ms = (int)(next_tick - monotonic_ms());
+        if (interactive) {
+            if (wait_for_key(wait_ms) >= 0) {
+                break;
+            }
+        } else if (wait_ms > 0) {
+            poll(NULL, 0, wait_ms);
+        }
+
+        long long now = monotonic_ms();
+        if (now < next_tick) {
+            continue;
+        }
+        next_tick += tick_ms;
+        if (next_tick <= now) {
+            next_tick = now + tick_ms;
+        }
+
+        if (perf != NULL) {
+            perf_sampler_drain(perf, &table);
+        }
+#ifdef PROFILE_HAVE_PTRACE
+        if (traced != NULL) {
+            ptrace_sampler_tick(traced, &table);
+        }
+#endif
+
+        // Pick up dlopen()ed libraries and new threads
+        if (now >= next_maps) {
+            next_maps = now + 1000;
+            if (!symbol_cache_load_maps(&symbols)) {
+                break;  // Target exited; keep what we have
+            }
+            if (perf != NULL) {
+                perf_sampler_attach(perf);
+            }
+#ifdef PROFILE_HAVE_PTRACE
+            if (traced != NULL) {
+                ptrace_sampler_seize(traced);
+            }
+#endif
+            fprintf(status, "\r  %llds, %lu samples   ", (now - start) / 1000, table.samples);
+            fflush(status);
+        }
+        if (duration_s > 0 && now - start >= (long long)duration_s * 1000) {
+            break;
+        }
+    }
+    long long elapsed_ms = monotonic_ms() - start;
+
+    if (interactive) {
+        terminal_set_raw(false);
+    }
+    sigaction(SIGINT, &old_sa, NULL);
+    fprintf(status, "\n");
+
+    if (perf != NULL) {
+        perf_sampler_drain(perf, &table);
+        perf_sampler_close(perf);
+        free(perf);
+    }
+#ifdef PROFILE_HAVE_PTRACE
+    if (traced != NULL) {
+        ptrace_sampler_detach(traced);
+        if (traced->samples > 0) {
+            // Each running thread is stopped once per tick for about this long
+            double stop_us = (double)traced->stopped_us / (double)traced->samples;
+            fprintf(status, "  Average stop per sample %.0f us, about %.2f%% of a busy thread at %d Hz\n",
+                    stop_us, stop_us * hz / 1e4, hz);
+        }
+        free(traced);
+    }
+#endif
+    if (table.lost > 0) {
+        print_warning("Some samples were lost; the ring buffers overflowed.");
+    }
+
+    fprintf(status, "  %lu samples in %.1f s, %zu distinct stacks\n", table.samples,
+           (double)elapsed_ms / 1000.0, table.used);
+    if (table.samples == 0) {
+        print_warning("No samples: the process was idle, or it is not using the CPU in user space.");
+    } else {
+        FILE *out = to_stdout ? stdout : fopen(out_path, "w");
+        if (out == NULL) {
+            print_error("Could not open the output file!");
+        } else {
+            write_folded(&table, &symbols, out, !to_stdout);
+            if (!to_stdout) {
+                fclose(out);
+                printf("  Collapsed stacks written to %s (flamegraph.pl %s > flame.svg)\n",
+                       out_path, out_path);
+            }
+        }
+    }
+
+    symbol_cache_free(&symbols);
+    stack_table_free(&table);
+#endif
+}
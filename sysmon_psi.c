@@ -0,0 +1,328 @@
+/**
+ * DevHelper+Portal CLI - Pressure Stall Information
+ *
+ * Shows how much wall time tasks spent stalled on CPU, memory and I/O,
+ * for the whole host (/proc/pressure) and for our cgroup (*.pressure).
+ * Besides the kernel's avg10/60/300 it computes the stall rate over the
+ * refresh interval from the `total` counters, and can register PSI
+ * triggers so stall events wake the view immediately.
+ */
+
+#define _GNU_SOURCE
+#include "devhelper.h"
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <poll.h>
+#endif
+
+#ifdef __linux__
+
+// Unprivileged triggers need a window that is a multiple of 2 s
+#define PSI_TRIGGER_WINDOW_US 2000000
+
+static const char *psi_resources[PSI_RESOURCE_COUNT] = { "cpu", "memory", "io" };
+
+/**
+ * Parse the "some" and "full" lines of one pressure file
+ */
+static bool parse_pressure(const char *buf, PsiResource *res) {
+    const char *full = strstr(buf, "full ");
+
+    memset(res, 0, sizeof(*res));
+    res->some.valid = sscanf(buf, "some avg10=%lf avg60=%lf avg300=%lf total=%llu",
+                             &res->some.avg10, &res->some.avg60, &res->some.avg300,
+                             &res->some.total_usec) == 4;
+    if (full != NULL) {
+        res->full.valid = sscanf(full, "full avg10=%lf avg60=%lf avg300=%lf total=%llu",
+                                 &res->full.avg10, &res->full.avg60, &res->full.avg300,
+                                 &res->full.total_usec) == 4;
+    }
+    return res->some.valid;
+}
+
+static void pressure_path(char *out, size_t size, bool cgroup, int resource) {
+    if (cgroup) {
+        snprintf(out, size, "%s/%s.pressure", cgroup_v2_dir(), psi_resources[resource]);
+    } else {
+        snprintf(out, size, "/proc/pressure/%s", psi_resources[resource]);
+    }
+}
+
+#endif
+
+/**
+ * Read host and cgroup pressure for CPU, memory and I/O
+ */
+bool psi_read(PsiSnapshot *snap) {
+    memset(snap, 0, sizeof(*snap));
+#ifdef __linux__
+    char path[MAX_PATH_LENGTH + 32];
+    char buf[256];
+
+    snap->time_ms = monotonic_ms();
+    for (int r = 0; r < PSI_RESOURCE_COUNT; r++) {
+        pressure_path(path, sizeof(path), false, r);
+        if (sysmon_read_file(path, buf, sizeof(buf)) > 0 && parse_pressure(buf, &snap->host[r])) {
+            snap->has_host = true;
+        }
+        if (cgroup_v2_dir()[0] != '\0') {
+            pressure_path(path, sizeof(path), true, r);
+            if (sysmon_read_file(path, buf, sizeof(buf)) > 0 && parse_pressure(buf, &snap->cgroup[r])) {
+                snap->has_cgroup = true;
+            }
+        }
+    }
+    return snap->has_host || snap->has_cgroup;
+#else
+    return false;
+#endif
+}
+
+#ifdef __linux__
+
+typedef struct {
+    int fds[PSI_RESOURCE_COUNT];
+    unsigned long events[PSI_RESOURCE_COUNT];
+    long long last_event_ms[PSI_RESOURCE_COUNT];
+    int percent;
+    int active;
+} PsiTriggers;
+
+/**
+ * Ask the kernel to wake us when "some" stall time exceeds the given
+ * share of a 2 s window. Triggers the kernel refuses are skipped.
+ */
+static void register_triggers(PsiTriggers *triggers, int percent) {
+    char path[64];
+    char spec[64];
+
+    memset(triggers, 0, sizeof(*triggers));
+    triggers->percent = percent;
+    snprintf(spec, sizeof(spec), "some %d %d",
+             PSI_TRIGGER_WINDOW_US / 100 * percent, PSI_TRIGGER_WINDOW_US);
+
+    for (int r = 0; r < PSI_RESOURCE_COUNT; r++) {
+        triggers->fds[r] = -1;
+        if (percent <= 0) {
+            continue;
+        }
+        pressure_path(path, sizeof(path), false, r);
+        int fd = open(path, O_RDWR | O_NONBLOCK | O_CLOEXEC);
+        if (fd < 0) {
+            continue;
+        }
+        // The kernel wants the terminating NUL as part of the write
+        if (write(fd, spec, strlen(spec) + 1) < 0) {
+            close(fd);
+            continue;
+        }
+        triggers->fds[r] = fd;
+        triggers->active++;
+    }
+}
+
+static void close_triggers(PsiTriggers *triggers) {
+    for (int r = 0; r < PSI_RESOURCE_COUNT; r++) {
+        if (triggers->fds[r] >= 0) {
+            close(triggers->fds[r]);
+        }
+    }
+}
+
+/**
+ * Wait for a key, a trigger or the timeout.
+ * Returns the key (0 on EOF or SIGINT/SIGTERM), -1 on timeout, -2 if a
+ * trigger fired.
+ */
+static int wait_for_key_or_trigger(PsiTriggers *triggers, int timeout_ms) {
+    struct pollfd pfds[1 + PSI_RESOURCE_COUNT];
+    int map[1 + PSI_RESOURCE_COUNT];
+    int count = 0;
+
+    pfds[count].fd = STDIN_FILENO;
+    pfds[count].events = POLLIN;
+    map[count++] = -1;
+    for (int r = 0; r < PSI_RESOURCE_COUNT; r++) {
+        if (triggers->fds[r] >= 0) {
+            pfds[count].fd = triggers->fds[r];
+            pfds[count].events = POLLPRI;
+            map[count++] = r;
+        }
+    }
+
+    if (terminal_interrupted()) {
+        return 0;
+    }
+    if (poll(pfds, (nfds_t)count, timeout_ms < 0 ? 0 : timeout_ms) <= 0) {
+        return terminal_interrupted() ? 0 : -1;
+    }
+
+    if (pfds[0].revents & (POLLIN | POLLHUP)) {
+        unsigned char key;
+        return read(STDIN_FILENO, &key, 1) == 1 ? key : 0;
+    }
+
+    bool fired = false;
+    for (int i = 1; i < count; i++) {
+        int r = map[i];
+        if (pfds[i].revents & POLLERR) {
+            // The monitored file went away; stop watching it
+            close(triggers->fds[r]);
+            triggers->fds[r] = -1;
+            triggers->active--;
+        } else if (pfds[i].revents & POLLPRI) {
+            triggers->events[r]++;
+            triggers->last_event_ms[r] = monotonic_ms();
+            fired = true;
+        }
+    }
+    return fired ? -2 : -1;
+}
+
+static double stall_percent(const PsiLine *prev, const PsiLine *cur, long long elapsed_ms) {
+    if (!prev->valid || !cur->valid || elapsed_ms <= 0 || cur->total_usec < prev->total_usec) {
+        return 0.0;
+    }
+    double percent = (double)(cur->total_usec - prev->total_usec) / ((double)elapsed_ms * 10.0);
+    return percent > 100.0 ? 100.0 : percent;
+}
+
+static int render_psi_rows(LiveScreen *screen, int row, const char *scope,
+                           const PsiResource *prev, const PsiResource *cur, long long elapsed_ms) {
+    for (int r = 0; r < PSI_RESOURCE_COUNT; r++) {
+        const PsiLine *lines[2] = { &cur[r].some, &cur[r].full };
+        const PsiLine *prev_lines[2] = { &prev[r].some, &prev[r].full };
+
+        for (int k = 0; k < 2; k++) {
+            if (!lines[k]->valid) {
+                continue;
+            }
+            double now = stall_percent(prev_lines[k], lines[k], elapsed_ms);
+            CellColor color = now >= 20.0 || lines[k]->avg10 >= 20.0 ? CELL_RED
+                            : now >= 5.0 || lines[k]->avg10 >= 5.0 ? CELL_YELLOW : CELL_DEFAULT;
+            int used = live_screen_print(screen, row, 0, color, "%-7s %-7s %-5s %7.2f %7.2f %7.2f %7.2f ",
+                                         scope, psi_resources[r], k == 0 ? "some" : "full",
+                                         lines[k]->avg10, lines[k]->avg60, lines[k]->avg300, now);
+            live_screen_bar(screen, row, used, 20, now);
+            row++;
+        }
+    }
+    return row;
+}
+
+static void render_psi_frame(LiveScreen *screen, const PsiSnapshot *prev, const PsiSnapshot *cur,
+                             const PsiTriggers *triggers, int interval_ms) {
+    long long elapsed = cur->time_ms - prev->time_ms;
+    int row = 0;
+
+    live_screen_begin(screen);
+    live_screen_print(screen, row, 0, CELL_BOLD, "DevHelper Pressure (PSI)");
+    live_screen_print(screen, row++, 26, CELL_CYAN, "interval %d ms  (any key exits)", interval_ms);
+    row++;
+    live_screen_print(screen, row++, 0, CELL_BOLD, "%-7s %-7s %-5s %7s %7s %7s %7s  stalled now",
+                      "Scope", "Res", "Kind", "avg10", "avg60", "avg300", "now%");
+
+    if (cur->has_host) {
+        row = render_psi_rows(screen, row, "host", prev->host, cur->host, elapsed);
+    }
+    if (cur->has_cgroup) {
+        row = render_psi_rows(screen, row, "cgroup", prev->cgroup, cur->cgroup, elapsed);
+    }
+
+    row++;
+    if (triggers->percent <= 0) {
+        live_screen_print(screen, row, 0, CELL_DEFAULT, "Triggers off (polling every %d ms)", interval_ms);
+        return;
+    }
+    if (triggers->active == 0) {
+        live_screen_print(screen, row, 0, CELL_YELLOW, "Triggers unavailable on this kernel, polling instead");
+        return;
+    }
+
+    int col = live_screen_print(screen, row, 0, CELL_BOLD, "Stall events (some >= %d%% of 2 s):",
+                                triggers->percent);
+    long long now = monotonic_ms();
+    for (int r = 0; r < PSI_RESOURCE_COUNT; r++) {
+        if (triggers->fds[r] < 0 && triggers->events[r] == 0) {
+            continue;
+        }
+        bool recent = triggers->events[r] > 0 && now - triggers->last_event_ms[r] < 5000;
+        col += live_screen_print(screen, row, col, recent ? CELL_RED : CELL_DEFAULT, "  %s %lu",
+                                 psi_resources[r], triggers->events[r]);
+    }
+}
+
+#endif
+
+/**
+ * Live PSI view. trigger_percent > 0 registers kernel triggers so the
+ * view refreshes as soon as stalls cross that share of a 2 s window.
+ */
+void sysmon_psi_view(int interval_ms, int trigger_percent) {
+#ifndef __linux__
+    (void)interval_ms;
+    (void)trigger_percent;
+    print_warning("Pressure stall information is only available on Linux.");
+#else
+    PsiSnapshot prev, cur;
+    PsiTriggers triggers;
+    LiveScreen screen;
+
+    if (interval_ms < 100) interval_ms = 100;
+    if (interval_ms > 5000) interval_ms = 5000;
+    if (trigger_percent > 100) trigger_percent = 100;
+
+    if (!psi_read(&prev)) {
+        print_error("Could not read /proc/pressure (kernel without CONFIG_PSI or psi=0)!");
+        return;
+    }
+    if (!live_screen_init(&screen)) {
+        print_error("Not enough memory for the pressure view!");
+        return;
+    }
+    register_triggers(&triggers, trigger_percent);
+    cur = prev;
+
+    terminal_set_raw(true);
+    render_psi_frame(&screen, &prev, &cur, &triggers, interval_ms);
+    live_screen_flush(&screen);
+
+    long long next_tick = monotonic_ms() + interval_ms;
+    for (;;) {
+        int event = wait_for_key_or_trigger(&triggers, (int)(next_tick - monotonic_ms()));
+        if (event >= 0) {
+            break;
+        }
+
+        long long now = monotonic_ms();
+        if (event == -1 && now < next_tick) {
+            continue;
+        }
+        if (now >= next_tick) {
+            next_tick += interval_ms;
+            if (next_tick <= now) {
+                next_tick = now + interval_ms;
+            }
+        }
+
+        // A trigger refreshes early without moving the rate baseline
+        PsiSnapshot sample;
+        psi_read(&sample);
+        if (event == -1) {
+            prev = cur;
+            cur = sample;
+            render_psi_frame(&screen, &prev, &cur, &triggers, interval_ms);
+        } else {
+            render_psi_frame(&screen, &cur, &sample, &triggers, interval_ms);
+        }
+        live_screen_flush(&screen);
+    }
+
+    terminal_set_raw(false);
+    printf("%s\033[H\033[2J", COLOR_RESET);
+    fflush(stdout);
+    close_triggers(&triggers);
+    live_screen_free(&screen);
+#endif
+}
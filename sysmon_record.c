@@ -0,0 +1,846 @@
+/**
+ * DevHelper+Portal CLI - Resource Recording and Replay
+ *
+ * Records CPU, memory, disk and network samples from /proc into a compact
+ * append-only file and plays them back through the live view.
+ *
+ * File layout:
+ *   RecordingHeader (fixed size, updated in place as frames are appended)
+ *   frames: [type:u8][payload length:varint][payload]
+ *
+ * Every sample is a vector of integer columns. Key frames store absolute
+ * values; delta frames store, per column, the change from the previous
+ * sample (gauges) or the change of that change (counters). Residuals are
+ * zigzag varints, and runs of zeros collapse into a 0x00 byte plus a run
+ * length. Index frames list the key frames written since the previous
+ * index and link back to it, so a reader can seek without decoding.
+ *
+ * The file is written through a shared mapping and never fsync'd; the
+ * header's data_end tells a reader how much of the file is valid even
+ * if the recorder was killed.
+ */
+
+#define _GNU_SOURCE
+#include "devhelper.h"
+#include <stdint.h>
+#include <signal.h>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#endif
+
+#define RECORD_MAGIC "DHSMREC1"
+#define RECORD_VERSION 1
+#define RECORD_GROW_BYTES (1024 * 1024)
+#define RECORD_KEY_INTERVAL 256     // Samples between key frames
+#define RECORD_KEYS_PER_INDEX 16    // Key frames listed per index frame
+
+// Fixed columns before the per-core blocks (see sample_to_columns)
+#define RECORD_FIXED_COLUMNS 32
+#define RECORD_PER_CORE_COLUMNS 4
+#define RECORD_MAX_COLUMNS (RECORD_FIXED_COLUMNS + RECORD_PER_CORE_COLUMNS * SYSMON_MAX_CPUS)
+
+enum {
+    FRAME_KEY = 1,
+    FRAME_DELTA = 2,
+    FRAME_INDEX = 3
+};
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t cpu_count;
+    uint32_t column_count;
+    uint32_t interval_ms;
+    uint64_t start_unix_ms;
+    uint64_t data_end;        // Offset just past the last complete frame
+    uint64_t last_index;      // Offset of the newest index frame, 0 if none
+    uint64_t sample_count;
+} RecordingHeader;
+
+#ifdef __linux__
+
+/* ------------------------------------------------------------------ */
+/* Column mapping                                                      */
+/* ------------------------------------------------------------------ */
+
+/**
+ * Counters are monotonic and encoded as delta-of-delta; everything else
+ * is a gauge encoded as a plain delta
+ */
+static bool column_is_counter(int col) {
+    if (col <= 9) return true;                    // time, total CPU, ctxt
+    if (col >= 23) return true;                   // disk/net, per-core ticks
+    return false;
+}
+
+/**
+ * Flatten a sample into the recording's column order
+ */
+static void sample_to_columns(const LiveSample *s, long long start_ms, int cpu_count, int64_t *cols) {
+    const CpuTimes *t = &s->cpu.total;
+
+    cols[0] = s->time_ms - start_ms;
+    cols[1] = (int64_t)t->user;
+    cols[2] = (int64_t)t->nice;
+    cols[3] = (int64_t)t->system;
+    cols[4] = (int64_t)t->idle;
+    cols[5] = (int64_t)t->iowait;
+    cols[6] = (int64_t)t->irq;
+    cols[7] = (int64_t)t->softirq;
+    cols[8] = (int64_t)t->steal;
+    cols[9] = (int64_t)s->cpu.context_switches;
+    cols[10] = s->cpu.procs_running;
+    cols[11] = (int64_t)s->mem.total_kb;
+    cols[12] = (int64_t)s->mem.free_kb;
+    cols[13] = (int64_t)s->mem.available_kb;
+    cols[14] = (int64_t)s->mem.buffers_kb;
+    cols[15] = (int64_t)s->mem.cached_kb;
+    cols[16] = (int64_t)s->mem.swap_total_kb;
+    cols[17] = (int64_t)s->mem.swap_free_kb;
+    cols[18] = (int64_t)(s->load.load1 * 100.0 + 0.5);
+    cols[19] = (int64_t)(s->load.load5 * 100.0 + 0.5);
+    cols[20] = (int64_t)(s->load.load15 * 100.0 + 0.5);
+    cols[21] = s->load.running_tasks;
+    cols[22] = s->load.total_tasks;
+    cols[23] = (int64_t)s->io.reads;
+    cols[24] = (int64_t)s->io.writes;
+    cols[25] = (int64_t)s->io.read_sectors;
+    cols[26] = (int64_t)s->io.write_sectors;
+    cols[27] = (int64_t)s->io.io_ms;
+    cols[28] = (int64_t)s->io.rx_bytes;
+    cols[29] = (int64_t)s->io.tx_bytes;
+    cols[30] = (int64_t)s->io.rx_packets;
+    cols[31] = (int64_t)s->io.tx_packets;
+
+    // Per-core values grouped by kind so idle iowait/steal become zero runs
+    int64_t *busy = cols + RECORD_FIXED_COLUMNS;
+    int64_t *idle = busy + cpu_count;
+    int64_t *iowait = idle + cpu_count;
+    int64_t *steal = iowait + cpu_count;
+    for (int i = 0; i < cpu_count; i++) {
+        const CpuTimes *c = &s->cpu.cpu[i];
+        busy[i] = (int64_t)(c->user + c->nice + c->system + c->irq + c->softirq);
+        idle[i] = (int64_t)c->idle;
+        iowait[i] = (int64_t)c->iowait;
+        steal[i] = (int64_t)c->steal;
+    }
+}
+
+/**
+ * Rebuild a sample from recorded columns (per-core busy time is
+ * reported as user time)
+ */
+static void columns_to_sample(const int64_t *cols, int cpu_count, LiveSample *s) {
+    CpuTimes *t = &s->cpu.total;
+
+    memset(s, 0, sizeof(*s));
+    s->time_ms = cols[0];
+    t->user = (unsigned long long)cols[1];
+    t->nice = (unsigned long long)cols[2];
+    t->system = (unsigned long long)cols[3];
+    t->idle = (unsigned long long)cols[4];
+    t->iowait = (unsigned long long)cols[5];
+    t->irq = (unsigned long long)cols[6];
+    t->softirq = (unsigned long long)cols[7];
+    t->steal = (unsigned long long)cols[8];
+    s->cpu.context_switches = (unsigned long long)cols[9];
+    s->cpu.procs_running = (int)cols[10];
+    s->cpu.cpu_count = cpu_count;
+    s->mem.total_kb = (unsigned long long)cols[11];
+    s->mem.free_kb = (unsigned long long)cols[12];
+    s->mem.available_kb = (unsigned long long)cols[13];
+    s->mem.buffers_kb = (unsigned long long)cols[14];
+    s->mem.cached_kb = (unsigned long long)cols[15];
+    s->mem.swap_total_kb = (unsigned long long)cols[16];
+    s->mem.swap_free_kb = (unsigned long long)cols[17];
+    s->load.load1 = cols[18] / 100.0;
+    s->load.load5 = cols[19] / 100.0;
+    s->load.load15 = cols[20] / 100.0;
+    s->load.running_tasks = (int)cols[21];
+    s->load.total_tasks = (int)cols[22];
+    s->io.reads = (unsigned long long)cols[23];
+    s->io.writes = (unsigned long long)cols[24];
+    s->io.read_sectors = (unsigned long long)cols[25];
+    s->io.write_sectors = (unsigned long long)cols[26];
+    s->io.io_ms = (unsigned long long)cols[27];
+    s->io.rx_bytes = (unsigned long long)cols[28];
+    s->io.tx_bytes = (unsigned long long)cols[29];
+    s->io.rx_packets = (unsigned long long)cols[30];
+    s->io.tx_packets = (unsigned long long)cols[31];
+
+    const int64_t *busy = cols + RECORD_FIXED_COLUMNS;
+    const int64_t *idle = busy + cpu_count;
+    const int64_t *iowait = idle + cpu_count;
+    const int64_t *steal = iowait + cpu_count;
+    for (int i = 0; i < cpu_count; i++) {
+        s->cpu.cpu[i].user = (unsigned long long)busy[i];
+        s->cpu.cpu[i].idle = (unsigned long long)idle[i];
+        s->cpu.cpu[i].iowait = (unsigned long long)iowait[i];
+        s->cpu.cpu[i].steal = (unsigned long long)steal[i];
+    }
+}
+
+#endif
+
+/* ------------------------------------------------------------------ */
+/* Varint coding (shared with the agent stream)                        */
+/* ------------------------------------------------------------------ */
+
+size_t put_varint(uint8_t *out, uint64_t value) {
+    size_t n = 0;
+    while (value >= 0x80) {
+        out[n++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    out[n++] = (uint8_t)value;
+    return n;
+}
+
+/**
+ * Decode a varint; returns bytes consumed, or 0 if it runs past `end`
+ */
+size_t get_varint(const uint8_t *p, const uint8_t *end, uint64_t *value) {
+    uint64_t result = 0;
+    size_t n = 0;
+
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (p + n >= end) {
+            return 0;
+        }
+        uint8_t byte = p[n++];
+        result |= (uint64_t)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            *value = result;
+            return n;
+        }
+    }
+    return 0;
+}
+
+uint64_t zigzag(int64_t v) {
+    return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+int64_t unzigzag(uint64_t v) {
+    return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
+
+/**
+ * Encode residuals: nonzero values as zigzag varints (always >= 1),
+ * zero runs as a 0x00 byte followed by the run length
+ */
+size_t encode_residuals(const int64_t *residuals, int count, uint8_t *out) {
+    size_t n = 0;
+
+    for (int i = 0; i < count; ) {
+        if (residuals[i] == 0) {
+            int run = 1;
+            while (i + run < count && residuals[i + run] == 0) run++;
+            out[n++] = 0;
+            n += put_varint(out + n, (uint64_t)run);
+            i += run;
+        } else {
+            n += put_varint(out + n, zigzag(residuals[i]));
+            i++;
+        }
+    }
+    return n;
+}
+
+bool decode_residuals(const uint8_t *p, const uint8_t *end, int64_t *residuals, int count) {
+    for (int i = 0; i < count; ) {
+        uint64_t value;
+        size_t used = get_varint(p, end, &value);
+        if (used == 0) return false;
+        p += used;
+
+        if (value == 0) {
+            uint64_t run;
+            used = get_varint(p, end, &run);
+            if (used == 0 || run == 0 || run > (uint64_t)(count - i)) return false;
+            p += used;
+            memset(&residuals[i], 0, (size_t)run * sizeof(int64_t));
+            i += (int)run;
+        } else {
+            residuals[i++] = unzigzag(value);
+        }
+    }
+    return true;
+}
+
+#ifdef __linux__
+
+/* ------------------------------------------------------------------ */
+/* Recorder                                                            */
+/* ------------------------------------------------------------------ */
+
+typedef struct {
+    int fd;
+    uint8_t *map;
+    size_t map_size;
+    int cpu_count;
+    int columns;
+    long long start_ms;
+    int64_t prev[RECORD_MAX_COLUMNS];
+    int64_t prev_delta[RECORD_MAX_COLUMNS];
+    int64_t residuals[RECORD_MAX_COLUMNS];
+    uint8_t payload[RECORD_MAX_COLUMNS * 11 + 16];
+
+    // Key frames written since the last index frame
+    uint64_t key_sample[RECORD_KEYS_PER_INDEX];
+    uint64_t key_time[RECORD_KEYS_PER_INDEX];
+    uint64_t key_offset[RECORD_KEYS_PER_INDEX];
+    int key_count;
+} Recorder;
+
+static RecordingHeader *recorder_header(Recorder *rec) {
+    return (RecordingHeader *)rec->map;
+}
+
+/**
+ * Make room for `bytes` more at the end of the mapping
+ */
+static bool recorder_reserve(Recorder *rec, size_t bytes) {
+    size_t end = (size_t)recorder_header(rec)->data_end;
+    if (end + bytes <= rec->map_size) {
+        return true;
+    }
+
+    size_t new_size = rec->map_size + RECORD_GROW_BYTES;
+    while (new_size < end + bytes) new_size += RECORD_GROW_BYTES;
+
+    if (ftruncate(rec->fd, (off_t)new_size) != 0) {
+        return false;
+    }
+    void *map = mremap(rec->map, rec->map_size, new_size, MREMAP_MAYMOVE);
+    if (map == MAP_FAILED) {
+        return false;
+    }
+    rec->map = map;
+    rec->map_size = new_size;
+    return true;
+}
+
+/**
+ * Append one frame and publish it by advancing data_end
+ */
+static bool recorder_append(Recorder *rec, uint8_t type, const uint8_t *payload, size_t len) {
+    uint8_t prefix[11];
+    size_t prefix_len = 1 + put_varint(prefix + 1, len);
+    prefix[0] = type;
+
+    if (!recorder_reserve(rec, prefix_len + len)) {
+        return false;
+    }
+
+    RecordingHeader *hdr = recorder_header(rec);
+    uint8_t *dst = rec->map + hdr->data_end;
+    memcpy(dst, prefix, prefix_len);
+    memcpy(dst + prefix_len, payload, len);
+    hdr->data_end += prefix_len + len;
+    return true;
+}
+
+/**
+ * Write an index frame for the pending key frames
+ */
+static bool recorder_write_index(Recorder *rec) {
+    RecordingHeader *hdr = recorder_header(rec);
+    uint8_t payload[16 + RECORD_KEYS_PER_INDEX * 30];
+    size_t n = 0;
+
+    if (rec->key_count == 0) {
+        return true;
+    }
+
+    uint64_t offset = hdr->data_end;
+    n += put_varint(payload + n, hdr->last_index);
+    n += put_varint(payload + n, (uint64_t)rec->key_count);
+    for (int i = 0; i < rec->key_count; i++) {
+        n += put_varint(payload + n, rec->key_sample[i]);
+        n += put_varint(payload + n, rec->key_time[i]);
+        n += put_varint(payload + n, rec->key_offset[i]);
+    }
+
+    if (!recorder_append(rec, FRAME_INDEX, payload, n)) {
+        return false;
+    }
+    recorder_header(rec)->last_index = offset;
+    rec->key_count = 0;
+    return true;
+}
+
+/**
+ * Create the recording file and map its header
+ */
+static bool recorder_open(Recorder *rec, const char *path, int cpu_count, int interval_ms,
+                          long long start_ms) {
+    memset(rec, 0, sizeof(*rec));
+    rec->fd = open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (rec->fd < 0) {
+        return false;
+    }
+
+    rec->map_size = RECORD_GROW_BYTES;
+    if (ftruncate(rec->fd, (off_t)rec->map_size) != 0) {
+        close(rec->fd);
+        return false;
+    }
+    rec->map = mmap(NULL, rec->map_size, PROT_READ | PROT_WRITE, MAP_SHARED, rec->fd, 0);
+    if (rec->map == MAP_FAILED) {
+        close(rec->fd);
+        return false;
+    }
+
+    rec->cpu_count = cpu_count;
+    rec->columns = RECORD_FIXED_COLUMNS + RECORD_PER_CORE_COLUMNS * cpu_count;
+    rec->start_ms = start_ms;
+
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+
+    RecordingHeader *hdr = recorder_header(rec);
+    memcpy(hdr->magic, RECORD_MAGIC, sizeof(hdr->magic));
+    hdr->version = RECORD_VERSION;
+    hdr->cpu_count = (uint32_t)cpu_count;
+    hdr->column_count = (uint32_t)rec->columns;
+    hdr->interval_ms = (uint32_t)interval_ms;
+    hdr->start_unix_ms = (uint64_t)now.tv_sec * 1000 + (uint64_t)now.tv_nsec / 1000000;
+    hdr->data_end = sizeof(RecordingHeader);
+    return true;
+}
+
+/**
+ * Encode and append one sample. No allocation, no fsync.
+ */
+static bool recorder_add(Recorder *rec, const LiveSample *sample) {
+    RecordingHeader *hdr = recorder_header(rec);
+    int64_t cols[RECORD_MAX_COLUMNS];
+    bool key = hdr->sample_count % RECORD_KEY_INTERVAL == 0;
+
+    sample_to_columns(sample, rec->start_ms, rec->cpu_count, cols);
+
+    for (int c = 0; c < rec->columns; c++) {
+        if (key) {
+            rec->residuals[c] = cols[c];
+            rec->prev_delta[c] = 0;
+        } else if (column_is_counter(c)) {
+            int64_t delta = cols[c] - rec->prev[c];
+            rec->residuals[c] = delta - rec->prev_delta[c];
+            rec->prev_delta[c] = delta;
+        } else {
+            rec->residuals[c] = cols[c] - rec->prev[c];
+        }
+        rec->prev[c] = cols[c];
+    }
+
+    if (key) {
+        rec->key_sample[rec->key_count] = hdr->sample_count;
+        rec->key_time[rec->key_count] = (uint64_t)cols[0];
+        rec->key_offset[rec->key_count] = hdr->data_end;
+        rec->key_count++;
+    }
+
+    size_t len = encode_residuals(rec->residuals, rec->columns, rec->payload);
+    if (!recorder_append(rec, key ? FRAME_KEY : FRAME_DELTA, rec->payload, len)) {
+        return false;
+    }
+    recorder_header(rec)->sample_count++;
+
+    if (rec->key_count == RECORD_KEYS_PER_INDEX) {
+        return recorder_write_index(rec);
+    }
+    return true;
+}
+
+/**
+ * Index the trailing key frames, trim the file and unmap
+ */
+static void recorder_close(Recorder *rec) {
+    recorder_write_index(rec);
+    size_t end = (size_t)recorder_header(rec)->data_end;
+    munmap(rec->map, rec->map_size);
+    if (ftruncate(rec->fd, (off_t)end) != 0) {
+        print_warning("Could not trim the recording file.");
+    }
+    close(rec->fd);
+}
+
+/* ------------------------------------------------------------------ */
+/* Reader                                                              */
+/* ------------------------------------------------------------------ */
+
+typedef struct {
+    uint64_t sample;
+    uint64_t time_ms;
+    uint64_t offset;
+} KeyFrameRef;
+
+typedef struct {
+    int fd;
+    const uint8_t *map;
+    size_t size;
+    size_t end;
+    size_t pos;
+    int cpu_count;
+    int columns;
+    bool have_key;
+    bool pending;           // cols holds a decoded sample not yet consumed
+    int64_t prev[RECORD_MAX_COLUMNS];
+    int64_t prev_delta[RECORD_MAX_COLUMNS];
+    int64_t residuals[RECORD_MAX_COLUMNS];
+    int64_t cols[RECORD_MAX_COLUMNS];
+    RecordingHeader header;
+} RecordingReader;
+
+static bool reader_open(RecordingReader *rd, const char *path) {
+    struct stat st;
+
+    memset(rd, 0, sizeof(*rd));
+    rd->fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (rd->fd < 0) {
+        return false;
+    }
+    if (fstat(rd->fd, &st) != 0 || (size_t)st.st_size < sizeof(RecordingHeader)) {
+        close(rd->fd);
+        return false;
+    }
+
+    rd->size = (size_t)st.st_size;
+    rd->map = mmap(NULL, rd->size, PROT_READ, MAP_SHARED, rd->fd, 0);
+    if (rd->map == MAP_FAILED) {
+        close(rd->fd);
+        return false;
+    }
+    memcpy(&rd->header, rd->map, sizeof(rd->header));
+
+    const RecordingHeader *hdr = &rd->header;
+    if (memcmp(hdr->magic, RECORD_MAGIC, sizeof(hdr->magic)) != 0 ||
+        hdr->version != RECORD_VERSION || hdr->cpu_count == 0 ||
+        hdr->cpu_count > SYSMON_MAX_CPUS ||
+        hdr->column_count != RECORD_FIXED_COLUMNS + RECORD_PER_CORE_COLUMNS * hdr->cpu_count) {
+        munmap((void *)rd->map, rd->size);
+        close(rd->fd);
+        return false;
+    }
+
+    rd->cpu_count = (int)hdr->cpu_count;
+    rd->columns = (int)hdr->column_count;
+    rd->end = hdr->data_end < rd->size ? (size_t)hdr->data_end : rd->size;
+    rd->pos = sizeof(RecordingHeader);
+    return true;
+}
+
+static void reader_close(RecordingReader *rd) {
+    munmap((void *)rd->map, rd->size);
+    close(rd->fd);
+}
+
+/**
+ * Read a frame header at `pos`; returns false past the valid data
+ */
+static bool frame_at(const RecordingReader *rd, size_t pos, uint8_t *type,
+                     const uint8_t **payload, size_t *len) {
+    const uint8_t *end = rd->map + rd->end;
+    uint64_t length;
+
+    if (pos + 2 > rd->end) {
+        return false;
+    }
+    size_t used = get_varint(rd->map + pos + 1, end, &length);
+    if (used == 0 || pos + 1 + used + length > rd->end) {
+        return false;
+    }
+    *type = rd->map[pos];
+    *payload = rd->map + pos + 1 + used;
+    *len = (size_t)length;
+    return true;
+}
+
+/**
+ * Decode the next sample into rd->cols, skipping index frames
+ */
+static bool reader_next(RecordingReader *rd) {
+    uint8_t type;
+    const uint8_t *payload;
+    size_t len;
+
+    while (frame_at(rd, rd->pos, &type, &payload, &len)) {
+        rd->pos = (size_t)(payload - rd->map) + len;
+        if (type == FRAME_INDEX) {
+            continue;
+        }
+        if ((type != FRAME_KEY && type != FRAME_DELTA) || (type == FRAME_DELTA && !rd->have_key)) {
+            continue;
+        }
+        if (!decode_residuals(payload, payload + len, rd->residuals, rd->columns)) {
+            return false;
+        }
+
+        for (int c = 0; c < rd->columns; c++) {
+            if (type == FRAME_KEY) {
+                rd->cols[c] = rd->residuals[c];
+                rd->prev_delta[c] = 0;
+            } else if (column_is_counter(c)) {
+                rd->prev_delta[c] += rd->residuals[c];
+                rd->cols[c] = rd->prev[c] + rd->prev_delta[c];
+            } else {
+                rd->cols[c] = rd->prev[c] + rd->residuals[c];
+            }
+            rd->prev[c] = rd->cols[c];
+        }
+        rd->have_key = true;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * Position the reader at the last key frame at or before `time_ms`.
+ * Uses the index chain, then scans frame headers past the newest index.
+ */
+static void reader_seek(RecordingReader *rd, long long time_ms) {
+    size_t best_offset = sizeof(RecordingHeader);
+    uint64_t best_time = 0;
+    uint64_t index = rd->header.last_index;
+    size_t scan_from = index > 0 ? (size_t)index : sizeof(RecordingHeader);
+
+    // Walk index frames newest to oldest
+    while (index > 0) {
+        uint8_t type;
+        const uint8_t *p, *end;
+        size_t len;
+        uint64_t prev_index, count;
+
+        if (!frame_at(rd, (size_t)index, &type, &p, &len) || type != FRAME_INDEX) {
+            break;
+        }
+        end = p + len;
+        size_t used = get_varint(p, end, &prev_index);
+        if (used == 0) break;
+        p += used;
+        used = get_varint(p, end, &count);
+        if (used == 0) break;
+        p += used;
+
+        for (uint64_t i = 0; i < count; i++) {
+            uint64_t sample, t, offset;
+            size_t a = get_varint(p, end, &sample);
+            size_t b = a ? get_varint(p + a, end, &t) : 0;
+            size_t c = b ? get_varint(p + a + b, end, &offset) : 0;
+            if (c == 0) break;
+            p += a + b + c;
+            if ((long long)t <= time_ms && t >= best_time) {
+                best_time = t;
+                best_offset = (size_t)offset;
+            }
+        }
+        if (prev_index >= index) break;
+        index = prev_index;
+    }
+
+    // Key frames recorded after the newest index (e.g. a killed recorder)
+    size_t pos = scan_from;
+    uint8_t type;
+    const uint8_t *payload;
+    size_t len;
+    while (frame_at(rd, pos, &type, &payload, &len)) {
+        if (type == FRAME_KEY) {
+            uint64_t t;
+            uint8_t first = len > 0 ? payload[0] : 0;
+            if (first != 0 && get_varint(payload, payload + len, &t) > 0) {
+                t = (uint64_t)unzigzag(t);
+            } else {
+                t = 0;  // Time column zero (first frame) is coded as a zero run
+            }
+            if ((long long)t <= time_ms && t >= best_time) {
+                best_time = t;
+                best_offset = pos;
+            }
+        }
+        pos = (size_t)(payload - rd->map) + len;
+    }
+
+    rd->pos = best_offset;
+    rd->have_key = false;
+}
+
+/* ------------------------------------------------------------------ */
+/* Record / replay commands                                            */
+/* ------------------------------------------------------------------ */
+
+static volatile sig_atomic_t record_interrupted = 0;
+
+static void record_signal_handler(int sig) {
+    (void)sig;
+    record_interrupted = 1;
+}
+
+static bool replay_source(void *ctx, LiveSample *sample) {
+    RecordingReader *rd = ctx;
+
+    if (rd->pending) {
+        rd->pending = false;
+    } else if (!reader_next(rd)) {
+        return false;
+    }
+    columns_to_sample(rd->cols, rd->cpu_count, sample);
+    return true;
+}
+
+#endif
+
+/**
+ * Record samples into `path` every interval_ms until a key is pressed,
+ * SIGINT/SIGTERM, or duration_s elapses (0 = no limit). Without a
+ * terminal the recorder runs unattended and only the signals or the
+ * duration stop it.
+ */
+void sysmon_record(const char *path, int interval_ms, int duration_s) {
+#ifndef __linux__
+    (void)path;
+    (void)interval_ms;
+    (void)duration_s;
+    print_warning("Recording reads /proc and is only available on Linux.");
+#else
+    static LiveSample sample;
+    static Recorder rec;
+
+    if (interval_ms < 100) interval_ms = 100;
+    if (interval_ms > 60000) interval_ms = 60000;
+
+    if (!sysmon_read_sample(&sample)) {
+        print_error("Could not read /proc!");
+        return;
+    }
+    if (!recorder_open(&rec, path, sample.cpu.cpu_count, interval_ms, sample.time_ms)) {
+        print_error("Could not create the recording file!");
+        return;
+    }
+
+    struct sigaction sa, old_int, old_term;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = record_signal_handler;
+    sigaction(SIGINT, &sa, &old_int);
+    sigaction(SIGTERM, &sa, &old_term);
+    record_interrupted = 0;
+
+    // Unattended runs (no terminal) sleep between ticks and skip the progress line
+    bool interactive = isatty(STDIN_FILENO) && isatty(STDOUT_FILENO);
+    if (interactive) {
+        printf("%sRecording to %s every %d ms - press any key to stop%s\n",
+               COLOR_CYAN, path, interval_ms, COLOR_RESET);
+        terminal_set_raw(true);
+    } else {
+        printf("Recording to %s every %d ms - send SIGINT or SIGTERM to stop\n", path, interval_ms);
+        fflush(stdout);
+    }
+
+    long long start = sample.time_ms;
+    long long next_tick = start;
+    bool ok = true;
+    while (!record_interrupted) {
+        int wait = (int)(next_tick - monotonic_ms());
+        if (interactive) {
+            if (wait_for_key(wait) >= 0) {
+                break;
+            }
+        } else if (wait > 0) {
+            usleep((useconds_t)wait * 1000);
+        }
+        long long now = monotonic_ms();
+        if (record_interrupted || now < next_tick) {
+            continue;
+        }
+        next_tick += interval_ms;
+        if (next_tick <= now) {
+            next_tick = now + interval_ms;
+        }
+
+        if (!sysmon_read_sample(&sample)) {
+            continue;
+        }
+        if (!recorder_add(&rec, &sample)) {
+            ok = false;
+            break;
+        }
+
+        if (interactive) {
+            const RecordingHeader *hdr = recorder_header(&rec);
+            printf("\r  %llu samples, %.1f KB (%.0f bytes/sample)   ",
+                   (unsigned long long)hdr->sample_count, hdr->data_end / 1024.0,
+                   (double)hdr->data_end / (double)hdr->sample_count);
+            fflush(stdout);
+        }
+
+        if (duration_s > 0 && now - start >= (long long)duration_s * 1000) {
+            break;
+        }
+    }
+
+    if (interactive) {
+        terminal_set_raw(false);
+    }
+    sigaction(SIGINT, &old_int, NULL);
+    sigaction(SIGTERM, &old_term, NULL);
+
+    const RecordingHeader *hdr = recorder_header(&rec);
+    unsigned long long samples = hdr->sample_count;
+    double bytes = (double)hdr->data_end;
+    recorder_close(&rec);
+
+    printf("\n\n");
+    if (!ok) {
+        print_error("Writing the recording failed (disk full?); kept what was written.");
+    }
+    char msg[256];
+    snprintf(msg, sizeof(msg), "Recorded %llu samples (%.1f KB) to %s", samples, bytes / 1024.0, path);
+    print_success(msg);
+    if (samples > 0) {
+        snprintf(msg, sizeof(msg), "Average %.0f bytes/sample, about %.2f MB per hour at 1 Hz",
+                 bytes / (double)samples, bytes / (double)samples * 3600.0 / 1e6);
+        print_info(msg);
+    }
+#endif
+}
+
+/**
+ * Play a recording through the live view at `speed`x, starting
+ * `start_s` seconds into it
+ */
+void sysmon_replay(const char *path, double speed, int start_s) {
+#ifndef __linux__
+    (void)path;
+    (void)speed;
+    (void)start_s;
+    print_warning("Replay is only available on Linux.");
+#else
+    static RecordingReader rd;
+
+    if (!reader_open(&rd, path)) {
+        print_error("Not a valid devhelper recording!");
+        return;
+    }
+    if (speed <= 0.0) speed = 1.0;
+    if (start_s > 0) {
+        // Jump to the nearest key frame, then decode up to the start time
+        long long target = (long long)start_s * 1000;
+        reader_seek(&rd, target);
+        while (reader_next(&rd) && rd.cols[0] < target) {
+        }
+        rd.pending = rd.have_key && rd.cols[0] >= target;
+        if (!rd.pending) {
+            print_error("The recording is shorter than the requested start time!");
+            reader_close(&rd);
+            return;
+        }
+    }
+
+    live_monitor_run("DevHelper Replay", replay_source, &rd, (int)rd.header.interval_ms, &speed);
+    reader_close(&rd);
+#endif
+}
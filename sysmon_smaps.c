@@ -0,0 +1,351 @@
+/**
+ * DevHelper+Portal CLI - Per-process Memory (smaps_rollup)
+ *
+ * RSS counts shared pages in full for every process that maps them, so
+ * services that share large mappings look many times bigger than they
+ * are. /proc/[pid]/smaps_rollup gives PSS, where shared pages are split
+ * between their users, plus the clean/dirty and shared/private split.
+ * The kernel walks every mapping to produce it, so reads are spread
+ * over threads on busy hosts and all buffers are reused between scans.
+ */
+
+#define _GNU_SOURCE
+#include "devhelper.h"
+
+#include <stddef.h>
+
+#ifdef __linux__
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#endif
+
+// smaps_rollup is far more expensive than stat, so go parallel early
+#define SMAPS_PARALLEL_THRESHOLD 256
+#define SMAPS_MAX_THREADS 8
+#define SMAPS_BATCH 16
+
+#ifdef __linux__
+
+/**
+ * Parse one smaps_rollup file into an entry (all values in kB).
+ * Returns false only when permission was denied; kernel threads
+ * (ESRCH) and exited processes just leave the entry empty.
+ */
+static bool parse_smaps_rollup(int proc_fd, SmapsEntry *entry) {
+    static _Thread_local char buf[4096];
+    char path[32];
+
+    snprintf(path, sizeof(path), "%d/smaps_rollup", entry->pid);
+    int fd = openat(proc_fd, path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return errno != EACCES && errno != EPERM;
+    }
+    ssize_t n = read(fd, buf, sizeof(buf) - 1);
+    int saved_errno = errno;
+    close(fd);
+    if (n < 0) {
+        return saved_errno != EACCES && saved_errno != EPERM;
+    }
+    buf[n] = '\0';
+
+    static const struct { const char *key; size_t offset; } fields[] = {
+        { "Rss:",           offsetof(SmapsEntry, rss_kb) },
+        { "Pss:",           offsetof(SmapsEntry, pss_kb) },
+        { "Shared_Clean:",  offsetof(SmapsEntry, shared_clean_kb) },
+        { "Shared_Dirty:",  offsetof(SmapsEntry, shared_dirty_kb) },
+        { "Private_Clean:", offsetof(SmapsEntry, private_clean_kb) },
+        { "Private_Dirty:", offsetof(SmapsEntry, private_dirty_kb) },
+        { "AnonHugePages:", offsetof(SmapsEntry, anon_huge_kb) },
+        { "Swap:",          offsetof(SmapsEntry, swap_kb) },
+        { "SwapPss:",       offsetof(SmapsEntry, swap_pss_kb) },
+    };
+
+    // The first line is the "[rollup]" pseudo mapping header
+    for (char *line = strchr(buf, '\n'); line != NULL && line[1]; line = strchr(line, '\n')) {
+        line++;
+        for (size_t f = 0; f < sizeof(fields) / sizeof(fields[0]); f++) {
+            size_t len = strlen(fields[f].key);
+            if (strncmp(line, fields[f].key, len) == 0) {
+                *(unsigned long long *)((char *)entry + fields[f].offset) = strtoull(line + len, NULL, 10);
+                break;
+            }
+        }
+    }
+    return true;
+}
+
+typedef struct {
+    SmapsTable *table;
+    atomic_int *next;
+} SmapsJob;
+
+/**
+ * Workers claim small batches of pids, since a single process with
+ * thousands of mappings can take much longer than its neighbours
+ */
+static void *smaps_worker(void *arg) {
+    SmapsJob *job = arg;
+    SmapsTable *table = job->table;
+    int count = table->procs.count;
+
+    for (;;) {
+        int start = atomic_fetch_add(job->next, SMAPS_BATCH);
+        if (start >= count) {
+            break;
+        }
+        int end = start + SMAPS_BATCH < count ? start + SMAPS_BATCH : count;
+        for (int i = start; i < end; i++) {
+            SmapsEntry *entry = &table->entries[i];
+            entry->readable = parse_smaps_rollup(table->procs.proc_fd, entry);
+        }
+    }
+    return NULL;
+}
+
+#endif
+
+bool smaps_table_init(SmapsTable *table) {
+    memset(table, 0, sizeof(*table));
+#ifdef __linux__
+    return proc_table_init(&table->procs);
+#else
+    return false;
+#endif
+}
+
+void smaps_table_free(SmapsTable *table) {
+#ifdef __linux__
+    proc_table_free(&table->procs);
+#endif
+    free(table->entries);
+    memset(table, 0, sizeof(*table));
+}
+
+/**
+ * Rescan processes and read every smaps_rollup.
+ * Returns the number of processes, or -1 on error.
+ */
+int smaps_table_refresh(SmapsTable *table) {
+#ifndef __linux__
+    (void)table;
+    return -1;
+#else
+    long long started = monotonic_ms();
+    int count = proc_table_refresh(&table->procs);
+    if (count < 0) {
+        return -1;
+    }
+
+    if (count > table->capacity) {
+        int capacity = count + count / 2 + 64;
+        SmapsEntry *grown = realloc(table->entries, (size_t)capacity * sizeof(SmapsEntry));
+        if (grown == NULL) {
+            return -1;
+        }
+        table->entries = grown;
+        table->capacity = capacity;
+    }
+
+    for (int i = 0; i < count; i++) {
+        memset(&table->entries[i], 0, sizeof(SmapsEntry));
+        table->entries[i].pid = table->procs.entries[i].pid;
+    }
+
+    atomic_int next = 0;
+    SmapsJob job = { table, &next };
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int workers = count > SMAPS_PARALLEL_THRESHOLD ? (int)cpus : 1;
+    if (workers > SMAPS_MAX_THREADS) workers = SMAPS_MAX_THREADS;
+
+    pthread_t threads[SMAPS_MAX_THREADS];
+    bool started_thread[SMAPS_MAX_THREADS] = { false };
+    for (int w = 1; w < workers; w++) {
+        started_thread[w] = pthread_create(&threads[w], NULL, smaps_worker, &job) == 0;
+    }
+    smaps_worker(&job);
+    for (int w = 1; w < workers; w++) {
+        if (started_thread[w]) pthread_join(threads[w], NULL);
+    }
+
+    // Kernel threads have an empty rollup; keep totals to user processes
+    table->unreadable = 0;
+    table->total_pss_kb = 0;
+    table->total_rss_kb = 0;
+    table->total_swap_kb = 0;
+    for (int i = 0; i < count; i++) {
+        const SmapsEntry *entry = &table->entries[i];
+        if (!entry->readable) {
+            table->unreadable++;
+            continue;
+        }
+        table->total_pss_kb += entry->pss_kb;
+        table->total_rss_kb += entry->rss_kb;
+        table->total_swap_kb += entry->swap_kb;
+    }
+
+    table->scan_ms = monotonic_ms() - started;
+    return count;
+#endif
+}
+
+/**
+ * Select the top N entries by the given key, largest first.
+ * `out` receives indexes into table->entries.
+ */
+int smaps_table_top(const SmapsTable *table, SmapsSortKey key, TopNItem *out, int n) {
+    TopNHeap heap;
+
+    topn_init(&heap, out, n);
+    for (int i = 0; i < table->procs.count; i++) {
+        const SmapsEntry *e = &table->entries[i];
+        if (!e->readable || e->rss_kb + e->swap_kb == 0) {
+            continue;
+        }
+        unsigned long long value;
+        switch (key) {
+            case SMAPS_SORT_RSS:     value = e->rss_kb; break;
+            case SMAPS_SORT_PRIVATE: value = e->private_clean_kb + e->private_dirty_kb; break;
+            case SMAPS_SORT_SWAP:    value = e->swap_kb; break;
+            default:                 value = e->pss_kb; break;
+        }
+        topn_offer(&heap, (double)value, i);
+    }
+    return topn_finish(&heap);
+}
+
+#ifdef __linux__
+
+static const char *smaps_sort_name(SmapsSortKey key) {
+    switch (key) {
+        case SMAPS_SORT_RSS:     return "RSS";
+        case SMAPS_SORT_PRIVATE: return "private (USS)";
+        case SMAPS_SORT_SWAP:    return "swap";
+        default:                 return "PSS";
+    }
+}
+
+static void render_smaps_frame(LiveScreen *screen, const SmapsTable *table, SmapsSortKey key,
+                               TopNItem *top, int interval_ms) {
+    char pss[16], rss[16], swap[16];
+    char v[7][16];
+    int row = 0;
+
+    live_screen_begin(screen);
+    format_kb(table->total_pss_kb, pss, sizeof(pss));
+    format_kb(table->total_rss_kb, rss, sizeof(rss));
+    format_kb(table->total_swap_kb, swap, sizeof(swap));
+    live_screen_print(screen, row, 0, CELL_BOLD, "DevHelper Process Memory");
+    live_screen_print(screen, row++, 26, CELL_CYAN, "PSS %s  RSS %s  swap %s  scan %lld/%d ms",
+                      pss, rss, swap, table->scan_ms, interval_ms);
+    live_screen_print(screen, row++, 0, CELL_DEFAULT,
+                      "Sorted by %s  [p] PSS [r] RSS [u] USS [s] swap  any other key exits",
+                      smaps_sort_name(key));
+    if (table->unreadable > 0) {
+        live_screen_print(screen, row, 0, CELL_YELLOW,
+                          "%d processes not readable (other users' processes need root)",
+                          table->unreadable);
+    }
+    row++;
+
+    live_screen_print(screen, row++, 0, CELL_BOLD, "%7s %7s %7s %7s %7s %7s %7s %7s  %s",
+                      "PID", "PSS", "RSS", "ShClean", "ShDirty", "PrClean", "PrDirty", "Swap",
+                      "COMMAND");
+
+    int n = screen->rows - row;
+    if (n > PROC_TOP_MAX) n = PROC_TOP_MAX;
+    if (n < 1) return;
+
+    int count = smaps_table_top(table, key, top, n);
+    for (int i = 0; i < count; i++) {
+        const SmapsEntry *e = &table->entries[top[i].index];
+        const unsigned long long values[7] = {
+            e->pss_kb, e->rss_kb, e->shared_clean_kb, e->shared_dirty_kb,
+            e->private_clean_kb, e->private_dirty_kb, e->swap_kb
+        };
+        for (int k = 0; k < 7; k++) {
+            format_kb(values[k], v[k], sizeof(v[k]));
+        }
+
+        int col = live_screen_print(screen, row, 0, e->swap_kb > 0 ? CELL_YELLOW : CELL_DEFAULT,
+                                    "%7d %7s %7s %7s %7s %7s %7s %7s  %s",
+                                    e->pid, v[0], v[1], v[2], v[3], v[4], v[5], v[6],
+                                    table->procs.entries[top[i].index].comm);
+        if (e->anon_huge_kb > 0) {
+            char huge[16];
+            format_kb(e->anon_huge_kb, huge, sizeof(huge));
+            live_screen_print(screen, row, col, CELL_MAGENTA, " (THP %s)", huge);
+        }
+        row++;
+    }
+}
+
+#endif
+
+/**
+ * Live per-process memory view sorted by PSS
+ */
+void sysmon_smaps_view(int interval_ms) {
+#ifndef __linux__
+    (void)interval_ms;
+    print_warning("The process memory view reads /proc and is only available on Linux.");
+#else
+    static TopNItem top[PROC_TOP_MAX];
+    SmapsTable table;
+    LiveScreen screen;
+    SmapsSortKey key = SMAPS_SORT_PSS;
+
+    if (interval_ms < 500) interval_ms = 500;
+    if (interval_ms > 10000) interval_ms = 10000;
+
+    if (!smaps_table_init(&table)) {
+        print_error("Could not open /proc!");
+        return;
+    }
+    if (!live_screen_init(&screen)) {
+        print_error("Not enough memory for the process memory view!");
+        smaps_table_free(&table);
+        return;
+    }
+
+    terminal_set_raw(true);
+    smaps_table_refresh(&table);
+    render_smaps_frame(&screen, &table, key, top, interval_ms);
+    live_screen_flush(&screen);
+
+    long long next_tick = monotonic_ms() + interval_ms;
+    for (;;) {
+        int k = wait_for_key((int)(next_tick - monotonic_ms()));
+        if (k == 'p' || k == 'P') {
+            key = SMAPS_SORT_PSS;
+        } else if (k == 'r' || k == 'R') {
+            key = SMAPS_SORT_RSS;
+        } else if (k == 'u' || k == 'U') {
+            key = SMAPS_SORT_PRIVATE;
+        } else if (k == 's' || k == 'S') {
+            key = SMAPS_SORT_SWAP;
+        } else if (k >= 0) {
+            break;
+        }
+
+        if (k < 0) {
+            if (smaps_table_refresh(&table) < 0) {
+                break;
+            }
+            next_tick += interval_ms;
+            if (next_tick <= monotonic_ms()) {
+                next_tick = monotonic_ms() + interval_ms;
+            }
+        }
+        render_smaps_frame(&screen, &table, key, top, interval_ms);
+        live_screen_flush(&screen);
+    }
+
+    terminal_set_raw(false);
+    printf("%s\033[H\033[2J", COLOR_RESET);
+    fflush(stdout);
+    live_screen_free(&screen);
+    smaps_table_free(&table);
+#endif
+}
@@ -0,0 +1,532 @@
+/**
+ * DevHelper+Portal CLI - Sampling Session Statistics
+ *
+ * Records how the machine behaved over a sampling session and reports
+ * p50/p90/p99/max per metric. Each metric is kept in a log-linear
+ * histogram (HDR style): values below 128 get their own bucket and every
+ * power of two above is split into 64 buckets, so any reported quantile
+ * is within ~1.6% of the true value. Adding a sample is one bucket
+ * increment, memory is fixed by the metric's range, and two sketches
+ * merge exactly by adding bucket counts.
+ */
+
+#define _GNU_SOURCE
+#include "devhelper.h"
+#include <math.h>
+#include <signal.h>
+#include <stdint.h>
+
+#define SKETCH_MAGIC "DHSKETCH"
+#define SKETCH_VERSION 1
+#define SKETCH_SUB_BUCKETS 128
+#define SKETCH_HALF (SKETCH_SUB_BUCKETS / 2)
+
+/* ------------------------------------------------------------------ */
+/* Sketch                                                              */
+/* ------------------------------------------------------------------ */
+
+/**
+ * Bucket holding an already-scaled integer value
+ */
+static int bucket_index(uint64_t v) {
+    if (v < SKETCH_SUB_BUCKETS) {
+        return (int)v;
+    }
+    int msb = 63 - __builtin_clzll(v);
+    int shift = msb - 6;
+    return (shift + 1) * SKETCH_HALF + (int)(v >> shift) - SKETCH_HALF;
+}
+
+/**
+ * Smallest scaled value that lands in a bucket, and the bucket width
+ */
+static void bucket_range(int index, uint64_t *low, uint64_t *width) {
+    if (index < SKETCH_SUB_BUCKETS) {
+        *low = (uint64_t)index;
+        *width = 1;
+        return;
+    }
+    int shift = index / SKETCH_HALF - 1;
+    uint64_t sub = (uint64_t)(index - (shift + 1) * SKETCH_HALF + SKETCH_HALF);
+    *low = sub << shift;
+    *width = (uint64_t)1 << shift;
+}
+
+/**
+ * Set up a sketch for values in [0, max_value] stored with `scale`
+ * units per unit (e.g. scale 100 keeps two decimals of a percentage)
+ */
+bool sketch_init(QuantileSketch *sketch, const char *name, double scale, double max_value) {
+    memset(sketch, 0, sizeof(*sketch));
+    snprintf(sketch->name, sizeof(sketch->name), "%s", name);
+    sketch->scale = scale;
+    sketch->bucket_count = bucket_index((uint64_t)(max_value * scale)) + 1;
+    sketch->counts = calloc((size_t)sketch->bucket_count, sizeof(unsigned int));
+    return sketch->counts != NULL;
+}
+
+void sketch_free(QuantileSketch *sketch) {
+    free(sketch->counts);
+    sketch->counts = NULL;
+    sketch->bucket_count = 0;
+}
+
+/**
+ * Record one value. O(1), no allocation; values above the configured
+ * range are counted in the top bucket but still tracked as the max.
+ */
+void sketch_add(QuantileSketch *sketch, double value) {
+    if (value < 0.0 || isnan(value)) {
+        value = 0.0;
+    }
+
+    int index = bucket_index((uint64_t)(value * sketch->scale + 0.5));
+    if (index >= sketch->bucket_count) {
+        index = sketch->bucket_count - 1;
+    }
+    sketch->counts[index]++;
+
+    if (sketch->total == 0 || value < sketch->min) sketch->min = value;
+    if (sketch->total == 0 || value > sketch->max) sketch->max = value;
+    sketch->sum += value;
+    sketch->total++;
+}
+
+/**
+ * Value at quantile q (0..1), taken as the middle of its bucket and
+ * clamped to the observed min/max
+ */
+double sketch_quantile(const QuantileSketch *sketch, double q) {
+    if (sketch->total == 0) {
+        return 0.0;
+    }
+
+    uint64_t rank = (uint64_t)ceil(q * (double)sketch->total);
+    if (rank < 1) rank = 1;
+
+    uint64_t seen = 0;
+    for (int i = 0; i < sketch->bucket_count; i++) {
+        seen += sketch->counts[i];
+        if (seen >= rank) {
+            uint64_t low, width;
+            bucket_range(i, &low, &width);
+            double value = ((double)low + (double)(width - 1) / 2.0) / sketch->scale;
+            if (value < sketch->min) value = sketch->min;
+            if (value > sketch->max) value = sketch->max;
+            return value;
+        }
+    }
+    return sketch->max;
+}
+
+/**
+ * Add src's counts into dst. Exact: both share the same bucket layout;
+ * dst grows if src covers a wider range.
+ */
+bool sketch_merge(QuantileSketch *dst, const QuantileSketch *src) {
+    if (dst->scale != src->scale) {
+        return false;
+    }
+
+    if (src->bucket_count > dst->bucket_count) {
+        unsigned int *counts = realloc(dst->counts, (size_t)src->bucket_count * sizeof(unsigned int));
+        if (counts == NULL) {
+            return false;
+        }
+        memset(counts + dst->bucket_count, 0,
+               (size_t)(src->bucket_count - dst->bucket_count) * sizeof(unsigned int));
+        dst->counts = counts;
+        dst->bucket_count = src->bucket_count;
+    }
+
+    for (int i = 0; i < src->bucket_count; i++) {
+        dst->counts[i] += src->counts[i];
+    }
+    if (src->total > 0) {
+        if (dst->total == 0 || src->min < dst->min) dst->min = src->min;
+        if (dst->total == 0 || src->max > dst->max) dst->max = src->max;
+    }
+    dst->sum += src->sum;
+    dst->total += src->total;
+    return true;
+}
+
+/* ------------------------------------------------------------------ */
+/* Sketch sets (one per session)                                       */
+/* ------------------------------------------------------------------ */
+
+void sketch_set_free(SketchSet *set) {
+    for (int i = 0; i < set->count; i++) {
+        sketch_free(&set->sketches[i]);
+    }
+    free(set->sketches);
+    memset(set, 0, sizeof(*set));
+}
+
+/**
+ * Find a sketch by name, optionally creating it
+ */
+QuantileSketch *sketch_set_get(SketchSet *set, const char *name, double scale,
+                               double max_value, bool create) {
+    for (int i = 0; i < set->count; i++) {
+        if (strcmp(set->sketches[i].name, name) == 0) {
+            return &set->sketches[i];
+        }
+    }
+    if (!create) {
+        return NULL;
+    }
+
+    if (set->count == set->capacity) {
+        int capacity = set->capacity > 0 ? set->capacity * 2 : 16;
+        QuantileSketch *grown = realloc(set->sketches, (size_t)capacity * sizeof(QuantileSketch));
+        if (grown == NULL) {
+            return NULL;
+        }
+        set->sketches = grown;
+        set->capacity = capacity;
+    }
+
+    QuantileSketch *sketch = &set->sketches[set->count];
+    if (!sketch_init(sketch, name, scale, max_value)) {
+        return NULL;
+    }
+    set->count++;
+    return sketch;
+}
+
+/**
+ * Write a sketch set so later sessions can be merged with it
+ */
+bool sketch_set_save(const SketchSet *set, const char *path) {
+    FILE *fp = fopen(path, "wb");
+    if (fp == NULL) {
+        return false;
+    }
+
+    unsigned int version = SKETCH_VERSION;
+    unsigned int count = (unsigned int)set->count;
+    bool ok = fwrite(SKETCH_MAGIC, 1, 8, fp) == 8 &&
+              fwrite(&version, sizeof(version), 1, fp) == 1 &&
+              fwrite(&count, sizeof(count), 1, fp) == 1;
+
+    for (int i = 0; ok && i < set->count; i++) {
+        const QuantileSketch *s = &set->sketches[i];
+        unsigned int buckets = (unsigned int)s->bucket_count;
+        ok = fwrite(s->name, sizeof(s->name), 1, fp) == 1 &&
+             fwrite(&s->scale, sizeof(s->scale), 1, fp) == 1 &&
+             fwrite(&s->total, sizeof(s->total), 1, fp) == 1 &&
+             fwrite(&s->min, sizeof(s->min), 1, fp) == 1 &&
+             fwrite(&s->max, sizeof(s->max), 1, fp) == 1 &&
+             fwrite(&s->sum, sizeof(s->sum), 1, fp) == 1 &&
+             fwrite(&buckets, sizeof(buckets), 1, fp) == 1 &&
+             fwrite(s->counts, sizeof(unsigned int), buckets, fp) == buckets;
+    }
+
+    return fclose(fp) == 0 && ok;
+}
+
+/**
+ * Merge every sketch stored in `path` into `set`
+ */
+bool sketch_set_merge_file(SketchSet *set, const char *path) {
+    FILE *fp = fopen(path, "rb");
+    char magic[8];
+    unsigned int version, count;
+
+    if (fp == NULL) {
+        return false;
+    }
+    if (fread(magic, 1, 8, fp) != 8 || memcmp(magic, SKETCH_MAGIC, 8) != 0 ||
+        fread(&version, sizeof(version), 1, fp) != 1 || version != SKETCH_VERSION ||
+        fread(&count, sizeof(count), 1, fp) != 1) {
+        fclose(fp);
+        return false;
+    }
+
+    bool ok = true;
+    for (unsigned int i = 0; ok && i < count; i++) {
+        QuantileSketch s;
+        unsigned int buckets;
+
+        memset(&s, 0, sizeof(s));
+        ok = fread(s.name, sizeof(s.name), 1, fp) == 1 &&
+             fread(&s.scale, sizeof(s.scale), 1, fp) == 1 &&
+             fread(&s.total, sizeof(s.total), 1, fp) == 1 &&
+             fread(&s.min, sizeof(s.min), 1, fp) == 1 &&
+             fread(&s.max, sizeof(s.max), 1, fp) == 1 &&
+             fread(&s.sum, sizeof(s.sum), 1, fp) == 1 &&
+             fread(&buckets, sizeof(buckets), 1, fp) == 1 &&
+             buckets > 0 && buckets < 1000000;
+        if (!ok) break;
+
+        s.name[sizeof(s.name) - 1] = '\0';
+        s.bucket_count = (int)buckets;
+        s.counts = malloc(buckets * sizeof(unsigned int));
+        ok = s.counts != NULL && fread(s.counts, sizeof(unsigned int), buckets, fp) == buckets;
+
+        if (ok) {
+            QuantileSketch *dst = sketch_set_get(set, s.name, s.scale, 0.0, true);
+            ok = dst != NULL && sketch_merge(dst, &s);
+        }
+        free(s.counts);
+    }
+
+    fclose(fp);
+    return ok;
+}
+
+/**
+ * Print p50/p90/p99/max for every sketch in the set
+ */
+void sketch_set_report(const SketchSet *set) {
+    printf("%s%-22s %9s %10s %10s %10s %10s %10s%s\n", COLOR_BOLD,
+           "Metric", "samples", "mean", "p50", "p90", "p99", "max", COLOR_RESET);
+    print_separator();
+
+    for (int i = 0; i < set->count; i++) {
+        const QuantileSketch *s = &set->sketches[i];
+        if (s->total == 0) {
+            continue;
+        }
+        double p99 = sketch_quantile(s, 0.99);
+        const char *color = strstr(s->name, "%") != NULL && p99 >= 90.0 ? COLOR_RED : "";
+        printf("%s%-22s %9llu %10.2f %10.2f %10.2f %10.2f %10.2f%s\n", color, s->name,
+               (unsigned long long)s->total, s->sum / (double)s->total,
+               sketch_quantile(s, 0.50), sketch_quantile(s, 0.90), p99, s->max,
+               COLOR_RESET);
+    }
+}
+
+/* ------------------------------------------------------------------ */
+/* Session                                                             */
+/* ------------------------------------------------------------------ */
+
+#ifdef __linux__
+static volatile sig_atomic_t session_interrupted = 0;
+
+static void session_signal_handler(int sig) {
+    (void)sig;
+    session_interrupted = 1;
+}
+
+/**
+ * Feed the deltas between two samples into the session's sketches
+ */
+static void session_add(QuantileSketch **fixed, QuantileSketch **cores,
+                        const LiveSample *prev, const LiveSample *cur) {
+    double seconds = (double)(cur->time_ms - prev->time_ms) / 1000.0;
+    if (seconds <= 0.0) {
+        return;
+    }
+
+    unsigned long long total = cpu_times_total(&cur->cpu.total) - cpu_times_total(&prev->cpu.total);
+    const MemorySnapshot *mem = &cur->mem;
+
+    sketch_add(fixed[0], sysmon_cpu_busy_percent(&prev->cpu.total, &cur->cpu.total));
+    sketch_add(fixed[1], total > 0 ? 100.0 * (double)(cur->cpu.total.iowait - prev->cpu.total.iowait) /
+                                     (double)total : 0.0);
+    sketch_add(fixed[2], mem->total_kb > 0 ? 100.0 * (double)(mem->total_kb - mem->available_kb) /
+                                             (double)mem->total_kb : 0.0);
+    sketch_add(fixed[3], (double)(mem->total_kb - mem->available_kb) / 1024.0);
+    sketch_add(fixed[4], mem->swap_total_kb > 0
+                         ? 100.0 * (double)(mem->swap_total_kb - mem->swap_free_kb) /
+                           (double)mem->swap_total_kb : 0.0);
+    sketch_add(fixed[5], cur->load.load1);
+    sketch_add(fixed[6], (double)(cur->io.read_sectors - prev->io.read_sectors) * 512.0 / 1e6 / seconds);
+    sketch_add(fixed[7], (double)(cur->io.write_sectors - prev->io.write_sectors) * 512.0 / 1e6 / seconds);
+    sketch_add(fixed[8], (double)(cur->io.reads - prev->io.reads + cur->io.writes - prev->io.writes) /
+                         seconds);
+    sketch_add(fixed[9], (double)(cur->io.io_ms - prev->io.io_ms) / (seconds * 10.0));
+    sketch_add(fixed[10], (double)(cur->io.rx_bytes - prev->io.rx_bytes) / 1e6 / seconds);
+    sketch_add(fixed[11], (double)(cur->io.tx_bytes - prev->io.tx_bytes) / 1e6 / seconds);
+
+    for (int i = 0; i < cur->cpu.cpu_count; i++) {
+        if (cores[i] != NULL) {
+            sketch_add(cores[i], sysmon_cpu_busy_percent(&prev->cpu.cpu[i], &cur->cpu.cpu[i]));
+        }
+    }
+}
+#endif
+
+/**
+ * Sample until a key is pressed (SIGINT/SIGTERM without a terminal) or
+ * duration_s elapses, then report percentiles. With save_path the
+ * sketches are written out so later sessions can be merged with
+ * "sysmon merge".
+ */
+void sysmon_session(int interval_ms, int duration_s, const char *save_path) {
+#ifndef __linux__
+    (void)interval_ms;
+    (void)duration_s;
+    (void)save_path;
+    print_warning("Sampling sessions read /proc and are only available on Linux.");
+#else
+    // name, scale (units per unit), max value
+    static const struct { const char *name; double scale; double max; } metrics[] = {
+        { "cpu busy %",        100.0, 100.0 },
+        { "cpu iowait %",      100.0, 100.0 },
+        { "memory used %",     100.0, 100.0 },
+        { "memory used MB",      1.0, 1e9 },
+        { "swap used %",       100.0, 100.0 },
+        { "load 1m",           100.0, 1e5 },
+        { "disk read MB/s",    100.0, 1e6 },
+        { "disk write MB/s",   100.0, 1e6 },
+        { "disk IOPS",           1.0, 1e9 },
+        { "disk busy %",       100.0, 1e5 },
+        { "net rx MB/s",       100.0, 1e6 },
+        { "net tx MB/s",       100.0, 1e6 },
+    };
+    enum { FIXED_METRICS = sizeof(metrics) / sizeof(metrics[0]) };
+    QuantileSketch *fixed[FIXED_METRICS];
+    QuantileSketch *cores[SYSMON_MAX_CPUS] = { NULL };
+    SketchSet set;
+    LiveSample *samples = malloc(2 * sizeof(LiveSample));
+
+    if (interval_ms < 100) interval_ms = 100;
+    if (interval_ms > 60000) interval_ms = 60000;
+
+    memset(&set, 0, sizeof(set));
+    if (samples == NULL || !sysmon_read_sample(&samples[0])) {
+        free(samples);
+        print_error("Could not read /proc!");
+        return;
+    }
+    LiveSample *prev = &samples[0];
+    LiveSample *cur = &samples[1];
+
+    // All sketches are allocated up front; sampling itself never allocates
+    bool ok = true;
+    for (int i = 0; i < FIXED_METRICS && ok; i++) {
+        ok = sketch_set_get(&set, metrics[i].name, metrics[i].scale, metrics[i].max, true) != NULL;
+    }
+    for (int i = 0; i < prev->cpu.cpu_count && ok; i++) {
+        char name[32];
+        snprintf(name, sizeof(name), "cpu%d busy %%", i);
+        ok = sketch_set_get(&set, name, 100.0, 100.0, true) != NULL;
+    }
+    if (!ok) {
+        print_error("Not enough memory for the session statistics!");
+        sketch_set_free(&set);
+        free(samples);
+        return;
+    }
+
+    // The set has stopped growing, so pointers into it are stable now
+    for (int i = 0; i < FIXED_METRICS; i++) {
+        fixed[i] = &set.sketches[i];
+    }
+    for (int i = 0; i < prev->cpu.cpu_count; i++) {
+        cores[i] = &set.sketches[FIXED_METRICS + i];
+    }
+
+    struct sigaction sa, old_int, old_term;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = session_signal_handler;
+    sigaction(SIGINT, &sa, &old_int);
+    sigaction(SIGTERM, &sa, &old_term);
+    session_interrupted = 0;
+
+    // Unattended runs (no terminal) sleep between ticks and skip the progress line
+    bool interactive = isatty(STDIN_FILENO) && isatty(STDOUT_FILENO);
+    if (interactive) {
+        printf("%sSampling every %d ms - press any key to stop and report%s\n",
+               COLOR_CYAN, interval_ms, COLOR_RESET);
+        terminal_set_raw(true);
+    } else {
+        printf("Sampling every %d ms - send SIGINT or SIGTERM to stop and report\n", interval_ms);
+        fflush(stdout);
+    }
+
+    long long start = prev->time_ms;
+    long long next_tick = start + interval_ms;
+    while (!session_interrupted) {
+        int wait = (int)(next_tick - monotonic_ms());
+        if (interactive) {
+            if (wait_for_key(wait) >= 0) {
+                break;
+            }
+        } else if (wait > 0) {
+            usleep((useconds_t)wait * 1000);
+        }
+        long long now = monotonic_ms();
+        if (session_interrupted || now < next_tick) {
+            continue;
+        }
+        next_tick += interval_ms;
+        if (next_tick <= now) {
+            next_tick = now + interval_ms;
+        }
+
+        if (!sysmon_read_sample(cur)) {
+            continue;
+        }
+        session_add(fixed, cores, prev, cur);
+
+        if (interactive) {
+            printf("\r  %llds elapsed, %llu samples, cpu now %.1f%%   ",
+                   (now - start) / 1000, (unsigned long long)fixed[0]->total,
+                   sysmon_cpu_busy_percent(&prev->cpu.total, &cur->cpu.total));
+            fflush(stdout);
+        }
+
+        LiveSample *swap = prev;
+        prev = cur;
+        cur = swap;
+
+        if (duration_s > 0 && now - start >= (long long)duration_s * 1000) {
+            break;
+        }
+    }
+
+    if (interactive) {
+        terminal_set_raw(false);
+    }
+    sigaction(SIGINT, &old_int, NULL);
+    sigaction(SIGTERM, &old_term, NULL);
+    printf("\n\n");
+
+    sketch_set_report(&set);
+
+    if (save_path != NULL && save_path[0] != '\0') {
+        printf("\n");
+        if (sketch_set_save(&set, save_path)) {
+            print_success("Session sketches saved; merge them with 'devhelper sysmon merge'.");
+        } else {
+            print_error("Could not save the session sketches!");
+        }
+    }
+
+    sketch_set_free(&set);
+    free(samples);
+#endif
+}
+
+/**
+ * Merge saved session sketches and report the combined percentiles.
+ * With out_path the merged set is saved as well.
+ */
+int sysmon_merge_sessions(int count, char *paths[], const char *out_path) {
+    SketchSet set;
+    memset(&set, 0, sizeof(set));
+
+    for (int i = 0; i < count; i++) {
+        if (!sketch_set_merge_file(&set, paths[i])) {
+            char msg[MAX_PATH_LENGTH + 64];
+            snprintf(msg, sizeof(msg), "Could not merge %s", paths[i]);
+            print_error(msg);
+            sketch_set_free(&set);
+            return 1;
+        }
+    }
+
+    sketch_set_report(&set);
+    if (out_path != NULL && !sketch_set_save(&set, out_path)) {
+        print_error("Could not save the merged sketches!");
+        sketch_set_free(&set);
+        return 1;
+    }
+
+    sketch_set_free(&set);
+    return 0;
+}
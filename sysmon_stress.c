@@ -0,0 +1,679 @@
+/**
+ * DevHelper+Portal CLI - Synthetic Load Generator
+ *
+ * Applies a known load so the monitor's readings can be checked against
+ * it: CPU burners pinned one per core at a duty cycle, a memory toucher
+ * writing a fixed footprint at a set bandwidth, and a disk writer at a
+ * set MB/s. Every generator paces itself against absolute deadlines
+ * (busy-spin, then clock_nanosleep to the end of each 100 ms period or
+ * 10 ms slice), so rates don't drift with scheduling noise. A ramp
+ * schedule scales all targets over time. The screen shows the target,
+ * what each generator achieved, and what /proc reports side by side;
+ * without a terminal the same figures are logged once a second.
+ */
+
+#define _GNU_SOURCE
+#include "devhelper.h"
+
+#ifdef __linux__
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <time.h>
+#endif
+
+/**
+ * Parse "key=value" arguments:
+ *   cpu=N[@percent]  mem=MB[@MB/s]  disk=MB/s[@dir]  time=s
+ *   ramp=t:percent,t:percent,...  (seconds from start; steps)
+ * Returns false and prints why on a bad argument.
+ */
+bool stress_parse(StressConfig *config, int argc, char *argv[]) {
+    memset(config, 0, sizeof(*config));
+    config->cpu_percent = 100;
+    strcpy(config->disk_dir, "/tmp");
+
+    for (int i = 0; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *value = strchr(arg, '=');
+        if (value == NULL) {
+            print_error("Stress arguments look like cpu=2@50 mem=256@500 disk=20@/tmp time=60");
+            return false;
+        }
+        value++;
+        const char *at = strchr(value, '@');
+
+        if (strncmp(arg, "cpu=", 4) == 0) {
+            config->cpu_workers = atoi(value);
+            if (at != NULL) config->cpu_percent = atoi(at + 1);
+        } else if (strncmp(arg, "mem=", 4) == 0) {
+            config->mem_mb = atoi(value);
+            if (at != NULL) config->mem_mb_per_sec = atoi(at + 1);
+        } else if (strncmp(arg, "disk=", 5) == 0) {
+            config->disk_mb_per_sec = atoi(value);
+            if (at != NULL) snprintf(config->disk_dir, sizeof(config->disk_dir), "%s", at + 1);
+        } else if (strncmp(arg, "time=", 5) == 0) {
+            config->duration_s = atoi(value);
+        } else if (strncmp(arg, "ramp=", 5) == 0) {
+            const char *p = value;
+            config->ramp_count = 0;
+            while (*p != '\0' && config->ramp_count < STRESS_MAX_RAMP) {
+                int at_s, percent, used;
+                if (sscanf(p, "%d:%d%n", &at_s, &percent, &used) != 2 || at_s < 0 || percent < 0) {
+                    print_error("Ramp steps look like ramp=0:25,30:50,60:100");
+                    return false;
+                }
+                config->ramp_at_s[config->ramp_count] = at_s;
+                config->ramp_percent[config->ramp_count] = percent;
+                config->ramp_count++;
+                p += used;
+                if (*p == ',') p++;
+            }
+        } else {
+            print_error("Unknown stress argument!");
+            return false;
+        }
+    }
+
+    if (config->cpu_percent < 0) config->cpu_percent = 0;
+    if (config->cpu_percent > 100) config->cpu_percent = 100;
+    if (config->cpu_workers < 0 || config->mem_mb < 0 || config->mem_mb_per_sec < 0 ||
+        config->disk_mb_per_sec < 0) {
+        print_error("Stress targets can't be negative!");
+        return false;
+    }
+    if (config->cpu_workers == 0 && config->mem_mb == 0 && config->disk_mb_per_sec == 0) {
+        print_error("Nothing to do: give at least one of cpu=, mem= or disk=");
+        return false;
+    }
+    return true;
+}
+
+#ifdef __linux__
+
+#define STRESS_CPU_PERIOD_NS 100000000LL    // Duty cycle period
+#define STRESS_SLICE_NS 10000000LL          // Memory/disk pacing slice
+#define STRESS_DISK_CHUNK (1024 * 1024)
+#define STRESS_DISK_FILE_MB 256             // The writer wraps inside this size
+
+typedef struct {
+    atomic_int level_permille;  // Ramp level applied to every target
+    atomic_bool stop;
+} StressControl;
+
+typedef struct {
+    StressControl *control;
+    int cpu;                    // Pinned core, -1 for none
+    int percent;
+    atomic_int pin_error;       // errno from pthread_setaffinity_np, 0 if pinned
+    atomic_ullong busy_ns;
+    pthread_t thread;
+    bool started;
+} CpuBurner;
+
+typedef struct {
+    StressControl *control;
+    unsigned char *region;
+    size_t bytes;
+    double bytes_per_sec;
+    atomic_ullong written;
+    pthread_t thread;
+    bool started;
+} MemoryToucher;
+
+typedef struct {
+    StressControl *control;
+    int fd;
+    bool direct;
+    double bytes_per_sec;
+    atomic_ullong written;
+    atomic_int error;
+    pthread_t thread;
+    bool started;
+} DiskWriter;
+
+static volatile sig_atomic_t stress_interrupted = 0;
+
+static void stress_signal_handler(int sig) {
+    (void)sig;
+    stress_interrupted = 1;
+}
+
+static long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void sleep_until_ns(long long deadline) {
+    struct timespec ts = { (time_t)(deadline / 1000000000LL), (long)(deadline % 1000000000LL) };
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+    }
+}
+
+static double stress_level(const StressControl *control) {
+    return (double)atomic_load_explicit(&control->level_permille, memory_order_relaxed) / 1000.0;
+}
+
+/**
+ * Spin for percent of each period, sleep for the rest
+ */
+static void *cpu_burner_thread(void *arg) {
+    CpuBurner *burner = arg;
+    volatile unsigned long long sink = 0;
+
+    if (burner->cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(burner->cpu, &set);
+        atomic_store(&burner->pin_error, pthread_setaffinity_np(pthread_self(), sizeof(set), &set));
+    }
+
+    long long period_start = now_ns();
+    while (!atomic_load_explicit(&burner->control->stop, memory_order_relaxed)) {
+        double duty = burner->percent / 100.0 * stress_level(burner->control);
+        if (duty > 1.0) duty = 1.0;
+        long long busy_end = period_start + (long long)(duty * STRESS_CPU_PERIOD_NS);
+        long long t = period_start;
+
+        while (t < busy_end) {
+            for (int i = 0; i < 2000; i++) sink += (unsigned long long)i * 2654435761u;
+            t = now_ns();
+        }
+        if (busy_end > period_start) {
+            atomic_fetch_add_explicit(&burner->busy_ns, (unsigned long long)(t - period_start),
+                                      memory_order_relaxed);
+        }
+
+        period_start += STRESS_CPU_PERIOD_NS;
+        long long now = now_ns();
+        if (period_start <= now) {
+            period_start = now;     // Fell behind (preempted); don't try to catch up
+        } else {
+            sleep_until_ns(period_start);
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Write through the footprint sequentially at bytes_per_sec, one slice's
+ * worth per 10 ms; 0 means as fast as possible
+ */
+static void *memory_toucher_thread(void *arg) {
+    MemoryToucher *toucher = arg;
+    size_t pos = 0;
+    unsigned char fill = 1;
+    double carry = 0.0;
+    long long slice_start = now_ns();
+
+    while (!atomic_load_explicit(&toucher->control->stop, memory_order_relaxed)) {
+        double level = stress_level(toucher->control);
+        double budget = toucher->bytes_per_sec > 0.0
+                      ? toucher->bytes_per_sec * level * STRESS_SLICE_NS / 1e9 + carry
+                      : (double)toucher->bytes;
+        size_t todo = budget > 0.0 ? (size_t)budget : 0;
+        carry = budget - (double)todo;
+
+        size_t done = 0;
+        while (done < todo) {
+            size_t chunk = toucher->bytes - pos;
+            if (chunk > todo - done) chunk = todo - done;
+            if (chunk > 1024 * 1024) chunk = 1024 * 1024;
+            memset(toucher->region + pos, fill, chunk);
+            pos += chunk;
+            done += chunk;
+            if (pos == toucher->bytes) {
+                pos = 0;
+                fill++;
+            }
+        }
+        atomic_fetch_add_explicit(&toucher->written, done, memory_order_relaxed);
+
+        slice_start += STRESS_SLICE_NS;
+        long long now = now_ns();
+        if (slice_start <= now) {
+            slice_start = now;
+        } else {
+            sleep_until_ns(slice_start);
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Write 1 MB chunks at bytes_per_sec. O_DIRECT when the filesystem
+ * allows it so the disk sees the rate, not the page cache.
+ */
+static void *disk_writer_thread(void *arg) {
+    DiskWriter *writer = arg;
+    void *chunk = NULL;
+    off_t offset = 0;
+    double credit = 0.0;
+    long long slice_start = now_ns();
+
+    if (posix_memalign(&chunk, 4096, STRESS_DISK_CHUNK) != 0) {
+        atomic_store(&writer->error, ENOMEM);
+        return NULL;
+    }
+    memset(chunk, 0xA5, STRESS_DISK_CHUNK);
+
+    while (!atomic_load_explicit(&writer->control->stop, memory_order_relaxed)) {
+        credit += writer->bytes_per_sec * stress_level(writer->control) * STRESS_SLICE_NS / 1e9;
+        if (credit > 4.0 * STRESS_DISK_CHUNK) {
+            credit = 4.0 * STRESS_DISK_CHUNK;   // Don't burst after a stall
+        }
+
+        while (credit >= STRESS_DISK_CHUNK) {
+            ssize_t n = pwrite(writer->fd, chunk, STRESS_DISK_CHUNK, offset);
+            if (n < 0) {
+                atomic_store(&writer->error, errno);
+                free(chunk);
+                return NULL;
+            }
+            if (!writer->direct) {
+                // Push it out now so the device rate matches ours
+                sync_file_range(writer->fd, offset, n, SYNC_FILE_RANGE_WRITE);
+            }
+            atomic_fetch_add_explicit(&writer->written, (unsigned long long)n, memory_order_relaxed);
+            credit -= (double)n;
+            offset += n;
+            if (offset >= (off_t)STRESS_DISK_FILE_MB * 1024 * 1024) {
+                offset = 0;
+            }
+        }
+
+        slice_start += STRESS_SLICE_NS;
+        long long now = now_ns();
+        if (slice_start <= now) {
+            slice_start = now;
+        } else {
+            sleep_until_ns(slice_start);
+        }
+    }
+    free(chunk);
+    return NULL;
+}
+
+/**
+ * Ramp level in percent at `elapsed_s`: the last step that has started
+ */
+static int ramp_percent(const StressConfig *config, double elapsed_s) {
+    int percent = config->ramp_count > 0 && config->ramp_at_s[0] > 0 ? 0 : 100;
+    for (int i = 0; i < config->ramp_count; i++) {
+        if (elapsed_s >= config->ramp_at_s[i]) {
+            percent = config->ramp_percent[i];
+        }
+    }
+    return percent;
+}
+
+typedef struct {
+    unsigned long long cpu_busy_ns;
+    unsigned long long mem_written;
+    unsigned long long mem_resident;
+    unsigned long long disk_written;
+    long long time_ns;
+} StressTotals;
+
+static void render_stress_frame(LiveScreen *screen, const StressConfig *config, int level,
+                                double elapsed_s, const StressTotals *prev, const StressTotals *cur,
+                                const LiveSample *sys_prev, const LiveSample *sys_cur,
+                                const DiskWriter *disk, bool disk_direct, int pin_failed, int pin_error) {
+    double seconds = (double)(cur->time_ns - prev->time_ns) / 1e9;
+    int row = 0;
+    int cpus = sys_cur->cpu.cpu_count > 0 ? sys_cur->cpu.cpu_count : 1;
+
+    if (seconds <= 0.0) seconds = 1.0;
+    live_screen_begin(screen);
+    live_screen_print(screen, row, 0, CELL_BOLD, "DevHelper Stress");
+    if (config->duration_s > 0) {
+        live_screen_print(screen, row++, 18, CELL_CYAN, "%.0f / %d s  level %d%%  (any key stops)",
+                          elapsed_s, config->duration_s, level);
+    } else {
+        live_screen_print(screen, row++, 18, CELL_CYAN, "%.0f s  level %d%%  (any key stops)",
+                          elapsed_s, level);
+    }
+    row++;
+    live_screen_print(screen, row++, 0, CELL_BOLD, "%-10s %14s %14s %14s", "Load", "Target", "Achieved",
+                      "System sees");
+
+    if (config->cpu_workers > 0) {
+        // Target and achieved as a share of the whole machine, like the CPU view
+        double target = config->cpu_workers * config->cpu_percent * level / 100.0 / cpus;
+        double achieved = (double)(cur->cpu_busy_ns - prev->cpu_busy_ns) / (seconds * 1e9) * 100.0 / cpus;
+        double seen = sysmon_cpu_busy_percent(&sys_prev->cpu.total, &sys_cur->cpu.total);
+        live_screen_print(screen, row++, 0, CELL_DEFAULT, "%-10s %13.1f%% %13.1f%% %13.1f%%",
+                          "CPU", target, achieved, seen);
+        if (pin_failed > 0) {
+            live_screen_print(screen, row++, 0, CELL_YELLOW, "%d of %d burners could not be pinned: %s",
+                              pin_failed, config->cpu_workers, strerror(pin_error));
+        }
+    }
+    if (config->mem_mb > 0) {
+        double target = config->mem_mb_per_sec * level / 100.0;
+        double achieved = (double)(cur->mem_written - prev->mem_written) / seconds / 1048576.0;
+        double used_mb = (double)(sys_cur->mem.total_kb - sys_cur->mem.available_kb) / 1024.0;
+        live_screen_print(screen, row++, 0, CELL_DEFAULT, "%-10s %11.0f MB %11.0f MB %11.0f MB",
+                          "Mem used", (double)config->mem_mb, (double)cur->mem_resident / 1048576.0, used_mb);
+        if (config->mem_mb_per_sec > 0) {
+            live_screen_print(screen, row++, 0, CELL_DEFAULT, "%-10s %9.0f MB/s %9.0f MB/s %14s",
+                              "Mem write", target, achieved, "-");
+        } else {
+            live_screen_print(screen, row++, 0, CELL_DEFAULT, "%-10s %14s %9.0f MB/s %14s",
+                              "Mem write", "max", achieved, "-");
+        }
+    }
+    if (config->disk_mb_per_sec > 0) {
+        double target = config->disk_mb_per_sec * level / 100.0;
+        double achieved = (double)(cur->disk_written - prev->disk_written) / seconds / 1048576.0;
+        double sys_seconds = (double)(sys_cur->time_ms - sys_prev->time_ms) / 1000.0;
+        double seen = sys_seconds > 0.0
+            ? (double)(sys_cur->io.write_sectors - sys_prev->io.write_sectors) * 512.0 / sys_seconds / 1048576.0
+            : 0.0;
+        int error = atomic_load(&disk->error);
+        live_screen_print(screen, row++, 0, error ? CELL_RED : CELL_DEFAULT, "%-10s %9.1f MB/s %9.1f MB/s %9.1f MB/s",
+                          "Disk write", target, achieved, seen);
+        if (error) {
+            live_screen_print(screen, row++, 0, CELL_RED, "Disk writer stopped: %s", strerror(error));
+        } else if (!disk_direct) {
+            live_screen_print(screen, row++, 0, CELL_YELLOW,
+                              "O_DIRECT not supported here; writing through the page cache");
+        }
+    }
+
+    if (config->ramp_count > 0) {
+        row++;
+        int col = live_screen_print(screen, row, 0, CELL_BOLD, "Ramp:");
+        for (int i = 0; i < config->ramp_count; i++) {
+            bool active = elapsed_s >= config->ramp_at_s[i] &&
+                          (i + 1 == config->ramp_count || elapsed_s < config->ramp_at_s[i + 1]);
+            col += live_screen_print(screen, row, col, active ? CELL_GREEN : CELL_DEFAULT, " %ds:%d%%",
+                                     config->ramp_at_s[i], config->ramp_percent[i]);
+        }
+    }
+}
+
+/**
+ * One line per second for runs without a terminal
+ */
+static void log_stress_line(const StressConfig *config, int level, double elapsed_s,
+                            const StressTotals *prev, const StressTotals *cur,
+                            const LiveSample *sys_prev, const LiveSample *sys_cur, const DiskWriter *disk) {
+    double seconds = (double)(cur->time_ns - prev->time_ns) / 1e9;
+    int cpus = sys_cur->cpu.cpu_count > 0 ? sys_cur->cpu.cpu_count : 1;
+    char stamp[16];
+    time_t now = time(NULL);
+    struct tm tm;
+
+    if (seconds <= 0.0) seconds = 1.0;
+    localtime_r(&now, &tm);
+    strftime(stamp, sizeof(stamp), "%H:%M:%S", &tm);
+    printf("%s t=%.0fs level %d%%", stamp, elapsed_s, level);
+    if (config->cpu_workers > 0) {
+        printf("  cpu target %.1f%% achieved %.1f%% seen %.1f%%",
+               config->cpu_workers * config->cpu_percent * level / 100.0 / cpus,
+               (double)(cur->cpu_busy_ns - prev->cpu_busy_ns) / (seconds * 1e9) * 100.0 / cpus,
+               sysmon_cpu_busy_percent(&sys_prev->cpu.total, &sys_cur->cpu.total));
+    }
+    if (config->mem_mb > 0) {
+        printf("  mem resident %.0f MB write %.0f MB/s", (double)cur->mem_resident / 1048576.0,
+               (double)(cur->mem_written - prev->mem_written) / seconds / 1048576.0);
+    }
+    if (config->disk_mb_per_sec > 0) {
+        printf("  disk target %.1f MB/s achieved %.1f MB/s", config->disk_mb_per_sec * level / 100.0,
+               (double)(cur->disk_written - prev->disk_written) / seconds / 1048576.0);
+        int error = atomic_load(&disk->error);
+        if (error) {
+            printf(" (stopped: %s)", strerror(error));
+        }
+    }
+    printf("\n");
+    fflush(stdout);
+}
+
+/**
+ * Bytes of the footprint actually in RAM, from mincore() a chunk at a time
+ */
+static unsigned long long resident_bytes(const MemoryToucher *toucher) {
+    unsigned char pages[4096];
+    size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+    unsigned long long resident = 0;
+
+    for (size_t off = 0; off < toucher->bytes; ) {
+        size_t len = toucher->bytes - off;
+        if (len > sizeof(pages) * page_size) len = sizeof(pages) * page_size;
+        if (mincore(toucher->region + off, len, pages) != 0) {
+            break;
+        }
+        size_t count = (len + page_size - 1) / page_size;
+        for (size_t i = 0; i < count; i++) {
+            if (pages[i] & 1) resident += page_size;
+        }
+        off += len;
+    }
+    return resident;
+}
+
+static void collect_totals(StressTotals *totals, CpuBurner *burners, int burner_count,
+                           MemoryToucher *toucher, DiskWriter *disk) {
+    totals->time_ns = now_ns();
+    totals->cpu_busy_ns = 0;
+    for (int i = 0; i < burner_count; i++) {
+        totals->cpu_busy_ns += atomic_load_explicit(&burners[i].busy_ns, memory_order_relaxed);
+    }
+    totals->mem_written = atomic_load_explicit(&toucher->written, memory_order_relaxed);
+    totals->mem_resident = toucher->region != NULL ? resident_bytes(toucher) : 0;
+    totals->disk_written = atomic_load_explicit(&disk->written, memory_order_relaxed);
+}
+
+#endif
+
+/**
+ * Run the configured load until a key, duration_s, SIGINT or SIGTERM.
+ * Without a terminal keys are not read, so it runs until duration_s or
+ * a signal.
+ */
+void sysmon_stress(const StressConfig *config) {
+#ifndef __linux__
+    (void)config;
+    print_warning("The load generator is only available on Linux.");
+#else
+    static StressControl control;
+    static MemoryToucher toucher;
+    static DiskWriter disk;
+    static LiveSample samples[2];
+    static StressTotals totals[2];
+    CpuBurner *burners = NULL;
+    LiveScreen screen;
+    char path[MAX_PATH_LENGTH + 32];
+    bool ok = true;
+
+    memset(&toucher, 0, sizeof(toucher));
+    memset(&disk, 0, sizeof(disk));
+    atomic_init(&control.level_permille, ramp_percent(config, 0.0) * 10);
+    atomic_init(&control.stop, false);
+    toucher.control = &control;
+    disk.control = &control;
+    disk.fd = -1;
+
+    if (!sysmon_read_sample(&samples[0])) {
+        print_error("Could not read /proc samples!");
+        return;
+    }
+    // Pin to the CPUs we may run on, which a cpuset or taskset can limit
+    static int allowed[CPU_SETSIZE];
+    int allowed_count = 0;
+    cpu_set_t mask;
+    if (sched_getaffinity(0, sizeof(mask), &mask) == 0) {
+        for (int c = 0; c < CPU_SETSIZE; c++) {
+            if (CPU_ISSET(c, &mask)) allowed[allowed_count++] = c;
+        }
+    }
+
+    if (config->mem_mb > 0) {
+        toucher.bytes = (size_t)config->mem_mb * 1024 * 1024;
+        toucher.bytes_per_sec = (double)config->mem_mb_per_sec * 1024 * 1024;
+        toucher.region = mmap(NULL, toucher.bytes, PROT_READ | PROT_WRITE,
+                              MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+        if (toucher.region == MAP_FAILED) {
+            toucher.region = NULL;
+            print_error("Could not reserve the memory footprint!");
+            return;
+        }
+    }
+    if (config->disk_mb_per_sec > 0) {
+        // Unlinked right away so nothing is left behind if we are killed
+        snprintf(path, sizeof(path), "%s/.devhelper-stress-XXXXXX", config->disk_dir);
+        disk.fd = mkostemp(path, O_CLOEXEC);
+        if (disk.fd >= 0) {
+            unlink(path);
+            int flags = fcntl(disk.fd, F_GETFL);
+            disk.direct = fcntl(disk.fd, F_SETFL, flags | O_DIRECT) == 0;
+        }
+        if (disk.fd < 0) {
+            print_error("Could not create the scratch file in that directory!");
+            if (toucher.region != NULL) munmap(toucher.region, toucher.bytes);
+            return;
+        }
+        disk.bytes_per_sec = (double)config->disk_mb_per_sec * 1024 * 1024;
+    }
+    if (config->cpu_workers > 0) {
+        burners = calloc((size_t)config->cpu_workers, sizeof(CpuBurner));
+        if (burners == NULL) {
+            ok = false;
+        }
+    }
+    bool interactive = isatty(STDIN_FILENO) && isatty(STDOUT_FILENO);
+    if (!ok || (interactive && !live_screen_init(&screen))) {
+        print_error("Not enough memory for the load generator!");
+        free(burners);
+        if (toucher.region != NULL) munmap(toucher.region, toucher.bytes);
+        if (disk.fd >= 0) close(disk.fd);
+        return;
+    }
+
+    for (int i = 0; i < config->cpu_workers; i++) {
+        burners[i].control = &control;
+        burners[i].cpu = config->cpu_workers <= allowed_count ? allowed[i] : -1;
+        burners[i].percent = config->cpu_percent;
+        burners[i].started = pthread_create(&burners[i].thread, NULL, cpu_burner_thread, &burners[i]) == 0;
+    }
+    if (toucher.region != NULL) {
+        toucher.started = pthread_create(&toucher.thread, NULL, memory_toucher_thread, &toucher) == 0;
+    }
+    if (disk.fd >= 0) {
+        disk.started = pthread_create(&disk.thread, NULL, disk_writer_thread, &disk) == 0;
+    }
+
+    StressTotals *prev = &totals[0], *cur = &totals[1];
+    LiveSample *sys_prev = &samples[0], *sys_cur = &samples[1];
+    collect_totals(prev, burners, config->cpu_workers, &toucher, &disk);
+    *cur = *prev;
+    *sys_cur = *sys_prev;
+
+    struct sigaction sa, old_int, old_term;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = stress_signal_handler;
+    sigaction(SIGINT, &sa, &old_int);
+    sigaction(SIGTERM, &sa, &old_term);
+    stress_interrupted = 0;
+
+    long long start = monotonic_ms();
+    long long next_tick = start + 1000;
+    int level = ramp_percent(config, 0.0);
+    int pin_failed = 0, pin_error = 0;
+    if (interactive) {
+        terminal_set_raw(true);
+        render_stress_frame(&screen, config, level, 0.0, prev, cur, sys_prev, sys_cur, &disk, disk.direct,
+                            pin_failed, pin_error);
+        live_screen_flush(&screen);
+    } else if (config->duration_s > 0) {
+        printf("Applying load for %d s - send SIGINT or SIGTERM to stop early\n", config->duration_s);
+    } else {
+        printf("Applying load - send SIGINT or SIGTERM to stop\n");
+    }
+
+    while (!stress_interrupted) {
+        int wait = (int)(next_tick - monotonic_ms());
+        if (interactive) {
+            if (wait_for_key(wait) >= 0) {
+                break;
+            }
+        } else if (wait > 0) {
+            usleep((useconds_t)wait * 1000);
+        }
+        long long now = monotonic_ms();
+        if (stress_interrupted || now < next_tick) {
+            continue;
+        }
+        next_tick += 1000;
+        if (next_tick <= now) {
+            next_tick = now + 1000;
+        }
+
+        double elapsed_s = (double)(now - start) / 1000.0;
+        if (config->duration_s > 0 && elapsed_s >= config->duration_s) {
+            break;
+        }
+
+        StressTotals *swap_totals = prev;
+        prev = cur;
+        cur = swap_totals;
+        LiveSample *swap_sample = sys_prev;
+        sys_prev = sys_cur;
+        sys_cur = swap_sample;
+        collect_totals(cur, burners, config->cpu_workers, &toucher, &disk);
+        sysmon_read_sample(sys_cur);
+
+        // Burners pin themselves as they start; report any that could not
+        bool checking_pins = pin_failed == 0;
+        for (int i = 0; checking_pins && i < config->cpu_workers; i++) {
+            int error = atomic_load(&burners[i].pin_error);
+            if (error != 0) {
+                pin_failed++;
+                pin_error = error;
+            }
+        }
+        if (checking_pins && pin_failed > 0 && !interactive) {
+            printf("%d of %d burners could not be pinned: %s\n", pin_failed, config->cpu_workers,
+                   strerror(pin_error));
+        }
+
+        // Report the window that just ended, then move to the next step
+        if (interactive) {
+            render_stress_frame(&screen, config, level, elapsed_s, prev, cur, sys_prev, sys_cur,
+                                &disk, disk.direct, pin_failed, pin_error);
+            live_screen_flush(&screen);
+        } else {
+            log_stress_line(config, level, elapsed_s, prev, cur, sys_prev, sys_cur, &disk);
+        }
+        level = ramp_percent(config, elapsed_s);
+        atomic_store(&control.level_permille, level * 10);
+    }
+
+    atomic_store(&control.stop, true);
+    for (int i = 0; i < config->cpu_workers; i++) {
+        if (burners[i].started) pthread_join(burners[i].thread, NULL);
+    }
+    if (toucher.started) pthread_join(toucher.thread, NULL);
+    if (disk.started) pthread_join(disk.thread, NULL);
+
+    if (interactive) {
+        terminal_set_raw(false);
+        printf("%s\033[H\033[2J", COLOR_RESET);
+        fflush(stdout);
+        live_screen_free(&screen);
+    }
+    sigaction(SIGINT, &old_int, NULL);
+    sigaction(SIGTERM, &old_term, NULL);
+    free(burners);
+    if (toucher.region != NULL) munmap(toucher.region, toucher.bytes);
+    if (disk.fd >= 0) close(disk.fd);
+    print_success("Load stopped.");
+#endif
+}
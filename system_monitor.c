@@ -4,8 +4,283 @@
  * Displays system resource usage and information
  */
 
+#define _GNU_SOURCE
 #include "devhelper.h"
 
+#include <math.h>
+
+#ifdef __linux__
+#include <fcntl.h>
+#endif
+
+/**
+ * Read a whole /proc or /sys file into buf without allocating.
+ * Returns the number of bytes read, or -1 on failure.
+ */
+long sysmon_read_file(const char *path, char *buf, size_t size) {
+#ifdef __linux__
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+
+    size_t used = 0;
+    while (used + 1 < size) {
+        ssize_t n = read(fd, buf + used, size - used - 1);
+        if (n <= 0) {
+            break;
+        }
+        used += (size_t)n;
+    }
+    close(fd);
+
+    buf[used] = '\0';
+    return (long)used;
+#else
+    (void)path;
+    (void)size;
+    if (size > 0) buf[0] = '\0';
+    return -1;
+#endif
+}
+
+/**
+ * Parse the counters of one "cpu" line from /proc/stat
+ */
+static const char *parse_cpu_times(const char *p, CpuTimes *t) {
+    unsigned long long *fields[] = {
+        &t->user, &t->nice, &t->system, &t->idle,
+        &t->iowait, &t->irq, &t->softirq, &t->steal
+    };
+    char *end;
+
+    for (size_t i = 0; i < sizeof(fields) / sizeof(fields[0]); i++) {
+        *fields[i] = strtoull(p, &end, 10);
+        p = end;
+    }
+
+    // Skip guest/guest_nice; they are already counted in user/nice
+    while (*p && *p != '\n') p++;
+    return p;
+}
+
+/**
+ * Take a snapshot of the aggregate and per-core counters in /proc/stat
+ */
+bool sysmon_read_cpu(CpuSnapshot *snap) {
+    static _Thread_local char buf[65536];
+
+    if (sysmon_read_file("/proc/stat", buf, sizeof(buf)) <= 0) {
+        return false;
+    }
+
+    snap->cpu_count = 0;
+    snap->context_switches = 0;
+    snap->procs_running = 0;
+
+    const char *p = buf;
+    while (*p) {
+        if (strncmp(p, "cpu", 3) == 0) {
+            if (p[3] == ' ') {
+                p = parse_cpu_times(p + 4, &snap->total);
+            } else {
+                char *end;
+                long id = strtol(p + 3, &end, 10);
+                if (id >= 0 && id < SYSMON_MAX_CPUS) {
+                    p = parse_cpu_times(end, &snap->cpu[id]);
+                    if (id + 1 > snap->cpu_count) {
+                        snap->cpu_count = (int)id + 1;
+                    }
+                }
+            }
+        } else if (strncmp(p, "ctxt ", 5) == 0) {
+            snap->context_switches = strtoull(p + 5, NULL, 10);
+        } else if (strncmp(p, "procs_running ", 14) == 0) {
+            snap->procs_running = (int)strtol(p + 14, NULL, 10);
+        }
+
+        while (*p && *p != '\n') p++;
+        if (*p == '\n') p++;
+    }
+
+    return snap->cpu_count > 0;
+}
+
+/**
+ * Total jiffies across all states of a CPU counter set
+ */
+unsigned long long cpu_times_total(const CpuTimes *t) {
+    return t->user + t->nice + t->system + t->idle +
+           t->iowait + t->irq + t->softirq + t->steal;
+}
+
+/**
+ * Busy percentage between two samples of the same CPU
+ */
+double sysmon_cpu_busy_percent(const CpuTimes *prev, const CpuTimes *cur) {
+    unsigned long long total = cpu_times_total(cur) - cpu_times_total(prev);
+    unsigned long long idle = (cur->idle + cur->iowait) - (prev->idle + prev->iowait);
+
+    if (total == 0 || idle > total) {
+        return 0.0;
+    }
+    return 100.0 * (double)(total - idle) / (double)total;
+}
+
+/**
+ * Look up a "Key:   123 kB" field in a meminfo buffer
+ */
+static unsigned long long meminfo_field(const char *buf, const char *key) {
+    const char *p = strstr(buf, key);
+    if (p == NULL) {
+        return 0;
+    }
+    return strtoull(p + strlen(key), NULL, 10);
+}
+
+/**
+ * Read memory and swap totals from /proc/meminfo (values in kB)
+ */
+bool sysmon_read_memory(MemorySnapshot *mem) {
+    char buf[8192];
+
+    if (sysmon_read_file("/proc/meminfo", buf, sizeof(buf)) <= 0) {
+        return false;
+    }
+
+    mem->total_kb = meminfo_field(buf, "MemTotal:");
+    mem->free_kb = meminfo_field(buf, "MemFree:");
+    mem->available_kb = meminfo_field(buf, "MemAvailable:");
+    mem->buffers_kb = meminfo_field(buf, "Buffers:");
+    mem->cached_kb = meminfo_field(buf, "\nCached:");
+    mem->swap_total_kb = meminfo_field(buf, "SwapTotal:");
+    mem->swap_free_kb = meminfo_field(buf, "SwapFree:");
+
+    return mem->total_kb > 0;
+}
+
+/**
+ * Read load averages and task counts from /proc/loadavg
+ */
+bool sysmon_read_load(LoadSnapshot *load) {
+    char buf[256];
+
+    if (sysmon_read_file("/proc/loadavg", buf, sizeof(buf)) <= 0) {
+        return false;
+    }
+
+    return sscanf(buf, "%lf %lf %lf %d/%d", &load->load1, &load->load5,
+                  &load->load15, &load->running_tasks, &load->total_tasks) == 5;
+}
+
+/**
+ * Whole disks are the entries of /sys/block that are not virtual
+ * loop/ram devices; partitions have no entry there
+ */
+static bool is_whole_disk(const char *name) {
+    char path[96];
+
+    if (strncmp(name, "loop", 4) == 0 || strncmp(name, "ram", 3) == 0) {
+        return false;
+    }
+    snprintf(path, sizeof(path), "/sys/block/%s", name);
+    return access(path, F_OK) == 0;
+}
+
+/**
+ * Sum disk counters over whole disks and network counters over every
+ * interface except loopback
+ */
+bool sysmon_read_io(IoSnapshot *io) {
+    static _Thread_local char buf[65536];
+    bool ok = false;
+
+    memset(io, 0, sizeof(*io));
+
+    if (sysmon_read_file("/proc/diskstats", buf, sizeof(buf)) > 0) {
+        char *line = buf;
+        while (line && *line) {
+            char *next = strchr(line, '\n');
+            if (next) *next++ = '\0';
+
+            unsigned int major, minor;
+            char name[64];
+            unsigned long long reads, rd_merged, rd_sectors, rd_ms;
+            unsigned long long writes, wr_merged, wr_sectors, wr_ms, in_flight, io_ms;
+            if (sscanf(line, "%u %u %63s %llu %llu %llu %llu %llu %llu %llu %llu %llu %llu",
+                       &major, &minor, name, &reads, &rd_merged, &rd_sectors, &rd_ms,
+                       &writes, &wr_merged, &wr_sectors, &wr_ms, &in_flight, &io_ms) == 13 &&
+                is_whole_disk(name)) {
+                io->reads += reads;
+                io->writes += writes;
+                io->read_sectors += rd_sectors;
+                io->write_sectors += wr_sectors;
+                io->io_ms += io_ms;
+            }
+            line = next;
+        }
+        ok = true;
+    }
+
+    if (sysmon_read_file("/proc/net/dev", buf, sizeof(buf)) > 0) {
+        char *line = buf;
+        while (line && *line) {
+            char *next = strchr(line, '\n');
+            if (next) *next++ = '\0';
+
+            char *colon = strchr(line, ':');
+            if (colon != NULL) {
+                *colon = '\0';
+                char *name = line;
+                while (*name == ' ') name++;
+
+                unsigned long long rx_bytes, rx_packets, skip, tx_bytes, tx_packets;
+                if (strcmp(name, "lo") != 0 &&
+                    sscanf(colon + 1, "%llu %llu %llu %llu %llu %llu %llu %llu %llu %llu",
+                           &rx_bytes, &rx_packets, &skip, &skip, &skip, &skip, &skip, &skip,
+                           &tx_bytes, &tx_packets) == 10) {
+                    io->rx_bytes += rx_bytes;
+                    io->rx_packets += rx_packets;
+                    io->tx_bytes += tx_bytes;
+                    io->tx_packets += tx_packets;
+                }
+            }
+            line = next;
+        }
+        ok = true;
+    }
+
+    return ok;
+}
+
+/**
+ * Read a complete CPU/memory/load/IO sample stamped with the monotonic clock
+ */
+bool sysmon_read_sample(LiveSample *sample) {
+    sample->time_ms = monotonic_ms();
+    if (!sysmon_read_cpu(&sample->cpu) || !sysmon_read_memory(&sample->mem) ||
+        !sysmon_read_load(&sample->load)) {
+        return false;
+    }
+    sysmon_read_io(&sample->io);
+    return true;
+}
+
+/**
+ * Format a kB value as a short human-readable size
+ */
+void format_kb(unsigned long long kb, char *out, size_t size) {
+    const char *units[] = { "K", "M", "G", "T" };
+    double value = (double)kb;
+    int unit = 0;
+
+    while (value >= 1024.0 && unit < 3) {
+        value /= 1024.0;
+        unit++;
+    }
+    snprintf(out, size, unit == 0 ? "%.0f%s" : "%.1f%s", value, units[unit]);
+}
+
 /**
  * Display system information
  */
@@ -15,6 +290,13 @@ void display_system_info(void) {
     
 #ifdef _WIN32
     system("systeminfo | findstr /C:\"OS Name\" /C:\"OS Version\" /C:\"System Type\"");
+#elif defined(__linux__)
+    display_cpu_topology();
+
+    if (access("/etc/os-release", F_OK) == 0) {
+        printf("\n");
+        system("cat /etc/os-release | grep -E '^(NAME|VERSION)='");
+    }
 #else
     system("uname -a");
     
@@ -55,6 +337,12 @@ void display_cpu_usage(void) {
         system("lscpu | grep -E '^Model name|^CPU\\(s\\)|^Thread|^Core'");
         printf("\n%sCPU Usage:%s\n", COLOR_CYAN, COLOR_RESET);
         system("top -bn1 | grep 'Cpu(s)' | sed 's/.*, *\\([0-9.]*\\)%* id.*/\\1/' | awk '{print \"CPU Usage: \" 100 - $1\"%\"}'");
+        display_cgroup_cpu();
+
+        printf("\n");
+        display_metric_history(HIST_CPU_BUSY, 0.0f, 100.0f);
+        display_metric_history(HIST_CPU_IOWAIT, 0.0f, 100.0f);
+        display_metric_history(HIST_LOAD1, 0.0f, NAN);
     #endif
 #endif
     
@@ -80,6 +368,13 @@ void display_memory_usage(void) {
     #else
         // Linux
         system("free -h");
+        display_cgroup_memory();
+
+        printf("\n");
+        display_metric_history(HIST_MEM_USED, 0.0f, 100.0f);
+        display_metric_history(HIST_SWAP_USED, 0.0f, 100.0f);
+        printf("\n");
+        print_info("For per-process PSS and private memory use Process Memory (option 16).");
     #endif
 #endif
     
@@ -98,6 +393,12 @@ void display_disk_usage(void) {
     system("wmic logicaldisk get name,size,freespace");
 #else
     system("df -h");
+    #ifdef __linux__
+        printf("\n");
+        display_cgroup_io();
+        printf("\n");
+        print_info("For per-device IOPS and latency use Disk I/O per Device (option 12).");
+    #endif
 #endif
     
     printf("\n");
@@ -126,12 +427,8 @@ void display_network_info(void) {
         printf("\n%sActive Network Services:%s\n", COLOR_CYAN, COLOR_RESET);
         system("networksetup -listallhardwareports");
     #else
-        // Linux
-        printf("%sNetwork Interfaces:%s\n", COLOR_CYAN, COLOR_RESET);
-        system("ip addr show");
-        
-        printf("\n%sRouting Table:%s\n", COLOR_CYAN, COLOR_RESET);
-        system("ip route");
+        // Linux: rtnetlink and /proc, no external tools needed
+        display_network_native();
     #endif
 #endif
     
@@ -165,12 +462,365 @@ void display_all_resources(void) {
     pause_screen();
 }
 
+/**
+ * Ask for a file and options, then record samples
+ */
+static void record_menu(void) {
+    char path[MAX_PATH_LENGTH];
+    char input[MAX_INPUT_LENGTH];
+
+    clear_screen();
+    print_header("Record Resource Samples");
+    printf("\n");
+    get_user_input(path, sizeof(path), "Recording file [sysmon.rec]: ");
+    if (path[0] == '\0') {
+        strcpy(path, "sysmon.rec");
+    }
+    get_user_input(input, sizeof(input), "Sample interval in ms [1000]: ");
+    int interval = input[0] ? atoi(input) : 1000;
+    get_user_input(input, sizeof(input), "Duration in seconds [0 = until a key is pressed]: ");
+    int duration = atoi(input);
+
+    printf("\n");
+    sysmon_record(path, interval, duration);
+    pause_screen();
+}
+
+/**
+ * Ask for a recording and play it back
+ */
+static void replay_menu(void) {
+    char path[MAX_PATH_LENGTH];
+    char input[MAX_INPUT_LENGTH];
+
+    clear_screen();
+    print_header("Replay a Recording");
+    printf("\n");
+    get_user_input(path, sizeof(path), "Recording file [sysmon.rec]: ");
+    if (path[0] == '\0') {
+        strcpy(path, "sysmon.rec");
+    }
+    get_user_input(input, sizeof(input), "Playback speed [1]: ");
+    double speed = input[0] ? atof(input) : 1.0;
+    get_user_input(input, sizeof(input), "Start at second [0]: ");
+    int start = atoi(input);
+
+    sysmon_replay(path, speed, start);
+    pause_screen();
+}
+
+/**
+ * Ask for session options, sample, then show percentiles
+ */
+static void session_menu(void) {
+    char input[MAX_INPUT_LENGTH];
+    char path[MAX_PATH_LENGTH];
+
+    clear_screen();
+    print_header("Sampling Session");
+    printf("\n");
+    get_user_input(input, sizeof(input), "Sample interval in ms [1000]: ");
+    int interval = input[0] ? atoi(input) : 1000;
+    get_user_input(input, sizeof(input), "Duration in seconds [0 = until a key is pressed]: ");
+    int duration = atoi(input);
+    get_user_input(path, sizeof(path), "Save sketches to (blank to skip): ");
+
+    printf("\n");
+    sysmon_session(interval, duration, path);
+    pause_screen();
+}
+
+/**
+ * Ask for the refresh interval and trigger threshold, then show PSI
+ */
+static void psi_menu(void) {
+    char input[MAX_INPUT_LENGTH];
+
+    clear_screen();
+    print_header("Pressure Stall Information");
+    printf("\n");
+    int interval = prompt_interval_ms();
+    get_user_input(input, sizeof(input), "Wake on stalls above % of a 2 s window [0 = off]: ");
+    sysmon_psi_view(interval, atoi(input));
+}
+
+/**
+ * Ask for a pid (or none for per-core counters) and an interval
+ */
+static void perf_menu(void) {
+    char input[MAX_INPUT_LENGTH];
+
+    clear_screen();
+    print_header("CPU Efficiency");
+    printf("\n");
+    get_user_input(input, sizeof(input), "Process ID [empty = per core]: ");
+    int pid = atoi(input);
+    sysmon_perf_view(prompt_interval_ms(), pid);
+}
+
+/**
+ * Ask for a pid, duration and output file, then profile it
+ */
+static void profile_menu(void) {
+    char input[MAX_INPUT_LENGTH];
+    char path[MAX_PATH_LENGTH];
+
+    clear_screen();
+    print_header("Stack Profiler");
+    printf("\n");
+    get_user_input(input, sizeof(input), "Process ID: ");
+    int pid = atoi(input);
+    get_user_input(input, sizeof(input), "Duration in seconds [10, 0 = until a key]: ");
+    int seconds = input[0] ? atoi(input) : 10;
+    get_user_input(path, sizeof(path), "Output file [profile-<pid>.folded]: ");
+
+    printf("\n");
+    sysmon_profile(pid, seconds, 99, path, false);
+    pause_screen();
+}
+
+/**
+ * Run as an agent streaming to a collector, or as the collector
+ */
+static void fleet_menu(void) {
+    char input[MAX_INPUT_LENGTH];
+    char address[MAX_PATH_LENGTH];
+
+    clear_screen();
+    print_header("Fleet Agent / Collector");
+    printf("\n");
+    printf("  %s1.%s Collector (show the fleet table)\n", COLOR_CYAN, COLOR_RESET);
+    printf("  %s2.%s Agent (stream this host to a collector)\n", COLOR_CYAN, COLOR_RESET);
+    printf("\n");
+    int mode = get_user_choice(1, 2);
+
+    if (mode == 1) {
+        get_user_input(address, sizeof(address), "Listen on [port, host:port or unix:/path, default 7373]: ");
+        sysmon_collector(address[0] ? address : "7373", 1000);
+        return;
+    }
+    get_user_input(address, sizeof(address), "Collector address [127.0.0.1:7373]: ");
+    get_user_input(input, sizeof(input), "Samples per write [5]: ");
+    printf("\n");
+    sysmon_agent(address[0] ? address : "127.0.0.1:7373", 1000, input[0] ? atoi(input) : 5, NULL);
+    pause_screen();
+}
+
+/**
+ * Ask for a load spec in the same form as the command line, then run it
+ */
+static void stress_menu(void) {
+    char line[MAX_INPUT_LENGTH];
+    char *args[16];
+    int count = 0;
+    StressConfig config;
+
+    clear_screen();
+    print_header("Synthetic Load");
+    printf("\n");
+    printf("  cpu=N[@percent]  mem=MB[@MB/s]  disk=MB/s[@dir]  time=s  ramp=t:percent,...\n");
+    printf("  e.g. cpu=2@50 mem=256@500 disk=20@/tmp time=60 ramp=0:25,20:50,40:100\n\n");
+    get_user_input(line, sizeof(line), "Load: ");
+
+    for (char *token = strtok(line, " \t"); token != NULL && count < 16; token = strtok(NULL, " \t")) {
+        args[count++] = token;
+    }
+    if (!stress_parse(&config, count, args)) {
+        pause_screen();
+        return;
+    }
+    sysmon_stress(&config);
+    pause_screen();
+}
+
+/**
+ * Ask where and how hard to benchmark, then run the four tests
+ */
+static void io_bench_menu(void) {
+    char dir[MAX_PATH_LENGTH];
+    char input[MAX_INPUT_LENGTH];
+
+    clear_screen();
+    print_header("Disk Benchmark");
+    printf("\n");
+    get_user_input(dir, sizeof(dir), "Directory on the disk to test [.]: ");
+    get_user_input(input, sizeof(input), "Block size in KB [1024 sequential / 4 random]: ");
+    int block_kb = atoi(input);
+    get_user_input(input, sizeof(input), "Queue depth [32]: ");
+    int depth = input[0] ? atoi(input) : 32;
+    get_user_input(input, sizeof(input), "Scratch file size in MB [1024]: ");
+    int file_mb = input[0] ? atoi(input) : 1024;
+
+    printf("\n");
+    sysmon_io_bench(dir, block_kb, depth, file_mb, 10, false);
+    pause_screen();
+}
+
+/**
+ * Ask for the array size and thread count, then benchmark every node
+ */
+static void mem_bench_menu(void) {
+    char input[MAX_INPUT_LENGTH];
+
+    clear_screen();
+    print_header("Memory Benchmark");
+    printf("\n");
+    get_user_input(input, sizeof(input), "Array size in MB [auto = 4x last-level cache]: ");
+    int array_mb = atoi(input);
+    get_user_input(input, sizeof(input), "Threads per node [all CPUs of the node]: ");
+    int threads = atoi(input);
+
+    sysmon_mem_bench(array_mb, threads);
+    pause_screen();
+}
+
+/**
+ * Show the topology, then optionally where one process's memory lives
+ */
+static void numa_menu(void) {
+    char input[MAX_INPUT_LENGTH];
+
+    clear_screen();
+    print_header("NUMA Topology");
+    printf("\n");
+#ifdef __linux__
+    display_cpu_topology();
+    printf("\n");
+    get_user_input(input, sizeof(input), "Process ID to show memory placement [empty = skip]: ");
+    if (atoi(input) > 0) {
+        display_numa_process(atoi(input));
+    }
+#else
+    (void)input;
+    print_warning("Topology is read from /sys and is only available on Linux.");
+#endif
+    pause_screen();
+}
+
+/**
+ * Ask for a path and an optional warm/evict action
+ */
+static void fincore_menu(void) {
+    char path[MAX_PATH_LENGTH];
+    char *paths[1] = { path };
+
+    clear_screen();
+    print_header("Page-Cache Residency");
+    printf("\n");
+    get_user_input(path, sizeof(path), "File or directory [.]: ");
+    if (path[0] == '\0') {
+        strcpy(path, ".");
+    }
+    printf("\n");
+    printf("  %s1.%s Report only\n", COLOR_CYAN, COLOR_RESET);
+    printf("  %s2.%s Warm into the page cache\n", COLOR_CYAN, COLOR_RESET);
+    printf("  %s3.%s Evict from the page cache\n", COLOR_CYAN, COLOR_RESET);
+    printf("\n");
+    int action = get_user_choice(1, 3);
+
+    printf("\n");
+    sysmon_fincore(paths, 1, action == 2 ? FINCORE_WARM : action == 3 ? FINCORE_EVICT : FINCORE_REPORT, 0);
+    pause_screen();
+}
+
+/**
+ * Ask for the pids to watch and how often to sample them
+ */
+static void leak_menu(void) {
+    char input[MAX_INPUT_LENGTH];
+    int pids[32];
+    int count = 0;
+
+    clear_screen();
+    print_header("Memory Growth Watch");
+    printf("\n");
+    get_user_input(input, sizeof(input), "Process IDs (space separated): ");
+    for (char *token = strtok(input, " ,"); token != NULL && count < 32; token = strtok(NULL, " ,")) {
+        if (atoi(token) > 0) {
+            pids[count++] = atoi(token);
+        }
+    }
+    if (count == 0) {
+        print_error("No process IDs given!");
+        pause_screen();
+        return;
+    }
+    get_user_input(input, sizeof(input), "Sample interval in seconds [30]: ");
+    int interval = input[0] ? atoi(input) : 30;
+    get_user_input(input, sizeof(input), "Trend window in hours [6]: ");
+    double hours = input[0] ? atof(input) : 6.0;
+
+    sysmon_leak_watch(pids, count, interval, (int)(hours * 3600.0));
+    pause_screen();
+}
+
+/**
+ * Ask for the address and sampling mode, then serve metrics
+ */
+static void exporter_menu(void) {
+    char listen[MAX_INPUT_LENGTH];
+    char input[MAX_INPUT_LENGTH];
+
+    clear_screen();
+    print_header("OpenMetrics Exporter");
+    printf("\n");
+    get_user_input(listen, sizeof(listen), "Listen on [127.0.0.1:9373]: ");
+    get_user_input(input, sizeof(input), "Background sampling period in ms, 0 = on each scrape [0]: ");
+    int staleness = input[0] ? atoi(input) : 0;
+
+    printf("\n");
+    sysmon_exporter(listen, staleness);
+    pause_screen();
+}
+
+/**
+ * Ask for a rules file and interval, then watch for alerts
+ */
+static void alert_menu(void) {
+    char input[MAX_INPUT_LENGTH];
+    char path[MAX_PATH_LENGTH];
+
+    clear_screen();
+    print_header("Alert Rules");
+    printf("\n");
+    get_user_input(path, sizeof(path), "Rules file [alerts.rules]: ");
+    if (path[0] == '\0') {
+        strcpy(path, "alerts.rules");
+    }
+    get_user_input(input, sizeof(input), "Sample interval in ms [1000]: ");
+    int interval = input[0] ? atoi(input) : 1000;
+
+    printf("\n");
+    sysmon_alert_watch(path, interval);
+    pause_screen();
+}
+
+/**
+ * Offer to drill into directory sizes after the filesystem overview
+ */
+static void du_menu(void) {
+    char path[MAX_PATH_LENGTH];
+
+#ifdef __linux__
+    get_user_input(path, sizeof(path), "Analyze directory sizes under (blank to skip): ");
+    if (path[0] != '\0') {
+        sysmon_du_view(path, 0);
+    }
+#else
+    (void)path;
+    pause_screen();
+#endif
+}
+
 /**
  * System monitor menu
  */
 void system_monitor_menu(void) {
     int choice;
     bool back_to_main = false;
+
+    // Collect history in the background while the monitor is in use
+    history_start_sampler();
     
     while (!back_to_main) {
         clear_screen();
@@ -182,11 +832,34 @@ void system_monitor_menu(void) {
         printf("  %s4.%s Display Disk Usage\n", COLOR_CYAN, COLOR_RESET);
         printf("  %s5.%s Display Network Information\n", COLOR_CYAN, COLOR_RESET);
         printf("  %s6.%s Display All Resources\n", COLOR_GREEN, COLOR_RESET);
+        printf("  %s7.%s Live Monitor (auto-refresh)\n", COLOR_GREEN, COLOR_RESET);
+        printf("  %s8.%s Process Table (top)\n", COLOR_GREEN, COLOR_RESET);
+        printf("  %s9.%s Record Resource Samples\n", COLOR_GREEN, COLOR_RESET);
+        printf("  %s10.%s Replay a Recording\n", COLOR_GREEN, COLOR_RESET);
+        printf("  %s11.%s Sampling Session (percentiles)\n", COLOR_GREEN, COLOR_RESET);
+        printf("  %s12.%s Disk I/O per Device\n", COLOR_GREEN, COLOR_RESET);
+        printf("  %s13.%s Network Throughput per Interface\n", COLOR_GREEN, COLOR_RESET);
+        printf("  %s14.%s Pressure Stall Information (PSI)\n", COLOR_GREEN, COLOR_RESET);
+        printf("  %s15.%s Alert Rules (watch)\n", COLOR_GREEN, COLOR_RESET);
+        printf("  %s16.%s Process Memory (PSS)\n", COLOR_GREEN, COLOR_RESET);
+        printf("  %s17.%s Socket Table (connections)\n", COLOR_GREEN, COLOR_RESET);
+        printf("  %s18.%s CPU Efficiency (perf counters)\n", COLOR_GREEN, COLOR_RESET);
+        printf("  %s19.%s Stack Profiler (flamegraph)\n", COLOR_GREEN, COLOR_RESET);
+        printf("  %s20.%s Fleet Agent / Collector\n", COLOR_GREEN, COLOR_RESET);
+        printf("  %s21.%s Synthetic Load (stress)\n", COLOR_GREEN, COLOR_RESET);
+        printf("  %s22.%s Disk Benchmark (IOPS, latency)\n", COLOR_GREEN, COLOR_RESET);
+        printf("  %s23.%s Memory Benchmark (bandwidth, latency)\n", COLOR_GREEN, COLOR_RESET);
+        printf("  %s24.%s NUMA Topology and Memory Placement\n", COLOR_GREEN, COLOR_RESET);
+        printf("  %s25.%s Page-Cache Residency (fincore)\n", COLOR_GREEN, COLOR_RESET);
+        printf("  %s26.%s Interrupts, SoftIRQs and Run Queues\n", COLOR_GREEN, COLOR_RESET);
+        printf("  %s27.%s Memory Growth (Leak) Watch\n", COLOR_GREEN, COLOR_RESET);
+        printf("  %s28.%s Process I/O (iotop)\n", COLOR_GREEN, COLOR_RESET);
+        printf("  %s29.%s OpenMetrics Exporter (Prometheus)\n", COLOR_GREEN, COLOR_RESET);
         printf("  %s0.%s Back to Main Menu\n", COLOR_RED, COLOR_RESET);
         printf("\n");
         print_separator();
         
-        choice = get_user_choice(0, 6);
+        choice = get_user_choice(0, 29);
         
         switch (choice) {
             case 1:
@@ -207,7 +880,7 @@ void system_monitor_menu(void) {
             case 4:
                 clear_screen();
                 display_disk_usage();
-                pause_screen();
+                du_menu();
                 break;
             case 5:
                 clear_screen();
@@ -217,9 +890,320 @@ void system_monitor_menu(void) {
             case 6:
                 display_all_resources();
                 break;
+            case 7:
+                sysmon_live_view(prompt_interval_ms());
+                break;
+            case 8:
+                sysmon_process_view(prompt_interval_ms());
+                break;
+            case 9:
+                record_menu();
+                break;
+            case 10:
+                replay_menu();
+                break;
+            case 11:
+                session_menu();
+                break;
+            case 12:
+                sysmon_disk_io_view(prompt_interval_ms());
+                break;
+            case 13:
+                sysmon_net_view(prompt_interval_ms());
+                break;
+            case 14:
+                psi_menu();
+                break;
+            case 15:
+                alert_menu();
+                break;
+            case 16:
+                sysmon_smaps_view(2000);
+                break;
+            case 17:
+                sysmon_socket_view(2000);
+                break;
+            case 18:
+                perf_menu();
+                break;
+            case 19:
+                profile_menu();
+                break;
+            case 20:
+                fleet_menu();
+                break;
+            case 21:
+                stress_menu();
+                break;
+            case 22:
+                io_bench_menu();
+                break;
+            case 23:
+                mem_bench_menu();
+                break;
+            case 24:
+                numa_menu();
+                break;
+            case 25:
+                fincore_menu();
+                break;
+            case 26:
+                sysmon_irq_view(prompt_interval_ms());
+                break;
+            case 27:
+                leak_menu();
+                break;
+            case 28:
+                sysmon_iotop_view(prompt_interval_ms());
+                break;
+            case 29:
+                exporter_menu();
+                break;
             case 0:
                 back_to_main = true;
                 break;
         }
     }
 }
+
+/**
+ * Print command-line usage for the sysmon subcommands
+ */
+static void print_sysmon_usage(void) {
+    printf("Usage: devhelper sysmon <command> [options]\n\n");
+    printf("Commands:\n");
+    printf("  live [interval_ms]    Live auto-refreshing monitor (100-5000 ms, default 1000)\n");
+    printf("  top [interval_ms]     Live process table sorted by CPU or memory\n");
+    printf("  record <file> [interval_ms] [duration_s]\n");
+    printf("                        Record samples into a compact file\n");
+    printf("  replay <file> [speed] [start_s]\n");
+    printf("                        Play a recording through the live view\n");
+    printf("  session [interval_ms] [duration_s] [save_file]\n");
+    printf("                        Sample, then report p50/p90/p99/max per metric\n");
+    printf("  smaps [interval_ms]   Per-process PSS/RSS/shared/private/swap from smaps_rollup\n");
+    printf("  diskio [interval_ms]  Per-device IOPS, throughput, await and utilization\n");
+    printf("  net [interval_ms|once]\n");
+    printf("                        Per-interface throughput; 'once' prints addresses and routes\n");
+    printf("  psi [interval_ms] [trigger_percent]\n");
+    printf("                        CPU/memory/IO stall pressure, optionally woken by PSI triggers\n");
+    printf("  sockets [interval_ms] TCP/UDP sockets with state, queues and owning process\n");
+    printf("  perf [interval_ms] [pid]\n");
+    printf("                        IPC, cache and branch miss rates per core or for one process\n");
+    printf("  profile <pid> [seconds] [hz] [out_file|-] [--ptrace]\n");
+    printf("                        Sample user stacks into collapsed format for flamegraphs\n");
+    printf("  agent <collector> [interval_ms] [batch] [name]\n");
+    printf("                        Stream samples to a collector (host:port or unix:/path)\n");
+    printf("  collect [listen] [interval_ms]\n");
+    printf("                        Accept agents and show the fleet table (default port 7373)\n");
+    printf("  stress [cpu=N@pct] [mem=MB@MBps] [disk=MBps@dir] [time=s] [ramp=t:pct,...]\n");
+    printf("                        Generate paced CPU, memory and disk load to check readings\n");
+    printf("  iobench [dir] [block_kb] [queue_depth] [file_mb] [seconds] [--threads]\n");
+    printf("                        O_DIRECT sequential/random read/write IOPS and latency\n");
+    printf("  membench [array_mb] [threads]\n");
+    printf("                        STREAM bandwidth and pointer-chase latency per NUMA node\n");
+    printf("  numa [pid]            Sockets, cores, caches, per-node memory and a pid's placement\n");
+    printf("  fincore <path>... [--warm|--evict] [-j threads]\n");
+    printf("                        Page-cache residency per file and per directory tree\n");
+    printf("  irq [interval_ms]     Per-CPU interrupt, softirq, run-queue wait and NIC IRQ balance\n");
+    printf("  leak <pid>... [-i seconds] [-w hours]\n");
+    printf("                        Track RSS/PSS/anon growth trends and flag suspected leaks\n");
+    printf("  iotop [interval_ms]   Processes ranked by disk read/write and I/O syscall rate\n");
+    printf("  exporter [[host:]port] [-s staleness_ms]\n");
+    printf("                        Serve OpenMetrics for Prometheus (default 127.0.0.1:9373)\n");
+    printf("  du [path] [threads]   Parallel directory size analyzer (stays on one filesystem)\n");
+    printf("  alert <rules_file> [interval_ms]\n");
+    printf("                        Watch threshold rules and run their actions\n");
+    printf("  merge <file>... [-o out_file]\n");
+    printf("                        Merge saved session sketches and report\n");
+}
+
+/**
+ * Entry point for "devhelper sysmon ..." invoked from the command line.
+ * argv[0] is the subcommand name.
+ */
+int sysmon_command(int argc, char *argv[]) {
+    if (argc < 1) {
+        print_sysmon_usage();
+        return 1;
+    }
+
+    if (strcmp(argv[0], "live") == 0) {
+        sysmon_live_view(argc > 1 ? atoi(argv[1]) : 1000);
+        return 0;
+    }
+    if (strcmp(argv[0], "top") == 0) {
+        sysmon_process_view(argc > 1 ? atoi(argv[1]) : 1000);
+        return 0;
+    }
+    if (strcmp(argv[0], "record") == 0 && argc > 1) {
+        sysmon_record(argv[1], argc > 2 ? atoi(argv[2]) : 1000, argc > 3 ? atoi(argv[3]) : 0);
+        return 0;
+    }
+    if (strcmp(argv[0], "replay") == 0 && argc > 1) {
+        sysmon_replay(argv[1], argc > 2 ? atof(argv[2]) : 1.0, argc > 3 ? atoi(argv[3]) : 0);
+        return 0;
+    }
+    if (strcmp(argv[0], "session") == 0) {
+        sysmon_session(argc > 1 ? atoi(argv[1]) : 1000, argc > 2 ? atoi(argv[2]) : 0,
+                       argc > 3 ? argv[3] : NULL);
+        return 0;
+    }
+    if (strcmp(argv[0], "smaps") == 0) {
+        sysmon_smaps_view(argc > 1 ? atoi(argv[1]) : 2000);
+        return 0;
+    }
+    if (strcmp(argv[0], "diskio") == 0) {
+        sysmon_disk_io_view(argc > 1 ? atoi(argv[1]) : 1000);
+        return 0;
+    }
+    if (strcmp(argv[0], "net") == 0) {
+        if (argc > 1 && strcmp(argv[1], "once") == 0) {
+            display_network_info();
+        } else {
+            sysmon_net_view(argc > 1 ? atoi(argv[1]) : 1000);
+        }
+        return 0;
+    }
+    if (strcmp(argv[0], "sockets") == 0) {
+        sysmon_socket_view(argc > 1 ? atoi(argv[1]) : 2000);
+        return 0;
+    }
+    if (strcmp(argv[0], "perf") == 0) {
+        sysmon_perf_view(argc > 1 ? atoi(argv[1]) : 1000, argc > 2 ? atoi(argv[2]) : 0);
+        return 0;
+    }
+    if (strcmp(argv[0], "profile") == 0 && argc > 1) {
+        bool use_ptrace = strcmp(argv[argc - 1], "--ptrace") == 0;
+        int args = use_ptrace ? argc - 1 : argc;
+        sysmon_profile(atoi(argv[1]), args > 2 ? atoi(argv[2]) : 10, args > 3 ? atoi(argv[3]) : 99,
+                       args > 4 ? argv[4] : NULL, use_ptrace);
+        return 0;
+    }
+    if (strcmp(argv[0], "agent") == 0 && argc > 1) {
+        sysmon_agent(argv[1], argc > 2 ? atoi(argv[2]) : 1000, argc > 3 ? atoi(argv[3]) : 5,
+                     argc > 4 ? argv[4] : NULL);
+        return 0;
+    }
+    if (strcmp(argv[0], "collect") == 0) {
+        sysmon_collector(argc > 1 ? argv[1] : "7373", argc > 2 ? atoi(argv[2]) : 1000);
+        return 0;
+    }
+    if (strcmp(argv[0], "stress") == 0) {
+        StressConfig config;
+        if (!stress_parse(&config, argc - 1, argv + 1)) {
+            return 1;
+        }
+        sysmon_stress(&config);
+        return 0;
+    }
+    if (strcmp(argv[0], "iobench") == 0) {
+        bool use_threads = strcmp(argv[argc - 1], "--threads") == 0;
+        int args = use_threads ? argc - 1 : argc;
+        sysmon_io_bench(args > 1 ? argv[1] : ".", args > 2 ? atoi(argv[2]) : 0, args > 3 ? atoi(argv[3]) : 32,
+                        args > 4 ? atoi(argv[4]) : 1024, args > 5 ? atoi(argv[5]) : 10, use_threads);
+        return 0;
+    }
+    if (strcmp(argv[0], "membench") == 0) {
+        sysmon_mem_bench(argc > 1 ? atoi(argv[1]) : 0, argc > 2 ? atoi(argv[2]) : 0);
+        return 0;
+    }
+    if (strcmp(argv[0], "numa") == 0) {
+#ifdef __linux__
+        display_cpu_topology();
+        if (argc > 1) {
+            display_numa_process(atoi(argv[1]));
+        }
+#endif
+        return 0;
+    }
+    if (strcmp(argv[0], "fincore") == 0 && argc > 1) {
+        FincoreAction action = FINCORE_REPORT;
+        int threads = 0;
+        int count = 0;
+        // Paths are compacted to the front of argv[1..]
+        for (int i = 1; i < argc; i++) {
+            if (strcmp(argv[i], "--warm") == 0) {
+                action = FINCORE_WARM;
+            } else if (strcmp(argv[i], "--evict") == 0) {
+                action = FINCORE_EVICT;
+            } else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+                threads = atoi(argv[++i]);
+            } else {
+                argv[1 + count++] = argv[i];
+            }
+        }
+        if (count == 0) {
+            print_sysmon_usage();
+            return 1;
+        }
+        sysmon_fincore(argv + 1, count, action, threads);
+        return 0;
+    }
+    if (strcmp(argv[0], "irq") == 0) {
+        sysmon_irq_view(argc > 1 ? atoi(argv[1]) : 1000);
+        return 0;
+    }
+    if (strcmp(argv[0], "leak") == 0 && argc > 1) {
+        int pids[32];
+        int count = 0;
+        int interval = 30;
+        double hours = 6.0;
+        for (int i = 1; i < argc; i++) {
+            if (strcmp(argv[i], "-i") == 0 && i + 1 < argc) {
+                interval = atoi(argv[++i]);
+            } else if (strcmp(argv[i], "-w") == 0 && i + 1 < argc) {
+                hours = atof(argv[++i]);
+            } else if (atoi(argv[i]) > 0 && count < 32) {
+                pids[count++] = atoi(argv[i]);
+            }
+        }
+        if (count == 0) {
+            print_sysmon_usage();
+            return 1;
+        }
+        sysmon_leak_watch(pids, count, interval, (int)(hours * 3600.0));
+        return 0;
+    }
+    if (strcmp(argv[0], "iotop") == 0) {
+        sysmon_iotop_view(argc > 1 ? atoi(argv[1]) : 1000);
+        return 0;
+    }
+    if (strcmp(argv[0], "exporter") == 0) {
+        const char *listen = NULL;
+        int staleness = 0;
+        for (int i = 1; i < argc; i++) {
+            if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+                staleness = atoi(argv[++i]);
+            } else {
+                listen = argv[i];
+            }
+        }
+        sysmon_exporter(listen, staleness);
+        return 0;
+    }
+    if (strcmp(argv[0], "du") == 0) {
+        sysmon_du_view(argc > 1 ? argv[1] : ".", argc > 2 ? atoi(argv[2]) : 0);
+        return 0;
+    }
+    if (strcmp(argv[0], "alert") == 0 && argc > 1) {
+        sysmon_alert_watch(argv[1], argc > 2 ? atoi(argv[2]) : 1000);
+        return 0;
+    }
+    if (strcmp(argv[0], "psi") == 0) {
+        sysmon_psi_view(argc > 1 ? atoi(argv[1]) : 1000, argc > 2 ? atoi(argv[2]) : 0);
+        return 0;
+    }
+    if (strcmp(argv[0], "merge") == 0 && argc > 1) {
+        const char *out = NULL;
+        int files = argc - 1;
+        if (argc > 3 && strcmp(argv[argc - 2], "-o") == 0) {
+            out = argv[argc - 1];
+            files -= 2;
+        }
+        return sysmon_merge_sessions(files, argv + 1, out);
+    }
+
+    print_error("Unknown sysmon command!");
+    print_sysmon_usage();
+    return 1;
+}
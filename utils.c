@@ -4,7 +4,18 @@
  * Common helper functions used throughout the application
  */
 
+#define _GNU_SOURCE
 #include "devhelper.h"
+#include <time.h>
+
+#ifdef _WIN32
+#include <conio.h>
+#else
+#include <termios.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/ioctl.h>
+#endif
 
 #ifdef _WIN32
 /**
@@ -187,3 +198,163 @@ void print_info(const char *message) {
 void print_warning(const char *message) {
     printf("%s⚠ %s%s\n", COLOR_YELLOW, message, COLOR_RESET);
 }
+
+#ifndef _WIN32
+static struct termios saved_termios;
+static bool termios_saved = false;
+static volatile sig_atomic_t raw_interrupted = 0;
+static struct sigaction saved_sigint, saved_sigterm;
+static bool sigint_saved = false, sigterm_saved = false;
+
+/**
+ * SIGINT/SIGTERM while a view has the terminal raw. The first signal
+ * makes wait_for_key() return so the view stops and restores the
+ * terminal itself; a second one means it is stuck, so restore and die.
+ */
+static void raw_signal_handler(int sig) {
+    if (raw_interrupted) {
+        tcsetattr(STDIN_FILENO, TCSANOW, &saved_termios);
+        signal(sig, SIG_DFL);
+        raise(sig);
+        return;
+    }
+    raw_interrupted = 1;
+}
+
+/**
+ * Catch sig unless the caller already has its own handler for it
+ */
+static bool catch_if_default(int sig, struct sigaction *old) {
+    struct sigaction sa;
+
+    if (sigaction(sig, NULL, old) != 0 || old->sa_handler != SIG_DFL) {
+        return false;
+    }
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = raw_signal_handler;
+    return sigaction(sig, &sa, NULL) == 0;
+}
+#endif
+
+/**
+ * Switch stdin between normal line mode and single-key, no-echo mode.
+ * Live views use this so one keypress exits without waiting for Enter.
+ * While raw, SIGINT and SIGTERM stop the view like a key does, unless
+ * the view installed handlers of its own.
+ */
+void terminal_set_raw(bool enable) {
+#ifdef _WIN32
+    (void)enable;
+    enable_windows_ansi_colors();
+#else
+    if (!isatty(STDIN_FILENO)) {
+        return;
+    }
+
+    if (enable) {
+        struct termios raw;
+        if (tcgetattr(STDIN_FILENO, &saved_termios) != 0) {
+            return;
+        }
+        termios_saved = true;
+        raw = saved_termios;
+        raw.c_lflag &= ~(ICANON | ECHO);
+        raw.c_cc[VMIN] = 0;
+        raw.c_cc[VTIME] = 0;
+        tcsetattr(STDIN_FILENO, TCSANOW, &raw);
+        raw_interrupted = 0;
+        sigint_saved = catch_if_default(SIGINT, &saved_sigint);
+        sigterm_saved = catch_if_default(SIGTERM, &saved_sigterm);
+        printf("\033[?25l");  // Hide cursor
+    } else if (termios_saved) {
+        tcsetattr(STDIN_FILENO, TCSANOW, &saved_termios);
+        termios_saved = false;
+        if (sigint_saved) sigaction(SIGINT, &saved_sigint, NULL);
+        if (sigterm_saved) sigaction(SIGTERM, &saved_sigterm, NULL);
+        sigint_saved = sigterm_saved = false;
+        printf("\033[?25h");  // Show cursor
+    }
+    fflush(stdout);
+#endif
+}
+
+/**
+ * True once SIGINT or SIGTERM arrived while terminal_set_raw() was
+ * handling them. Views that poll more than stdin check this themselves.
+ */
+bool terminal_interrupted(void) {
+#ifdef _WIN32
+    return false;
+#else
+    return raw_interrupted != 0;
+#endif
+}
+
+/**
+ * Wait up to timeout_ms for a keypress.
+ * Returns the key code, or -1 if the timeout expired first. EOF on stdin
+ * and a caught SIGINT/SIGTERM return 0.
+ */
+int wait_for_key(int timeout_ms) {
+#ifdef _WIN32
+    long long deadline = monotonic_ms() + timeout_ms;
+    while (!_kbhit()) {
+        if (monotonic_ms() >= deadline) {
+            return -1;
+        }
+        Sleep(10);
+    }
+    return _getch();
+#else
+    struct pollfd pfd = { .fd = STDIN_FILENO, .events = POLLIN };
+
+    if (raw_interrupted) {
+        return 0;
+    }
+    if (poll(&pfd, 1, timeout_ms < 0 ? 0 : timeout_ms) <= 0) {
+        return raw_interrupted ? 0 : -1;
+    }
+
+    unsigned char key;
+    if (read(STDIN_FILENO, &key, 1) != 1) {
+        // EOF on stdin also counts as a request to stop
+        return 0;
+    }
+    return key;
+#endif
+}
+
+/**
+ * Query the terminal dimensions, falling back to 24x80
+ */
+void get_terminal_size(int *rows, int *cols) {
+    *rows = 24;
+    *cols = 80;
+
+#ifdef _WIN32
+    CONSOLE_SCREEN_BUFFER_INFO info;
+    if (GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &info)) {
+        *rows = info.srWindow.Bottom - info.srWindow.Top + 1;
+        *cols = info.srWindow.Right - info.srWindow.Left + 1;
+    }
+#else
+    struct winsize ws;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) == 0 && ws.ws_row > 0 && ws.ws_col > 0) {
+        *rows = ws.ws_row;
+        *cols = ws.ws_col;
+    }
+#endif
+}
+
+/**
+ * Milliseconds from a monotonic clock, for scheduling refreshes
+ */
+long long monotonic_ms(void) {
+#ifdef _WIN32
+    return (long long)GetTickCount64();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+#endif
+}